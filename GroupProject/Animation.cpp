@@ -0,0 +1,363 @@
+/**
+ * @file Animation.cpp
+ * @brief Implementation of the Animation class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "Animation.h"
+#include "ExplodedView.h"
+#include "Trace.h"
+
+#include <QList>
+
+#include <vtkCamera.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkTransform.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+/**
+ * @brief Moves a cursor to the last key at or before a time.
+ * @param keys Keys sorted by time.
+ * @param count Number of keys, at least one.
+ * @param time Time to find.
+ * @param cursor Key found last time, where the search starts.
+ * @return the key index, 0 if the time is before the first key
+ */
+template <typename KeyType>
+int seek(const KeyType* keys, int count, double time, int cursor) {
+    cursor = std::min(cursor, count - 1);
+    while (cursor > 0 && time < keys[cursor].time)
+        --cursor;
+    while (cursor + 1 < count && time >= keys[cursor + 1].time)
+        ++cursor;
+    return cursor;
+}
+
+/**
+ * @brief Returns how far a time is between two keys, 0 to 1.
+ */
+double fraction(double from, double to, double time, Animation::Easing easing) {
+    double u = std::clamp((time - from) / (to - from), 0., 1.);
+    if (easing == Animation::EaseInOut)
+        u = u * u * (3. - 2. * u);
+    return u;
+}
+
+/**
+ * @brief Interpolates three values.
+ */
+void lerp(const double from[3], const double to[3], double u, double result[3]) {
+    for (int k = 0; k < 3; ++k)
+        result[k] = from[k] + u * (to[k] - from[k]);
+}
+
+}
+
+/**
+ * @brief Sizes the cursors and matrices for the animation's tracks.
+ */
+Animation::Playhead::Playhead(const Animation& animation)
+    : cursors(animation.tracks.size(), 0), local(16 * animation.tracks.size()),
+      world(16 * animation.tracks.size()) {
+}
+
+/**
+ * @brief Looks the part up before adding a track.
+ */
+int Animation::addTrack(ModelPart* part) {
+    auto it = trackOfPart.constFind(part);
+    if (it != trackOfPart.constEnd())
+        return it.value();
+
+    Track track;
+    track.part = part;
+    tracks.append(track);
+    trackOfPart.insert(part, tracks.size() - 1);
+    return tracks.size() - 1;
+}
+
+/**
+ * @brief Appends the key, it is sorted into place by finish().
+ */
+void Animation::addKey(int track, const Key& key) {
+    keys.append(key);
+    keyTracks.append(track);
+}
+
+/**
+ * @brief Appends the key, it is sorted into place by finish().
+ */
+void Animation::addCameraKey(const CameraKey& key) {
+    cameraKeys.append(key);
+}
+
+/**
+ * @brief Groups the keys by track and works out how each track's world matrix is composed.
+ */
+void Animation::finish() {
+    TRACE_SCOPE("Animation::finish");
+
+    /* A track without keys holds the part where it is */
+    QVector<bool> hasKeys(tracks.size(), false);
+    for (int track : std::as_const(keyTracks))
+        hasKeys[track] = true;
+    for (int i = 0; i < tracks.size(); ++i) {
+        if (!hasKeys[i])
+            addKey(i, { 0., tracks[i].part->transform(), Linear });
+    }
+
+    /* Stable, so keys at the same time keep the order they were added in */
+    QVector<int> sorted(keys.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::stable_sort(sorted.begin(), sorted.end(), [this](int a, int b) {
+        if (keyTracks[a] != keyTracks[b])
+            return keyTracks[a] < keyTracks[b];
+        return keys[a].time < keys[b].time;
+    });
+    QVector<Key> grouped;
+    grouped.reserve(keys.size());
+    for (int i = 0; i < sorted.size(); ++i) {
+        Track& track = tracks[keyTracks[sorted[i]]];
+        if (track.keyCount++ == 0)
+            track.firstKey = i;
+        grouped.append(keys[sorted[i]]);
+    }
+    keys = grouped;
+    keyTracks.clear();
+
+    std::stable_sort(cameraKeys.begin(), cameraKeys.end(), [](const CameraKey& a, const CameraKey& b) {
+        return a.time < b.time;
+    });
+
+    length = 0.;
+    for (const Key& key : std::as_const(keys))
+        length = std::max(length, key.time);
+    for (const CameraKey& key : std::as_const(cameraKeys))
+        length = std::max(length, key.time);
+
+    /* Parents are evaluated before their children, so sorting by depth is enough */
+    QVector<int> depths(tracks.size(), 0);
+    for (int i = 0; i < tracks.size(); ++i) {
+        for (ModelPart* part = tracks[i].part->parentItem(); part; part = part->parentItem())
+            ++depths[i];
+    }
+    order.resize(tracks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&depths](int a, int b) { return depths[a] < depths[b]; });
+
+    /* Collect the fixed local matrices between each track and its nearest animated ancestor */
+    for (Track& track : tracks) {
+        double between[16];
+        vtkMatrix4x4::Identity(between);
+        track.parent = -1;
+        for (ModelPart* part = track.part->parentItem(); part; part = part->parentItem()) {
+            auto it = trackOfPart.constFind(part);
+            if (it != trackOfPart.constEnd()) {
+                track.parent = it.value();
+                break;
+            }
+            double local[16];
+            double product[16];
+            part->transform().toMatrix(local);
+            vtkMatrix4x4::Multiply4x4(local, between, product);
+            std::copy(product, product + 16, between);
+        }
+        std::copy(between, between + 16, track.base);
+
+        vtkMatrix4x4* dequantise = nullptr;
+        track.part->getStoredGeometry(&dequantise);
+        if (dequantise)
+            vtkMatrix4x4::DeepCopy(track.stored, dequantise);
+        else
+            vtkMatrix4x4::Identity(track.stored);
+    }
+}
+
+/**
+ * @brief Returns the time of the last key.
+ */
+double Animation::duration() const {
+    return length;
+}
+
+/**
+ * @brief Returns the number of tracks.
+ */
+int Animation::trackCount() const {
+    return tracks.size();
+}
+
+/**
+ * @brief Returns the track's part.
+ */
+ModelPart* Animation::part(int track) const {
+    return tracks[track].part;
+}
+
+/**
+ * @brief Looks up the part's track.
+ */
+int Animation::track(ModelPart* part) const {
+    return trackOfPart.value(part, -1);
+}
+
+/**
+ * @brief Checks for camera keys.
+ */
+bool Animation::hasCamera() const {
+    return !cameraKeys.isEmpty();
+}
+
+/**
+ * @brief Moves each cursor to its key, interpolates the local matrices and composes the world ones.
+ */
+void Animation::evaluate(double time, Playhead& playhead) const {
+    int* cursors = playhead.cursors.data();
+    double* local = playhead.local.data();
+    double* world = playhead.world.data();
+
+    for (int i = 0; i < tracks.size(); ++i) {
+        const Track& track = tracks[i];
+        const Key* first = keys.constData() + track.firstKey;
+        const int cursor = cursors[i] = seek(first, track.keyCount, time, cursors[i]);
+        const Key& from = first[cursor];
+
+        if (cursor + 1 == track.keyCount || time <= from.time) {
+            from.transform.toMatrix(local + 16 * i);
+            continue;
+        }
+        const Key& to = first[cursor + 1];
+        const double u = fraction(from.time, to.time, time, from.easing);
+        ModelPart::Transform transform;
+        lerp(from.transform.position, to.transform.position, u, transform.position);
+        lerp(from.transform.orientation, to.transform.orientation, u, transform.orientation);
+        lerp(from.transform.scale, to.transform.scale, u, transform.scale);
+        transform.toMatrix(local + 16 * i);
+    }
+
+    for (int i : order) {
+        const Track& track = tracks[i];
+        double parentWorld[16];
+        if (track.parent >= 0)
+            vtkMatrix4x4::Multiply4x4(world + 16 * track.parent, track.base, parentWorld);
+        else
+            std::copy(track.base, track.base + 16, parentWorld);
+        vtkMatrix4x4::Multiply4x4(parentWorld, local + 16 * i, world + 16 * i);
+    }
+
+    playhead.cameraPose.time = time;
+    if (cameraKeys.isEmpty())
+        return;
+    const int cursor = playhead.cameraCursor = seek(cameraKeys.constData(), int(cameraKeys.size()), time,
+                                                    playhead.cameraCursor);
+    const CameraKey& from = cameraKeys[cursor];
+    const CameraKey& to = cameraKeys[std::min(cursor + 1, int(cameraKeys.size()) - 1)];
+    const double u = &from == &to || time <= from.time ? 0. : fraction(from.time, to.time, time, Linear);
+    lerp(from.position, to.position, u, playhead.cameraPose.position);
+    lerp(from.focalPoint, to.focalPoint, u, playhead.cameraPose.focalPoint);
+    lerp(from.viewUp, to.viewUp, u, playhead.cameraPose.viewUp);
+}
+
+/**
+ * @brief Appends the dequantisation to the track's world matrix.
+ */
+void Animation::actorMatrix(int track, const Playhead& playhead, double matrix[16]) const {
+    vtkMatrix4x4::Multiply4x4(playhead.worldMatrix(track), tracks[track].stored, matrix);
+}
+
+/**
+ * @brief Gives every part below the node six keys: rest, leave, arrive, hold, return and rest.
+ */
+Animation Animation::explodeSequence(ModelPart* root, double duration) {
+    TRACE_SCOPE("Animation::explodeSequence");
+
+    /* Also brings the world matrices up to date, which the parents' frames are read from */
+    const QHash<ModelPart*, ExplodedView::Offset> offsets = ExplodedView::offsets(root);
+
+    struct Entry {
+        ModelPart*  part;
+        int         level;
+    };
+    QList<Entry> entries;
+    QList<Entry> stack;
+    for (int i = root->childCount() - 1; i >= 0; --i)
+        stack.append({ root->child(i), 0 });
+    int levels = 0;
+    while (!stack.isEmpty()) {
+        Entry entry = stack.takeLast();
+        entries.append(entry);
+        levels = std::max(levels, entry.level + 1);
+        for (int i = entry.part->childCount() - 1; i >= 0; --i)
+            stack.append({ entry.part->child(i), entry.level + 1 });
+    }
+
+    /* Exploding and assembling take 40% of the time each, with a pause between */
+    const double phase = 0.4 * duration;
+    const double slot = levels > 0 ? phase / levels : 0.;
+
+    Animation animation;
+    for (const Entry& entry : std::as_const(entries)) {
+        ModelPart* part = entry.part;
+        ModelPart* parent = part->parentItem();
+        const ExplodedView::Offset offset = offsets.value(part);
+        const ExplodedView::Offset parentOffset = parent == root ? ExplodedView::Offset{ 0., 0., 0. }
+                                                                 : offsets.value(parent);
+
+        /* The offsets are in the scene, the transform is in the parent's frame */
+        double inverse[16];
+        vtkMatrix4x4::Invert(parent->worldMatrix(), inverse);
+        ModelPart::Transform rest = part->transform();
+        ModelPart::Transform exploded = rest;
+        for (int row = 0; row < 3; ++row) {
+            for (int k = 0; k < 3; ++k)
+                exploded.position[row] += inverse[4 * row + k] * (offset[k] - parentOffset[k]);
+        }
+
+        const double leave = entry.level * slot;
+        const double back = duration - phase + (levels - 1 - entry.level) * slot;
+        const int track = animation.addTrack(part);
+        animation.addKey(track, { 0., rest, Linear });
+        animation.addKey(track, { leave, rest, EaseInOut });
+        animation.addKey(track, { leave + slot, exploded, Linear });
+        animation.addKey(track, { back, exploded, EaseInOut });
+        animation.addKey(track, { back + slot, rest, Linear });
+        animation.addKey(track, { duration, rest, Linear });
+    }
+    animation.finish();
+    return animation;
+}
+
+/**
+ * @brief Samples the turn every five degrees.
+ */
+Animation Animation::cameraOrbit(vtkCamera* camera, double duration) {
+    const int steps = 72;
+
+    CameraKey start;
+    camera->GetPosition(start.position);
+    camera->GetFocalPoint(start.focalPoint);
+    camera->GetViewUp(start.viewUp);
+
+    Animation animation;
+    vtkNew<vtkTransform> turn;
+    for (int i = 0; i <= steps; ++i) {
+        turn->Identity();
+        turn->Translate(start.focalPoint);
+        turn->RotateWXYZ(360. * i / steps, start.viewUp);
+        turn->Translate(-start.focalPoint[0], -start.focalPoint[1], -start.focalPoint[2]);
+
+        CameraKey key = start;
+        key.time = duration * i / steps;
+        turn->TransformPoint(start.position, key.position);
+        animation.addCameraKey(key);
+    }
+    animation.finish();
+    return animation;
+}
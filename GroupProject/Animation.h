@@ -0,0 +1,199 @@
+/**
+ * @file Animation.h
+ * @brief Declaration of the Animation class, a keyframe timeline of part placements and camera poses.
+ * @details A part's track is a list of keys, each giving its local transform at a time in seconds;
+ *          between keys the transform is interpolated, and the world matrices are composed down
+ *          the tree from the animated local ones. A camera track does the same for the view.
+ *          Keys live in one flat array, sorted by track and time, and every track remembers the
+ *          key it was last evaluated at, so stepping forward costs a comparison per track and
+ *          nothing is allocated once a Playhead exists. The timeline itself is read only after
+ *          finish(), so the desktop view and the VR thread can play the same one at once, each
+ *          with its own Playhead and clock.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_ANIMATION_H
+#define VIEWER_ANIMATION_H
+
+#include "ModelPart.h"
+
+#include <QHash>
+#include <QVector>
+
+class vtkCamera;
+
+/**
+ * @class Animation
+ * @brief Timeline of keyframed part transforms and camera poses.
+ * @details Orientations are interpolated angle by angle, like the position and scale, so keys
+ *          should be close enough that this looks right.
+ */
+class Animation {
+public:
+    /** How the segment from a key to the next one is interpolated */
+    enum Easing {
+        Linear,     /**< Constant speed */
+        EaseInOut   /**< Starts and stops smoothly */
+    };
+
+    /** A part's placement at one time */
+    struct Key {
+        double                  time = 0.;          /**< Seconds from the start */
+        ModelPart::Transform    transform;          /**< Placement relative to the parent */
+        Easing                  easing = Linear;    /**< Interpolation towards the next key */
+    };
+
+    /** The camera's pose at one time */
+    struct CameraKey {
+        double  time = 0.;                          /**< Seconds from the start */
+        double  position[3] = { 0., 0., 0. };       /**< Eye position */
+        double  focalPoint[3] = { 0., 0., 0. };     /**< Point looked at */
+        double  viewUp[3] = { 0., 0., 1. };         /**< Up direction */
+    };
+
+    /**
+     * @class Playhead
+     * @brief Where one viewer is in an animation, and the matrices it evaluated there.
+     * @details Holds everything evaluate() writes, allocated once for the animation's tracks.
+     *          Use one per thread.
+     */
+    class Playhead {
+    public:
+        /**
+         * @brief Allocates the state for an animation; it must be finished.
+         */
+        explicit Playhead(const Animation& animation);
+
+        /**
+         * @brief Returns a track's row-major local matrix at the last evaluated time.
+         */
+        const double* localMatrix(int track) const { return local.constData() + 16 * track; }
+
+        /**
+         * @brief Returns a track's row-major world matrix at the last evaluated time.
+         */
+        const double* worldMatrix(int track) const { return world.constData() + 16 * track; }
+
+        /**
+         * @brief Returns the camera pose at the last evaluated time.
+         */
+        const CameraKey& camera() const { return cameraPose; }
+
+    private:
+        friend class Animation;
+
+        QVector<int>    cursors;            /**< Per track, the key last evaluated from */
+        int             cameraCursor = 0;   /**< Camera key last evaluated from */
+        QVector<double> local;              /**< 16 values per track */
+        QVector<double> world;              /**< 16 values per track */
+        CameraKey       cameraPose;         /**< Interpolated camera, its time is the evaluated time */
+    };
+
+    /**
+     * @brief Adds a track for a part, or returns its existing one.
+     * @param part Part to animate.
+     * @return the track's index
+     */
+    int addTrack(ModelPart* part);
+
+    /**
+     * @brief Adds a key to a track; keys may be added in any order.
+     */
+    void addKey(int track, const Key& key);
+
+    /**
+     * @brief Adds a camera key; keys may be added in any order.
+     */
+    void addCameraKey(const CameraKey& key);
+
+    /**
+     * @brief Sorts the keys and links every track to its nearest animated ancestor.
+     * @details Call on the GUI thread once all keys are added, with the world matrices current.
+     *          A track without keys keeps the part's current transform. Parts between a track and
+     *          its animated ancestor are taken to stay where they are now.
+     */
+    void finish();
+
+    /**
+     * @brief Returns the time of the last key, in seconds.
+     */
+    double duration() const;
+
+    /**
+     * @brief Returns the number of part tracks.
+     */
+    int trackCount() const;
+
+    /**
+     * @brief Returns the part a track animates.
+     */
+    ModelPart* part(int track) const;
+
+    /**
+     * @brief Returns a part's track, -1 if it is not animated.
+     */
+    int track(ModelPart* part) const;
+
+    /**
+     * @brief Checks whether the animation moves the camera.
+     */
+    bool hasCamera() const;
+
+    /**
+     * @brief Interpolates every track and the camera at a time.
+     * @details Allocation free. Fastest when the time only moves forward, but any time works;
+     *          times outside the animation hold the first or last key.
+     * @param time Seconds from the start.
+     * @param playhead Receives the matrices and camera pose.
+     */
+    void evaluate(double time, Playhead& playhead) const;
+
+    /**
+     * @brief Computes the user matrix for an actor showing a track's stored geometry.
+     * @details The world matrix from the playhead, followed by the dequantisation of a compact part.
+     * @param track Track of the actor's part.
+     * @param playhead Playhead evaluate() last wrote to.
+     * @param matrix Receives 16 values.
+     */
+    void actorMatrix(int track, const Playhead& playhead, double matrix[16]) const;
+
+    /**
+     * @brief Builds a sequence that explodes the parts below a node, holds, and assembles them again.
+     * @details Each level of the tree moves in turn, the top level first when exploding and last
+     *          when assembling, to the positions the explode slider uses at its end.
+     * @param root Node whose descendants move, normally the tree's root item.
+     * @param duration Length of the whole sequence in seconds.
+     * @return the finished animation
+     */
+    static Animation explodeSequence(ModelPart* root, double duration);
+
+    /**
+     * @brief Builds one turn of the camera around its focal point, about its up direction.
+     * @param camera Camera to start from.
+     * @param duration Length of the turn in seconds.
+     * @return the finished animation
+     */
+    static Animation cameraOrbit(vtkCamera* camera, double duration);
+
+private:
+    /** Keys and tree links of one part */
+    struct Track {
+        ModelPart*  part;               /**< Animated part */
+        int         firstKey = 0;       /**< Index of its first key in keys, after finish() */
+        int         keyCount = 0;       /**< Number of keys */
+        int         parent = -1;        /**< Track of the nearest animated ancestor, -1 if none */
+        double      base[16];           /**< Parent track's world to this part's parent's world, or the parent's world if no parent track */
+        double      stored[16];         /**< Dequantisation of the stored geometry, identity unless compact */
+    };
+
+    QVector<Track>          tracks;         /**< Part tracks, in the order they were added */
+    QVector<Key>            keys;           /**< Keys of all tracks, grouped by track after finish() */
+    QVector<int>            keyTracks;      /**< Track of each key, until finish() groups them */
+    QVector<int>            order;          /**< Track indexes, ancestors before descendants */
+    QHash<ModelPart*, int>  trackOfPart;    /**< Track of each animated part */
+    QVector<CameraKey>      cameraKeys;     /**< Camera keys by time */
+    double                  length = 0.;    /**< Time of the last key */
+};
+
+#endif
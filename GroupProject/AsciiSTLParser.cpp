@@ -0,0 +1,201 @@
+/**
+ * @file AsciiSTLParser.cpp
+ * @brief Implementation of the AsciiSTLParser class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "AsciiSTLParser.h"
+#include "MeshUtils.h"
+
+#include <QFile>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+/** Smallest chunk worth parsing on its own thread */
+const qint64 MinChunkBytes = 1 << 20;
+
+/** Size of a binary STL header plus triangle count */
+const qint64 BinaryHeaderBytes = 84;
+
+/** Size of one triangle record in a binary STL file */
+const qint64 BinaryTriangleBytes = 50;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/** Returns the position of the next whole word at or after pos, e.g. "facet" but not the tail of
+ *  "endfacet", or the size of the text if there is none */
+size_t findToken(std::string_view text, std::string_view word, size_t pos) {
+    while ((pos = text.find(word, pos)) != std::string_view::npos) {
+        const size_t after = pos + word.size();
+        if ((pos == 0 || isSpace(text[pos - 1])) && (after == text.size() || isSpace(text[after])))
+            return pos;
+        pos += word.size();
+    }
+    return text.size();
+}
+
+/** Returns the position of the next "facet" keyword at or after pos */
+size_t findFacet(std::string_view text, size_t pos) {
+    return findToken(text, "facet", pos);
+}
+
+/** Returns the position after the line that contains pos */
+size_t skipLine(std::string_view text, size_t pos) {
+    pos = text.find('\n', pos);
+    return pos == std::string_view::npos ? text.size() : pos + 1;
+}
+
+/** Skips a "solid name" line at pos, if there is one; the name may contain any word */
+size_t skipSolidLine(std::string_view text, size_t pos) {
+    while (pos < text.size() && isSpace(text[pos]))
+        ++pos;
+    if (text.compare(pos, 5, "solid") == 0 && (pos + 5 == text.size() || isSpace(text[pos + 5])))
+        pos = skipLine(text, pos);
+    return pos;
+}
+
+/** A piece of the file parsed by one task */
+struct Chunk {
+    const char*         begin = nullptr;
+    const char*         end = nullptr;
+    std::vector<float>  vertices;
+    bool                ok = true;
+};
+
+}
+
+/**
+ * @brief Decides whether a file is ASCII by checking its first bytes and size.
+ */
+bool AsciiSTLParser::isAscii(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray head = file.read(BinaryHeaderBytes);
+    if (!head.trimmed().startsWith("solid"))
+        return false;
+
+    /* A binary file whose header happens to start with "solid" still has a consistent size */
+    if (head.size() == BinaryHeaderBytes) {
+        quint32 triangles;
+        std::memcpy(&triangles, head.constData() + 80, sizeof(triangles));
+        if (BinaryHeaderBytes + qint64(triangles) * BinaryTriangleBytes == file.size())
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses every "vertex x y z" line in a block of text.
+ * @details Only the whole word "vertex" starts a vertex; the names on "solid" and "endsolid"
+ *          lines are skipped, since they may contain it too.
+ */
+bool AsciiSTLParser::parseBlock(const char* begin, const char* end, std::vector<float>& vertices) {
+    std::string_view text(begin, static_cast<size_t>(end - begin));
+    size_t pos = skipSolidLine(text, 0);
+    size_t endSolid = findToken(text, "endsolid", pos);
+
+    while ((pos = findToken(text, "vertex", pos)) < text.size()) {
+        /* Past the end of a solid: skip its name and the next solid's */
+        if (pos > endSolid) {
+            pos = skipSolidLine(text, skipLine(text, endSolid));
+            endSolid = findToken(text, "endsolid", pos);
+            continue;
+        }
+
+        const char* p = begin + pos + 6;
+        for (int k = 0; k < 3; ++k) {
+            while (p < end && isSpace(*p))
+                ++p;
+            if (p < end && *p == '+')           // from_chars does not accept a leading '+'
+                ++p;
+
+            float value;
+            std::from_chars_result result = std::from_chars(p, end, value);
+            if (result.ec != std::errc())
+                return false;
+            vertices.push_back(value);
+            p = result.ptr;
+        }
+        pos = static_cast<size_t>(p - begin);
+    }
+
+    return vertices.size() % 9 == 0;
+}
+
+/**
+ * @brief Reads an ASCII STL file using all cores.
+ */
+vtkSmartPointer<vtkPolyData> AsciiSTLParser::read(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    const qint64 size = file.size();
+    const char* data = reinterpret_cast<const char*>(file.map(0, size));
+    if (!data)
+        return nullptr;
+
+    std::string_view text(data, static_cast<size_t>(size));
+
+    /* Split at facet boundaries near evenly spaced offsets, skipping the "solid name" line */
+    qint64 chunkCount = std::max<qint64>(1, std::min<qint64>(QThread::idealThreadCount() * 4, size / MinChunkBytes));
+    QVector<Chunk> chunks;
+    size_t start = findFacet(text, 0);
+    for (qint64 c = 1; c <= chunkCount && start < text.size(); ++c) {
+        size_t next = (c == chunkCount) ? text.size()
+                                        : findFacet(text, std::max(start + 1, size_t(size * c / chunkCount)));
+        Chunk chunk;
+        chunk.begin = data + start;
+        chunk.end = data + next;
+        chunks.append(chunk);
+        start = next;
+    }
+
+    /* Parse all chunks in parallel, a facet is roughly 28 bytes of text per float */
+    QtConcurrent::blockingMap(chunks, [](Chunk& chunk) {
+        chunk.vertices.reserve(static_cast<size_t>(chunk.end - chunk.begin) / 28);
+        chunk.ok = parseBlock(chunk.begin, chunk.end, chunk.vertices);
+    });
+
+    /* Merge into a single triangle soup, each chunk copies into its own slice */
+    QVector<size_t> offsets(chunks.size() + 1, 0);
+    for (int c = 0; c < chunks.size(); ++c) {
+        if (!chunks[c].ok)
+            return nullptr;
+        offsets[c + 1] = offsets[c] + chunks[c].vertices.size();
+    }
+    if (offsets.last() == 0)
+        return nullptr;
+
+    std::vector<float> soup(offsets.last());
+    Chunk* chunkData = chunks.data();
+    const size_t* offsetData = offsets.constData();
+    MeshUtils::parallelFor(chunks.size(), [&](qint64 begin, qint64 end) {
+        for (qint64 c = begin; c < end; ++c) {
+            std::vector<float>& vertices = chunkData[c].vertices;
+            std::memcpy(soup.data() + offsetData[c], vertices.data(), vertices.size() * sizeof(float));
+            std::vector<float>().swap(vertices);
+        }
+    }, 1);
+
+    /* Merge shared corners like vtkSTLReader does, so filters see a connected mesh */
+    std::vector<float> points;
+    std::vector<quint32> indices;
+    MeshUtils::weld(soup, points, indices);
+
+    return MeshUtils::makePolyData(points.data(), static_cast<qint64>(points.size() / 3),
+                                   indices.data(), static_cast<qint64>(indices.size() / 3));
+}
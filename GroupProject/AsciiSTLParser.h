@@ -0,0 +1,55 @@
+/**
+ * @file AsciiSTLParser.h
+ * @brief Declaration of the AsciiSTLParser class, a parallel reader for ASCII STL files.
+ * @details vtkSTLReader parses ASCII files with stream based number parsing, which is far too slow
+ *          for the multi-hundred-MB exports produced by some CAD packages. This parser memory-maps
+ *          the file, splits it into chunks at facet boundaries, parses the chunks on all cores with
+ *          std::from_chars and welds the merged result into an indexed mesh.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_ASCIISTLPARSER_H
+#define VIEWER_ASCIISTLPARSER_H
+
+#include <QString>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+#include <vector>
+
+/**
+ * @class AsciiSTLParser
+ * @brief Fast parallel parser for ASCII STL files.
+ */
+class AsciiSTLParser {
+public:
+    /**
+     * @brief Checks whether a file is an ASCII STL file.
+     * @details Binary files may also start with "solid", so a file is only treated as ASCII if
+     *          its size does not match the triangle count in the binary header.
+     * @param fileName Path to the STL file.
+     * @return true if the file should be parsed as ASCII.
+     */
+    static bool isAscii(const QString& fileName);
+
+    /**
+     * @brief Reads an ASCII STL file.
+     * @param fileName Path to the STL file.
+     * @return the welded mesh, or nullptr if the file could not be parsed
+     */
+    static vtkSmartPointer<vtkPolyData> read(const QString& fileName);
+
+    /**
+     * @brief Parses the vertices of a block of ASCII STL text.
+     * @details The block must start and end on facet boundaries so that no vertex is split.
+     * @param begin Start of the text.
+     * @param end One past the end of the text.
+     * @param vertices Receives 3 floats per vertex, 3 vertices per facet.
+     * @return false if a vertex line could not be parsed
+     */
+    static bool parseBlock(const char* begin, const char* end, std::vector<float>& vertices);
+};
+
+#endif
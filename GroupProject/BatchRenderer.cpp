@@ -0,0 +1,492 @@
+/**
+ * @file BatchRenderer.cpp
+ * @brief Implementation of the BatchRenderer class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "BatchRenderer.h"
+#include "FolderWatcher.h"
+#include "MeshImporter.h"
+#include "MeshUtils.h"
+#include "ModelPart.h"
+#include "ModelPartList.h"
+#include "Trace.h"
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkSmartPointer.h>
+#include <vtkWindowToImageFilter.h>
+
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+/** Camera direction (from the focal point towards the camera) and view up of a preset */
+struct ViewPreset {
+    const char* name;
+    double      direction[3];
+    double      up[3];
+};
+
+const ViewPreset ViewPresets[] = {
+    { "iso",    {  1.,  1.,  1. }, { 0., 1.,  0. } },
+    { "front",  {  0.,  0.,  1. }, { 0., 1.,  0. } },
+    { "back",   {  0.,  0., -1. }, { 0., 1.,  0. } },
+    { "left",   { -1.,  0.,  0. }, { 0., 1.,  0. } },
+    { "right",  {  1.,  0.,  0. }, { 0., 1.,  0. } },
+    { "top",    {  0.,  1.,  0. }, { 0., 0., -1. } },
+    { "bottom", {  0., -1.,  0. }, { 0., 0.,  1. } },
+};
+
+/** Offscreen window and renderer owned by one thread */
+struct OffscreenView {
+    vtkSmartPointer<vtkRenderWindow>    window;
+    vtkSmartPointer<vtkRenderer>        renderer;
+};
+
+/**
+ * @brief Returns the calling thread's offscreen view, creating it on first use.
+ */
+OffscreenView& threadView() {
+    thread_local OffscreenView view;
+    if (!view.window) {
+        view.renderer = vtkSmartPointer<vtkRenderer>::New();
+        view.renderer->SetBackground(1., 1., 1.);
+        view.window = vtkSmartPointer<vtkRenderWindow>::New();
+        view.window->SetOffScreenRendering(1);
+        view.window->AddRenderer(view.renderer);
+    }
+    return view;
+}
+
+/**
+ * @brief Renders a mesh while the camera turns once around it and returns the average frame time.
+ */
+double timeFrames(vtkPolyData* polyData, int width, int height, int frames) {
+    OffscreenView& offscreen = threadView();
+    offscreen.renderer->RemoveAllViewProps();
+    auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    mapper->SetInputData(polyData);
+    auto actor = vtkSmartPointer<vtkActor>::New();
+    actor->SetMapper(mapper);
+    offscreen.renderer->AddActor(actor);
+
+    vtkCamera* camera = offscreen.renderer->GetActiveCamera();
+    camera->SetFocalPoint(0., 0., 0.);
+    camera->SetPosition(1., 1., 1.);
+    camera->SetViewUp(0., 1., 0.);
+    offscreen.renderer->ResetCamera();
+    offscreen.window->SetSize(width, height);
+
+    /* The first frames upload the buffers and compile the shaders */
+    for (int i = 0; i < 5; ++i)
+        offscreen.window->Render();
+    offscreen.window->WaitForCompletion();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < frames; ++i) {
+        camera->Azimuth(360. / frames);
+        offscreen.window->Render();
+    }
+    offscreen.window->WaitForCompletion();
+    const double elapsedMs = timer.nsecsElapsed() / 1e6;
+
+    offscreen.renderer->RemoveAllViewProps();
+    return elapsedMs / frames;
+}
+
+/** One image to render for a part */
+struct PartJob {
+    ModelPart*  part;
+    QString     baseName;
+    bool        ok = false;
+};
+
+}
+
+/**
+ * @brief Looks for the --render switch.
+ */
+bool BatchRenderer::isRequested(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--render") == 0)
+            return true;
+    return false;
+}
+
+/**
+ * @brief Returns the preset names in table order.
+ */
+QStringList BatchRenderer::viewNames() {
+    QStringList names;
+    for (const ViewPreset& preset : ViewPresets)
+        names.append(preset.name);
+    return names;
+}
+
+/**
+ * @brief Renders the items with the thread's offscreen window and copies the frame buffer.
+ */
+QImage BatchRenderer::renderToImage(const QList<Item>& items, const QString& view, int width, int height) {
+    TRACE_SCOPE("BatchRenderer::renderToImage");
+
+    const ViewPreset* preset = nullptr;
+    for (const ViewPreset& p : ViewPresets)
+        if (view == QLatin1String(p.name))
+            preset = &p;
+    if (!preset)
+        return QImage();
+
+    OffscreenView& offscreen = threadView();
+    offscreen.renderer->RemoveAllViewProps();
+    for (const Item& item : items) {
+        auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        mapper->SetInputData(item.polyData);
+        auto actor = vtkSmartPointer<vtkActor>::New();
+        actor->SetMapper(mapper);
+        actor->SetUserMatrix(item.matrix);
+        actor->GetProperty()->SetColor(item.rgb[0], item.rgb[1], item.rgb[2]);
+        offscreen.renderer->AddActor(actor);
+    }
+
+    /* Look along the preset direction, then fit the camera to the items */
+    vtkCamera* camera = offscreen.renderer->GetActiveCamera();
+    camera->SetFocalPoint(0., 0., 0.);
+    camera->SetPosition(preset->direction);
+    camera->SetViewUp(preset->up);
+    offscreen.renderer->ResetCamera();
+
+    offscreen.window->SetSize(width, height);
+    offscreen.window->Render();
+
+    vtkNew<vtkWindowToImageFilter> grab;
+    grab->SetInput(offscreen.window);
+    grab->SetInputBufferTypeToRGB();
+    grab->ReadFrontBufferOff();
+    grab->Update();
+    offscreen.renderer->RemoveAllViewProps();
+
+    /* VTK's rows start at the bottom, QImage's at the top */
+    vtkImageData* pixels = grab->GetOutput();
+    int dims[3];
+    pixels->GetDimensions(dims);
+    if (dims[0] <= 0 || dims[1] <= 0 || pixels->GetNumberOfScalarComponents() != 3)
+        return QImage();
+    QImage image(dims[0], dims[1], QImage::Format_RGB888);
+    const unsigned char* source = static_cast<const unsigned char*>(pixels->GetScalarPointer());
+    for (int y = 0; y < dims[1]; ++y)
+        std::memcpy(image.scanLine(dims[1] - 1 - y), source + size_t(y) * dims[0] * 3, size_t(dims[0]) * 3);
+    return image;
+}
+
+/**
+ * @brief Renders the items and saves them as a PNG file.
+ */
+bool BatchRenderer::renderImage(const QList<Item>& items, const QString& view, int width, int height,
+                                const QString& fileName) {
+    TRACE_SCOPE("BatchRenderer::renderImage");
+
+    QImage image = renderToImage(items, view, width, height);
+    return !image.isNull() && image.save(fileName, "PNG");
+}
+
+/**
+ * @brief Times the mesh as given, then reorders it both ways and times each result.
+ */
+QList<BatchRenderer::OrderTiming> BatchRenderer::benchmarkOrder(vtkPolyData* polyData, int width, int height,
+                                                                int frames) {
+    TRACE_SCOPE("BatchRenderer::benchmarkOrder");
+
+    QList<OrderTiming> timings;
+    timings.append({ "file", MeshUtils::cacheMissRatio(polyData), 0., timeFrames(polyData, width, height, frames) });
+
+    for (bool spatial : { false, true }) {
+        QElapsedTimer timer;
+        timer.start();
+        vtkSmartPointer<vtkPolyData> ordered = MeshUtils::reorder(polyData, spatial);
+        const double reorderMs = timer.nsecsElapsed() / 1e6;
+        if (!ordered)
+            break;
+        timings.append({ spatial ? "spatial" : "cache", MeshUtils::cacheMissRatio(ordered), reorderMs,
+                         timeFrames(ordered, width, height, frames) });
+    }
+    return timings;
+}
+
+/**
+ * @brief Hands the parts' VR actors to an offscreen render thread and waits for it.
+ */
+VRRenderThread::FrameStats BatchRenderer::benchmarkVR(const QList<ModelPart*>& parts, int width, int height,
+                                                       int frames) {
+    TRACE_SCOPE("BatchRenderer::benchmarkVR");
+
+    VRRenderThread thread;
+    for (ModelPart* part : parts)
+        thread.addActorOffline(part->getNewActor());
+    thread.setOffscreen(width, height, frames);
+    thread.issueCommand(VRRenderThread::ROTATE_Y, 0.5);
+    thread.start();
+    thread.wait();
+    return thread.frameStats();
+}
+
+/**
+ * @brief Parses the options, loads every input into a ModelPartList and renders in parallel.
+ */
+int BatchRenderer::run(const QStringList& arguments) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders mesh files offscreen to PNG images.");
+    parser.addHelpOption();
+    parser.addOption({ "render", "Run without a window and render images." });
+    parser.addOption({ { "o", "output" }, "Folder the images are written to.", "dir" });
+    parser.addOption({ "views", QString("Comma separated views: %1 (default iso).").arg(viewNames().join(", ")),
+                       "list", "iso" });
+    parser.addOption({ "size", "Image size (default 256x256).", "WxH", "256x256" });
+    parser.addOption({ { "j", "jobs" }, "Number of worker threads (default: all cores).", "n" });
+    parser.addOption({ "scene", "Also render all parts together into scene_<view>.png." });
+    parser.addOption({ "trace", "Record timings and write them as Chrome trace JSON.", "file" });
+    parser.addOption({ "benchmark-order", "Instead of writing images, time rendering every large part in file, "
+                                          "vertex cache and spatial order." });
+    parser.addOption({ "benchmark-vr", "Instead of writing images, run the VR render loop offscreen over all "
+                                       "parts and time its frames." });
+    parser.addOption({ "frames", "Frames timed per order by --benchmark-order, or in all by --benchmark-vr "
+                                 "(default 200).", "n", "200" });
+    parser.addPositionalArgument("inputs", "Mesh files and folders to load.", "inputs...");
+
+    if (!parser.parse(arguments)) {
+        err << parser.errorText() << Qt::endl;
+        return 2;
+    }
+    if (parser.isSet("help")) {
+        out << parser.helpText();
+        return 0;
+    }
+
+    const QStringList inputs = parser.positionalArguments();
+    const QString outputDir = parser.value("output");
+    const QStringList views = parser.value("views").split(',', Qt::SkipEmptyParts);
+    const QStringList size = parser.value("size").split('x');
+    int width = size.value(0).toInt();
+    int height = size.value(1).toInt();
+
+    const bool benchmarkVRLoop = parser.isSet("benchmark-vr");
+    const bool benchmark = parser.isSet("benchmark-order") || benchmarkVRLoop;
+    const int frames = parser.value("frames").toInt();
+
+    if (inputs.isEmpty() || (outputDir.isEmpty() && !benchmark)) {
+        err << "Usage: --render -o <dir> [options] <inputs...>, see --render --help" << Qt::endl;
+        return 2;
+    }
+    if (frames <= 0) {
+        err << "Invalid frame count \"" << parser.value("frames") << "\"" << Qt::endl;
+        return 2;
+    }
+    for (const QString& view : views) {
+        if (!viewNames().contains(view)) {
+            err << "Unknown view \"" << view << "\", use one of " << viewNames().join(", ") << Qt::endl;
+            return 2;
+        }
+    }
+    if (width <= 0 || height <= 0) {
+        err << "Invalid size \"" << parser.value("size") << "\", expected e.g. 256x256" << Qt::endl;
+        return 2;
+    }
+    if (parser.isSet("jobs") && parser.value("jobs").toInt() > 0)
+        QThreadPool::globalInstance()->setMaxThreadCount(parser.value("jobs").toInt());
+    if (!benchmark && !QDir().mkpath(outputDir)) {
+        err << "Cannot create output folder \"" << outputDir << "\"" << Qt::endl;
+        return 1;
+    }
+
+    if (parser.isSet("trace"))
+        Trace::setEnabled(true);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    /* The benchmark compares against the order the files were written in */
+    if (benchmark)
+        MeshImporter::setMeshOrder(MeshImporter::FileOrder);
+
+    /* 1. Load everything into the tree, folders through the same importer as the GUI */
+    ModelPartList partList("PartsList");
+    FolderWatcher importer(&partList);
+    QStringList files;
+    int failed = 0;
+    for (const QString& input : inputs) {
+        if (QFileInfo(input).isDir())
+            importer.importFolder(input, QModelIndex(), false);
+        else
+            files.append(input);
+    }
+
+    struct LoadedMesh {
+        QString                         path;
+        vtkSmartPointer<vtkPolyData>    polyData;
+        double                          loadMs = 0.;
+    };
+    QVector<LoadedMesh> meshes;
+    for (const QString& file : std::as_const(files))
+        meshes.append({ file, nullptr });
+    QtConcurrent::blockingMap(meshes, [](LoadedMesh& mesh) {
+        mesh.polyData = MeshImporter::read(mesh.path, &mesh.loadMs);
+    });
+
+    QList<ModelPart*> parts;
+    for (const LoadedMesh& mesh : std::as_const(meshes)) {
+        if (!mesh.polyData) {
+            err << "Could not read " << mesh.path << Qt::endl;
+            ++failed;
+            continue;
+        }
+        ModelPart* part = new ModelPart({ QFileInfo(mesh.path).fileName(), true });
+        part->setFileName(mesh.path);
+        part->setPolyData(mesh.polyData);
+        part->setLoadTime(mesh.loadMs);
+        parts.append(part);
+    }
+    partList.appendParts(QModelIndex(), parts);
+
+    /* 2. One job per part with geometry, named after its file and made unique */
+    QVector<PartJob> jobs;
+    QSet<QString> usedNames;
+    QList<ModelPart*> stack = { partList.getRootItem() };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        for (int i = part->childCount() - 1; i >= 0; --i)
+            stack.append(part->child(i));
+        if (!part->getActor())
+            continue;
+
+        QString base = QFileInfo(part->getFileName()).completeBaseName();
+        QString name = base;
+        for (int n = 2; usedNames.contains(name); ++n)
+            name = QString("%1_%2").arg(base).arg(n);
+        usedNames.insert(name);
+        jobs.append(PartJob{ part, name });
+    }
+
+    /* The VR loop draws every part at once, on its own thread */
+    if (benchmarkVRLoop) {
+        QList<ModelPart*> parts;
+        for (const PartJob& job : std::as_const(jobs))
+            parts.append(job.part);
+        const VRRenderThread::FrameStats stats = benchmarkVR(parts, width, height, frames);
+        if (stats.frames == 0) {
+            err << "The VR loop rendered no frames" << Qt::endl;
+            return 1;
+        }
+        const double frameMs = stats.totalMs / stats.frames;
+        out << QString("VR loop: %1 parts, %2 frames  %3 ms/frame  %4 ms max  %5 frames/s")
+                   .arg(parts.size())
+                   .arg(stats.frames)
+                   .arg(frameMs, 0, 'f', 3)
+                   .arg(stats.maxMs, 0, 'f', 3)
+                   .arg(1000. / frameMs, 0, 'f', 1)
+            << Qt::endl;
+        return failed > 0 ? 1 : 0;
+    }
+
+    /* Benchmark one part and one order at a time, on this thread only */
+    if (benchmark) {
+        for (const PartJob& job : std::as_const(jobs)) {
+            vtkSmartPointer<vtkPolyData> polyData = job.part->getPolyData();
+            const qint64 triangles = polyData->GetNumberOfPolys();
+            if (triangles < BenchmarkMinTriangles)
+                continue;
+
+            out << job.baseName << ": " << triangles << " triangles" << Qt::endl;
+            const QList<OrderTiming> timings = benchmarkOrder(polyData, width, height, frames);
+            for (const OrderTiming& timing : timings) {
+                out << QString("  %1 %2 misses/triangle  %3 ms/frame  %4 Mtriangles/s  %5x  (reordered in %6 ms)")
+                           .arg(timing.name, -8)
+                           .arg(timing.missRatio, 5, 'f', 3)
+                           .arg(timing.frameMs, 8, 'f', 3)
+                           .arg(triangles / timing.frameMs / 1000., 8, 'f', 1)
+                           .arg(timings.first().frameMs / timing.frameMs, 5, 'f', 2)
+                           .arg(timing.reorderMs, 0, 'f', 0)
+                    << Qt::endl;
+            }
+        }
+        return failed > 0 ? 1 : 0;
+    }
+
+    /* 3. Render every part from every view, each worker with its own offscreen window */
+    const QDir dir(outputDir);
+    std::atomic<int> written{ 0 };
+    QtConcurrent::blockingMap(jobs, [&](PartJob& job) {
+        vtkSmartPointer<vtkPolyData> polyData = job.part->getPolyData();
+        Item item{ polyData, { job.part->getColourR() / 255., job.part->getColourG() / 255.,
+                               job.part->getColourB() / 255. } };
+        job.ok = true;
+        for (const QString& view : views) {
+            QString fileName = dir.filePath(QString("%1_%2.png").arg(job.baseName, view));
+            if (renderImage({ item }, view, width, height, fileName))
+                ++written;
+            else
+                job.ok = false;
+        }
+    });
+    for (const PartJob& job : std::as_const(jobs)) {
+        if (!job.ok) {
+            err << "Could not render " << job.part->getFileName() << Qt::endl;
+            ++failed;
+        }
+    }
+
+    /* 4. Review images of the whole tree */
+    if (parser.isSet("scene") && !jobs.isEmpty()) {
+        std::vector<vtkSmartPointer<vtkPolyData>> keep;
+        QList<Item> items;
+        for (const PartJob& job : std::as_const(jobs)) {
+            keep.push_back(job.part->getPolyData());
+            items.append(Item{ keep.back(), { job.part->getColourR() / 255., job.part->getColourG() / 255.,
+                                              job.part->getColourB() / 255. } });
+        }
+        for (const QString& view : views) {
+            if (renderImage(items, view, width, height, dir.filePath(QString("scene_%1.png").arg(view))))
+                ++written;
+            else
+                ++failed;
+        }
+    }
+
+    out << "Rendered " << written << " images of " << jobs.size() << " parts in "
+        << QString::number(timer.elapsed() / 1000., 'f', 1) << " s using "
+        << QThreadPool::globalInstance()->maxThreadCount() << " threads";
+    if (failed > 0)
+        out << ", " << failed << " failed";
+    out << Qt::endl;
+
+    QString traceError;
+    if (parser.isSet("trace") && !Trace::exportChromeJson(parser.value("trace"), &traceError)) {
+        err << "Could not write trace: " << traceError << Qt::endl;
+        ++failed;
+    }
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file BatchRenderer.h
+ * @brief Declaration of the BatchRenderer class, the headless command line mode.
+ * @details Started with --render, the program loads mesh files and folders into a ModelPartList
+ *          without opening a window and writes offscreen PNG images of every part (and
+ *          optionally the whole scene) from preset camera views. Files are read and images
+ *          rendered in parallel, each worker thread using its own offscreen render window.
+ *
+ *          Example: GroupProject --render -o thumbs --views iso,front --size 256x256 parts/
+ *
+ *          With --benchmark-order no images are written; instead every large part is rendered
+ *          for a number of frames in file order, vertex cache order and spatial order, and the
+ *          frame times are printed, e.g. GroupProject --render --benchmark-order big.stl
+ *
+ *          With --benchmark-vr the VR render loop of VRRenderThread runs offscreen over all parts
+ *          for --frames frames and its frame timings are printed, so the loop can be measured
+ *          without a headset, e.g. GroupProject --render --benchmark-vr --frames 500 parts/
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_BATCHRENDERER_H
+#define VIEWER_BATCHRENDERER_H
+
+#include "VRRenderThread.h"
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QImage>
+#include <QtGlobal>
+
+#include <vtkPolyData.h>
+#include <vtkMatrix4x4.h>
+
+class ModelPart;
+
+/**
+ * @class BatchRenderer
+ * @brief Command line entry point and offscreen rendering helpers.
+ */
+class BatchRenderer {
+public:
+    /** Geometry and colour of one actor in an offscreen image */
+    struct Item {
+        vtkPolyData*    polyData;   /**< Geometry, only read */
+        double          rgb[3];     /**< Colour, 0 to 1 */
+        vtkMatrix4x4*   matrix = nullptr; /**< Optional user matrix, e.g. of a compact part */
+    };
+
+    /** Rendering speed of one mesh order, see benchmarkOrder() */
+    struct OrderTiming {
+        QString name;       /**< Name of the order */
+        double  missRatio;  /**< Vertex cache misses per triangle, see MeshUtils::cacheMissRatio() */
+        double  reorderMs;  /**< Time taken to reorder the mesh */
+        double  frameMs;    /**< Average time of one frame */
+    };
+
+    /** Parts with fewer triangles are skipped by the benchmark, they render too fast to time */
+    static constexpr qint64 BenchmarkMinTriangles = 10000;
+
+    /**
+     * @brief Checks whether the command line asks for the headless mode.
+     * @param argc Argument count from main().
+     * @param argv Arguments from main().
+     * @return true if --render is present
+     */
+    static bool isRequested(int argc, char* argv[]);
+
+    /**
+     * @brief Parses the arguments, loads the inputs and renders every image.
+     * @details Needs a QCoreApplication but no GUI.
+     * @param arguments Command line including the program name.
+     * @return process exit code, 0 if every input was read and every image written
+     */
+    static int run(const QStringList& arguments);
+
+    /**
+     * @brief Returns the names of the preset camera views.
+     */
+    static QStringList viewNames();
+
+    /**
+     * @brief Renders items offscreen into an image.
+     * @details Thread safe, every thread renders with its own window.
+     * @param items Actors to show.
+     * @param view Preset view name, see viewNames().
+     * @param width Image width in pixels.
+     * @param height Image height in pixels.
+     * @return the image, null if the view is unknown
+     */
+    static QImage renderToImage(const QList<Item>& items, const QString& view, int width, int height);
+
+    /**
+     * @brief Renders items offscreen and writes a PNG file.
+     * @details Thread safe, every thread renders with its own window.
+     * @param items Actors to show.
+     * @param view Preset view name, see viewNames().
+     * @param width Image width in pixels.
+     * @param height Image height in pixels.
+     * @param fileName Output PNG file.
+     * @return true if the image was written
+     */
+    static bool renderImage(const QList<Item>& items, const QString& view, int width, int height,
+                            const QString& fileName);
+
+    /**
+     * @brief Times offscreen rendering of a mesh as given, in vertex cache order and in spatial order.
+     * @details Each order is drawn with the calling thread's offscreen window while the camera
+     *          turns once around the mesh, after a few untimed frames that upload the buffers.
+     *          Nothing else may render at the same time, or the timings mean little. A small
+     *          window keeps the frame time down to the vertex work the order affects.
+     * @param polyData Mesh made of triangles, in the order it was read.
+     * @param width Window width in pixels.
+     * @param height Window height in pixels.
+     * @param frames Number of timed frames per order.
+     * @return one timing per order, the given order first; only the given order if the mesh
+     *         cannot be reordered
+     */
+    static QList<OrderTiming> benchmarkOrder(vtkPolyData* polyData, int width, int height, int frames);
+
+    /**
+     * @brief Runs the VR render loop offscreen over some parts and returns its frame timings.
+     * @details Every part gets a VR actor as for the headset, placed the same way, and the loop
+     *          turns them slowly so that each frame draws a new view. Blocks until the loop ends.
+     * @param parts Parts with geometry.
+     * @param width Window width in pixels.
+     * @param height Window height in pixels.
+     * @param frames Number of frames to render.
+     * @return the timings of the loop
+     */
+    static VRRenderThread::FrameStats benchmarkVR(const QList<ModelPart*>& parts, int width, int height, int frames);
+};
+
+#endif
@@ -0,0 +1,512 @@
+/**
+ * @file ClashDetector.cpp
+ * @brief Implementation of the ClashDetector class.
+ * @details The triangle test follows T. Möller, "A Fast Triangle-Triangle Intersection Test",
+ *          Journal of Graphics Tools 2(2), 1997, with a tolerance so that touching faces and
+ *          edges are not counted as intersections.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "ClashDetector.h"
+#include "MeshUtils.h"
+#include "ModelPart.h"
+#include "Trace.h"
+
+#include <QSet>
+#include <QtConcurrent>
+
+#include <vtkCellArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPoints.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+/** Bounding volume hierarchy over a part's triangles in scene coordinates */
+struct ClashDetector::Tree {
+    /** Node of the hierarchy, the left child of an inner node directly follows it */
+    struct Node {
+        float   box[6];     /**< Bounds of the node's triangles */
+        qint32  first;      /**< First triangle of a leaf */
+        qint32  count;      /**< Triangles in a leaf, 0 for an inner node */
+        qint32  right;      /**< Right child of an inner node */
+    };
+
+    std::vector<float>  triangles;  /**< Nine floats per triangle, in leaf order */
+    std::vector<Node>   nodes;      /**< Root first */
+};
+
+namespace {
+
+/** Most triangles in a leaf */
+const int LeafSize = 8;
+
+/** Surfaces closer than this fraction of the larger part's size are treated as touching */
+const double RelativeTolerance = 1e-6;
+
+typedef ClashDetector::Clash Clash;
+
+/**
+ * @brief Returns whether two boxes overlap by more than zero.
+ */
+inline bool boxesOverlap(const float* a, const float* b) {
+    return a[0] < b[1] && b[0] < a[1] && a[2] < b[3] && b[2] < a[3] && a[4] < b[5] && b[4] < a[5];
+}
+
+/**
+ * @brief Returns the length of a box's diagonal.
+ */
+double diagonal(const float* box) {
+    double dx = box[1] - box[0], dy = box[3] - box[2], dz = box[5] - box[4];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/**
+ * @brief Returns where a triangle crosses the line shared by the two planes, projected on one axis.
+ * @param p Projected vertices.
+ * @param d Signed distances of the vertices from the other triangle's plane.
+ * @param t0 Receives the start of the interval.
+ * @param t1 Receives the end of the interval.
+ * @return false if the triangle lies in the plane
+ */
+bool crossing(const double p[3], const double d[3], double& t0, double& t1) {
+    /* Find the vertex that is alone on its side of the plane */
+    int k;
+    if (d[0] * d[1] > 0.)
+        k = 2;
+    else if (d[0] * d[2] > 0.)
+        k = 1;
+    else if (d[1] * d[2] > 0. || d[0] != 0.)
+        k = 0;
+    else if (d[1] != 0.)
+        k = 1;
+    else if (d[2] != 0.)
+        k = 2;
+    else
+        return false;
+
+    const int i = (k + 1) % 3, j = (k + 2) % 3;
+    t0 = p[k] + (p[i] - p[k]) * d[k] / (d[k] - d[i]);
+    t1 = p[k] + (p[j] - p[k]) * d[k] / (d[k] - d[j]);
+    if (t0 > t1)
+        std::swap(t0, t1);
+    return true;
+}
+
+/**
+ * @brief Computes the signed distances of a triangle's vertices from another triangle's plane.
+ * @return false if every vertex is strictly on the same side, or the plane is degenerate
+ */
+bool planeDistances(const double plane[3][3], const double vertices[3][3], double tolerance, double n[3],
+                    double d[3]) {
+    const double e1[3] = { plane[1][0] - plane[0][0], plane[1][1] - plane[0][1], plane[1][2] - plane[0][2] };
+    const double e2[3] = { plane[2][0] - plane[0][0], plane[2][1] - plane[0][1], plane[2][2] - plane[0][2] };
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length == 0.)
+        return false;
+
+    for (int i = 0; i < 3; ++i) {
+        d[i] = (n[0] * (vertices[i][0] - plane[0][0]) + n[1] * (vertices[i][1] - plane[0][1]) +
+                n[2] * (vertices[i][2] - plane[0][2])) / length;
+        if (std::abs(d[i]) < tolerance)
+            d[i] = 0.;
+    }
+    return !(d[0] * d[1] > 0. && d[0] * d[2] > 0.);
+}
+
+/**
+ * @brief Tests whether two triangles cross each other by more than the tolerance.
+ * @param a Nine floats of the first triangle.
+ * @param b Nine floats of the second triangle.
+ * @param tolerance Distance below which points count as touching.
+ */
+bool trianglesIntersect(const float* a, const float* b, double tolerance) {
+    double va[3][3], vb[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            va[i][k] = a[3 * i + k];
+            vb[i][k] = b[3 * i + k];
+        }
+    }
+
+    double na[3], nb[3], da[3], db[3];
+    if (!planeDistances(vb, va, tolerance, nb, da) || !planeDistances(va, vb, tolerance, na, db))
+        return false;
+
+    /* Crossing needs each triangle on both sides of the other's plane; an edge or corner lying in
+     * the other's plane, like a face resting on another, only touches */
+    auto straddles = [](const double d[3]) {
+        return std::min({ d[0], d[1], d[2] }) < 0. && std::max({ d[0], d[1], d[2] }) > 0.;
+    };
+    if (!straddles(da) || !straddles(db))
+        return false;
+
+    /* Project onto the largest axis of the line where the two planes meet */
+    const double line[3] = { na[1] * nb[2] - na[2] * nb[1], na[2] * nb[0] - na[0] * nb[2],
+                             na[0] * nb[1] - na[1] * nb[0] };
+    int axis = 0;
+    if (std::abs(line[1]) > std::abs(line[axis]))
+        axis = 1;
+    if (std::abs(line[2]) > std::abs(line[axis]))
+        axis = 2;
+    const double pa[3] = { va[0][axis], va[1][axis], va[2][axis] };
+    const double pb[3] = { vb[0][axis], vb[1][axis], vb[2][axis] };
+
+    double a0, a1, b0, b1;
+    if (!crossing(pa, da, a0, a1) || !crossing(pb, db, b0, b1))
+        return false;
+    return std::max(a0, b0) < std::min(a1, b1) - tolerance;
+}
+
+/**
+ * @brief Builds the nodes for triangles [begin, end) of the order, splitting at the median centroid.
+ */
+void buildNodes(ClashDetector::Tree& tree, std::vector<qint32>& order, const std::vector<float>& soup,
+                const std::vector<float>& centroids, qint32 begin, qint32 end) {
+    ClashDetector::Tree::Node node;
+    float* box = node.box;
+    box[0] = box[2] = box[4] = std::numeric_limits<float>::max();
+    box[1] = box[3] = box[5] = -std::numeric_limits<float>::max();
+    float centreBox[6] = { box[0], box[1], box[2], box[3], box[4], box[5] };
+    for (qint32 i = begin; i < end; ++i) {
+        const float* t = soup.data() + 9 * size_t(order[i]);
+        for (int v = 0; v < 3; ++v) {
+            for (int k = 0; k < 3; ++k) {
+                box[2 * k] = std::min(box[2 * k], t[3 * v + k]);
+                box[2 * k + 1] = std::max(box[2 * k + 1], t[3 * v + k]);
+            }
+        }
+        const float* c = centroids.data() + 3 * size_t(order[i]);
+        for (int k = 0; k < 3; ++k) {
+            centreBox[2 * k] = std::min(centreBox[2 * k], c[k]);
+            centreBox[2 * k + 1] = std::max(centreBox[2 * k + 1], c[k]);
+        }
+    }
+
+    const size_t index = tree.nodes.size();
+    if (end - begin <= LeafSize) {
+        node.first = begin;
+        node.count = end - begin;
+        node.right = -1;
+        tree.nodes.push_back(node);
+        return;
+    }
+
+    int axis = 0;
+    for (int k = 1; k < 3; ++k)
+        if (centreBox[2 * k + 1] - centreBox[2 * k] > centreBox[2 * axis + 1] - centreBox[2 * axis])
+            axis = k;
+
+    const qint32 middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                     [&](qint32 l, qint32 r) { return centroids[3 * size_t(l) + axis] < centroids[3 * size_t(r) + axis]; });
+
+    node.first = 0;
+    node.count = 0;
+    tree.nodes.push_back(node);
+    buildNodes(tree, order, soup, centroids, begin, middle);
+    tree.nodes[index].right = qint32(tree.nodes.size());
+    buildNodes(tree, order, soup, centroids, middle, end);
+}
+
+/**
+ * @brief Splits polygons into fans of triangles and appends their corners' scene coordinates.
+ */
+template <typename Id>
+void fanTriangles(const Id* offsets, const Id* connectivity, qint64 cells, const std::vector<float>& points,
+                  std::vector<float>& soup) {
+    for (qint64 cell = 0; cell < cells; ++cell) {
+        const Id first = offsets[cell];
+        const Id last = offsets[cell + 1];
+        for (Id k = first + 1; k + 1 < last; ++k) {
+            const Id ids[3] = { connectivity[first], connectivity[k], connectivity[k + 1] };
+            for (Id id : ids)
+                soup.insert(soup.end(), points.begin() + 3 * size_t(id), points.begin() + 3 * size_t(id) + 3);
+        }
+    }
+}
+
+/**
+ * @brief Builds the hierarchy of a part in scene coordinates.
+ * @return the tree, null if the part has no triangles
+ */
+std::shared_ptr<const ClashDetector::Tree> buildTree(vtkPolyData* polyData, const double matrix[16]) {
+    TRACE_SCOPE("ClashDetector::buildTree");
+
+    vtkCellArray* polys = polyData->GetPolys();
+    if (!polys || polys->GetNumberOfCells() == 0 || !polyData->GetPoints())
+        return nullptr;
+
+    /* Points in scene coordinates */
+    const qint64 pointCount = polyData->GetNumberOfPoints();
+    std::vector<float> points(size_t(pointCount) * 3);
+    vtkDataArray* pointData = polyData->GetPoints()->GetData();
+    MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+        double x[3];
+        for (qint64 i = begin; i < end; ++i) {
+            pointData->GetTuple(i, x);
+            for (int r = 0; r < 3; ++r)
+                points[3 * i + r] = float(matrix[4 * r] * x[0] + matrix[4 * r + 1] * x[1] +
+                                          matrix[4 * r + 2] * x[2] + matrix[4 * r + 3]);
+        }
+    });
+
+    std::vector<float> soup;
+    soup.reserve(size_t(polys->GetNumberOfConnectivityIds()) * 3);
+    if (polys->IsStorage64Bit())
+        fanTriangles(polys->GetOffsetsArray64()->GetPointer(0), polys->GetConnectivityArray64()->GetPointer(0),
+                     polys->GetNumberOfCells(), points, soup);
+    else
+        fanTriangles(polys->GetOffsetsArray32()->GetPointer(0), polys->GetConnectivityArray32()->GetPointer(0),
+                     polys->GetNumberOfCells(), points, soup);
+
+    const qint32 triangleCount = qint32(soup.size() / 9);
+    if (triangleCount == 0)
+        return nullptr;
+
+    std::vector<float> centroids(size_t(triangleCount) * 3);
+    std::vector<qint32> order(triangleCount);
+    for (qint32 t = 0; t < triangleCount; ++t) {
+        order[t] = t;
+        for (int k = 0; k < 3; ++k)
+            centroids[3 * size_t(t) + k] = (soup[9 * size_t(t) + k] + soup[9 * size_t(t) + 3 + k] +
+                                            soup[9 * size_t(t) + 6 + k]) / 3.f;
+    }
+
+    auto tree = std::make_shared<ClashDetector::Tree>();
+    tree->nodes.reserve(size_t(2 * triangleCount / LeafSize + 1));
+    buildNodes(*tree, order, soup, centroids, 0, triangleCount);
+
+    /* Store the triangles in leaf order so that each leaf reads one contiguous block */
+    tree->triangles.resize(soup.size());
+    for (qint32 i = 0; i < triangleCount; ++i)
+        std::memcpy(tree->triangles.data() + 9 * size_t(i), soup.data() + 9 * size_t(order[i]), 9 * sizeof(float));
+    return tree;
+}
+
+/**
+ * @brief Walks two hierarchies together and records intersecting triangle pairs.
+ */
+void collide(const ClashDetector::Tree& a, const ClashDetector::Tree& b, double tolerance, Clash& clash) {
+    std::vector<std::pair<qint32, qint32>> stack = { { 0, 0 } };
+    double location[3] = { 0., 0., 0. };
+
+    while (!stack.empty() && clash.contacts < ClashDetector::MaxContacts) {
+        const auto [i, j] = stack.back();
+        stack.pop_back();
+        const ClashDetector::Tree::Node& na = a.nodes[i];
+        const ClashDetector::Tree::Node& nb = b.nodes[j];
+        if (!boxesOverlap(na.box, nb.box))
+            continue;
+
+        if (na.count && nb.count) {
+            for (qint32 s = na.first; s < na.first + na.count; ++s) {
+                const float* ta = a.triangles.data() + 9 * size_t(s);
+                for (qint32 t = nb.first; t < nb.first + nb.count; ++t) {
+                    const float* tb = b.triangles.data() + 9 * size_t(t);
+                    if (!trianglesIntersect(ta, tb, tolerance))
+                        continue;
+                    clash.triangles.append(QVector<float>(ta, ta + 9));
+                    clash.triangles.append(QVector<float>(tb, tb + 9));
+                    for (int v = 0; v < 3; ++v)
+                        for (int k = 0; k < 3; ++k)
+                            location[k] += ta[3 * v + k] + tb[3 * v + k];
+                    if (++clash.contacts >= ClashDetector::MaxContacts)
+                        break;
+                }
+                if (clash.contacts >= ClashDetector::MaxContacts)
+                    break;
+            }
+            continue;
+        }
+
+        /* Descend into the inner node with the larger box */
+        const bool splitA = !na.count && (nb.count || diagonal(na.box) >= diagonal(nb.box));
+        if (splitA) {
+            stack.push_back({ i + 1, j });
+            stack.push_back({ na.right, j });
+        } else {
+            stack.push_back({ i, j + 1 });
+            stack.push_back({ i, nb.right });
+        }
+    }
+
+    for (int k = 0; k < 3; ++k)
+        clash.location[k] = clash.contacts ? location[k] / (6. * clash.contacts) : 0.;
+}
+
+}
+
+/**
+ * @brief Starts with an empty cache.
+ */
+ClashDetector::ClashDetector() : rebuilt(0), tested(0), reused(0) {
+}
+
+/**
+ * @brief Defined here, where Tree is complete.
+ */
+ClashDetector::~ClashDetector() = default;
+
+/**
+ * @brief Snapshots the visible parts' geometry and actor matrices.
+ */
+QList<ClashDetector::Input> ClashDetector::collect(ModelPart* root) {
+    QList<Input> inputs;
+    QList<ModelPart*> stack = { root };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        for (int i = part->childCount() - 1; i >= 0; --i)
+            stack.append(part->child(i));
+
+        vtkActor* actor = part->getActor();
+        vtkPolyData* geometry = part->getStoredGeometry();
+        if (!part->visible() || !actor || !actor->GetVisibility() || !geometry || geometry->GetNumberOfPolys() == 0)
+            continue;
+
+        /* The actor matrix covers both a compact part's dequantisation and the exploded offset */
+        Input input;
+        input.part = part;
+        input.geometry = vtkSmartPointer<vtkPolyData>::New();
+        input.geometry->ShallowCopy(geometry);
+        vtkMatrix4x4::DeepCopy(input.matrix, actor->GetMatrix());
+        input.time = geometry->GetMTime();
+        inputs.append(input);
+    }
+    return inputs;
+}
+
+/**
+ * @brief Updates the hierarchies of moved parts, sweeps the boxes and tests the new candidate pairs.
+ */
+QList<ClashDetector::Clash> ClashDetector::detect(const QList<Input>& inputs) {
+    TRACE_SCOPE("ClashDetector::detect");
+
+    /* 1. Keep the hierarchies of parts that have not moved, build the others in parallel */
+    struct Build {
+        const Input*    input;
+        Entry           entry;
+    };
+    QHash<ModelPart*, Entry> current;
+    current.reserve(inputs.size());
+    QVector<Build> builds;
+    QSet<ModelPart*> changed;
+    for (const Input& input : inputs) {
+        auto cached = entries.constFind(input.part);
+        if (cached != entries.constEnd() && cached->time == input.time &&
+            std::memcmp(cached->matrix, input.matrix, sizeof(input.matrix)) == 0) {
+            current.insert(input.part, *cached);
+            continue;
+        }
+        Build build{ &input, Entry() };
+        build.entry.time = input.time;
+        std::memcpy(build.entry.matrix, input.matrix, sizeof(input.matrix));
+        builds.append(build);
+        changed.insert(input.part);
+    }
+    QtConcurrent::blockingMap(builds, [](Build& build) {
+        build.entry.tree = buildTree(build.input->geometry, build.input->matrix);
+    });
+    for (const Build& build : std::as_const(builds))
+        if (build.entry.tree)
+            current.insert(build.input->part, build.entry);
+    entries = current;
+    rebuilt = builds.size();
+
+    /* 2. Sweep and prune: sort the boxes by their start along x, keep the ones still open */
+    struct Sweep {
+        ModelPart*      part;
+        const Tree*     tree;
+    };
+    std::vector<Sweep> sweep;
+    sweep.reserve(size_t(entries.size()));
+    for (auto entry = entries.constBegin(); entry != entries.constEnd(); ++entry)
+        sweep.push_back({ entry.key(), entry->tree.get() });
+    std::sort(sweep.begin(), sweep.end(), [](const Sweep& l, const Sweep& r) {
+        return l.tree->nodes[0].box[0] < r.tree->nodes[0].box[0];
+    });
+
+    struct Task {
+        PairKey         key;
+        const Tree*     first;
+        const Tree*     second;
+        Clash           clash;
+    };
+    QVector<Task> tasks;
+    QHash<PairKey, Clash> next;
+    std::vector<const Sweep*> open;
+    reused = 0;
+    for (const Sweep& item : sweep) {
+        const float* box = item.tree->nodes[0].box;
+        open.erase(std::remove_if(open.begin(), open.end(),
+                                  [&](const Sweep* other) { return other->tree->nodes[0].box[1] <= box[0]; }),
+                   open.end());
+
+        for (const Sweep* other : open) {
+            if (!boxesOverlap(box, other->tree->nodes[0].box))
+                continue;
+
+            const bool ordered = std::less<ModelPart*>()(item.part, other->part);
+            const PairKey key = ordered ? PairKey(item.part, other->part) : PairKey(other->part, item.part);
+            auto previous = results.constFind(key);
+            if (previous != results.constEnd() && !changed.contains(item.part) && !changed.contains(other->part)) {
+                next.insert(key, *previous);
+                ++reused;
+                continue;
+            }
+
+            Task task{ key, ordered ? item.tree : other->tree, ordered ? other->tree : item.tree, Clash() };
+            task.clash.first = key.first;
+            task.clash.second = key.second;
+            task.clash.contacts = 0;
+            tasks.append(task);
+        }
+        open.push_back(&item);
+    }
+
+    /* 3. Triangle tests, one task per candidate pair */
+    QtConcurrent::blockingMap(tasks, [](Task& task) {
+        const double size = std::max(diagonal(task.first->nodes[0].box), diagonal(task.second->nodes[0].box));
+        collide(*task.first, *task.second, RelativeTolerance * size, task.clash);
+    });
+    for (const Task& task : std::as_const(tasks))
+        next.insert(task.key, task.clash);
+    results = next;
+    tested = tasks.size();
+
+    QList<Clash> clashes;
+    for (const Clash& clash : std::as_const(results))
+        if (clash.contacts > 0)
+            clashes.append(clash);
+    std::sort(clashes.begin(), clashes.end(), [](const Clash& l, const Clash& r) { return l.contacts > r.contacts; });
+    return clashes;
+}
+
+/**
+ * @brief Returns the number of hierarchies built by the last check.
+ */
+int ClashDetector::rebuiltParts() const {
+    return rebuilt;
+}
+
+/**
+ * @brief Returns the number of pairs tested by the last check.
+ */
+int ClashDetector::testedPairs() const {
+    return tested;
+}
+
+/**
+ * @brief Returns the number of pairs reused by the last check.
+ */
+int ClashDetector::reusedPairs() const {
+    return reused;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file ClashDetector.h
+ * @brief Declaration of the ClashDetector class, which finds parts whose surfaces intersect.
+ * @details A broad phase sorts the parts' world bounding boxes along x and sweeps over them
+ *          (sweep and prune), so only parts whose boxes overlap are compared. The narrow phase
+ *          walks the bounding volume hierarchies of both parts of each candidate pair together and
+ *          runs triangle-triangle tests at the leaves, with the pairs spread over the thread pool.
+ *          Hierarchies and pair results are kept between checks; after a part moves, only its
+ *          hierarchy is rebuilt and only pairs involving it are tested again.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_CLASHDETECTOR_H
+#define VIEWER_CLASHDETECTOR_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+#include <memory>
+
+class ModelPart;
+
+/**
+ * @class ClashDetector
+ * @brief Incremental interference check between the surfaces of parts.
+ * @details Surfaces that only touch (shared faces or edges) do not count as clashes. A part
+ *          completely inside another without the surfaces crossing is not reported either.
+ */
+class ClashDetector {
+public:
+    /** Most intersecting triangle pairs recorded for one clash, the search stops there */
+    static constexpr int MaxContacts = 256;
+
+    /** Bounding volume hierarchy of one part, defined in the source file */
+    struct Tree;
+
+    /** A part to check, a snapshot taken on the GUI thread */
+    struct Input {
+        ModelPart*                      part;           /**< Part, only used as a key */
+        vtkSmartPointer<vtkPolyData>    geometry;       /**< Shallow copy of the stored geometry */
+        double                          matrix[16];     /**< Actor matrix placing the geometry in the scene */
+        vtkMTimeType                    time;           /**< Modification time of the geometry */
+    };
+
+    /** Two parts whose surfaces intersect */
+    struct Clash {
+        ModelPart*      first;          /**< One part */
+        ModelPart*      second;         /**< The other part */
+        int             contacts;       /**< Intersecting triangle pairs found, at most MaxContacts */
+        double          location[3];    /**< Average centre of the intersecting triangles */
+        QVector<float>  triangles;      /**< Intersecting triangles in scene coordinates, nine floats each */
+    };
+
+    /**
+     * @brief Constructs a detector with nothing cached.
+     */
+    ClashDetector();
+
+    /**
+     * @brief Releases the cached hierarchies.
+     */
+    ~ClashDetector();
+
+    /**
+     * @brief Takes a snapshot of the visible parts with geometry below a node.
+     * @details Call on the GUI thread, the snapshot can then be checked on any thread.
+     * @param root Node to start from, normally the tree's root item.
+     * @return one input per part
+     */
+    static QList<Input> collect(ModelPart* root);
+
+    /**
+     * @brief Finds all clashes between the given parts.
+     * @details Runs in parallel. Not reentrant: one check at a time per detector. Cached data of
+     *          parts missing from the inputs is dropped.
+     * @param inputs Parts to check.
+     * @return the clashes, ordered by the number of contacts, most first
+     */
+    QList<Clash> detect(const QList<Input>& inputs);
+
+    /**
+     * @brief Returns how many part hierarchies the last check had to build.
+     */
+    int rebuiltParts() const;
+
+    /**
+     * @brief Returns how many candidate pairs the last check tested triangle by triangle.
+     */
+    int testedPairs() const;
+
+    /**
+     * @brief Returns how many candidate pairs the last check took from the previous one.
+     */
+    int reusedPairs() const;
+
+private:
+    /** Cached hierarchy of a part and the placement it was built for */
+    struct Entry {
+        vtkMTimeType                time;           /**< Modification time of the geometry */
+        double                      matrix[16];     /**< Actor matrix */
+        std::shared_ptr<const Tree> tree;           /**< Triangles in scene coordinates */
+    };
+
+    /** Key of a pair, the lower address first */
+    typedef QPair<ModelPart*, ModelPart*> PairKey;
+
+    QHash<ModelPart*, Entry>    entries;    /**< Hierarchy of every part of the last check */
+    QHash<PairKey, Clash>       results;    /**< Narrow phase result of every candidate pair of the last check */
+    int                         rebuilt;    /**< Hierarchies built by the last check */
+    int                         tested;     /**< Pairs tested by the last check */
+    int                         reused;     /**< Pairs reused by the last check */
+};
+
+#endif
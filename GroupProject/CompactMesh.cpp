@@ -0,0 +1,237 @@
+/**
+ * @file CompactMesh.cpp
+ * @brief Implementation of the CompactMesh class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "CompactMesh.h"
+#include "MeshUtils.h"
+
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkUnsignedShortArray.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/** Largest quantised coordinate */
+const double QuantisedMax = 65535.;
+
+/** Scale of the signed normal components */
+const double NormalMax = 32767.;
+
+/** Narrows cell array ids to 32 bits */
+template <typename T>
+void copyIds(const T* source, vtkTypeInt32* target, qint64 count) {
+    MeshUtils::parallelFor(count, [&](qint64 begin, qint64 end) {
+        for (qint64 i = begin; i < end; ++i)
+            target[i] = static_cast<vtkTypeInt32>(source[i]);
+    }, 1 << 16);
+}
+
+}
+
+/**
+ * @brief Quantises a mesh's points and normals and narrows its connectivity.
+ */
+CompactMesh CompactMesh::encode(vtkPolyData* polyData) {
+    CompactMesh mesh;
+    if (!polyData || polyData->GetNumberOfPoints() == 0 || polyData->GetNumberOfPolys() == 0
+        || polyData->GetNumberOfVerts() || polyData->GetNumberOfLines() || polyData->GetNumberOfStrips())
+        return mesh;
+
+    vtkCellArray* polys = polyData->GetPolys();
+    const qint64 pointCount = polyData->GetNumberOfPoints();
+    const qint64 idCount = polys->GetNumberOfConnectivityIds();
+    if (idCount > std::numeric_limits<vtkTypeInt32>::max())
+        return mesh;
+
+    /* Points, relative to the bounding box */
+    double bounds[6];
+    polyData->GetBounds(bounds);
+    double origin[3], step[3];
+    for (int k = 0; k < 3; ++k) {
+        origin[k] = bounds[2 * k];
+        double extent = bounds[2 * k + 1] - bounds[2 * k];
+        step[k] = extent > 0. ? extent / QuantisedMax : 1.;
+    }
+
+    auto quantisedPoints = vtkSmartPointer<vtkUnsignedShortArray>::New();
+    quantisedPoints->SetNumberOfComponents(3);
+    quantisedPoints->SetNumberOfTuples(pointCount);
+    unsigned short* q = quantisedPoints->GetPointer(0);
+
+    vtkDataArray* sourcePoints = polyData->GetPoints()->GetData();
+    vtkFloatArray* floatPoints = vtkFloatArray::FastDownCast(sourcePoints);
+    MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+        double x[3];
+        for (qint64 i = begin; i < end; ++i) {
+            if (floatPoints) {
+                const float* f = floatPoints->GetPointer(3 * i);
+                x[0] = f[0];
+                x[1] = f[1];
+                x[2] = f[2];
+            } else {
+                sourcePoints->GetTuple(i, x);
+            }
+            for (int k = 0; k < 3; ++k)
+                q[3 * i + k] = static_cast<unsigned short>(
+                    std::clamp(std::lround((x[k] - origin[k]) / step[k]), 0L, long(QuantisedMax)));
+        }
+    });
+
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(quantisedPoints);
+
+    /* Connectivity, 32 bit ids halve the default 64 bit storage */
+    auto offsets = vtkSmartPointer<vtkTypeInt32Array>::New();
+    offsets->SetNumberOfValues(polys->GetNumberOfOffsets());
+    auto connectivity = vtkSmartPointer<vtkTypeInt32Array>::New();
+    connectivity->SetNumberOfValues(idCount);
+    if (polys->IsStorage64Bit()) {
+        copyIds(polys->GetOffsetsArray64()->GetPointer(0), offsets->GetPointer(0), offsets->GetNumberOfValues());
+        copyIds(polys->GetConnectivityArray64()->GetPointer(0), connectivity->GetPointer(0), idCount);
+    } else {
+        copyIds(polys->GetOffsetsArray32()->GetPointer(0), offsets->GetPointer(0), offsets->GetNumberOfValues());
+        copyIds(polys->GetConnectivityArray32()->GetPointer(0), connectivity->GetPointer(0), idCount);
+    }
+    auto cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(offsets, connectivity);
+
+    mesh.quantised = vtkSmartPointer<vtkPolyData>::New();
+    mesh.quantised->SetPoints(points);
+    mesh.quantised->SetPolys(cells);
+
+    /* Normals, if the mesh has them, in the quantised frame so they render with the points:
+     * the inverse transpose of the dequantisation divides each component by the step again */
+    vtkDataArray* sourceNormals = polyData->GetPointData()->GetNormals();
+    if (sourceNormals && sourceNormals->GetNumberOfComponents() == 3 && sourceNormals->GetNumberOfTuples() == pointCount) {
+        mesh.normals = vtkSmartPointer<vtkShortArray>::New();
+        mesh.normals->SetName("Normals");
+        mesh.normals->SetNumberOfComponents(3);
+        mesh.normals->SetNumberOfTuples(pointCount);
+        short* out = mesh.normals->GetPointer(0);
+        MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+            double n[3];
+            for (qint64 i = begin; i < end; ++i) {
+                sourceNormals->GetTuple(i, n);
+                for (int k = 0; k < 3; ++k)
+                    n[k] *= step[k];
+                const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (int k = 0; k < 3; ++k)
+                    out[3 * i + k] = static_cast<short>(length > 0. ? std::lround(n[k] / length * NormalMax) : 0);
+            }
+        });
+        mesh.quantised->GetPointData()->SetNormals(mesh.normals);
+    }
+
+    mesh.dequantise = vtkSmartPointer<vtkMatrix4x4>::New();
+    for (int k = 0; k < 3; ++k) {
+        mesh.dequantise->SetElement(k, k, step[k]);
+        mesh.dequantise->SetElement(k, 3, origin[k]);
+    }
+
+    mesh.originalSize = qint64(polyData->GetActualMemorySize()) * 1024;
+    return mesh;
+}
+
+/**
+ * @brief Rebuilds float points and normals, the connectivity is shared with the compact mesh.
+ */
+vtkSmartPointer<vtkPolyData> CompactMesh::decode() const {
+    if (!isValid())
+        return nullptr;
+
+    const qint64 pointCount = quantised->GetNumberOfPoints();
+    const unsigned short* q =
+        vtkUnsignedShortArray::FastDownCast(quantised->GetPoints()->GetData())->GetPointer(0);
+
+    double origin[3], step[3];
+    for (int k = 0; k < 3; ++k) {
+        step[k] = dequantise->GetElement(k, k);
+        origin[k] = dequantise->GetElement(k, 3);
+    }
+
+    auto floatPoints = vtkSmartPointer<vtkFloatArray>::New();
+    floatPoints->SetNumberOfComponents(3);
+    floatPoints->SetNumberOfTuples(pointCount);
+    float* p = floatPoints->GetPointer(0);
+    MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+        for (qint64 i = begin; i < end; ++i)
+            for (int k = 0; k < 3; ++k)
+                p[3 * i + k] = static_cast<float>(origin[k] + q[3 * i + k] * step[k]);
+    });
+
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(floatPoints);
+
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetPolys(quantised->GetPolys());
+
+    if (normals) {
+        auto floatNormals = vtkSmartPointer<vtkFloatArray>::New();
+        floatNormals->SetName("Normals");
+        floatNormals->SetNumberOfComponents(3);
+        floatNormals->SetNumberOfTuples(pointCount);
+        float* n = floatNormals->GetPointer(0);
+        const short* encoded = normals->GetPointer(0);
+        MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+            double m[3];
+            for (qint64 i = begin; i < end; ++i) {
+                for (int k = 0; k < 3; ++k)
+                    m[k] = encoded[3 * i + k] / step[k];
+                const double length = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+                for (int k = 0; k < 3; ++k)
+                    n[3 * i + k] = static_cast<float>(length > 0. ? m[k] / length : 0.);
+            }
+        });
+        polyData->GetPointData()->SetNormals(floatNormals);
+    }
+
+    return polyData;
+}
+
+/**
+ * @brief Returns whether the mesh holds any geometry.
+ */
+bool CompactMesh::isValid() const {
+    return quantised != nullptr;
+}
+
+/**
+ * @brief Returns the quantised mesh used for rendering.
+ */
+vtkPolyData* CompactMesh::polyData() const {
+    return quantised;
+}
+
+/**
+ * @brief Returns the dequantisation matrix.
+ */
+vtkMatrix4x4* CompactMesh::matrix() const {
+    return dequantise;
+}
+
+/**
+ * @brief Returns the memory used by the compact representation.
+ */
+qint64 CompactMesh::memorySize() const {
+    /* The normals are part of the quantised polydata's point data */
+    return quantised ? qint64(quantised->GetActualMemorySize()) * 1024 : 0;
+}
+
+/**
+ * @brief Returns the memory used by the source mesh.
+ */
+qint64 CompactMesh::originalMemorySize() const {
+    return originalSize;
+}
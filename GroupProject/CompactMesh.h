@@ -0,0 +1,81 @@
+/**
+ * @file CompactMesh.h
+ * @brief Declaration of the CompactMesh class, a quantised in-memory mesh representation.
+ * @details Positions are stored as 16 bit integers within the mesh's bounding box, normals as
+ *          three 16 bit signed components and the polygon connectivity with 32 bit indices.
+ *          The quantised points and normals are rendered directly, the dequantisation is applied
+ *          by the actor's user matrix, so full float geometry is only decoded for filters and
+ *          export. The normals are stored in the quantised frame, scaled by the box size along
+ *          each axis; the renderer turns normals by the inverse transpose of the actor's matrix,
+ *          which undoes that scaling.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_COMPACTMESH_H
+#define VIEWER_COMPACTMESH_H
+
+#include <QtGlobal>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkShortArray.h>
+
+/**
+ * @class CompactMesh
+ * @brief Quantised copy of a polygon mesh, roughly half the size of the float version.
+ * @details Positions are accurate to 1/65535 of the bounding box size along each axis.
+ */
+class CompactMesh {
+public:
+    /**
+     * @brief Encodes a mesh, in parallel.
+     * @details Only meshes made of polygons are supported; vertices, lines and strips are not.
+     * @param polyData Mesh with float or double points.
+     * @return the compact mesh, invalid (see isValid()) if the mesh cannot be encoded
+     */
+    static CompactMesh encode(vtkPolyData* polyData);
+
+    /**
+     * @brief Decodes the full float mesh, in parallel.
+     * @return a new polydata with float points (and normals if the source had them)
+     */
+    vtkSmartPointer<vtkPolyData> decode() const;
+
+    /**
+     * @brief Returns whether the mesh holds any geometry.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Returns the quantised mesh used for rendering.
+     * @details Its points are unsigned 16 bit values, use matrix() to place them in the scene.
+     *          Its normals, if any, are in the same frame and are turned by the inverse transpose
+     *          of matrix(); their length is not 1.
+     */
+    vtkPolyData* polyData() const;
+
+    /**
+     * @brief Returns the matrix that maps quantised points to model coordinates.
+     */
+    vtkMatrix4x4* matrix() const;
+
+    /**
+     * @brief Returns the memory used by the compact representation in bytes.
+     */
+    qint64 memorySize() const;
+
+    /**
+     * @brief Returns the memory the float mesh used before encoding, in bytes.
+     */
+    qint64 originalMemorySize() const;
+
+private:
+    vtkSmartPointer<vtkPolyData>    quantised;          /**< Quantised points and 32 bit connectivity */
+    vtkSmartPointer<vtkShortArray>  normals;            /**< Normals in the quantised frame, also set on quantised, may be null */
+    vtkSmartPointer<vtkMatrix4x4>   dequantise;         /**< Quantised to model coordinates */
+    qint64                          originalSize = 0;   /**< Size of the source mesh in bytes */
+};
+
+#endif
@@ -0,0 +1,397 @@
+/**
+ * @file ContourSlicer.cpp
+ * @brief Implementation of the ContourSlicer class.
+ * @details A vertex lying exactly on a plane is treated as being above it. Every edge is then either
+ *          crossed at one point or not at all, so the segments of neighbouring triangles meet at the
+ *          crossing of their shared edge and can be joined by the edge's two point ids alone.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "ContourSlicer.h"
+#include "MeshUtils.h"
+#include "ModelPart.h"
+#include "Trace.h"
+
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+typedef ContourSlicer::Contour Contour;
+
+/** A part prepared for slicing */
+struct Prepared {
+    const ContourSlicer::Input* input;          /**< Part being sliced */
+    std::vector<double>         points;         /**< Points in scene coordinates, three per point */
+    std::vector<qint64>         offsets;        /**< Polygon offsets, one more than the polygons */
+    std::vector<qint64>         connectivity;   /**< Polygon point ids */
+    std::vector<qint64>         bucketStarts;   /**< Start of each plane's bucket, one more than the planes */
+    std::vector<qint64>         buckets;        /**< Polygons cut by each plane, bucket after bucket */
+};
+
+/** One plane cutting one part */
+struct Task {
+    const Prepared*     prepared;   /**< Part to cut */
+    int                 station;    /**< Plane to cut with */
+    QList<Contour>      contours;   /**< Set by the worker */
+};
+
+/** Where a triangle crosses the plane */
+struct Segment {
+    quint64 key[2];         /**< Point ids of the crossed edges, lower id in the high half */
+    double  point[2][3];    /**< Crossing points */
+};
+
+/**
+ * @brief Returns the key of the edge between two points.
+ */
+inline quint64 edgeKey(qint64 a, qint64 b) {
+    if (a > b)
+        std::swap(a, b);
+    return (quint64(a) << 32) ^ quint64(b);
+}
+
+/**
+ * @brief Computes where the edge between two points crosses the plane.
+ * @details The ends are ordered by id first so every triangle sharing the edge gets the same point.
+ */
+void crossingPoint(const std::vector<double>& points, int axis, double height, qint64 a, qint64 b, double out[3]) {
+    if (a > b)
+        std::swap(a, b);
+    const double* pa = points.data() + 3 * a;
+    const double* pb = points.data() + 3 * b;
+    const double t = (height - pa[axis]) / (pb[axis] - pa[axis]);
+    for (int k = 0; k < 3; ++k)
+        out[k] = pa[k] + t * (pb[k] - pa[k]);
+    out[axis] = height;
+}
+
+/**
+ * @brief Copies a cell array into 64-bit offsets and connectivity.
+ */
+template <typename Array>
+void copyCells(Array* offsets, Array* connectivity, Prepared& prepared) {
+    prepared.offsets.assign(offsets->GetPointer(0), offsets->GetPointer(0) + offsets->GetNumberOfValues());
+    prepared.connectivity.assign(connectivity->GetPointer(0),
+                                 connectivity->GetPointer(0) + connectivity->GetNumberOfValues());
+}
+
+/**
+ * @brief Moves a part to scene coordinates and sorts its polygons into the buckets of the planes they span.
+ * @return false if the part has no polygons
+ */
+bool prepare(const ContourSlicer::Input& input, int axis, const QVector<double>& heights, Prepared& prepared) {
+    TRACE_SCOPE("ContourSlicer::prepare");
+
+    vtkPolyData* polyData = input.geometry;
+    vtkCellArray* polys = polyData->GetPolys();
+    if (!polys || polys->GetNumberOfCells() == 0 || !polyData->GetPoints())
+        return false;
+
+    prepared.input = &input;
+    const qint64 pointCount = polyData->GetNumberOfPoints();
+    prepared.points.resize(size_t(pointCount) * 3);
+    vtkDataArray* pointData = polyData->GetPoints()->GetData();
+    const double* matrix = input.matrix;
+    MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+        double x[3];
+        for (qint64 i = begin; i < end; ++i) {
+            pointData->GetTuple(i, x);
+            for (int r = 0; r < 3; ++r)
+                prepared.points[3 * i + r] = matrix[4 * r] * x[0] + matrix[4 * r + 1] * x[1] +
+                                             matrix[4 * r + 2] * x[2] + matrix[4 * r + 3];
+        }
+    });
+
+    if (polys->IsStorage64Bit())
+        copyCells(polys->GetOffsetsArray64(), polys->GetConnectivityArray64(), prepared);
+    else
+        copyCells(polys->GetOffsetsArray32(), polys->GetConnectivityArray32(), prepared);
+
+    /* A polygon is cut by the planes above its lowest point and not above its highest one */
+    const qint64 cellCount = qint64(prepared.offsets.size()) - 1;
+    std::vector<std::pair<int, int>> spans(cellCount);
+    MeshUtils::parallelFor(cellCount, [&](qint64 begin, qint64 end) {
+        for (qint64 cell = begin; cell < end; ++cell) {
+            double low = std::numeric_limits<double>::max(), high = std::numeric_limits<double>::lowest();
+            for (qint64 k = prepared.offsets[cell]; k < prepared.offsets[cell + 1]; ++k) {
+                const double h = prepared.points[3 * prepared.connectivity[k] + axis];
+                low = std::min(low, h);
+                high = std::max(high, h);
+            }
+            const int first = int(std::upper_bound(heights.begin(), heights.end(), low) - heights.begin());
+            const int last = int(std::upper_bound(heights.begin(), heights.end(), high) - heights.begin());
+            spans[cell] = { first, last };
+        }
+    });
+
+    /* Counting sort of the polygons into the planes' buckets */
+    prepared.bucketStarts.assign(size_t(heights.size()) + 1, 0);
+    for (const auto& [first, last] : spans)
+        for (int station = first; station < last; ++station)
+            ++prepared.bucketStarts[station + 1];
+    for (int station = 0; station < heights.size(); ++station)
+        prepared.bucketStarts[station + 1] += prepared.bucketStarts[station];
+    prepared.buckets.resize(size_t(prepared.bucketStarts.back()));
+    std::vector<qint64> fill(prepared.bucketStarts.begin(), prepared.bucketStarts.end() - 1);
+    for (qint64 cell = 0; cell < cellCount; ++cell)
+        for (int station = spans[cell].first; station < spans[cell].second; ++station)
+            prepared.buckets[fill[station]++] = cell;
+    return true;
+}
+
+/**
+ * @brief Joins segments that share an edge into polylines, open chains first.
+ */
+QList<Contour> chain(const std::vector<Segment>& segments, const QString& name, int station, double height) {
+    std::unordered_map<quint64, std::array<qint32, 2>> ends;
+    ends.reserve(segments.size() * 2);
+    for (qint32 s = 0; s < qint32(segments.size()); ++s) {
+        for (quint64 key : segments[s].key) {
+            auto inserted = ends.try_emplace(key, std::array<qint32, 2>{ -1, -1 });
+            std::array<qint32, 2>& slot = inserted.first->second;
+            /* A third segment at an edge only happens on non-manifold meshes, it becomes an open end */
+            if (slot[0] < 0)
+                slot[0] = s;
+            else if (slot[1] < 0)
+                slot[1] = s;
+        }
+    }
+
+    std::vector<bool> used(segments.size(), false);
+    auto append = [](Contour& contour, const double* point) {
+        const int n = contour.points.size();
+        if (n >= 3 && contour.points[n - 3] == point[0] && contour.points[n - 2] == point[1] &&
+            contour.points[n - 1] == point[2])
+            return;
+        contour.points.append(point[0]);
+        contour.points.append(point[1]);
+        contour.points.append(point[2]);
+    };
+    auto walk = [&](qint32 s, int end) {
+        Contour contour{ name, station, height, false, {} };
+        const quint64 start = segments[s].key[end];
+        append(contour, segments[s].point[end]);
+        quint64 key = start;
+        while (true) {
+            used[s] = true;
+            key = segments[s].key[1 - end];
+            append(contour, segments[s].point[1 - end]);
+            const std::array<qint32, 2>& slot = ends.at(key);
+            const qint32 next = slot[0] == s ? slot[1] : slot[0];
+            if (next < 0 || used[next])
+                break;
+            s = next;
+            end = segments[s].key[0] == key ? 0 : 1;
+        }
+        if (key == start) {
+            contour.closed = true;
+            contour.points.resize(contour.points.size() - 3);
+        }
+        return contour;
+    };
+
+    QList<Contour> contours;
+    for (qint32 s = 0; s < qint32(segments.size()); ++s) {
+        for (int end = 0; end < 2 && !used[s]; ++end) {
+            const std::array<qint32, 2>& slot = ends.at(segments[s].key[end]);
+            if (slot[0] < 0 || slot[1] < 0)
+                contours.append(walk(s, end));
+        }
+    }
+    for (qint32 s = 0; s < qint32(segments.size()); ++s)
+        if (!used[s])
+            contours.append(walk(s, 0));
+
+    contours.erase(std::remove_if(contours.begin(), contours.end(),
+                                  [](const Contour& contour) { return contour.points.size() < 6; }),
+                   contours.end());
+    return contours;
+}
+
+/**
+ * @brief Cuts the polygons in one plane's bucket and chains the segments.
+ */
+void cut(Task& task, int axis, double height) {
+    const Prepared& prepared = *task.prepared;
+    const std::vector<double>& points = prepared.points;
+    std::vector<Segment> segments;
+
+    for (qint64 b = prepared.bucketStarts[task.station]; b < prepared.bucketStarts[task.station + 1]; ++b) {
+        const qint64 cell = prepared.buckets[b];
+        const qint64 first = prepared.offsets[cell];
+        const qint64 last = prepared.offsets[cell + 1];
+
+        /* Fan triangles share their inner diagonals, so those join like mesh edges */
+        for (qint64 k = first + 1; k + 1 < last; ++k) {
+            const qint64 ids[3] = { prepared.connectivity[first], prepared.connectivity[k],
+                                    prepared.connectivity[k + 1] };
+            bool above[3];
+            for (int v = 0; v < 3; ++v)
+                above[v] = points[3 * ids[v] + axis] >= height;
+            if (above[0] == above[1] && above[1] == above[2])
+                continue;
+
+            /* The vertex alone on its side of the plane starts both crossed edges */
+            const int lone = above[0] == above[1] ? 2 : (above[0] == above[2] ? 1 : 0);
+            const qint64 a = ids[lone], b = ids[(lone + 1) % 3], c = ids[(lone + 2) % 3];
+            Segment segment;
+            segment.key[0] = edgeKey(a, b);
+            segment.key[1] = edgeKey(a, c);
+            crossingPoint(points, axis, height, a, b, segment.point[0]);
+            crossingPoint(points, axis, height, a, c, segment.point[1]);
+            segments.push_back(segment);
+        }
+    }
+    task.contours = chain(segments, prepared.input->name, task.station, height);
+}
+
+}
+
+/**
+ * @brief Snapshots the part and the visible parts below it with their actor matrices.
+ */
+QList<ContourSlicer::Input> ContourSlicer::collect(ModelPart* root) {
+    QList<Input> inputs;
+    QList<ModelPart*> stack = { root };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        for (int i = part->childCount() - 1; i >= 0; --i)
+            stack.append(part->child(i));
+
+        vtkActor* actor = part->getActor();
+        vtkPolyData* geometry = part->getStoredGeometry();
+        if (!part->visible() || !actor || !actor->GetVisibility() || !geometry || geometry->GetNumberOfPolys() == 0)
+            continue;
+
+        Input input;
+        input.name = part->data(0).toString();
+        input.geometry = vtkSmartPointer<vtkPolyData>::New();
+        input.geometry->ShallowCopy(geometry);
+        vtkMatrix4x4::DeepCopy(input.matrix, actor->GetMatrix());
+        inputs.append(input);
+    }
+    return inputs;
+}
+
+/**
+ * @brief Transforms the corners of each input's bounding box to find the extent along the axis.
+ */
+QVector<double> ContourSlicer::stations(const QList<Input>& inputs, int axis, double spacing) {
+    double low = std::numeric_limits<double>::max(), high = std::numeric_limits<double>::lowest();
+    for (const Input& input : inputs) {
+        double bounds[6];
+        input.geometry->GetBounds(bounds);
+        for (int corner = 0; corner < 8; ++corner) {
+            const double x[3] = { bounds[corner & 1], bounds[2 + ((corner >> 1) & 1)], bounds[4 + ((corner >> 2) & 1)] };
+            const double* row = input.matrix + 4 * axis;
+            const double h = row[0] * x[0] + row[1] * x[1] + row[2] * x[2] + row[3];
+            low = std::min(low, h);
+            high = std::max(high, h);
+        }
+    }
+
+    QVector<double> heights;
+    if (inputs.isEmpty() || !(spacing > 0.))
+        return heights;
+    const double first = std::ceil(low / spacing), last = std::floor(high / spacing);
+    if (last - first + 1. > MaxStations)
+        return heights;
+    for (double k = first; k <= last; k += 1.)
+        heights.append(k * spacing);
+    return heights;
+}
+
+/**
+ * @brief Buckets every part's polygons, then cuts all part and plane combinations on the thread pool.
+ */
+QList<ContourSlicer::Contour> ContourSlicer::slice(const QList<Input>& inputs, int axis, const QVector<double>& heights) {
+    TRACE_SCOPE("ContourSlicer::slice");
+
+    std::vector<Prepared> prepared(inputs.size());
+    QVector<Task> tasks;
+    for (int i = 0; i < inputs.size(); ++i) {
+        if (!prepare(inputs[i], axis, heights, prepared[i]))
+            continue;
+        for (int station = 0; station < heights.size(); ++station)
+            if (prepared[i].bucketStarts[station + 1] > prepared[i].bucketStarts[station])
+                tasks.append({ &prepared[i], station, {} });
+    }
+
+    QtConcurrent::blockingMap(tasks, [&](Task& task) { cut(task, axis, heights[task.station]); });
+
+    QList<Contour> contours;
+    for (const Task& task : std::as_const(tasks))
+        contours.append(task.contours);
+    return contours;
+}
+
+/**
+ * @brief Adds one line cell per contour, repeating the first point of closed ones.
+ */
+vtkSmartPointer<vtkPolyData> ContourSlicer::toPolyData(const QList<Contour>& contours) {
+    vtkNew<vtkPoints> points;
+    points->SetDataTypeToDouble();
+    vtkNew<vtkCellArray> lines;
+    for (const Contour& contour : contours) {
+        const vtkIdType first = points->GetNumberOfPoints();
+        const vtkIdType count = contour.points.size() / 3;
+        for (vtkIdType i = 0; i < count; ++i)
+            points->InsertNextPoint(contour.points.constData() + 3 * i);
+        lines->InsertNextCell(count + (contour.closed ? 1 : 0));
+        for (vtkIdType i = 0; i < count; ++i)
+            lines->InsertCellPoint(first + i);
+        if (contour.closed)
+            lines->InsertCellPoint(first);
+    }
+
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetLines(lines);
+    return polyData;
+}
+
+/**
+ * @brief Formats every point as a CSV row and writes the file in one go.
+ */
+bool ContourSlicer::exportCsv(const QList<Contour>& contours, const QString& fileName, QString* errorString) {
+    QByteArray out = "part,station,height,contour,closed,x,y,z\n";
+    for (int c = 0; c < contours.size(); ++c) {
+        const Contour& contour = contours[c];
+        QString name = contour.name;
+        name.replace('"', "\"\"");
+        const QByteArray prefix = QString("\"%1\",%2,%3,%4,%5,")
+                                      .arg(name).arg(contour.station).arg(contour.height, 0, 'g', 17)
+                                      .arg(c).arg(contour.closed ? 1 : 0).toUtf8();
+        for (int i = 0; i + 2 < contour.points.size(); i += 3) {
+            out += prefix;
+            out += QString("%1,%2,%3\n")
+                       .arg(contour.points[i], 0, 'g', 17)
+                       .arg(contour.points[i + 1], 0, 'g', 17)
+                       .arg(contour.points[i + 2], 0, 'g', 17).toUtf8();
+        }
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit()) {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file ContourSlicer.h
+ * @brief Declaration of the ContourSlicer class, which cuts parts with a stack of parallel planes.
+ * @details Each polygon only touches the planes between its lowest and highest point, so the
+ *          polygons are first sorted into per-plane buckets by that span. The planes are then cut
+ *          concurrently, each reading only its own bucket, and the cut segments are joined into
+ *          polylines through the mesh edges they cross. Unlike the clip filter of a part, nothing
+ *          is rebuilt for rendering; the result is a set of contour lines that can be overlaid on
+ *          the view or exported.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_CONTOURSLICER_H
+#define VIEWER_CONTOURSLICER_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+class ModelPart;
+
+/**
+ * @class ContourSlicer
+ * @brief Static helpers that slice part geometry into contour polylines.
+ * @details Planes are perpendicular to one of the scene axes. Contours are in scene coordinates,
+ *          so exploded or compact parts are sliced where they are drawn.
+ */
+class ContourSlicer {
+public:
+    /** Most planes in one stack */
+    static constexpr int MaxStations = 10000;
+
+    /** A part to slice, a snapshot taken on the GUI thread */
+    struct Input {
+        QString                         name;           /**< Part name, for export */
+        vtkSmartPointer<vtkPolyData>    geometry;       /**< Shallow copy of the stored geometry */
+        double                          matrix[16];     /**< Actor matrix placing the geometry in the scene */
+    };
+
+    /** One polyline where a plane cuts a part */
+    struct Contour {
+        QString         name;       /**< Name of the part */
+        int             station;    /**< Index of the plane in the stack */
+        double          height;     /**< Position of the plane along the axis */
+        bool            closed;     /**< True if the last point joins the first */
+        QVector<double> points;     /**< Three coordinates per point */
+    };
+
+    /**
+     * @brief Takes a snapshot of a part and the visible parts with geometry below it.
+     * @details Call on the GUI thread.
+     * @param root Part to start from; the tree's root item slices everything visible.
+     * @return one input per part
+     */
+    static QList<Input> collect(ModelPart* root);
+
+    /**
+     * @brief Returns the multiples of a spacing that lie within the inputs' extent along an axis.
+     * @param inputs Parts to be sliced.
+     * @param axis 0, 1 or 2 for x, y or z.
+     * @param spacing Distance between planes, must be positive.
+     * @return the plane positions in increasing order, empty if there would be more than MaxStations
+     */
+    static QVector<double> stations(const QList<Input>& inputs, int axis, double spacing);
+
+    /**
+     * @brief Cuts every input with every plane, in parallel.
+     * @param inputs Parts to slice.
+     * @param axis 0, 1 or 2 for x, y or z.
+     * @param heights Plane positions along the axis in increasing order.
+     * @return the contours, by part and then by plane
+     */
+    static QList<Contour> slice(const QList<Input>& inputs, int axis, const QVector<double>& heights);
+
+    /**
+     * @brief Converts contours into polylines for display.
+     * @param contours Contours from slice().
+     * @return polydata with one line cell per contour
+     */
+    static vtkSmartPointer<vtkPolyData> toPolyData(const QList<Contour>& contours);
+
+    /**
+     * @brief Writes contours to a CSV file, one row per point.
+     * @details Columns are part, station, height, contour, closed, x, y and z.
+     * @param contours Contours from slice().
+     * @param fileName File to write.
+     * @param errorString If given, receives a description of the failure.
+     * @return true if the file was written
+     */
+    static bool exportCsv(const QList<Contour>& contours, const QString& fileName, QString* errorString = nullptr);
+};
+
+#endif
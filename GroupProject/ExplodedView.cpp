@@ -0,0 +1,104 @@
+/**
+ * @file ExplodedView.cpp
+ * @brief Implementation of the ExplodedView class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "ExplodedView.h"
+#include "ModelPart.h"
+#include "Trace.h"
+
+#include <QHash>
+
+#include <vtkBoundingBox.h>
+
+namespace {
+
+/**
+ * @brief Collects the assembled bounding box of every subtree, children before parents.
+ * @param part Node to measure.
+ * @param boxes Receives the box of the node and of all its descendants.
+ * @return the box of the node's subtree, invalid if it holds no geometry
+ */
+vtkBoundingBox measure(ModelPart* part, QHash<ModelPart*, vtkBoundingBox>& boxes) {
+    vtkBoundingBox box;
+    vtkActor* actor = part->getActor();
+    if (actor && actor->GetMapper()) {
+        /* Bounds include the current explode offset, which is a pure translation */
+        double* bounds = actor->GetBounds();
+        double* position = actor->GetPosition();
+        if (bounds && vtkBoundingBox::IsValid(bounds)) {
+            double assembled[6];
+            for (int k = 0; k < 6; ++k)
+                assembled[k] = bounds[k] - position[k / 2];
+            box.AddBounds(assembled);
+        }
+    }
+    for (int i = 0; i < part->childCount(); ++i)
+        box.AddBox(measure(part->child(i), boxes));
+    boxes.insert(part, box);
+    return box;
+}
+
+/**
+ * @brief Computes the offsets of a node and its descendants.
+ * @param part Node to place.
+ * @param parentCentre Assembled centre of the parent's subtree.
+ * @param parentOffset Unscaled offset of the parent.
+ * @param boxes Subtree boxes from measure().
+ * @param offsets Receives the offset of the node and of all its descendants.
+ */
+void place(ModelPart* part, const double parentCentre[3], const double parentOffset[3],
+           const QHash<ModelPart*, vtkBoundingBox>& boxes, QHash<ModelPart*, ExplodedView::Offset>& offsets) {
+    const vtkBoundingBox& box = boxes[part];
+    double centre[3] = { parentCentre[0], parentCentre[1], parentCentre[2] };
+    if (box.IsValid())
+        box.GetCenter(centre);
+
+    double offset[3];
+    for (int k = 0; k < 3; ++k)
+        offset[k] = parentOffset[k] + centre[k] - parentCentre[k];
+    offsets.insert(part, { offset[0], offset[1], offset[2] });
+
+    for (int i = 0; i < part->childCount(); ++i)
+        place(part->child(i), centre, offset, boxes, offsets);
+}
+
+}
+
+/**
+ * @brief Measures every subtree, then offsets each part from its parent's centre.
+ */
+QHash<ModelPart*, ExplodedView::Offset> ExplodedView::offsets(ModelPart* root) {
+    /* The offsets go on top of the parts' own transforms, which must be current for the bounds */
+    root->updateWorldMatrices();
+
+    QHash<ModelPart*, vtkBoundingBox> boxes;
+    vtkBoundingBox all = measure(root, boxes);
+
+    double centre[3] = { 0., 0., 0. };
+    if (all.IsValid())
+        all.GetCenter(centre);
+    const double zero[3] = { 0., 0., 0. };
+
+    /* The root stays where it is, its children spread out around the overall centre */
+    QHash<ModelPart*, Offset> offsets;
+    for (int i = 0; i < root->childCount(); ++i)
+        place(root->child(i), centre, zero, boxes, offsets);
+    return offsets;
+}
+
+/**
+ * @brief Moves every actor by its scaled offset.
+ */
+void ExplodedView::apply(ModelPart* root, double factor) {
+    TRACE_SCOPE("ExplodedView::apply");
+
+    const QHash<ModelPart*, Offset> all = offsets(root);
+    for (auto it = all.cbegin(); it != all.cend(); ++it) {
+        if (vtkActor* actor = it.key()->getActor())
+            actor->SetPosition(factor * it.value()[0], factor * it.value()[1], factor * it.value()[2]);
+    }
+}
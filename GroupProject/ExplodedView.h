@@ -0,0 +1,50 @@
+/**
+ * @file ExplodedView.h
+ * @brief Declaration of the ExplodedView class, which spreads an assembly apart by moving actors.
+ * @details Every part is moved away from its parent along the line from the parent's centre to
+ *          its own centre, where a centre is the middle of the bounding box of everything below
+ *          that tree node. Offsets add up down the tree, so sub-assemblies separate as a group
+ *          and then spread out themselves. Only actor positions change; the geometry, unlike
+ *          with the shrink filter, is left untouched.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_EXPLODEDVIEW_H
+#define VIEWER_EXPLODEDVIEW_H
+
+#include <QHash>
+
+#include <array>
+
+class ModelPart;
+
+/**
+ * @class ExplodedView
+ * @brief Static helper that positions the actors of a tree for an explode factor.
+ * @details The cost is linear in the number of parts; the bounding boxes come from the mappers,
+ *          which VTK caches after the first render.
+ */
+class ExplodedView {
+public:
+    /** Unscaled offset of a part, in scene coordinates */
+    using Offset = std::array<double, 3>;
+
+    /**
+     * @brief Computes where every part below a node moves when fully exploded.
+     * @details Offsets include the parent's, so they are where the part goes, not how far it moves
+     *          relative to its parent.
+     * @param root Node whose descendants are exploded, normally the tree's root item.
+     * @return the offset of every descendant of root
+     */
+    static QHash<ModelPart*, Offset> offsets(ModelPart* root);
+
+    /**
+     * @brief Moves every actor below a node to its exploded position.
+     * @param root Node whose descendants are exploded, normally the tree's root item.
+     * @param factor 0 for the assembled model, 1 to move every part by one offset.
+     */
+    static void apply(ModelPart* root, double factor);
+};
+
+#endif
@@ -0,0 +1,519 @@
+/**
+ * @file FolderWatcher.cpp
+ * @brief Implementation of the FolderWatcher class.
+ * @details Scans run on the global thread pool and never touch the tree; they only report what
+ *          changed on disk together with the freshly read geometry. All model and VTK updates are
+ *          made afterwards on the GUI thread.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "FolderWatcher.h"
+#include "ModelPart.h"
+#include "ModelPartList.h"
+#include "MeshImporter.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMultiHash>
+#include <QtConcurrent>
+
+#include <functional>
+#include <utility>
+
+namespace {
+
+/** Time to wait for a burst of file system notifications to settle before rescanning */
+const int SettleTimeMs = 500;
+
+/** Reads the size and modification time of a file */
+FolderWatcher::FileStamp stampOf(const QFileInfo& info) {
+    FolderWatcher::FileStamp stamp;
+    stamp.modified = info.lastModified();
+    stamp.size = info.size();
+    return stamp;
+}
+
+/** Collects some parts and everything below them */
+QSet<ModelPart*> subtreeParts(QList<ModelPart*> stack) {
+    QSet<ModelPart*> parts;
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        if (!part)
+            continue;
+        parts.insert(part);
+        for (int i = 0; i < part->childCount(); ++i)
+            stack.append(part->child(i));
+    }
+    return parts;
+}
+
+/** Returns the children of a parent in a range of rows */
+QList<ModelPart*> rowParts(ModelPart* parent, int first, int last) {
+    QList<ModelPart*> parts;
+    for (int row = first; row <= last; ++row)
+        parts.append(parent->child(row));
+    return parts;
+}
+
+}
+
+/**
+ * @brief Constructs the watcher and connects it to the file system and the model.
+ * @param partList Model holding the tree.
+ * @param parent Optional QObject parent.
+ */
+FolderWatcher::FolderWatcher(ModelPartList* partList, QObject* parent)
+    : QObject(parent), partList(partList) {
+    settleTimer.setSingleShot(true);
+    settleTimer.setInterval(SettleTimeMs);
+
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, this, &FolderWatcher::directoryChanged);
+    connect(&watcher, &QFileSystemWatcher::fileChanged, this, &FolderWatcher::fileChanged);
+    connect(&settleTimer, &QTimer::timeout, this, &FolderWatcher::startScan);
+    connect(&scanWatcher, &QFutureWatcher<ScanResult>::finished, this, &FolderWatcher::applyScan);
+
+    /* Parts can also disappear because the user deleted them or the whole tree was replaced; an
+     * undoable delete only parks them, so they come back with rowsInserted() */
+    connect(partList, &ModelPartList::partsAboutToBeDeleted, this, &FolderWatcher::partsAboutToBeDeleted);
+    connect(partList, &QAbstractItemModel::rowsAboutToBeRemoved, this, &FolderWatcher::rowsAboutToBeRemoved);
+    connect(partList, &QAbstractItemModel::rowsInserted, this, &FolderWatcher::rowsInserted);
+    connect(partList, &QAbstractItemModel::modelAboutToBeReset, this, &FolderWatcher::unwatchAll);
+}
+
+/**
+ * @brief Imports every mesh file below a folder, optionally watching it for changes.
+ */
+int FolderWatcher::importFolder(const QString& dir, const QModelIndex& parent, bool watch) {
+    const QString rootPath = QDir(dir).absolutePath();
+
+    /* Collect every file and sub-directory below the folder */
+    QList<ScannedFile> files;
+    QDirIterator fileIt(rootPath, MeshImporter::nameFilters(), QDir::Files, QDirIterator::Subdirectories);
+    while (fileIt.hasNext()) {
+        fileIt.next();
+        ScannedFile file;
+        file.path = fileIt.filePath();
+        file.stamp = stampOf(fileIt.fileInfo());
+        files.append(file);
+    }
+    std::sort(files.begin(), files.end(),
+              [](const ScannedFile& a, const ScannedFile& b) { return a.path < b.path; });
+
+    QStringList subDirs;
+    QDirIterator dirIt(rootPath, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (dirIt.hasNext())
+        subDirs.append(dirIt.next());
+
+    /* Read all the files in parallel */
+    QtConcurrent::blockingMap(files, [](ScannedFile& file) {
+        file.polyData = MeshImporter::read(file.path, &file.loadMs);
+    });
+
+    /* Build the new sub-tree away from the model, folder items are only created for
+     * directories that actually contain something */
+    QList<ModelPart*> topLevel;
+    QHash<QString, ModelPart*> folders;
+    std::function<ModelPart*(const QString&)> folderFor = [&](const QString& path) -> ModelPart* {
+        if (path == rootPath)
+            return nullptr;
+        if (ModelPart* folder = folders.value(path))
+            return folder;
+
+        ModelPart* folder = new ModelPart({ QFileInfo(path).fileName(), true });
+        if (ModelPart* parentFolder = folderFor(QFileInfo(path).absolutePath()))
+            parentFolder->appendChild(folder);
+        else
+            topLevel.append(folder);
+        folders.insert(path, folder);
+        return folder;
+    };
+
+    int imported = 0;
+    QList<QPair<ScannedFile, ModelPart*>> loaded;
+    for (const ScannedFile& file : files) {
+        if (!file.polyData)
+            continue;
+
+        ModelPart* part = new ModelPart({ QFileInfo(file.path).fileName(), true });
+        part->setFileName(file.path);
+        part->setPolyData(file.polyData);
+        part->setLoadTime(file.loadMs);
+
+        if (ModelPart* folder = folderFor(QFileInfo(file.path).absolutePath()))
+            folder->appendChild(part);
+        else
+            topLevel.append(part);
+
+        loaded.append({ file, part });
+        ++imported;
+    }
+
+    partList->appendParts(parent, topLevel);
+
+    if (watch) {
+        rootDirs.insert(rootPath);
+        watchDirectory(rootPath, partList->getItem(parent));
+        for (const QString& subDir : subDirs)
+            watchDirectory(subDir, folders.value(subDir));
+
+        QStringList paths;
+        for (const auto& entry : loaded) {
+            watchFile(entry.first.path, entry.first.stamp, entry.second);
+            paths.append(entry.first.path);
+        }
+        if (!paths.isEmpty())
+            watcher.addPaths(paths);
+    }
+
+    return imported;
+}
+
+/**
+ * @brief Stops watching all folders and forgets every part.
+ */
+void FolderWatcher::unwatchAll() {
+    settleTimer.stop();
+    pendingDirs.clear();
+
+    if (!watcher.directories().isEmpty())
+        watcher.removePaths(watcher.directories());
+    if (!watcher.files().isEmpty())
+        watcher.removePaths(watcher.files());
+
+    rootDirs.clear();
+    dirParts.clear();
+    fileParts.clear();
+    fileStamps.clear();
+    parkedFiles.clear();
+    parkedDirs.clear();
+}
+
+/**
+ * @brief Returns the number of folders being watched, including sub-folders.
+ */
+int FolderWatcher::watchedFolderCount() const {
+    return dirParts.size();
+}
+
+/**
+ * @brief Queues a changed directory for rescanning.
+ */
+void FolderWatcher::directoryChanged(const QString& path) {
+    pendingDirs.insert(path);
+    settleTimer.start();
+}
+
+/**
+ * @brief Queues the directory of a changed file for rescanning.
+ */
+void FolderWatcher::fileChanged(const QString& path) {
+    pendingDirs.insert(QFileInfo(path).absolutePath());
+    settleTimer.start();
+}
+
+/**
+ * @brief Starts a background scan of the queued directories, unless one is already running.
+ */
+void FolderWatcher::startScan() {
+    if (pendingDirs.isEmpty())
+        return;
+
+    /* Only one scan at a time, anything queued meanwhile is picked up when it finishes */
+    if (scanWatcher.isRunning())
+        return;
+
+    QStringList dirs(pendingDirs.begin(), pendingDirs.end());
+    pendingDirs.clear();
+
+    QSet<QString> knownDirs;
+    for (auto it = dirParts.cbegin(); it != dirParts.cend(); ++it)
+        knownDirs.insert(it.key());
+
+    scanWatcher.setFuture(QtConcurrent::run(&FolderWatcher::scan, dirs, fileStamps, knownDirs));
+}
+
+/**
+ * @brief Compares directories on disk with what was last seen and reads any new or changed files.
+ */
+FolderWatcher::ScanResult FolderWatcher::scan(QStringList dirs, QHash<QString, FileStamp> knownFiles, QSet<QString> knownDirs) {
+    ScanResult result;
+
+    /* Index the known files by directory so each directory only looks at its own files */
+    QMultiHash<QString, QString> filesByDir;
+    for (auto it = knownFiles.cbegin(); it != knownFiles.cend(); ++it)
+        filesByDir.insert(QFileInfo(it.key()).absolutePath(), it.key());
+
+    QSet<QString> scanned;
+    while (!dirs.isEmpty()) {
+        const QString dir = dirs.takeFirst();
+        if (scanned.contains(dir))
+            continue;
+        scanned.insert(dir);
+
+        QDir d(dir);
+        if (!d.exists()) {
+            /* The directory and everything below it has gone */
+            if (knownDirs.contains(dir))
+                result.removedDirs.append(dir);
+            for (const QString& knownDir : std::as_const(knownDirs))
+                if (knownDir.startsWith(dir + '/'))
+                    result.removedDirs.append(knownDir);
+            for (auto it = knownFiles.cbegin(); it != knownFiles.cend(); ++it)
+                if (it.key().startsWith(dir + '/'))
+                    result.removedFiles.append(it.key());
+            continue;
+        }
+
+        /* Files in this directory */
+        QSet<QString> present;
+        const QFileInfoList entries = d.entryInfoList(MeshImporter::nameFilters(), QDir::Files);
+        for (const QFileInfo& info : entries) {
+            const QString path = info.absoluteFilePath();
+            present.insert(path);
+
+            ScannedFile file;
+            file.path = path;
+            file.stamp = stampOf(info);
+
+            auto known = knownFiles.constFind(path);
+            if (known == knownFiles.cend())
+                result.added.append(file);
+            else if (known->modified != file.stamp.modified || known->size != file.stamp.size)
+                result.changed.append(file);
+        }
+
+        const QStringList knownHere = filesByDir.values(dir);
+        for (const QString& path : knownHere)
+            if (!present.contains(path))
+                result.removedFiles.append(path);
+
+        /* New sub-directories are scanned in full, vanished ones are reported as removed */
+        const QStringList subDirs = d.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        QSet<QString> presentDirs;
+        for (const QString& name : subDirs) {
+            const QString subDir = d.absoluteFilePath(name);
+            presentDirs.insert(subDir);
+            if (!knownDirs.contains(subDir)) {
+                result.addedDirs.append(subDir);
+                knownDirs.insert(subDir);
+                dirs.append(subDir);
+            }
+        }
+        for (const QString& knownDir : std::as_const(knownDirs))
+            if (QFileInfo(knownDir).absolutePath() == dir && !presentDirs.contains(knownDir))
+                dirs.append(knownDir);
+    }
+
+    /* Only the files that changed are read, in parallel */
+    auto read = [](ScannedFile& file) { file.polyData = MeshImporter::read(file.path, &file.loadMs); };
+    QtConcurrent::blockingMap(result.changed, read);
+    QtConcurrent::blockingMap(result.added, read);
+
+    return result;
+}
+
+/**
+ * @brief Applies a finished scan: updates changed parts in place, adds new ones and removes deleted ones.
+ */
+void FolderWatcher::applyScan() {
+    const ScanResult result = scanWatcher.result();
+    int reloaded = 0, added = 0, removed = 0;
+
+    for (const QString& path : result.removedFiles) {
+        if (ModelPart* part = fileParts.value(path)) {
+            removePart(part);
+            ++removed;
+        } else {
+            fileStamps.remove(path);    // A parked part's file, it is not watched again
+        }
+    }
+
+    for (const QString& dir : result.removedDirs) {
+        ModelPart* part = dirParts.value(dir);
+        /* Never delete the item a folder was imported into, only the folder items we created */
+        if (part && !rootDirs.contains(dir))
+            removePart(part);
+        dirParts.remove(dir);
+        rootDirs.remove(dir);
+    }
+
+    for (const QString& dir : result.addedDirs)
+        watchDirectory(dir, nullptr);
+
+    /* Existing parts keep their actor, only the geometry underneath is swapped. Files
+     * replaced by a rename drop out of the watcher, so they are added back here */
+    const QStringList watchedFiles = watcher.files();
+    for (const ScannedFile& file : result.changed) {
+        ModelPart* part = fileParts.value(file.path);
+        if (!part || !file.polyData)
+            continue;           // Probably still being written, the next notification retries it
+
+        part->setPolyData(file.polyData);
+        part->setLoadTime(file.loadMs);
+        watchFile(file.path, file.stamp, part);
+        if (!watchedFiles.contains(file.path))
+            watcher.addPath(file.path);
+        ++reloaded;
+    }
+
+    for (const ScannedFile& file : result.added) {
+        if (!file.polyData)
+            continue;
+
+        ModelPart* folder = folderPart(QFileInfo(file.path).absolutePath());
+        if (!folder)
+            continue;
+
+        ModelPart* part = new ModelPart({ QFileInfo(file.path).fileName(), true });
+        part->setFileName(file.path);
+        part->setPolyData(file.polyData);
+        part->setLoadTime(file.loadMs);
+        partList->appendParts(partList->indexOf(folder), { part });
+
+        watchFile(file.path, file.stamp, part);
+        watcher.addPath(file.path);
+        emit partAdded(part);
+        ++added;
+    }
+
+    if (reloaded || added || removed)
+        emit partsUpdated(reloaded, added, removed);
+
+    /* Notifications that arrived during the scan */
+    if (!pendingDirs.isEmpty())
+        settleTimer.start();
+}
+
+/**
+ * @brief Drops bookkeeping for every part about to be deleted.
+ */
+void FolderWatcher::partsAboutToBeDeleted(const QList<ModelPart*>& parts) {
+    if (dirParts.isEmpty() && fileParts.isEmpty())
+        return;
+    unwatchParts(subtreeParts(parts), false);
+}
+
+/**
+ * @brief Parks the bookkeeping of the parts in the rows about to be removed; parts being deleted
+ *        have already been forgotten by partsAboutToBeDeleted().
+ */
+void FolderWatcher::rowsAboutToBeRemoved(const QModelIndex& parent, int first, int last) {
+    if (dirParts.isEmpty() && fileParts.isEmpty())
+        return;
+    unwatchParts(subtreeParts(rowParts(partList->getItem(parent), first, last)), true);
+}
+
+/**
+ * @brief Watches the parked parts among the inserted rows again and rescans their directories,
+ *        so changes made while they were out of the tree are picked up.
+ */
+void FolderWatcher::rowsInserted(const QModelIndex& parent, int first, int last) {
+    if (parkedFiles.isEmpty() && parkedDirs.isEmpty())
+        return;
+
+    const QSet<ModelPart*> inserted = subtreeParts(rowParts(partList->getItem(parent), first, last));
+    for (ModelPart* part : inserted) {
+        auto file = parkedFiles.find(part);
+        if (file != parkedFiles.end()) {
+            const QString path = file.value();
+            parkedFiles.erase(file);
+            /* The stamp is gone if the file was removed meanwhile; the name guards against a
+             * new part that reuses a freed parked part's address */
+            if (fileStamps.contains(path) && !fileParts.contains(path) && part->getFileName() == path) {
+                fileParts.insert(path, part);
+                watcher.addPath(path);
+                pendingDirs.insert(QFileInfo(path).absolutePath());
+            }
+        }
+
+        auto dir = parkedDirs.find(part);
+        if (dir != parkedDirs.end()) {
+            /* Unless the folder item was recreated for new files meanwhile */
+            if (dirParts.contains(dir.value()) && !dirParts.value(dir.value()))
+                dirParts.insert(dir.value(), part);
+            parkedDirs.erase(dir);
+        }
+    }
+
+    if (!pendingDirs.isEmpty())
+        settleTimer.start();
+}
+
+/**
+ * @brief Starts watching a directory.
+ */
+void FolderWatcher::watchDirectory(const QString& dir, ModelPart* part) {
+    if (!dirParts.contains(dir))
+        watcher.addPath(dir);
+    if (part || !dirParts.contains(dir))
+        dirParts.insert(dir, part);
+}
+
+/**
+ * @brief Records a file's part and stamp, the caller adds the path to the watcher.
+ */
+void FolderWatcher::watchFile(const QString& path, const FileStamp& stamp, ModelPart* part) {
+    fileParts.insert(path, part);
+    fileStamps.insert(path, stamp);
+}
+
+/**
+ * @brief Returns the folder item for a directory, creating it and any missing parents.
+ */
+ModelPart* FolderWatcher::folderPart(const QString& dir) {
+    ModelPart* part = dirParts.value(dir);
+    if (part || rootDirs.contains(dir) || !dirParts.contains(dir))
+        return part;
+
+    ModelPart* parentPart = folderPart(QFileInfo(dir).absolutePath());
+    if (!parentPart)
+        return nullptr;
+
+    part = new ModelPart({ QFileInfo(dir).fileName(), true });
+    partList->appendParts(partList->indexOf(parentPart), { part });
+    dirParts.insert(dir, part);
+    return part;
+}
+
+/**
+ * @brief Unwatches the parts' files, keeping their stamps if they are parked, and clears the
+ *        folder items; directories stay watched, their folder item is recreated if new files
+ *        turn up.
+ */
+void FolderWatcher::unwatchParts(const QSet<ModelPart*>& parts, bool park) {
+    for (auto it = fileParts.begin(); it != fileParts.end(); ) {
+        if (parts.contains(it.value())) {
+            watcher.removePath(it.key());
+            if (park)
+                parkedFiles.insert(it.value(), it.key());
+            else
+                fileStamps.remove(it.key());
+            it = fileParts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = dirParts.begin(); it != dirParts.end(); ++it) {
+        if (it.value() && parts.contains(it.value())) {
+            if (park)
+                parkedDirs.insert(it.value(), it.key());
+            it.value() = nullptr;
+        }
+    }
+}
+
+/**
+ * @brief Removes a part from the model after telling listeners it is going.
+ */
+void FolderWatcher::removePart(ModelPart* part) {
+    QModelIndex index = partList->indexOf(part);
+    if (!index.isValid())
+        return;
+
+    emit partAboutToBeRemoved(part);
+    partList->removeRows(index.row(), 1, index.parent());
+}
@@ -0,0 +1,203 @@
+/**
+ * @file FolderWatcher.h
+ * @brief Declaration of the FolderWatcher class for recursive folder import and hot reload.
+ * @details Imports every mesh file below a folder, mirroring the sub-folder structure in the tree,
+ *          and can keep watching the folders so that files which are changed, added or removed on
+ *          disk are re-imported in the background and the matching parts are updated in place.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_FOLDERWATCHER_H
+#define VIEWER_FOLDERWATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QDateTime>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QModelIndex>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+class ModelPart;
+class ModelPartList;
+
+/**
+ * @class FolderWatcher
+ * @brief Imports folders of mesh files and re-imports only the files that change.
+ * @details Change notifications are collected for a short settling time, then only the affected
+ *          directories are rescanned and the changed files re-read on a worker thread. Results are
+ *          applied on the GUI thread: existing parts get new geometry (their actor is kept), new
+ *          files become new parts and deleted files have their parts removed. Parts taken out of
+ *          the tree without being deleted, e.g. parked by an undoable delete, stop being watched
+ *          and are watched again when they are put back.
+ */
+class FolderWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    /** Size and modification time used to decide whether a file needs re-reading */
+    struct FileStamp {
+        QDateTime   modified;
+        qint64      size = -1;
+    };
+
+    /** A file read by the background scan */
+    struct ScannedFile {
+        QString                         path;
+        FileStamp                       stamp;
+        vtkSmartPointer<vtkPolyData>    polyData;
+        double                          loadMs = 0.;
+    };
+
+    /** Everything a background scan found out about the queued directories */
+    struct ScanResult {
+        QList<ScannedFile>  changed;        /**< Known files with a new size or time stamp */
+        QList<ScannedFile>  added;          /**< Files not seen before */
+        QStringList         removedFiles;   /**< Known files that no longer exist */
+        QStringList         addedDirs;      /**< New sub-directories, parents listed first */
+        QStringList         removedDirs;    /**< Known directories that no longer exist */
+    };
+
+    /**
+     * @brief Constructs a watcher that adds and removes parts in the given model.
+     * @param partList Model holding the tree.
+     * @param parent Optional QObject parent.
+     */
+    FolderWatcher(ModelPartList* partList, QObject* parent = nullptr);
+
+    /**
+     * @brief Imports all mesh files below a folder, recursing into sub-folders.
+     * @details Files are read in parallel, each sub-folder becomes a tree node and the new parts
+     *          are inserted into the model in one batch per parent.
+     * @param dir Folder to import.
+     * @param parent Tree item the folder contents are added under.
+     * @param watch If true, keep the folder under observation and hot reload changes.
+     * @return Number of files imported.
+     */
+    int importFolder(const QString& dir, const QModelIndex& parent, bool watch);
+
+    /**
+     * @brief Stops watching every folder, the parts already imported are left untouched.
+     */
+    void unwatchAll();
+
+    /**
+     * @brief Returns the number of folders currently being watched.
+     */
+    int watchedFolderCount() const;
+
+signals:
+    /**
+     * @brief Emitted after a new part with geometry has been added to the tree.
+     * @param part The new part.
+     */
+    void partAdded(ModelPart* part);
+
+    /**
+     * @brief Emitted just before a part (and its children) is removed from the tree.
+     * @param part The part about to be deleted.
+     */
+    void partAboutToBeRemoved(ModelPart* part);
+
+    /**
+     * @brief Emitted once a batch of changes has been applied.
+     * @param reloaded Number of parts whose geometry was replaced.
+     * @param added Number of new parts.
+     * @param removed Number of parts removed.
+     */
+    void partsUpdated(int reloaded, int added, int removed);
+
+private slots:
+    /**
+     * @brief Queues a directory for rescanning and restarts the settle timer.
+     * @param path Directory that changed.
+     */
+    void directoryChanged(const QString& path);
+
+    /**
+     * @brief Queues the directory containing a changed file for rescanning.
+     * @param path File that changed.
+     */
+    void fileChanged(const QString& path);
+
+    /**
+     * @brief Starts a background scan of all queued directories.
+     */
+    void startScan();
+
+    /**
+     * @brief Applies the results of a finished background scan to the tree.
+     */
+    void applyScan();
+
+    /**
+     * @brief Forgets any parts that are about to be deleted by someone else.
+     */
+    void partsAboutToBeDeleted(const QList<ModelPart*>& parts);
+
+    /**
+     * @brief Parks the watches of parts about to be taken out of the model.
+     */
+    void rowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+
+    /**
+     * @brief Watches parked parts again once they are back in the model.
+     */
+    void rowsInserted(const QModelIndex& parent, int first, int last);
+
+private:
+    /**
+     * @brief Rescans directories and reads changed files, runs on a worker thread.
+     */
+    static ScanResult scan(QStringList dirs, QHash<QString, FileStamp> knownFiles, QSet<QString> knownDirs);
+
+    /**
+     * @brief Starts watching a directory that is represented by a tree item.
+     */
+    void watchDirectory(const QString& dir, ModelPart* part);
+
+    /**
+     * @brief Adds a file's part and stamp to the bookkeeping.
+     */
+    void watchFile(const QString& path, const FileStamp& stamp, ModelPart* part);
+
+    /**
+     * @brief Returns the tree item for a watched directory, creating folder items as needed.
+     * @return the item, or nullptr if the directory's watched root is no longer in the tree
+     */
+    ModelPart* folderPart(const QString& dir);
+
+    /**
+     * @brief Removes a part from the tree, notifying listeners first.
+     */
+    void removePart(ModelPart* part);
+
+    /**
+     * @brief Stops watching the files and folder items among some parts.
+     * @param parts Parts leaving the tree, children included.
+     * @param park If true, remember them so that rowsInserted() can watch them again.
+     */
+    void unwatchParts(const QSet<ModelPart*>& parts, bool park);
+
+    ModelPartList*                  partList;       /**< Model the parts live in */
+    QFileSystemWatcher              watcher;        /**< Change notifications from the OS */
+    QTimer                          settleTimer;    /**< Collects bursts of notifications into one scan */
+    QFutureWatcher<ScanResult>      scanWatcher;    /**< Tracks the running background scan */
+    QSet<QString>                   pendingDirs;    /**< Directories waiting to be rescanned */
+
+    QSet<QString>                   rootDirs;       /**< Folders passed to importFolder() with watching on */
+    QHash<QString, ModelPart*>      dirParts;       /**< Watched directory -> tree item holding its contents */
+    QHash<QString, ModelPart*>      fileParts;      /**< Watched file -> part showing it */
+    QHash<QString, FileStamp>       fileStamps;     /**< Watched or parked file -> stamp when last read */
+    QHash<ModelPart*, QString>      parkedFiles;    /**< Part out of the tree -> file it showed */
+    QHash<ModelPart*, QString>      parkedDirs;     /**< Folder item out of the tree -> its directory */
+};
+
+#endif
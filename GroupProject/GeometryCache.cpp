@@ -0,0 +1,210 @@
+/**
+ * @file GeometryCache.cpp
+ * @brief Implementation of the GeometryCache class.
+ * @details Each entry is a small header followed by a geometry block written with
+ *          ProjectFile::appendGeometry(). Entries are written through QSaveFile so that a reader
+ *          never sees a half written file, even when two threads insert the same source.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "GeometryCache.h"
+#include "ProjectFile.h"
+#include "Trace.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "Cache entries are little-endian");
+
+namespace {
+
+const char     CacheMagic[4] = { 'G', 'P', 'G', 'C' };
+const quint32  CacheVersion  = 1;
+
+/** Flags stored in the cache header */
+enum CacheFlags : quint32 {
+    CacheHasNormals = 0x01
+};
+
+/** Header of every cache entry */
+struct CacheHeader {
+    char     magic[4];
+    quint32  version;
+    quint32  pointCount;
+    quint32  triangleCount;
+    quint32  flags;         /**< Combination of CacheFlags */
+    quint32  reserved;
+};
+static_assert(sizeof(CacheHeader) == 24, "Cache header layout must not change");
+
+std::atomic<bool>    cacheEnabled(true);
+std::atomic<qint64>  cacheMaximumSize(qint64(2) << 30);
+std::once_flag       pruneOnce;
+
+}
+
+/**
+ * @brief Builds the cache file name from the source path, size, time stamp and variant.
+ */
+QString GeometryCache::entryFileName(const QString& fileName, const QString& variant) {
+    QFileInfo info(fileName);
+    if (!info.exists())
+        return QString();
+
+    QString key = info.absoluteFilePath() + '|' + QString::number(info.size())
+                  + '|' + QString::number(info.lastModified().toMSecsSinceEpoch()) + '|' + variant;
+    QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return directory() + '/' + QString::fromLatin1(hash) + ".gpg";
+}
+
+/**
+ * @brief Returns the cached mesh for a source file, or nullptr.
+ */
+vtkSmartPointer<vtkPolyData> GeometryCache::find(const QString& fileName, const QString& variant) {
+    if (!cacheEnabled)
+        return nullptr;
+    TRACE_SCOPE("GeometryCache::find");
+
+    QString entry = entryFileName(fileName, variant);
+    if (entry.isEmpty())
+        return nullptr;
+
+    vtkSmartPointer<vtkPolyData> polyData = readEntry(entry);
+    if (!polyData)
+        return nullptr;
+
+    /* Touch the entry so that pruning treats it as recently used */
+    QFile touch(entry);
+    if (touch.open(QIODevice::ReadWrite))
+        touch.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    return polyData;
+}
+
+/**
+ * @brief Writes a mesh to the cache.
+ */
+void GeometryCache::insert(const QString& fileName, vtkPolyData* polyData, const QString& variant) {
+    if (!cacheEnabled || !polyData)
+        return;
+    TRACE_SCOPE("GeometryCache::insert");
+
+    QString entry = entryFileName(fileName, variant);
+    if (entry.isEmpty() || !QDir().mkpath(directory()))
+        return;
+
+    if (!writeEntry(entry, polyData))
+        return;
+
+    /* Trim old entries once per session, in the background */
+    std::call_once(pruneOnce, [] { QThreadPool::globalInstance()->start([] { GeometryCache::prune(); }); });
+}
+
+/**
+ * @brief Writes a header and geometry block to a file, atomically.
+ */
+bool GeometryCache::writeEntry(const QString& entry, vtkPolyData* polyData) {
+    if (!polyData)
+        return false;
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CacheMagic, sizeof(header.magic));
+    header.version = CacheVersion;
+
+    QByteArray block;
+    bool hasNormals = false;
+    ProjectFile::appendGeometry(block, polyData, header.pointCount, header.triangleCount, hasNormals);
+    if (hasNormals)
+        header.flags |= CacheHasNormals;
+
+    QSaveFile file(entry);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(block);
+    return file.commit();
+}
+
+/**
+ * @brief Reads and validates a file written by writeEntry().
+ */
+vtkSmartPointer<vtkPolyData> GeometryCache::readEntry(const QString& entry) {
+    QFile file(entry);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(CacheHeader)))
+        return nullptr;
+
+    const uchar* data = file.map(0, file.size());
+    if (!data)
+        return nullptr;
+
+    /* Any other version is not read, the entry is simply made again */
+    CacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const bool hasNormals = header.flags & CacheHasNormals;
+    if (std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0
+        || header.version != CacheVersion
+        || qint64(sizeof(header)) + ProjectFile::geometrySize(header.pointCount, header.triangleCount, hasNormals) > file.size())
+        return nullptr;
+
+    return ProjectFile::readGeometry(data + sizeof(header), header.pointCount, header.triangleCount, hasNormals);
+}
+
+/**
+ * @brief Enables or disables the cache.
+ */
+void GeometryCache::setEnabled(bool enabled) {
+    cacheEnabled = enabled;
+}
+
+/**
+ * @brief Returns whether the cache is enabled.
+ */
+bool GeometryCache::isEnabled() {
+    return cacheEnabled;
+}
+
+/**
+ * @brief Sets the size limit of the cache directory.
+ */
+void GeometryCache::setMaximumSize(qint64 bytes) {
+    cacheMaximumSize = bytes;
+}
+
+/**
+ * @brief Returns the cache directory.
+ */
+QString GeometryCache::directory() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/geometry";
+}
+
+/**
+ * @brief Removes the least recently used entries until the cache fits its size limit.
+ */
+void GeometryCache::prune() {
+    QDir dir(directory());
+    QFileInfoList entries = dir.entryInfoList({ "*.gpg" }, QDir::Files, QDir::Time | QDir::Reversed);
+
+    qint64 total = 0;
+    for (const QFileInfo& info : entries)
+        total += info.size();
+
+    for (const QFileInfo& info : entries) {
+        if (total <= cacheMaximumSize)
+            break;
+        if (QFile::remove(info.absoluteFilePath()))
+            total -= info.size();
+    }
+}
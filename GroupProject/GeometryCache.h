@@ -0,0 +1,98 @@
+/**
+ * @file GeometryCache.h
+ * @brief Declaration of the GeometryCache class, a persistent cache of imported meshes.
+ * @details Every mesh read by MeshImporter is stored on disk in the compact geometry block format
+ *          used by project files, keyed by the source file's path, size and modification time.
+ *          Loading a file a second time then only needs a memory-mapped copy instead of a parse.
+ *          Point normals are stored with the mesh, so they are not computed again either.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_GEOMETRYCACHE_H
+#define VIEWER_GEOMETRYCACHE_H
+
+#include <QString>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @class GeometryCache
+ * @brief Thread-safe on-disk cache of parsed meshes.
+ * @details All functions may be called from worker threads. Entries for a file are invalidated
+ *          automatically when the file's size or time stamp changes.
+ */
+class GeometryCache {
+public:
+    /**
+     * @brief Looks up the cached mesh for a source file.
+     * @param fileName Path of the source file.
+     * @param variant Distinguishes meshes made from the same file with different settings,
+     *        e.g. the feature angle of their normals.
+     * @return the cached mesh, or nullptr if there is no valid entry
+     */
+    static vtkSmartPointer<vtkPolyData> find(const QString& fileName, const QString& variant = QString());
+
+    /**
+     * @brief Stores the mesh read from a source file.
+     * @param fileName Path of the source file.
+     * @param polyData Mesh to store.
+     * @param variant Settings the mesh was made with, as passed to find().
+     */
+    static void insert(const QString& fileName, vtkPolyData* polyData, const QString& variant = QString());
+
+    /**
+     * @brief Enables or disables the cache (enabled by default).
+     * @param enabled True to use the cache.
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Returns whether the cache is in use.
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Sets the largest total size of the cache directory in bytes.
+     * @details Least recently used entries are deleted once the limit is passed.
+     * @param bytes Size limit.
+     */
+    static void setMaximumSize(qint64 bytes);
+
+    /**
+     * @brief Returns the directory the cache files are written to.
+     */
+    static QString directory();
+
+    /**
+     * @brief Deletes cache entries, least recently used first, until the cache fits its size limit.
+     */
+    static void prune();
+
+    /**
+     * @brief Writes a mesh to a file in the cache entry format.
+     * @details Also used for geometry that has no source file, such as parts whose memory is
+     *          released by MemoryBudget.
+     * @param entry Path of the file to write.
+     * @param polyData Mesh to store.
+     * @return true on success
+     */
+    static bool writeEntry(const QString& entry, vtkPolyData* polyData);
+
+    /**
+     * @brief Reads a file written by writeEntry().
+     * @param entry Path of the file.
+     * @return the mesh, or nullptr if the file is missing or invalid
+     */
+    static vtkSmartPointer<vtkPolyData> readEntry(const QString& entry);
+
+private:
+    /**
+     * @brief Returns the cache file used for a source file in its current state.
+     * @return the path, or an empty string if the source file does not exist
+     */
+    static QString entryFileName(const QString& fileName, const QString& variant);
+};
+
+#endif
@@ -0,0 +1,404 @@
+/**
+ * @file InteractionLod.cpp
+ * @brief Implementation of the InteractionLod class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "InteractionLod.h"
+#include "ModelPart.h"
+#include "Trace.h"
+
+#include <QtConcurrent>
+
+#include <vtkCallbackCommand.h>
+#include <vtkCubeSource.h>
+#include <vtkMapper.h>
+#include <vtkNew.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkQuadricClustering.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/** Cells of a box proxy */
+constexpr qint64 BoxCells = 6;
+
+/** Smallest budget, so that a budget cut to nothing can still grow again */
+constexpr double MinBudget = 1000.;
+
+/**
+ * @brief Clusters a mesh down to about a tenth of its cells.
+ * @return the reduced mesh, null if it does not at least halve the cells
+ */
+vtkSmartPointer<vtkPolyData> reduce(vtkPolyData* input) {
+    const qint64 cells = input->GetNumberOfCells();
+
+    /* A closed surface crosses about 3 d^2 cells of a d^3 grid, each leaving two triangles */
+    const int divisions = std::clamp(int(std::sqrt(cells / 60.)), 4, 128);
+    vtkNew<vtkQuadricClustering> clustering;
+    clustering->SetInputData(input);
+    clustering->SetNumberOfDivisions(divisions, divisions, divisions);
+    clustering->AutoAdjustNumberOfDivisionsOn();
+    clustering->Update();
+
+    vtkSmartPointer<vtkPolyData> mesh = clustering->GetOutput();
+    if (mesh->GetNumberOfCells() * 2 > cells)
+        return nullptr;
+    return mesh;
+}
+
+}
+
+/**
+ * @brief Sets up the refinement and wheel timers and the reduction watcher.
+ */
+InteractionLod::InteractionLod(QObject* parent)
+    : QObject(parent), enabled(true), buttonDown(false), interacting(false), totalCells(0),
+      interactiveBudget(-1.), budget(0.), reductionsWanted(false) {
+    refineTimer.setSingleShot(true);
+    refineTimer.setInterval(30);
+    connect(&refineTimer, &QTimer::timeout, this, &InteractionLod::refine);
+
+    wheelTimer.setSingleShot(true);
+    wheelTimer.setInterval(250);
+    connect(&wheelTimer, &QTimer::timeout, this, &InteractionLod::endInteraction);
+
+    connect(&watcher, &QFutureWatcher<void>::finished, this, &InteractionLod::reductionsFinished);
+}
+
+/**
+ * @brief Detaches from the view before it goes away.
+ */
+InteractionLod::~InteractionLod() {
+    for (unsigned long tag : std::as_const(interactorTags))
+        interactor->RemoveObserver(tag);
+    for (unsigned long tag : std::as_const(windowTags))
+        window->RemoveObserver(tag);
+    watcher.waitForFinished();
+}
+
+/**
+ * @brief Observes the mouse ahead of the interactor style, and the start and end of every render.
+ */
+void InteractionLod::setView(vtkRenderWindowInteractor* viewInteractor, vtkRenderer* viewRenderer) {
+    interactor = viewInteractor;
+    window = viewInteractor->GetRenderWindow();
+    renderer = viewRenderer;
+
+    vtkNew<vtkCallbackCommand> callback;
+    callback->SetClientData(this);
+    callback->SetCallback([](vtkObject*, unsigned long event, void* clientData, void*) {
+        static_cast<InteractionLod*>(clientData)->handleEvent(event);
+    });
+
+    /* The style renders on mouse moves, so the levels must change before it sees them */
+    for (unsigned long event : { vtkCommand::LeftButtonPressEvent, vtkCommand::MiddleButtonPressEvent,
+                                 vtkCommand::RightButtonPressEvent, vtkCommand::LeftButtonReleaseEvent,
+                                 vtkCommand::MiddleButtonReleaseEvent, vtkCommand::RightButtonReleaseEvent,
+                                 vtkCommand::MouseMoveEvent, vtkCommand::MouseWheelForwardEvent,
+                                 vtkCommand::MouseWheelBackwardEvent })
+        interactorTags.append(interactor->AddObserver(event, callback, 1.));
+    windowTags.append(window->AddObserver(vtkCommand::StartEvent, callback));
+    windowTags.append(window->AddObserver(vtkCommand::EndEvent, callback));
+}
+
+/**
+ * @brief Stores the flag; turning it off restores full detail.
+ */
+void InteractionLod::setEnabled(bool on) {
+    enabled = on;
+    if (!enabled) {
+        refineTimer.stop();
+        wheelTimer.stop();
+        interacting = false;
+        assign(double(totalCells));
+        emit renderRequested();
+    }
+}
+
+/**
+ * @brief Returns the flag.
+ */
+bool InteractionLod::isEnabled() const {
+    return enabled;
+}
+
+/**
+ * @brief Lists the parts by size and queues the missing reduced meshes.
+ */
+void InteractionLod::setParts(const QList<ModelPart*>& parts) {
+    TRACE_SCOPE("InteractionLod::setParts");
+    reset();
+
+    for (ModelPart* part : parts) {
+        vtkActor* actor = part->getActor();
+        if (!actor || !actor->GetMapper() || !actor->GetMapper()->GetInput())
+            continue;
+        const qint64 cells = actor->GetMapper()->GetInput()->GetNumberOfCells();
+        entries.append({ part, actor, cells, Full, nullptr, Full });
+        totalCells += cells;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.cells > b.cells; });
+    budget = double(totalCells);
+
+    /* Drop the meshes of parts that left the scene */
+    QHash<ModelPart*, Reduction> kept;
+    for (const Entry& entry : std::as_const(entries)) {
+        auto it = reductions.constFind(entry.part);
+        if (it != reductions.constEnd())
+            kept.insert(entry.part, it.value());
+    }
+    reductions = kept;
+    requestReductions();
+}
+
+/**
+ * @brief Swaps the proxies out for the parts' own actors.
+ */
+void InteractionLod::reset() {
+    refineTimer.stop();
+    for (Entry& entry : entries)
+        setLevel(entry, Full);
+    entries.clear();
+    totalCells = 0;
+    budget = 0.;
+}
+
+/**
+ * @brief Follows the mouse buttons and wheel, and times each render.
+ */
+void InteractionLod::handleEvent(unsigned long event) {
+    switch (event) {
+    case vtkCommand::LeftButtonPressEvent:
+    case vtkCommand::MiddleButtonPressEvent:
+    case vtkCommand::RightButtonPressEvent:
+        buttonDown = true;
+        break;
+    case vtkCommand::LeftButtonReleaseEvent:
+    case vtkCommand::MiddleButtonReleaseEvent:
+    case vtkCommand::RightButtonReleaseEvent:
+        buttonDown = false;
+        endInteraction();
+        break;
+    case vtkCommand::MouseMoveEvent:
+        /* A click without a drag, e.g. to pick a part, leaves the detail alone */
+        if (buttonDown && !interacting)
+            beginInteraction();
+        break;
+    case vtkCommand::MouseWheelForwardEvent:
+    case vtkCommand::MouseWheelBackwardEvent:
+        if (!interacting)
+            beginInteraction();
+        if (interacting)
+            wheelTimer.start();
+        break;
+    case vtkCommand::StartEvent:
+        frameClock.start();
+        break;
+    case vtkCommand::EndEvent:
+        if (interacting && frameClock.isValid())
+            frameRendered(frameClock.nsecsElapsed() / 1e9);
+        break;
+    }
+}
+
+/**
+ * @brief Starts from the budget the last interaction ended with, full detail the first time.
+ */
+void InteractionLod::beginInteraction() {
+    if (!enabled || entries.isEmpty())
+        return;
+    refineTimer.stop();
+    interacting = true;
+    if (interactiveBudget < 0.)
+        interactiveBudget = double(totalCells);
+    assign(interactiveBudget);
+}
+
+/**
+ * @brief Schedules the first refinement step if anything is coarsened.
+ */
+void InteractionLod::endInteraction() {
+    if (!interacting)
+        return;
+    interacting = false;
+    wheelTimer.stop();
+    if (budget < double(totalCells))
+        refineTimer.start();
+}
+
+/**
+ * @brief Scales the budget by how far the frame was from the target time.
+ * @details Frames within 25% of the target leave the levels alone, so parts do not flicker
+ *          between them, and the budget changes at most by a factor of two per frame.
+ */
+void InteractionLod::frameRendered(double seconds) {
+    if (seconds <= 0.)
+        return;
+    const double ratio = (1. / TargetFrameRate) / seconds;
+    if (ratio > 0.8 && ratio < 1.25)
+        return;
+    if (ratio >= 1.25 && budget >= double(totalCells))
+        return;
+
+    interactiveBudget = std::clamp(budget * std::clamp(ratio, 0.5, 2.), MinBudget, std::max(MinBudget, double(totalCells)));
+    assign(interactiveBudget);
+}
+
+/**
+ * @brief Brings more parts back to full detail and asks for a render.
+ */
+void InteractionLod::refine() {
+    if (interacting)
+        return;
+    TRACE_SCOPE("InteractionLod::refine");
+
+    assign(std::min(std::max(budget * 2., MinBudget), double(totalCells)));
+    emit renderRequested();
+    if (budget < double(totalCells))
+        refineTimer.start();
+}
+
+/**
+ * @brief Coarsens the largest parts first: to their reduced mesh, or a box if they have none,
+ *        then reduced meshes to boxes if that is still over the budget.
+ */
+void InteractionLod::assign(double newBudget) {
+    budget = newBudget;
+
+    double cost = double(totalCells);
+    QVector<Level> levels(entries.size(), Full);
+    for (int i = 0; i < entries.size() && cost > budget; ++i) {
+        const Reduction* reduced = reduction(entries[i]);
+        if (reduced && reduced->mesh) {
+            cost -= entries[i].cells - reduced->mesh->GetNumberOfCells();
+            levels[i] = Reduced;
+        } else if (entries[i].cells > BoxCells) {
+            cost -= entries[i].cells - BoxCells;
+            levels[i] = Box;
+        }
+    }
+    for (int i = 0; i < entries.size() && cost > budget; ++i) {
+        if (levels[i] == Reduced) {
+            cost -= reduction(entries[i])->mesh->GetNumberOfCells() - BoxCells;
+            levels[i] = Box;
+        }
+    }
+
+    for (int i = 0; i < entries.size(); ++i)
+        setLevel(entries[i], levels[i]);
+}
+
+/**
+ * @brief Builds the proxy's geometry when it changes, copies the part's look and placement onto
+ *        it and swaps the actors in the renderer.
+ */
+void InteractionLod::setLevel(Entry& entry, Level level) {
+    if (level == Full) {
+        if (entry.level != Full) {
+            renderer->RemoveActor(entry.proxy);
+            renderer->AddActor(entry.actor);
+            entry.level = Full;
+        }
+        return;
+    }
+
+    if (!entry.proxy) {
+        entry.proxy = vtkSmartPointer<vtkActor>::New();
+        entry.proxy->SetMapper(vtkSmartPointer<vtkPolyDataMapper>::New());
+        entry.proxy->PickableOff();
+    }
+    auto mapper = vtkPolyDataMapper::SafeDownCast(entry.proxy->GetMapper());
+    if (level == Reduced) {
+        vtkPolyData* mesh = reduction(entry)->mesh;
+        if (mapper->GetInput() != mesh)
+            mapper->SetInputData(mesh);
+    } else if (entry.proxyLevel != Box) {
+        vtkNew<vtkCubeSource> cube;
+        cube->SetBounds(entry.actor->GetMapper()->GetBounds());
+        cube->Update();
+        mapper->SetInputData(cube->GetOutput());
+    }
+    entry.proxyLevel = level;
+
+    /* The proxy draws in the actor's own coordinates, so it takes over its whole placement */
+    entry.proxy->SetProperty(entry.actor->GetProperty());
+    entry.proxy->SetUserMatrix(entry.actor->GetUserMatrix());
+    entry.proxy->SetPosition(entry.actor->GetPosition());
+    entry.proxy->SetOrientation(entry.actor->GetOrientation());
+    entry.proxy->SetScale(entry.actor->GetScale());
+    mapper->SetClippingPlanes(entry.actor->GetMapper()->GetClippingPlanes());
+
+    if (entry.level == Full) {
+        renderer->RemoveActor(entry.actor);
+        renderer->AddActor(entry.proxy);
+    }
+    entry.level = level;
+}
+
+/**
+ * @brief Finds the part's reduction and checks it was made from the geometry the actor draws now.
+ */
+const InteractionLod::Reduction* InteractionLod::reduction(const Entry& entry) const {
+    auto it = reductions.constFind(entry.part);
+    if (it == reductions.constEnd())
+        return nullptr;
+    vtkDataSet* input = entry.actor->GetMapper()->GetInput();
+    if (it->source != input || it->time != input->GetMTime())
+        return nullptr;
+    return &it.value();
+}
+
+/**
+ * @brief Copies the geometry of every large polygonal part without a current reduction and
+ *        clusters the copies on the thread pool.
+ */
+void InteractionLod::requestReductions() {
+    if (watcher.isRunning()) {
+        reductionsWanted = true;
+        return;
+    }
+    reductionsWanted = false;
+
+    QVector<Reduction> jobs;
+    for (const Entry& entry : std::as_const(entries)) {
+        if (entry.cells < MinReducedTriangles || reduction(entry))
+            continue;
+        /* Filtered parts draw unstructured grids, they only get boxes */
+        vtkPolyData* input = vtkPolyData::SafeDownCast(entry.actor->GetMapper()->GetInput());
+        if (!input)
+            continue;
+
+        Reduction job;
+        job.part = entry.part;
+        job.source = input;
+        job.time = input->GetMTime();
+        job.input = vtkSmartPointer<vtkPolyData>::New();
+        job.input->ShallowCopy(input);
+        jobs.append(job);
+    }
+    if (jobs.isEmpty())
+        return;
+
+    running = jobs;
+    watcher.setFuture(QtConcurrent::map(running, [](Reduction& job) {
+        job.mesh = reduce(job.input);
+        job.input = nullptr;
+    }));
+}
+
+/**
+ * @brief Keeps the new meshes; the next level change picks them up.
+ */
+void InteractionLod::reductionsFinished() {
+    for (const Reduction& job : std::as_const(running))
+        reductions.insert(job.part, job);
+    running.clear();
+
+    if (reductionsWanted)
+        requestReductions();
+}
@@ -0,0 +1,197 @@
+/**
+ * @file InteractionLod.h
+ * @brief Declaration of the InteractionLod class, which lowers part detail while the camera moves.
+ * @details While the user drags or zooms the desktop view, the largest parts are swapped for
+ *          proxies: a clustered mesh with a fraction of the triangles, or a box the size of the
+ *          part. How many triangles may be drawn at full detail is adjusted from the measured
+ *          time of each frame towards a target frame rate, and remembered for the next time the
+ *          camera moves. Once it stops, the budget doubles every step until every part is back to
+ *          full detail. The reduced meshes are built on the thread pool when the scene changes;
+ *          until a part's mesh is ready it falls back to its box.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_INTERACTIONLOD_H
+#define VIEWER_INTERACTIONLOD_H
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+
+class ModelPart;
+
+/**
+ * @class InteractionLod
+ * @brief Frame time driven level of detail for the parts' actors in one renderer.
+ * @details Must be used on the GUI thread. Only swaps actors in the renderer; the parts, their
+ *          actors and the tree are left alone.
+ */
+class InteractionLod : public QObject {
+    Q_OBJECT
+
+public:
+    /** Frame rate aimed for while the camera moves */
+    static constexpr double TargetFrameRate = 30.;
+
+    /** Parts with fewer triangles are never given a reduced mesh, only a box */
+    static constexpr qint64 MinReducedTriangles = 5000;
+
+    /**
+     * @brief Constructs an enabled controller without a view.
+     * @param parent Optional QObject parent.
+     */
+    InteractionLod(QObject* parent = nullptr);
+
+    /**
+     * @brief Removes the observers and waits for the reduced meshes being built.
+     */
+    ~InteractionLod();
+
+    /**
+     * @brief Watches a view's mouse and render events.
+     * @param interactor Interactor of the render window.
+     * @param renderer Renderer holding the parts' actors.
+     */
+    void setView(vtkRenderWindowInteractor* interactor, vtkRenderer* renderer);
+
+    /**
+     * @brief Turns the interactive mode on or off; off puts every part back at once.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Returns whether the interactive mode is on.
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Takes the parts whose actors are in the renderer, all at full detail.
+     * @details Call after the renderer's actors have been rebuilt. Starts building reduced meshes
+     *          for the large parts that lack an up to date one.
+     * @param parts Parts whose own actor is in the renderer.
+     */
+    void setParts(const QList<ModelPart*>& parts);
+
+    /**
+     * @brief Puts every part's own actor back and forgets the parts.
+     * @details Call before the renderer's actors are rebuilt.
+     */
+    void reset();
+
+signals:
+    /**
+     * @brief Emitted when a refinement step needs a render.
+     */
+    void renderRequested();
+
+private:
+    /** Detail a part is drawn with */
+    enum Level {
+        Full,       /**< The part's own actor */
+        Reduced,    /**< Clustered mesh */
+        Box         /**< Box around the part */
+    };
+
+    /** A part in the renderer */
+    struct Entry {
+        ModelPart*                  part;       /**< Part, for looking up its reduced mesh */
+        vtkSmartPointer<vtkActor>   actor;      /**< The part's own actor */
+        qint64                      cells;      /**< Cells the actor draws */
+        Level                       level;      /**< Detail it is drawn with now */
+        vtkSmartPointer<vtkActor>   proxy;      /**< Actor drawing the reduced mesh or box, made when first needed */
+        Level                       proxyLevel; /**< Geometry the proxy holds, Full if none yet */
+    };
+
+    /** A reduced mesh, or a request for one */
+    struct Reduction {
+        ModelPart*                      part;       /**< Part, only compared, never dereferenced by workers */
+        vtkPolyData*                    source;     /**< Geometry it was made from, only compared */
+        vtkMTimeType                    time;       /**< Modification time of that geometry */
+        vtkSmartPointer<vtkPolyData>    input;      /**< Shallow copy of the geometry, while being built */
+        vtkSmartPointer<vtkPolyData>    mesh;       /**< Reduced mesh, null if reducing did not pay */
+    };
+
+    /**
+     * @brief Dispatches the observed VTK events.
+     */
+    void handleEvent(unsigned long event);
+
+    /**
+     * @brief Switches to the remembered interactive budget.
+     */
+    void beginInteraction();
+
+    /**
+     * @brief Starts refining towards full detail.
+     */
+    void endInteraction();
+
+    /**
+     * @brief Adjusts the budget from the time the last frame took.
+     */
+    void frameRendered(double seconds);
+
+    /**
+     * @brief Doubles the budget, or ends the refinement once everything is at full detail.
+     */
+    void refine();
+
+    /**
+     * @brief Chooses every part's level for a triangle budget, largest parts coarsened first.
+     */
+    void assign(double budget);
+
+    /**
+     * @brief Shows a part at a level, swapping its actors in the renderer.
+     */
+    void setLevel(Entry& entry, Level level);
+
+    /**
+     * @brief Returns the reduction made from a part's current geometry, null if there is none.
+     */
+    const Reduction* reduction(const Entry& entry) const;
+
+    /**
+     * @brief Starts building reduced meshes for the large parts without a current one.
+     */
+    void requestReductions();
+
+    /**
+     * @brief Stores the finished reduced meshes.
+     */
+    void reductionsFinished();
+
+    vtkSmartPointer<vtkRenderWindowInteractor>  interactor;         /**< Observed interactor */
+    vtkSmartPointer<vtkRenderWindow>            window;             /**< Observed render window */
+    vtkSmartPointer<vtkRenderer>                renderer;           /**< Renderer holding the actors */
+    QList<unsigned long>                        interactorTags;     /**< Observers on the interactor */
+    QList<unsigned long>                        windowTags;         /**< Observers on the window */
+    bool                                        enabled;            /**< Interactive mode on */
+    bool                                        buttonDown;         /**< A mouse button is held in the view */
+    bool                                        interacting;        /**< The camera is being moved */
+    QVector<Entry>                              entries;            /**< Parts in the renderer, most cells first */
+    qint64                                      totalCells;         /**< Cells of all parts at full detail */
+    double                                      interactiveBudget;  /**< Cells drawn in full while moving, learned from frame times */
+    double                                      budget;             /**< Budget the levels were last assigned for */
+    QElapsedTimer                               frameClock;         /**< Times the frame being rendered */
+    QTimer                                      refineTimer;        /**< Steps the refinement after the camera stops */
+    QTimer                                      wheelTimer;         /**< Ends a zoom by the mouse wheel once it is quiet */
+    QHash<ModelPart*, Reduction>                reductions;         /**< Reduced meshes by part */
+    QFutureWatcher<void>                        watcher;            /**< Watches the meshes being built */
+    QVector<Reduction>                          running;            /**< Meshes being built */
+    bool                                        reductionsWanted;   /**< Parts changed while meshes were being built */
+};
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file MemoryBudget.cpp
+ * @brief Implementation of the MemoryBudget class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "MemoryBudget.h"
+#include "ModelPart.h"
+#include "ModelPartList.h"
+#include "MeshUtils.h"
+#include "Trace.h"
+
+#include <QVector>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+/** Budget used until setBudget() is called */
+const qint64 DefaultBudget = qint64(4) << 30;
+
+}
+
+/**
+ * @brief Constructs the manager with the default budget.
+ * @param partList Model holding the tree.
+ * @param parent Optional QObject parent.
+ */
+MemoryBudget::MemoryBudget(ModelPartList* partList, QObject* parent)
+    : QObject(parent), partList(partList), limit(DefaultBudget) {
+}
+
+/**
+ * @brief Sets the budget and applies it.
+ */
+void MemoryBudget::setBudget(qint64 bytes) {
+    limit = bytes;
+    update();
+}
+
+/**
+ * @brief Returns the budget.
+ */
+qint64 MemoryBudget::budget() const {
+    return limit;
+}
+
+/**
+ * @brief Returns the usage after the last update.
+ */
+qint64 MemoryBudget::usage() const {
+    return used;
+}
+
+/**
+ * @brief Restores visible parts, then releases least recently viewed hidden parts until under budget.
+ */
+void MemoryBudget::update() {
+    TRACE_SCOPE("MemoryBudget::update");
+    ++tick;
+
+    /* Every part that has geometry, resident or released */
+    QVector<ModelPart*> parts;
+    QList<ModelPart*> stack = { partList->getRootItem() };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        if (part->getActor())
+            parts.append(part);
+        for (int i = 0; i < part->childCount(); ++i)
+            stack.append(part->child(i));
+    }
+
+    /* Visible parts count as viewed now, released ones are read back in parallel */
+    QVector<ModelPart*> restore;
+    for (ModelPart* part : std::as_const(parts)) {
+        if (!part->visible())
+            continue;
+        part->markViewed(tick);
+        if (part->isReleased())
+            restore.append(part);
+    }
+
+    std::vector<vtkSmartPointer<vtkPolyData>> meshes(static_cast<size_t>(restore.size()));
+    ModelPart* const* restoreData = restore.constData();
+    MeshUtils::parallelFor(restore.size(), [&](qint64 begin, qint64 end) {
+        for (qint64 i = begin; i < end; ++i)
+            meshes[i] = restoreData[i]->getPolyData();
+    }, 1);
+    for (int i = 0; i < restore.size(); ++i)
+        if (meshes[i])
+            restore[i]->setPolyData(meshes[i]);
+    meshes.clear();
+
+    /* Release hidden parts, least recently viewed first */
+    used = 0;
+    QVector<ModelPart*> candidates;
+    for (ModelPart* part : std::as_const(parts)) {
+        used += part->memorySize();
+        if (!part->visible() && !part->isReleased())
+            candidates.append(part);
+    }
+
+    if (used > limit) {
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const ModelPart* a, const ModelPart* b) { return a->lastViewed() < b->lastViewed(); });
+
+        for (ModelPart* part : std::as_const(candidates)) {
+            if (used <= limit)
+                break;
+            qint64 size = part->memorySize();
+            QString spill = spillDir.filePath(QString("part%1.gpg").arg(++spillCount));
+            if (part->releaseGeometry(spill))
+                used -= size;
+        }
+    }
+
+    int released = 0;
+    for (ModelPart* part : std::as_const(parts))
+        if (part->isReleased())
+            ++released;
+
+    emit usageChanged(used, limit, released);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file MemoryBudget.h
+ * @brief Declaration of the MemoryBudget class, which caps the memory used by part geometry.
+ * @details Once the geometry of all parts exceeds the budget, hidden parts are released in least
+ *          recently viewed order until the total fits again. Released parts are re-read from their
+ *          source file (usually a hit in the GeometryCache) or from a spill file as soon as they
+ *          are made visible again.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_MEMORYBUDGET_H
+#define VIEWER_MEMORYBUDGET_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class ModelPartList;
+
+/**
+ * @class MemoryBudget
+ * @brief Least recently used eviction of hidden parts' geometry.
+ * @details Visible parts are never released, so usage can stay above the budget if everything
+ *          on screen needs more memory than allowed.
+ */
+class MemoryBudget : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a budget manager for the parts in a model.
+     * @param partList Model holding the tree.
+     * @param parent Optional QObject parent.
+     */
+    MemoryBudget(ModelPartList* partList, QObject* parent = nullptr);
+
+    /**
+     * @brief Sets the budget and applies it straight away.
+     * @param bytes Largest amount of geometry memory to keep, in bytes.
+     */
+    void setBudget(qint64 bytes);
+
+    /**
+     * @brief Returns the budget in bytes.
+     */
+    qint64 budget() const;
+
+    /**
+     * @brief Returns the geometry memory in use after the last update(), in bytes.
+     */
+    qint64 usage() const;
+
+public slots:
+    /**
+     * @brief Reloads visible parts that were released and releases hidden ones over the budget.
+     * @details Call after anything that loads geometry or changes visibility. Reloads run in
+     *          parallel on the thread pool.
+     */
+    void update();
+
+signals:
+    /**
+     * @brief Emitted at the end of every update().
+     * @param usage Geometry memory in use, in bytes.
+     * @param budget Current budget, in bytes.
+     * @param released Number of parts whose geometry is currently released.
+     */
+    void usageChanged(qint64 usage, qint64 budget, int released);
+
+private:
+    ModelPartList*  partList;           /**< Model holding the tree */
+    QTemporaryDir   spillDir;           /**< Holds released geometry that has no source file */
+    qint64          limit;              /**< Budget in bytes */
+    qint64          used = 0;           /**< Usage after the last update */
+    quint64         tick = 0;           /**< Incremented on every update, stamps visible parts */
+    quint64         spillCount = 0;     /**< Used to name spill files */
+};
+
+#endif
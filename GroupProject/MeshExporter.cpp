@@ -0,0 +1,398 @@
+/**
+ * @file MeshExporter.cpp
+ * @brief Implementation of the MeshExporter class.
+ * @details Both formats start from the same flat buffers: float points already placed in the
+ *          scene and uint32 triangle indices, gathered straight from the offsets and connectivity
+ *          of the cell array. STL facets are then filled in parallel into one buffer and written
+ *          with a single call; cache files go through GeometryCache::writeEntry().
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "MeshExporter.h"
+#include "GeometryCache.h"
+#include "MeshImporter.h"
+#include "MeshUtils.h"
+#include "ModelPart.h"
+#include "Trace.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QVector>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkCellType.h>
+#include <vtkFloatArray.h>
+#include <vtkMapper.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+/** Binary STL: an 80 byte header and a facet count, then 50 bytes per facet */
+const qint64 StlHeaderSize = 84;
+const qint64 StlFacetSize  = 50;
+
+/** A mesh's triangles with its points placed in the scene */
+struct Mesh {
+    std::vector<float>      points;     /**< xyz per point */
+    std::vector<quint32>    indices;    /**< Three point ids per triangle */
+};
+
+/**
+ * @brief Stores a message and returns false.
+ */
+bool fail(QString* errorString, const QString& message) {
+    if (errorString)
+        *errorString = message;
+    return false;
+}
+
+/**
+ * @brief Returns the matrix, or nullptr if it is missing or the identity.
+ */
+const double* placement(const double matrix[16]) {
+    if (!matrix)
+        return nullptr;
+    for (int i = 0; i < 16; ++i) {
+        if (matrix[i] != (i % 5 == 0 ? 1. : 0.))
+            return matrix;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Checks whether a cell of an unstructured grid is a polygon with its corners in order.
+ */
+bool isPolygon(unsigned char type) {
+    return type == VTK_TRIANGLE || type == VTK_QUAD || type == VTK_POLYGON;
+}
+
+/**
+ * @brief Fan triangulates the polygons of a cell array.
+ * @param offsetsArray Offsets of the cells, one more than there are cells.
+ * @param connectivityArray Point ids of the cells.
+ * @param types Cell types of an unstructured grid, nullptr if every cell is a polygon.
+ * @param indices Receives three point ids per triangle.
+ */
+template <typename IdArray>
+void fanTriangulate(IdArray* offsetsArray, IdArray* connectivityArray, const unsigned char* types,
+                    std::vector<quint32>& indices) {
+    const auto* offsets = offsetsArray->GetPointer(0);
+    const auto* connectivity = connectivityArray->GetPointer(0);
+    const qint64 cellCount = std::max<qint64>(offsetsArray->GetNumberOfValues() - 1, 0);
+
+    /* Where each cell's triangles start, so the cells can be split freely between tasks */
+    std::vector<qint64> first(static_cast<size_t>(cellCount) + 1);
+    first[0] = 0;
+    for (qint64 c = 0; c < cellCount; ++c) {
+        const qint64 size = qint64(offsets[c + 1] - offsets[c]);
+        const bool polygon = size >= 3 && (!types || isPolygon(types[c]));
+        first[c + 1] = first[c] + (polygon ? size - 2 : 0);
+    }
+
+    indices.resize(static_cast<size_t>(3 * first[cellCount]));
+    MeshUtils::parallelFor(cellCount, [&](qint64 begin, qint64 end) {
+        for (qint64 c = begin; c < end; ++c) {
+            quint32* out = indices.data() + 3 * first[c];
+            const auto* pts = connectivity + offsets[c];
+            for (qint64 k = 1; k < first[c + 1] - first[c] + 1; ++k) {
+                *out++ = static_cast<quint32>(pts[0]);
+                *out++ = static_cast<quint32>(pts[k]);
+                *out++ = static_cast<quint32>(pts[k + 1]);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Collects the triangles of a polydata or unstructured grid and places its points.
+ * @param geometry Mesh to read.
+ * @param matrix Row-major matrix applied to the points, nullptr for none.
+ * @param mesh Receives the points and triangles.
+ * @return false if the geometry is of another type or too large for 32 bit ids
+ */
+bool gather(vtkDataSet* geometry, const double* matrix, Mesh& mesh) {
+    vtkCellArray* cells = nullptr;
+    const unsigned char* types = nullptr;
+    vtkDataArray* sourcePoints = nullptr;
+    if (vtkPolyData* polyData = vtkPolyData::SafeDownCast(geometry)) {
+        cells = polyData->GetPolys();
+        sourcePoints = polyData->GetPoints() ? polyData->GetPoints()->GetData() : nullptr;
+    } else if (vtkUnstructuredGrid* grid = vtkUnstructuredGrid::SafeDownCast(geometry)) {
+        cells = grid->GetCells();
+        types = grid->GetCellTypesArray() ? grid->GetCellTypesArray()->GetPointer(0) : nullptr;
+        sourcePoints = grid->GetPoints() ? grid->GetPoints()->GetData() : nullptr;
+    }
+    if (!cells || !sourcePoints || sourcePoints->GetNumberOfTuples() > std::numeric_limits<quint32>::max())
+        return false;
+
+    if (cells->IsStorage64Bit())
+        fanTriangulate(cells->GetOffsetsArray64(), cells->GetConnectivityArray64(), types, mesh.indices);
+    else
+        fanTriangulate(cells->GetOffsetsArray32(), cells->GetConnectivityArray32(), types, mesh.indices);
+
+    const qint64 pointCount = sourcePoints->GetNumberOfTuples();
+    mesh.points.resize(static_cast<size_t>(3 * pointCount));
+    MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+        double p[3];
+        for (qint64 i = begin; i < end; ++i) {
+            sourcePoints->GetTuple(i, p);
+            float* out = mesh.points.data() + 3 * i;
+            for (int row = 0; row < 3; ++row) {
+                if (matrix) {
+                    const double* m = matrix + 4 * row;
+                    out[row] = static_cast<float>(m[0] * p[0] + m[1] * p[1] + m[2] * p[2] + m[3]);
+                } else {
+                    out[row] = static_cast<float>(p[row]);
+                }
+            }
+        }
+    });
+    return true;
+}
+
+/**
+ * @brief Turns point normals by a matrix and renormalises them.
+ * @param normals Three component normals.
+ * @param matrix Row-major matrix the points were placed with, nullptr for none.
+ * @return float normals named "Normals"
+ */
+vtkSmartPointer<vtkFloatArray> placeNormals(vtkDataArray* normals, const double* matrix) {
+    /* Normals follow the inverse transpose, so they stay square to scaled faces */
+    double inverse[16];
+    if (matrix)
+        vtkMatrix4x4::Invert(matrix, inverse);
+
+    const qint64 count = normals->GetNumberOfTuples();
+    auto result = vtkSmartPointer<vtkFloatArray>::New();
+    result->SetName("Normals");
+    result->SetNumberOfComponents(3);
+    result->SetNumberOfTuples(count);
+    float* out = result->GetPointer(0);
+    MeshUtils::parallelFor(count, [&](qint64 begin, qint64 end) {
+        double n[3], turned[3];
+        for (qint64 i = begin; i < end; ++i) {
+            normals->GetTuple(i, n);
+            for (int row = 0; row < 3; ++row)
+                turned[row] = matrix ? inverse[row] * n[0] + inverse[4 + row] * n[1] + inverse[8 + row] * n[2] : n[row];
+            const double length = std::sqrt(turned[0] * turned[0] + turned[1] * turned[1] + turned[2] * turned[2]);
+            for (int row = 0; row < 3; ++row)
+                out[3 * i + row] = static_cast<float>(length > 0. ? turned[row] / length : 0.);
+        }
+    });
+    return result;
+}
+
+/**
+ * @brief Turns a part name into a file name without a suffix, replacing characters that are not
+ *        allowed in file names.
+ */
+QString fileBaseName(const QString& partName) {
+    QString name = MeshImporter::canRead(partName) ? QFileInfo(partName).completeBaseName() : partName;
+    for (QChar& c : name) {
+        if (c < QChar(' ') || QStringLiteral("\\/:*?\"<>|").contains(c))
+            c = '_';
+    }
+    name = name.trimmed();
+    return name.isEmpty() ? QStringLiteral("part") : name;
+}
+
+}
+
+/**
+ * @brief Walks the subtrees and snapshots the drawn geometry and actor matrix of each part.
+ */
+QList<MeshExporter::Input> MeshExporter::collect(const QList<ModelPart*>& roots) {
+    TRACE_SCOPE("MeshExporter::collect");
+
+    /* Subtrees inside another selected subtree would be exported twice */
+    const QSet<ModelPart*> selected(roots.cbegin(), roots.cend());
+    QList<ModelPart*> stack;
+    for (ModelPart* root : roots) {
+        bool inside = false;
+        for (ModelPart* part = root->parentItem(); part && !inside; part = part->parentItem())
+            inside = selected.contains(part);
+        if (!inside && !stack.contains(root))
+            stack.prepend(root);
+    }
+
+    QList<Input> inputs;
+    QSet<QString> usedNames;
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        for (int i = part->childCount() - 1; i >= 0; --i)
+            stack.append(part->child(i));
+
+        vtkActor* actor = part->getActor();
+        if (!actor)
+            continue;
+        vtkSmartPointer<vtkDataSet> geometry;
+        if (part->isReleased()) {
+            geometry = part->getPolyData();
+        } else if (vtkDataSet* output = actor->GetMapper() ? actor->GetMapper()->GetInput() : nullptr) {
+            geometry = vtkSmartPointer<vtkDataSet>::Take(output->NewInstance());
+            geometry->ShallowCopy(output);
+        }
+        if (!geometry || geometry->GetNumberOfCells() == 0)
+            continue;
+
+        const QString base = fileBaseName(part->data(0).toString());
+        QString name = base;
+        for (int n = 2; usedNames.contains(name.toLower()); ++n)
+            name = QString("%1_%2").arg(base).arg(n);
+        usedNames.insert(name.toLower());
+
+        Input input;
+        input.name = name;
+        input.geometry = geometry;
+        vtkMatrix4x4::DeepCopy(input.matrix, actor->GetMatrix());
+        inputs.append(input);
+    }
+    return inputs;
+}
+
+/**
+ * @brief Writes the files concurrently, each on one task of the thread pool.
+ */
+MeshExporter::Result MeshExporter::exportParts(const QList<Input>& inputs, const QString& directory, Format format) {
+    TRACE_SCOPE("MeshExporter::exportParts");
+
+    struct Outcome {
+        bool    ok = false;
+        qint64  bytes = 0;
+        QString error;
+    };
+    QVector<Outcome> outcomes(inputs.size());
+    const Outcome* first = outcomes.constData();
+    const QDir dir(directory);
+    QtConcurrent::blockingMap(outcomes, [&](Outcome& outcome) {
+        const Input& input = inputs[&outcome - first];
+        const QString fileName = dir.filePath(input.name + '.' + suffix(format));
+        outcome.ok = format == BinarySTL ? writeSTL(fileName, input.geometry, input.matrix, &outcome.error)
+                                         : writeGeometry(fileName, input.geometry, input.matrix, &outcome.error);
+        if (outcome.ok)
+            outcome.bytes = QFileInfo(fileName).size();
+    });
+
+    Result result;
+    for (int i = 0; i < outcomes.size(); ++i) {
+        if (outcomes[i].ok) {
+            ++result.written;
+            result.bytes += outcomes[i].bytes;
+        } else {
+            result.errors.append(QString("%1: %2").arg(inputs[i].name, outcomes[i].error));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Fills the facets in parallel, then writes the whole file at once.
+ */
+bool MeshExporter::writeSTL(const QString& fileName, vtkDataSet* geometry, const double matrix[16],
+                            QString* errorString) {
+    TRACE_SCOPE("MeshExporter::writeSTL");
+
+    Mesh mesh;
+    if (!geometry || !gather(geometry, placement(matrix), mesh))
+        return fail(errorString, QObject::tr("geometry of this kind cannot be exported"));
+    const qint64 triangleCount = qint64(mesh.indices.size() / 3);
+    if (triangleCount == 0)
+        return fail(errorString, QObject::tr("no triangles to export"));
+    if (triangleCount > std::numeric_limits<quint32>::max())
+        return fail(errorString, QObject::tr("too many triangles for an STL file"));
+
+    /* The header must not start with "solid", or readers take the file for ASCII */
+    QByteArray data(StlHeaderSize + StlFacetSize * triangleCount, Qt::Uninitialized);
+    char* header = data.data();
+    std::memset(header, 0, StlHeaderSize);
+    const char title[] = "Binary STL exported by GroupProject";
+    std::memcpy(header, title, sizeof(title) - 1);
+    qToLittleEndian(static_cast<quint32>(triangleCount), header + 80);
+
+    const float* points = mesh.points.data();
+    const quint32* indices = mesh.indices.data();
+    MeshUtils::parallelFor(triangleCount, [&](qint64 begin, qint64 end) {
+        float facet[12];
+        for (qint64 t = begin; t < end; ++t) {
+            const float* a = points + 3 * indices[3 * t];
+            const float* b = points + 3 * indices[3 * t + 1];
+            const float* c = points + 3 * indices[3 * t + 2];
+            const double u[3] = { double(b[0]) - a[0], double(b[1]) - a[1], double(b[2]) - a[2] };
+            const double v[3] = { double(c[0]) - a[0], double(c[1]) - a[1], double(c[2]) - a[2] };
+            double n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+            const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int k = 0; k < 3; ++k) {
+                facet[k] = static_cast<float>(length > 0. ? n[k] / length : 0.);
+                facet[3 + k] = a[k];
+                facet[6 + k] = b[k];
+                facet[9 + k] = c[k];
+            }
+
+            char* out = header + StlHeaderSize + StlFacetSize * t;
+            qToLittleEndian<float>(facet, 12, out);
+            out[48] = 0;
+            out[49] = 0;
+        }
+    });
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+        return fail(errorString, file.errorString());
+    return true;
+}
+
+/**
+ * @brief Writes triangle polydata as it is, and rebuilds anything else as a placed triangle mesh.
+ */
+bool MeshExporter::writeGeometry(const QString& fileName, vtkDataSet* geometry, const double matrix[16],
+                                 QString* errorString) {
+    TRACE_SCOPE("MeshExporter::writeGeometry");
+
+    matrix = placement(matrix);
+    vtkSmartPointer<vtkPolyData> polyData = vtkPolyData::SafeDownCast(geometry);
+    if (!polyData || matrix) {
+        Mesh mesh;
+        if (!geometry || !gather(geometry, matrix, mesh))
+            return fail(errorString, QObject::tr("geometry of this kind cannot be exported"));
+        if (mesh.indices.empty())
+            return fail(errorString, QObject::tr("no triangles to export"));
+        polyData = MeshUtils::makePolyData(mesh.points.data(), qint64(mesh.points.size() / 3),
+                                           mesh.indices.data(), qint64(mesh.indices.size() / 3));
+
+        /* Normals of compact parts are in the quantised frame, the inverse transpose restores them */
+        vtkDataArray* normals = geometry->GetPointData()->GetNormals();
+        if (normals && normals->GetNumberOfComponents() == 3
+            && normals->GetNumberOfTuples() == polyData->GetNumberOfPoints())
+            polyData->GetPointData()->SetNormals(placeNormals(normals, matrix));
+    } else if (polyData->GetNumberOfPolys() == 0) {
+        return fail(errorString, QObject::tr("no triangles to export"));
+    }
+
+    if (!GeometryCache::writeEntry(fileName, polyData))
+        return fail(errorString, QObject::tr("could not write \"%1\"").arg(QDir::toNativeSeparators(fileName)));
+    return true;
+}
+
+/**
+ * @brief Returns "stl" or "gpg".
+ */
+QString MeshExporter::suffix(Format format) {
+    return format == BinarySTL ? QStringLiteral("stl") : QStringLiteral("gpg");
+}
@@ -0,0 +1,104 @@
+/**
+ * @file MeshExporter.h
+ * @brief Declaration of the MeshExporter class, which writes parts out as binary STL or cache files.
+ * @details Parts are exported as they are drawn: the output of their clip and shrink filters is
+ *          taken from the pipeline as it stands, so nothing is filtered again, and it is placed in
+ *          the scene with the actor's matrix. Every part goes to its own file. Parts are written
+ *          concurrently on the thread pool, and the triangles of each part are gathered and
+ *          converted in parallel, so exporting many parts is bound by the disk. The cache format
+ *          is the geometry block of GeometryCache, which MeshImporter reads back as *.gpg files.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_MESHEXPORTER_H
+#define VIEWER_MESHEXPORTER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <vtkSmartPointer.h>
+#include <vtkDataSet.h>
+
+class ModelPart;
+
+/**
+ * @class MeshExporter
+ * @brief Static helpers that write part geometry to mesh files.
+ * @details Polygons are fan triangulated; vertices, lines and 3D cells are left out. Apart from
+ *          collect(), every function may be called from worker threads.
+ */
+class MeshExporter {
+public:
+    /** File format to write */
+    enum Format {
+        BinarySTL,      /**< Binary STL, one facet per triangle */
+        CacheFormat     /**< Indexed geometry block with point normals, see GeometryCache */
+    };
+
+    /** A part to export, a snapshot taken on the GUI thread */
+    struct Input {
+        QString                     name;           /**< File name without the suffix, unique within the export */
+        vtkSmartPointer<vtkDataSet> geometry;       /**< Shallow copy of the geometry the actor draws */
+        double                      matrix[16];     /**< Actor matrix placing the geometry in the scene */
+    };
+
+    /** Outcome of an export */
+    struct Result {
+        int             written = 0;    /**< Files written */
+        qint64          triangles = 0;  /**< Triangles in the files written */
+        qint64          bytes = 0;      /**< Size of the files written */
+        QStringList     errors;         /**< One message per part that failed */
+    };
+
+    /**
+     * @brief Takes a snapshot of the parts with geometry in some subtrees.
+     * @details Call on the GUI thread. A subtree inside another one is only taken once. A part
+     *          whose geometry has been released has no filter output; it is read again and
+     *          exported unfiltered.
+     * @param roots Parts to start from, each exported with everything below it.
+     * @return one input per part, named after the part
+     */
+    static QList<Input> collect(const QList<ModelPart*>& roots);
+
+    /**
+     * @brief Writes every input to its own file in a folder, in parallel.
+     * @param inputs Parts from collect().
+     * @param directory Existing folder to write to; files of the same name are replaced.
+     * @param format Format of the files.
+     * @return what was written and what failed
+     */
+    static Result exportParts(const QList<Input>& inputs, const QString& directory, Format format);
+
+    /**
+     * @brief Writes a mesh to a binary STL file.
+     * @param fileName File to write.
+     * @param geometry Polydata or unstructured grid.
+     * @param matrix Row-major matrix applied to the points, nullptr for none.
+     * @param errorString If given, receives a description of the failure.
+     * @return true if the file was written
+     */
+    static bool writeSTL(const QString& fileName, vtkDataSet* geometry, const double matrix[16],
+                         QString* errorString = nullptr);
+
+    /**
+     * @brief Writes a mesh to a file in the geometry cache format.
+     * @details Point normals are kept, turned by the matrix. A triangle polydata without a
+     *          matrix is written as it is.
+     * @param fileName File to write.
+     * @param geometry Polydata or unstructured grid.
+     * @param matrix Row-major matrix applied to the points, nullptr for none.
+     * @param errorString If given, receives a description of the failure.
+     * @return true if the file was written
+     */
+    static bool writeGeometry(const QString& fileName, vtkDataSet* geometry, const double matrix[16],
+                              QString* errorString = nullptr);
+
+    /**
+     * @brief Returns the file suffix of a format without the dot, e.g. "stl".
+     */
+    static QString suffix(Format format);
+};
+
+#endif
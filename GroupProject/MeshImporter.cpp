@@ -0,0 +1,698 @@
+/**
+ * @file MeshImporter.cpp
+ * @brief Implementation of the MeshImporter registry and the built-in STL, OBJ and PLY readers.
+ * @details The OBJ and PLY readers memory-map the file. OBJ text is split into chunks at line
+ *          boundaries and parsed in parallel; binary PLY vertex data has a fixed stride and is
+ *          decoded in parallel, the variable length face lists are decoded in one pass.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "MeshImporter.h"
+#include "AsciiSTLParser.h"
+#include "GeometryCache.h"
+#include "MeshUtils.h"
+#include "Trace.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QReadWriteLock>
+#include <QSysInfo>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <vtkNew.h>
+#include <vtkSTLReader.h>
+#include <vtkPLYReader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+/** A registered file format */
+struct Format {
+    QString                     description;
+    MeshImporter::ReadFunction  read;
+};
+
+/** The registry, built-in formats are added on first use */
+struct Registry {
+    QReadWriteLock          lock;
+    QMap<QString, Format>   formats;
+
+    Registry() {
+        formats.insert("stl", { QObject::tr("STL Files"), &MeshImporter::readSTL });
+        formats.insert("obj", { QObject::tr("OBJ Files"), &MeshImporter::readOBJ });
+        formats.insert("ply", { QObject::tr("PLY Files"), &MeshImporter::readPLY });
+        formats.insert("gpg", { QObject::tr("Geometry Cache Files"), &GeometryCache::readEntry });
+    }
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+/** Feature angle of generated normals in degrees, 0 for none */
+std::atomic<double> normalFeatureAngle(30.);
+
+/** Order imported meshes are put in */
+std::atomic<MeshImporter::MeshOrder> importOrder(MeshImporter::CacheOrder);
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/** Skips blanks (not newlines) */
+const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p))
+        ++p;
+    return p;
+}
+
+/** Builds a polydata if the parsed buffers are valid */
+vtkSmartPointer<vtkPolyData> toPolyData(const std::vector<float>& points, const std::vector<quint32>& indices) {
+    if (points.empty() || indices.empty())
+        return nullptr;
+    return MeshUtils::makePolyData(points.data(), qint64(points.size() / 3),
+                                   indices.data(), qint64(indices.size() / 3));
+}
+
+/* ---------------------------------------------------------------------------------------------
+ * OBJ
+ * ------------------------------------------------------------------------------------------- */
+
+/** A block of OBJ lines parsed by one task */
+struct ObjChunk {
+    const char*             begin = nullptr;
+    const char*             end = nullptr;
+    std::vector<float>      vertices;
+    std::vector<qint64>     indices;        /**< 0-based, absolute or relative to the chunk's first vertex */
+    std::vector<size_t>     relative;       /**< Positions in indices that are relative */
+    bool                    ok = true;
+};
+
+/** Parses the "v" and "f" lines of a chunk, other statements are ignored */
+void parseObjChunk(ObjChunk& chunk) {
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+    std::vector<std::pair<qint64, bool>> polygon;
+
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        if (!lineEnd)
+            lineEnd = end;
+
+        p = skipBlanks(p, lineEnd);
+        if (lineEnd - p > 1 && p[0] == 'v' && isBlank(p[1])) {
+            p += 1;
+            for (int k = 0; k < 3; ++k) {
+                p = skipBlanks(p, lineEnd);
+                if (p < lineEnd && *p == '+')
+                    ++p;
+                float value;
+                std::from_chars_result result = std::from_chars(p, lineEnd, value);
+                if (result.ec != std::errc()) {
+                    chunk.ok = false;
+                    return;
+                }
+                chunk.vertices.push_back(value);
+                p = result.ptr;
+            }
+        } else if (lineEnd - p > 1 && p[0] == 'f' && isBlank(p[1])) {
+            p += 1;
+            polygon.clear();
+            const qint64 localVertices = qint64(chunk.vertices.size() / 3);
+            while (true) {
+                p = skipBlanks(p, lineEnd);
+                if (p >= lineEnd)
+                    break;
+                qint64 index;
+                std::from_chars_result result = std::from_chars(p, lineEnd, index);
+                if (result.ec != std::errc() || index == 0) {
+                    chunk.ok = false;
+                    return;
+                }
+                /* Negative indices count back from the last vertex defined so far */
+                if (index > 0)
+                    polygon.push_back({ index - 1, false });
+                else
+                    polygon.push_back({ localVertices + index, true });
+
+                /* Skip any texture and normal indices ("v/vt/vn") */
+                p = result.ptr;
+                while (p < lineEnd && !isBlank(*p))
+                    ++p;
+            }
+            for (size_t k = 1; k + 1 < polygon.size(); ++k) {
+                for (const auto& corner : { polygon[0], polygon[k], polygon[k + 1] }) {
+                    if (corner.second)
+                        chunk.relative.push_back(chunk.indices.size());
+                    chunk.indices.push_back(corner.first);
+                }
+            }
+        }
+        p = lineEnd + 1;
+    }
+}
+
+/** Parses a whole OBJ file held in memory */
+bool parseOBJ(const char* data, qint64 size, std::vector<float>& points, std::vector<quint32>& indices) {
+    /* Split at line boundaries into roughly equal chunks */
+    const qint64 chunkCount = std::max<qint64>(1, std::min<qint64>(QThread::idealThreadCount() * 4, size >> 20));
+    QVector<ObjChunk> chunks;
+    qint64 start = 0;
+    for (qint64 c = 1; c <= chunkCount && start < size; ++c) {
+        qint64 next = size;
+        if (c < chunkCount) {
+            const char* newline = static_cast<const char*>(
+                std::memchr(data + std::max(start, size * c / chunkCount), '\n', size_t(size - std::max(start, size * c / chunkCount))));
+            next = newline ? (newline - data) + 1 : size;
+        }
+        ObjChunk chunk;
+        chunk.begin = data + start;
+        chunk.end = data + next;
+        chunks.append(chunk);
+        start = next;
+    }
+
+    QtConcurrent::blockingMap(chunks, parseObjChunk);
+
+    /* Each chunk's first vertex and first index in the merged buffers */
+    QVector<qint64> vertexBase(chunks.size() + 1, 0), indexBase(chunks.size() + 1, 0);
+    for (int c = 0; c < chunks.size(); ++c) {
+        if (!chunks[c].ok)
+            return false;
+        vertexBase[c + 1] = vertexBase[c] + qint64(chunks[c].vertices.size() / 3);
+        indexBase[c + 1] = indexBase[c] + qint64(chunks[c].indices.size());
+    }
+
+    const qint64 pointCount = vertexBase.last();
+    points.resize(size_t(pointCount) * 3);
+    indices.resize(size_t(indexBase.last()));
+
+    std::atomic<bool> valid(true);
+    ObjChunk* chunkData = chunks.data();
+    const qint64* vertexBaseData = vertexBase.constData();
+    const qint64* indexBaseData = indexBase.constData();
+    MeshUtils::parallelFor(chunks.size(), [&](qint64 begin, qint64 end) {
+        for (qint64 c = begin; c < end; ++c) {
+            ObjChunk& chunk = chunkData[c];
+            std::memcpy(points.data() + 3 * vertexBaseData[c], chunk.vertices.data(), chunk.vertices.size() * sizeof(float));
+
+            for (size_t position : chunk.relative)
+                chunk.indices[position] += vertexBaseData[c];
+
+            quint32* out = indices.data() + indexBaseData[c];
+            for (size_t i = 0; i < chunk.indices.size(); ++i) {
+                qint64 index = chunk.indices[i];
+                if (index < 0 || index >= pointCount)
+                    valid = false;
+                out[i] = static_cast<quint32>(index);
+            }
+        }
+    }, 1);
+
+    return valid;
+}
+
+/* ---------------------------------------------------------------------------------------------
+ * PLY
+ * ------------------------------------------------------------------------------------------- */
+
+enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64, Invalid };
+
+struct PlyProperty {
+    std::string_view    name;
+    PlyType             type = PlyType::Invalid;
+    bool                isList = false;
+    PlyType             countType = PlyType::Invalid;
+};
+
+struct PlyElement {
+    std::string_view            name;
+    qint64                      count = 0;
+    std::vector<PlyProperty>    properties;
+};
+
+PlyType plyType(std::string_view name) {
+    if (name == "char"   || name == "int8")    return PlyType::Int8;
+    if (name == "uchar"  || name == "uint8")   return PlyType::UInt8;
+    if (name == "short"  || name == "int16")   return PlyType::Int16;
+    if (name == "ushort" || name == "uint16")  return PlyType::UInt16;
+    if (name == "int"    || name == "int32")   return PlyType::Int32;
+    if (name == "uint"   || name == "uint32")  return PlyType::UInt32;
+    if (name == "float"  || name == "float32") return PlyType::Float32;
+    if (name == "double" || name == "float64") return PlyType::Float64;
+    return PlyType::Invalid;
+}
+
+int plySize(PlyType type) {
+    switch (type) {
+    case PlyType::Int8:    case PlyType::UInt8:   return 1;
+    case PlyType::Int16:   case PlyType::UInt16:  return 2;
+    case PlyType::Int32:   case PlyType::UInt32:  case PlyType::Float32: return 4;
+    case PlyType::Float64: return 8;
+    default:               return 0;
+    }
+}
+
+template <typename T>
+T plyLoad(const uchar* p, bool swap) {
+    uchar bytes[sizeof(T)];
+    std::memcpy(bytes, p, sizeof(T));
+    if (swap)
+        std::reverse(bytes, bytes + sizeof(T));
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+/** Reads one binary value of any PLY type as a double */
+double plyRead(const uchar* p, PlyType type, bool swap) {
+    switch (type) {
+    case PlyType::Int8:    return plyLoad<qint8>(p, swap);
+    case PlyType::UInt8:   return plyLoad<quint8>(p, swap);
+    case PlyType::Int16:   return plyLoad<qint16>(p, swap);
+    case PlyType::UInt16:  return plyLoad<quint16>(p, swap);
+    case PlyType::Int32:   return plyLoad<qint32>(p, swap);
+    case PlyType::UInt32:  return plyLoad<quint32>(p, swap);
+    case PlyType::Float32: return plyLoad<float>(p, swap);
+    case PlyType::Float64: return plyLoad<double>(p, swap);
+    default:               return 0.;
+    }
+}
+
+/** Splits a header line into whitespace separated words */
+std::vector<std::string_view> words(std::string_view line) {
+    std::vector<std::string_view> result;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        while (pos < line.size() && (isBlank(line[pos])))
+            ++pos;
+        size_t start = pos;
+        while (pos < line.size() && !isBlank(line[pos]))
+            ++pos;
+        if (pos > start)
+            result.push_back(line.substr(start, pos - start));
+    }
+    return result;
+}
+
+/**
+ * Parses a binary PLY file held in memory. Sets unsupported (and returns false) for valid files
+ * this reader does not handle itself, such as ASCII PLY, so the caller can fall back to VTK.
+ */
+bool parsePLY(const uchar* data, qint64 size, std::vector<float>& points, std::vector<quint32>& indices, bool& unsupported) {
+    unsupported = false;
+    std::string_view text(reinterpret_cast<const char*>(data), size_t(size));
+    if (text.substr(0, 3) != "ply")
+        return false;
+
+    size_t headerEnd = text.find("end_header");
+    if (headerEnd == std::string_view::npos)
+        return false;
+    size_t dataStart = text.find('\n', headerEnd);
+    if (dataStart == std::string_view::npos)
+        return false;
+    ++dataStart;
+
+    /* Header */
+    bool swap = false;
+    std::vector<PlyElement> elements;
+    size_t pos = 0;
+    while (pos < headerEnd) {
+        size_t lineEnd = text.find('\n', pos);
+        std::vector<std::string_view> w = words(text.substr(pos, lineEnd - pos));
+        pos = lineEnd + 1;
+        if (w.empty())
+            continue;
+
+        if (w[0] == "format" && w.size() >= 2) {
+            const bool littleEndianHost = QSysInfo::ByteOrder == QSysInfo::LittleEndian;
+            if (w[1] == "binary_little_endian")
+                swap = !littleEndianHost;
+            else if (w[1] == "binary_big_endian")
+                swap = littleEndianHost;
+            else {
+                unsupported = true;         // ASCII
+                return false;
+            }
+        } else if (w[0] == "element" && w.size() >= 3) {
+            PlyElement element;
+            element.name = w[1];
+            std::from_chars_result result = std::from_chars(w[2].data(), w[2].data() + w[2].size(), element.count);
+            if (result.ec != std::errc() || element.count < 0)
+                return false;
+            elements.push_back(element);
+        } else if (w[0] == "property" && !elements.empty()) {
+            PlyProperty property;
+            if (w.size() >= 5 && w[1] == "list") {
+                property.isList = true;
+                property.countType = plyType(w[2]);
+                property.type = plyType(w[3]);
+                property.name = w[4];
+            } else if (w.size() >= 3) {
+                property.type = plyType(w[1]);
+                property.name = w[2];
+            }
+            if (property.type == PlyType::Invalid || (property.isList && property.countType == PlyType::Invalid))
+                return false;
+            if (property.isList && (property.countType == PlyType::Float32 || property.countType == PlyType::Float64))
+                return false;               // List counts must be integers
+            elements.back().properties.push_back(property);
+        }
+    }
+
+    /* Body, element by element */
+    const uchar* p = data + dataStart;
+    const uchar* end = data + size;
+    bool haveVertices = false;
+
+    for (const PlyElement& element : elements) {
+        const bool fixedSize = std::none_of(element.properties.begin(), element.properties.end(),
+                                            [](const PlyProperty& property) { return property.isList; });
+        qint64 stride = 0;
+        for (const PlyProperty& property : element.properties)
+            stride += plySize(property.type);
+
+        /* Every item takes at least its scalars and list counts, so the count can be checked
+         * against the bytes left without multiplying, which could overflow */
+        qint64 minItemSize = 0;
+        for (const PlyProperty& property : element.properties)
+            minItemSize += plySize(property.isList ? property.countType : property.type);
+        if (minItemSize == 0)
+            continue;                       // No properties, nothing stored
+        if (element.count > (end - p) / minItemSize)
+            return false;
+
+        if (element.name == "vertex") {
+            if (!fixedSize) {
+                unsupported = true;
+                return false;
+            }
+            qint64 offset[3] = { -1, -1, -1 };
+            PlyType type[3] = { PlyType::Invalid, PlyType::Invalid, PlyType::Invalid };
+            qint64 at = 0;
+            for (const PlyProperty& property : element.properties) {
+                int axis = property.name == "x" ? 0 : property.name == "y" ? 1 : property.name == "z" ? 2 : -1;
+                if (axis >= 0) {
+                    offset[axis] = at;
+                    type[axis] = property.type;
+                }
+                at += plySize(property.type);
+            }
+            if (offset[0] < 0 || offset[1] < 0 || offset[2] < 0)
+                return false;
+
+            /* Fixed stride, so vertices decode in parallel */
+            points.resize(size_t(element.count) * 3);
+            MeshUtils::parallelFor(element.count, [&](qint64 begin, qint64 last) {
+                for (qint64 i = begin; i < last; ++i) {
+                    const uchar* vertex = p + i * stride;
+                    for (int k = 0; k < 3; ++k)
+                        points[3 * i + k] = static_cast<float>(plyRead(vertex + offset[k], type[k], swap));
+                }
+            });
+            p += stride * element.count;
+            haveVertices = true;
+
+        } else if (element.name == "face") {
+            indices.reserve(size_t(element.count) * 3);
+            std::vector<quint32> polygon;
+            for (qint64 i = 0; i < element.count; ++i) {
+                for (const PlyProperty& property : element.properties) {
+                    if (!property.isList) {
+                        if (end - p < plySize(property.type))
+                            return false;
+                        p += plySize(property.type);
+                        continue;
+                    }
+                    if (end - p < plySize(property.countType))
+                        return false;
+                    qint64 n = static_cast<qint64>(plyRead(p, property.countType, swap));
+                    p += plySize(property.countType);
+                    const int itemSize = plySize(property.type);
+                    if (n < 0 || end - p < n * itemSize)
+                        return false;
+
+                    if (property.name == "vertex_indices" || property.name == "vertex_index") {
+                        polygon.resize(size_t(n));
+                        for (qint64 k = 0; k < n; ++k)
+                            polygon[k] = static_cast<quint32>(plyRead(p + k * itemSize, property.type, swap));
+                        for (qint64 k = 1; k + 1 < n; ++k) {
+                            indices.push_back(polygon[0]);
+                            indices.push_back(polygon[k]);
+                            indices.push_back(polygon[k + 1]);
+                        }
+                    }
+                    p += n * itemSize;
+                }
+                if (p > end)
+                    return false;
+            }
+
+        } else if (fixedSize) {
+            p += stride * element.count;
+
+        } else {
+            /* Some other element with lists, step over it item by item */
+            for (qint64 i = 0; i < element.count; ++i) {
+                for (const PlyProperty& property : element.properties) {
+                    if (!property.isList) {
+                        if (end - p < plySize(property.type))
+                            return false;
+                        p += plySize(property.type);
+                        continue;
+                    }
+                    if (end - p < plySize(property.countType))
+                        return false;
+                    qint64 n = static_cast<qint64>(plyRead(p, property.countType, swap));
+                    p += plySize(property.countType);
+                    const int itemSize = plySize(property.type);
+                    if (n < 0 || end - p < n * itemSize)
+                        return false;
+                    p += n * itemSize;
+                }
+            }
+        }
+
+        if (p > end)
+            return false;
+    }
+
+    if (!haveVertices)
+        return false;
+
+    const quint32 pointCount = static_cast<quint32>(points.size() / 3);
+    return std::all_of(indices.begin(), indices.end(), [&](quint32 index) { return index < pointCount; });
+}
+
+}
+
+/**
+ * @brief Registers a reader for an extension.
+ */
+void MeshImporter::registerFormat(const QString& extension, const QString& description, ReadFunction read) {
+    Registry& r = registry();
+    QWriteLocker locker(&r.lock);
+    r.formats.insert(extension.toLower(), { description, read });
+}
+
+/**
+ * @brief Checks for a registered extension.
+ */
+bool MeshImporter::canRead(const QString& fileName) {
+    Registry& r = registry();
+    QReadLocker locker(&r.lock);
+    return r.formats.contains(QFileInfo(fileName).suffix().toLower());
+}
+
+/**
+ * @brief Stores the order.
+ */
+void MeshImporter::setMeshOrder(MeshOrder order) {
+    importOrder = order;
+}
+
+/**
+ * @brief Returns the order.
+ */
+MeshImporter::MeshOrder MeshImporter::meshOrder() {
+    return importOrder;
+}
+
+/**
+ * @brief Stores the feature angle.
+ */
+void MeshImporter::setNormalAngle(double degrees) {
+    normalFeatureAngle = std::clamp(degrees, 0., 180.);
+}
+
+/**
+ * @brief Returns the feature angle.
+ */
+double MeshImporter::normalAngle() {
+    return normalFeatureAngle;
+}
+
+/**
+ * @brief Reads a file with the reader registered for its extension, reorders it and adds
+ *        normals, via the geometry cache.
+ */
+vtkSmartPointer<vtkPolyData> MeshImporter::read(const QString& fileName, double* milliseconds) {
+    TRACE_SCOPE("MeshImporter::read");
+    QElapsedTimer timer;
+    timer.start();
+    auto finish = [&](vtkSmartPointer<vtkPolyData> polyData) {
+        if (milliseconds)
+            *milliseconds = timer.nsecsElapsed() / 1e6;
+        return polyData;
+    };
+
+    ReadFunction reader = nullptr;
+    {
+        Registry& r = registry();
+        QReadLocker locker(&r.lock);
+        auto it = r.formats.constFind(QFileInfo(fileName).suffix().toLower());
+        if (it == r.formats.cend())
+            return finish(nullptr);
+        reader = it->read;
+    }
+
+    /* Each setting has its own cache entries, so changing it back finds the old ones */
+    const MeshOrder order = importOrder;
+    const double angle = normalFeatureAngle;
+    QString variant;
+    if (order != FileOrder)
+        variant += QString("order %1 ").arg(int(order));
+    if (angle > 0.)
+        variant += QString("normals %1").arg(angle);
+    if (vtkSmartPointer<vtkPolyData> cached = GeometryCache::find(fileName, variant))
+        return finish(cached);
+
+    /* Reorder first, normals only add points next to the ones they split */
+    vtkSmartPointer<vtkPolyData> polyData = reader(fileName);
+    if (polyData && order != FileOrder) {
+        TRACE_SCOPE("MeshUtils::reorder");
+        if (vtkSmartPointer<vtkPolyData> ordered = MeshUtils::reorder(polyData, order == SpatialOrder))
+            polyData = ordered;
+    }
+    if (polyData && angle > 0.) {
+        TRACE_SCOPE("MeshUtils::generateNormals");
+        if (vtkSmartPointer<vtkPolyData> smooth = MeshUtils::generateNormals(polyData, angle))
+            polyData = smooth;
+    }
+    if (polyData)
+        GeometryCache::insert(fileName, polyData, variant);
+    return finish(polyData);
+}
+
+/**
+ * @brief Returns "*.ext" filters for every registered format.
+ */
+QStringList MeshImporter::nameFilters() {
+    Registry& r = registry();
+    QReadLocker locker(&r.lock);
+    QStringList filters;
+    for (auto it = r.formats.cbegin(); it != r.formats.cend(); ++it)
+        filters.append("*." + it.key());
+    return filters;
+}
+
+/**
+ * @brief Returns a file dialog filter with an "all meshes" entry followed by one entry per format.
+ */
+QString MeshImporter::fileDialogFilter() {
+    QStringList entries;
+    entries.append(QObject::tr("Mesh Files (%1)").arg(nameFilters().join(' ')));
+
+    Registry& r = registry();
+    QReadLocker locker(&r.lock);
+    for (auto it = r.formats.cbegin(); it != r.formats.cend(); ++it)
+        entries.append(QString("%1 (*.%2)").arg(it->description, it.key()));
+    return entries.join(";;");
+}
+
+/**
+ * @brief Reads an STL file, ASCII files through the parallel parser.
+ */
+vtkSmartPointer<vtkPolyData> MeshImporter::readSTL(const QString& fileName) {
+    /* Large ASCII exports are parsed in parallel, vtkSTLReader's stream based
+     * number parsing is far too slow for them */
+    if (AsciiSTLParser::isAscii(fileName))
+        return AsciiSTLParser::read(fileName);
+
+    vtkNew<vtkSTLReader> reader;
+    reader->SetFileName(fileName.toStdString().c_str());
+    reader->Update();
+
+    if (reader->GetErrorCode() != 0 || reader->GetOutput()->GetNumberOfPoints() == 0)
+        return nullptr;
+
+    /* Take a shallow copy so the geometry outlives the reader */
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->ShallowCopy(reader->GetOutput());
+    return polyData;
+}
+
+/**
+ * @brief Reads an OBJ file natively.
+ */
+vtkSmartPointer<vtkPolyData> MeshImporter::readOBJ(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+        return nullptr;
+
+    const char* data = reinterpret_cast<const char*>(file.map(0, file.size()));
+    if (!data)
+        return nullptr;
+
+    std::vector<float> points;
+    std::vector<quint32> indices;
+    if (!parseOBJ(data, file.size(), points, indices))
+        return nullptr;
+    return toPolyData(points, indices);
+}
+
+/**
+ * @brief Reads a PLY file, natively when binary.
+ */
+vtkSmartPointer<vtkPolyData> MeshImporter::readPLY(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+        return nullptr;
+
+    const uchar* data = file.map(0, file.size());
+    if (!data)
+        return nullptr;
+
+    std::vector<float> points;
+    std::vector<quint32> indices;
+    bool unsupported = false;
+    if (parsePLY(data, file.size(), points, indices, unsupported))
+        return toPolyData(points, indices);
+    if (!unsupported)
+        return nullptr;
+
+    /* ASCII and other unusual layouts go through VTK */
+    file.close();
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(fileName.toStdString().c_str());
+    reader->Update();
+    if (reader->GetErrorCode() != 0 || reader->GetOutput()->GetNumberOfPoints() == 0)
+        return nullptr;
+
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->ShallowCopy(reader->GetOutput());
+    return polyData;
+}
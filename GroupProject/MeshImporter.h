@@ -0,0 +1,109 @@
+/**
+ * @file MeshImporter.h
+ * @brief Declaration of the MeshImporter class, a registry of mesh file readers keyed by extension.
+ * @details STL, OBJ and PLY readers are built in, as is a reader for the geometry cache format
+ *          that MeshExporter writes (*.gpg). OBJ and PLY are read natively and keep their
+ *          indexed (shared vertex) geometry. All formats go through the same GeometryCache and
+ *          can be called from worker threads, so every load path (open file, folders, projects)
+ *          handles every format. Every mesh read from its file is reordered for the GPU's vertex
+ *          cache and given point normals before it is cached, so neither is done twice and parts
+ *          are smooth shaded without a filter.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_MESHIMPORTER_H
+#define VIEWER_MESHIMPORTER_H
+
+#include <QString>
+#include <QStringList>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @class MeshImporter
+ * @brief Reads mesh files of any registered format.
+ */
+class MeshImporter {
+public:
+    /** Order of the triangles and points of imported meshes */
+    enum MeshOrder {
+        FileOrder,      /**< As written in the file */
+        CacheOrder,     /**< Reordered for the vertex cache, see MeshUtils::reorder() */
+        SpatialOrder    /**< Sorted along a space filling curve, then reordered for the vertex cache */
+    };
+
+    /** Function that reads one file, returning nullptr on failure. Must be safe to call from any thread. */
+    using ReadFunction = vtkSmartPointer<vtkPolyData> (*)(const QString& fileName);
+
+    /**
+     * @brief Registers (or replaces) the reader for a file extension.
+     * @param extension Extension without the dot, matched case-insensitively.
+     * @param description Text shown in file dialogs, e.g. "STL Files".
+     * @param read Reader function.
+     */
+    static void registerFormat(const QString& extension, const QString& description, ReadFunction read);
+
+    /**
+     * @brief Checks whether a file has a registered extension.
+     */
+    static bool canRead(const QString& fileName);
+
+    /**
+     * @brief Sets the order of the meshes read from now on, CacheOrder by default.
+     */
+    static void setMeshOrder(MeshOrder order);
+
+    /**
+     * @brief Returns the order meshes are read in.
+     */
+    static MeshOrder meshOrder();
+
+    /**
+     * @brief Sets the feature angle of the normals generated for meshes read from now on.
+     * @param degrees Largest angle between faces that are shaded as one surface, 0 to store no
+     *        normals and shade every face flat. The default is 30.
+     */
+    static void setNormalAngle(double degrees);
+
+    /**
+     * @brief Returns the feature angle of generated normals, 0 if none are generated.
+     */
+    static double normalAngle();
+
+    /**
+     * @brief Reads a mesh file, using the geometry cache when possible.
+     * @param fileName Path to the file.
+     * @param milliseconds If not null, receives the time taken, including any cache lookup.
+     * @return the mesh, or nullptr if the format is unknown or the file could not be read
+     */
+    static vtkSmartPointer<vtkPolyData> read(const QString& fileName, double* milliseconds = nullptr);
+
+    /**
+     * @brief Returns name filters for all registered extensions, e.g. "*.stl", for use with QDir.
+     */
+    static QStringList nameFilters();
+
+    /**
+     * @brief Returns a QFileDialog filter string listing all formats together and then each one.
+     */
+    static QString fileDialogFilter();
+
+    /**
+     * @brief Reads an ASCII or binary STL file.
+     */
+    static vtkSmartPointer<vtkPolyData> readSTL(const QString& fileName);
+
+    /**
+     * @brief Reads a Wavefront OBJ file, polygons are fan triangulated.
+     */
+    static vtkSmartPointer<vtkPolyData> readOBJ(const QString& fileName);
+
+    /**
+     * @brief Reads a PLY file, binary files natively and ASCII files through vtkPLYReader.
+     */
+    static vtkSmartPointer<vtkPolyData> readPLY(const QString& fileName);
+};
+
+#endif
@@ -0,0 +1,230 @@
+/**
+ * @file MeshMetrics.cpp
+ * @brief Implementation of the MeshMetrics struct.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "MeshMetrics.h"
+#include "MeshUtils.h"
+#include "Trace.h"
+
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPoints.h>
+#include <vtkUnsignedShortArray.h>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Adds the area, volume and moments of the polygons in [begin, end) to a partial sum.
+ * @param offsets Cell offsets.
+ * @param connectivity Point ids of all cells.
+ * @param points Points relative to the reference point, three doubles each.
+ * @param begin First cell.
+ * @param end One past the last cell.
+ * @param sum Partial sum to add to.
+ */
+template <typename Id>
+void accumulate(const Id* offsets, const Id* connectivity, const double* points, qint64 begin, qint64 end,
+                MeshMetrics& sum) {
+    /* Local accumulators keep the inner loop in registers */
+    double area = 0., volume = 0.;
+    double am[3] = { 0., 0., 0. }, vm[3] = { 0., 0., 0. };
+
+    for (qint64 cell = begin; cell < end; ++cell) {
+        const Id first = offsets[cell];
+        const Id last = offsets[cell + 1];
+        if (last - first < 3)
+            continue;
+
+        const double* a = points + 3 * connectivity[first];
+        for (Id k = first + 1; k + 1 < last; ++k) {
+            const double* b = points + 3 * connectivity[k];
+            const double* c = points + 3 * connectivity[k + 1];
+
+            const double u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            const double v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            const double n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+            const double triangleArea = 0.5 * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            /* Signed volume of the tetrahedron (reference point, a, b, c) is a . (b x c) / 6 */
+            const double bc[3] = { b[1] * c[2] - b[2] * c[1], b[2] * c[0] - b[0] * c[2], b[0] * c[1] - b[1] * c[0] };
+            const double tetraVolume = (a[0] * bc[0] + a[1] * bc[1] + a[2] * bc[2]) / 6.;
+
+            area += triangleArea;
+            volume += tetraVolume;
+            for (int j = 0; j < 3; ++j) {
+                const double s = a[j] + b[j] + c[j];
+                am[j] += triangleArea * s / 3.;
+                vm[j] += tetraVolume * s / 4.;     // the fourth vertex is the reference point, 0
+            }
+        }
+    }
+
+    sum.area += area;
+    sum.volume += volume;
+    for (int j = 0; j < 3; ++j) {
+        sum.areaMoment[j] += am[j];
+        sum.volumeMoment[j] += vm[j];
+    }
+}
+
+}
+
+/**
+ * @brief Adds the sums and grows the bounds.
+ */
+MeshMetrics& MeshMetrics::operator+=(const MeshMetrics& other) {
+    if (!other.isValid())
+        return *this;
+
+    for (int j = 0; j < 3; ++j) {
+        if (isValid()) {
+            bounds[2 * j] = std::min(bounds[2 * j], other.bounds[2 * j]);
+            bounds[2 * j + 1] = std::max(bounds[2 * j + 1], other.bounds[2 * j + 1]);
+        } else {
+            bounds[2 * j] = other.bounds[2 * j];
+            bounds[2 * j + 1] = other.bounds[2 * j + 1];
+        }
+        volumeMoment[j] += other.volumeMoment[j];
+        areaMoment[j] += other.areaMoment[j];
+    }
+    meshes += other.meshes;
+    area += other.area;
+    volume += other.volume;
+    return *this;
+}
+
+/**
+ * @brief Returns true once a mesh has been added.
+ */
+bool MeshMetrics::isValid() const {
+    return meshes > 0;
+}
+
+/**
+ * @brief Divides the volume moment by the volume, or the area moment by the area.
+ */
+bool MeshMetrics::centre(double centre[3]) const {
+    if (!isValid())
+        return false;
+
+    /* A volume that is tiny compared with the box is an open or flat surface */
+    double diagonal = 0.;
+    for (int j = 0; j < 3; ++j)
+        diagonal += (bounds[2 * j + 1] - bounds[2 * j]) * (bounds[2 * j + 1] - bounds[2 * j]);
+    const double boxScale = std::pow(diagonal, 1.5);
+
+    if (volume > 1e-6 * boxScale) {
+        for (int j = 0; j < 3; ++j)
+            centre[j] = volumeMoment[j] / volume;
+    } else if (area > 0.) {
+        for (int j = 0; j < 3; ++j)
+            centre[j] = areaMoment[j] / area;
+    } else {
+        for (int j = 0; j < 3; ++j)
+            centre[j] = 0.5 * (bounds[2 * j] + bounds[2 * j + 1]);
+    }
+    return true;
+}
+
+/**
+ * @brief Places the points relative to the first one, then sums the triangles in parallel blocks.
+ */
+MeshMetrics MeshMetrics::compute(vtkPolyData* polyData, vtkMatrix4x4* matrix) {
+    TRACE_SCOPE("MeshMetrics::compute");
+
+    MeshMetrics metrics;
+    vtkCellArray* polys = polyData ? polyData->GetPolys() : nullptr;
+    if (!polys || polys->GetNumberOfCells() == 0 || !polyData->GetPoints())
+        return metrics;
+
+    /* 1. Model coordinates in doubles, relative to a reference point on the mesh so that the
+     *    tetrahedra stay small and the sums keep their precision far from the origin */
+    const qint64 pointCount = polyData->GetNumberOfPoints();
+    vtkDataArray* pointData = polyData->GetPoints()->GetData();
+    vtkFloatArray* floatPoints = vtkFloatArray::FastDownCast(pointData);
+    vtkUnsignedShortArray* quantisedPoints = vtkUnsignedShortArray::FastDownCast(pointData);
+
+    auto place = [&](qint64 i, double x[3]) {
+        if (floatPoints) {
+            const float* f = floatPoints->GetPointer(3 * i);
+            x[0] = f[0]; x[1] = f[1]; x[2] = f[2];
+        } else if (quantisedPoints) {
+            const unsigned short* q = quantisedPoints->GetPointer(3 * i);
+            x[0] = q[0]; x[1] = q[1]; x[2] = q[2];
+        } else {
+            pointData->GetTuple(i, x);
+        }
+        if (matrix) {
+            double in[4] = { x[0], x[1], x[2], 1. }, out[4];
+            matrix->MultiplyPoint(in, out);
+            x[0] = out[0]; x[1] = out[1]; x[2] = out[2];
+        }
+    };
+
+    double reference[3];
+    place(0, reference);
+    for (int j = 0; j < 3; ++j)
+        metrics.bounds[2 * j] = metrics.bounds[2 * j + 1] = reference[j];
+
+    std::vector<double> points(size_t(pointCount) * 3);
+    std::mutex mutex;
+    MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+        double low[3] = { reference[0], reference[1], reference[2] };
+        double high[3] = { reference[0], reference[1], reference[2] };
+        double x[3];
+        for (qint64 i = begin; i < end; ++i) {
+            place(i, x);
+            for (int j = 0; j < 3; ++j) {
+                low[j] = std::min(low[j], x[j]);
+                high[j] = std::max(high[j], x[j]);
+                points[3 * i + j] = x[j] - reference[j];
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int j = 0; j < 3; ++j) {
+            metrics.bounds[2 * j] = std::min(metrics.bounds[2 * j], low[j]);
+            metrics.bounds[2 * j + 1] = std::max(metrics.bounds[2 * j + 1], high[j]);
+        }
+    }, 16384);
+
+    /* 2. Partial sums over blocks of cells, merged under a lock (there are only a few blocks) */
+    MeshMetrics sum;
+    const qint64 cellCount = polys->GetNumberOfCells();
+    MeshUtils::parallelFor(cellCount, [&](qint64 begin, qint64 end) {
+        MeshMetrics partial;
+        if (polys->IsStorage64Bit())
+            accumulate(polys->GetOffsetsArray64()->GetPointer(0), polys->GetConnectivityArray64()->GetPointer(0),
+                       points.data(), begin, end, partial);
+        else
+            accumulate(polys->GetOffsetsArray32()->GetPointer(0), polys->GetConnectivityArray32()->GetPointer(0),
+                       points.data(), begin, end, partial);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        sum.area += partial.area;
+        sum.volume += partial.volume;
+        for (int j = 0; j < 3; ++j) {
+            sum.areaMoment[j] += partial.areaMoment[j];
+            sum.volumeMoment[j] += partial.volumeMoment[j];
+        }
+    });
+
+    /* 3. Back to model coordinates, flipping inside-out meshes */
+    const double sign = sum.volume < 0. ? -1. : 1.;
+    metrics.meshes = 1;
+    metrics.area = sum.area;
+    metrics.volume = sign * sum.volume;
+    for (int j = 0; j < 3; ++j) {
+        metrics.areaMoment[j] = sum.areaMoment[j] + sum.area * reference[j];
+        metrics.volumeMoment[j] = sign * sum.volumeMoment[j] + metrics.volume * reference[j];
+    }
+    return metrics;
+}
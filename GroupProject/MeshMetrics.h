@@ -0,0 +1,62 @@
+/**
+ * @file MeshMetrics.h
+ * @brief Declaration of the MeshMetrics struct, the surface area, volume, bounds and centre of mass of a mesh.
+ * @details The volume and centre of mass come from the divergence theorem: every triangle spans a
+ *          signed tetrahedron with a common apex, and the signed volumes add up to the enclosed
+ *          volume of a closed surface. All quantities are sums over triangles, so a part's metrics
+ *          are computed as independent partial sums in parallel, and an assembly's metrics are the
+ *          sum of its parts'.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_MESHMETRICS_H
+#define VIEWER_MESHMETRICS_H
+
+#include <QtGlobal>
+
+#include <vtkPolyData.h>
+#include <vtkMatrix4x4.h>
+
+/**
+ * @struct MeshMetrics
+ * @brief Additive geometric properties of one mesh or of several meshes together.
+ * @details Moments rather than centres are stored, so that metrics can simply be added.
+ */
+struct MeshMetrics {
+    qint64  meshes = 0;                     /**< Number of meshes measured, 0 if nothing has been */
+    double  area = 0.;                      /**< Surface area */
+    double  volume = 0.;                    /**< Enclosed volume, only meaningful for closed surfaces */
+    double  volumeMoment[3] = { 0., 0., 0. };   /**< Volume times centre of mass */
+    double  areaMoment[3] = { 0., 0., 0. };     /**< Area times centre of the surface */
+    double  bounds[6] = { 1., -1., 1., -1., 1., -1. }; /**< Axis aligned box, xmin > xmax while empty */
+
+    /** Adds another mesh's metrics to these */
+    MeshMetrics& operator+=(const MeshMetrics& other);
+
+    /**
+     * @brief Returns whether any mesh has been measured.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Returns the centre of mass assuming uniform density.
+     * @details Falls back to the centre of the surface when the volume is negligible, e.g. for
+     *          open sheets.
+     * @param centre Receives the centre.
+     * @return false if there is nothing to take the centre of
+     */
+    bool centre(double centre[3]) const;
+
+    /**
+     * @brief Measures the polygons of a mesh, in parallel.
+     * @details Polygons with more than three points are split into fans. A consistently inward
+     *          facing mesh still gets a positive volume.
+     * @param polyData Mesh to measure, only read.
+     * @param matrix Optional matrix placing the points, e.g. the one of a compact part.
+     * @return the metrics, invalid if the mesh has no polygons
+     */
+    static MeshMetrics compute(vtkPolyData* polyData, vtkMatrix4x4* matrix = nullptr);
+};
+
+#endif
@@ -0,0 +1,733 @@
+/**
+ * @file MeshUtils.cpp
+ * @brief Implementation of the MeshUtils helper class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "MeshUtils.h"
+
+#include <vtkPoints.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkCellData.h>
+#include <vtkIdList.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+
+/** Number of independent partitions used when welding, must be a power of two */
+const int WeldPartitionBits = 6;
+const int WeldPartitions = 1 << WeldPartitionBits;
+
+/** Bit pattern of a vertex, used as the welding key */
+struct VertexKey {
+    quint32 x, y, z;
+    bool operator==(const VertexKey& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+/** Mixes the three coordinates into a well distributed 64 bit hash */
+quint64 hashKey(const VertexKey& key) {
+    quint64 h = (quint64(key.x) << 32 | key.y) * 0x9E3779B97F4A7C15ull;
+    h ^= (quint64(key.z) + (h >> 29)) * 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 31;
+    return h;
+}
+
+struct VertexKeyHash {
+    size_t operator()(const VertexKey& key) const { return static_cast<size_t>(hashKey(key)); }
+};
+
+/** Reads a vertex as a key, -0 is folded into +0 so both weld together */
+VertexKey keyOf(const float* v) {
+    VertexKey key;
+    float x = v[0] + 0.f, y = v[1] + 0.f, z = v[2] + 0.f;
+    std::memcpy(&key.x, &x, sizeof(float));
+    std::memcpy(&key.y, &y, sizeof(float));
+    std::memcpy(&key.z, &z, sizeof(float));
+    return key;
+}
+
+/** Entries of the simulated cache reorder() optimises for */
+const int VertexCacheSize = 32;
+
+/**
+ * @brief Forsyth's score of a point: high when it is recently used and has few triangles left.
+ */
+class VertexScores {
+public:
+    VertexScores() {
+        for (int i = 0; i < VertexCacheSize; ++i) {
+            /* The last triangle's points score a little lower, so the next one is not a strip */
+            cacheScores[i] = i < 3 ? 0.75f
+                                   : static_cast<float>(std::pow(1. - double(i - 3) / (VertexCacheSize - 3), 1.5));
+        }
+        for (int i = 0; i < ValenceTable; ++i)
+            valenceScores[i] = i == 0 ? 0.f : static_cast<float>(2. / std::sqrt(double(i)));
+    }
+
+    float operator()(int cachePosition, quint32 remaining) const {
+        if (remaining == 0)
+            return -1.f;
+        float score = cachePosition >= 0 ? cacheScores[cachePosition] : 0.f;
+        score += remaining < quint32(ValenceTable) ? valenceScores[remaining]
+                                                   : static_cast<float>(2. / std::sqrt(double(remaining)));
+        return score;
+    }
+
+private:
+    static const int ValenceTable = 64;
+    float cacheScores[VertexCacheSize];
+    float valenceScores[ValenceTable];
+};
+
+/**
+ * @brief Orders one run of triangles for the vertex cache.
+ * @param indices Three point ids per triangle of the whole mesh.
+ * @param triangles Ids of the run's triangles, reordered in place.
+ * @param count Number of triangles in the run.
+ * @param vertexScore Score tables.
+ */
+void forsythOrder(const quint32* indices, quint32* triangles, qint64 count, const VertexScores& vertexScore) {
+    /* Number the run's points from 0 */
+    std::vector<quint32> points(size_t(count) * 3);
+    for (qint64 t = 0; t < count; ++t)
+        std::copy(indices + 3 * size_t(triangles[t]), indices + 3 * size_t(triangles[t]) + 3, &points[3 * t]);
+    std::vector<quint32> corners(points);
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    for (quint32& corner : corners)
+        corner = quint32(std::lower_bound(points.begin(), points.end(), corner) - points.begin());
+    const size_t pointCount = points.size();
+
+    /* Triangles around each point, the first `remaining` of them not emitted yet */
+    std::vector<quint32> start(pointCount + 1, 0);
+    for (quint32 corner : corners)
+        ++start[corner + 1];
+    for (size_t p = 0; p < pointCount; ++p)
+        start[p + 1] += start[p];
+    std::vector<quint32> adjacent(corners.size());
+    std::vector<quint32> remaining(pointCount, 0);
+    for (size_t c = 0; c < corners.size(); ++c)
+        adjacent[start[corners[c]] + remaining[corners[c]]++] = quint32(c / 3);
+
+    std::vector<int> cachePosition(pointCount, -1);
+    std::vector<float> score(pointCount);
+    for (size_t p = 0; p < pointCount; ++p)
+        score[p] = vertexScore(-1, remaining[p]);
+    std::vector<float> triangleScore(static_cast<size_t>(count));
+    for (qint64 t = 0; t < count; ++t)
+        triangleScore[t] = score[corners[3 * t]] + score[corners[3 * t + 1]] + score[corners[3 * t + 2]];
+
+    std::vector<bool> emitted(size_t(count), false);
+    std::vector<quint32> order;
+    order.reserve(size_t(count));
+    std::vector<quint32> cache, newCache;
+    cache.reserve(VertexCacheSize + 3);
+    newCache.reserve(VertexCacheSize + 3);
+
+    qint64 best = -1;
+    qint64 next = 0;
+    for (qint64 n = 0; n < count; ++n) {
+        /* Nothing in the cache has triangles left, start again at the next triangle in run order */
+        if (best < 0) {
+            while (emitted[next])
+                ++next;
+            best = next;
+        }
+        emitted[best] = true;
+        order.push_back(triangles[best]);
+
+        const quint32* corner = &corners[3 * best];
+        for (int k = 0; k < 3; ++k) {
+            quint32* first = &adjacent[start[corner[k]]];
+            quint32* last = first + --remaining[corner[k]];
+            std::iter_swap(std::find(first, last + 1, quint32(best)), last);
+        }
+
+        /* The triangle's points move to the front of the cache, the rest shift back */
+        newCache.assign(corner, corner + 3);
+        for (quint32 p : cache) {
+            if (p != corner[0] && p != corner[1] && p != corner[2])
+                newCache.push_back(p);
+        }
+        for (size_t i = 0; i < newCache.size(); ++i) {
+            const quint32 p = newCache[i];
+            cachePosition[p] = i < VertexCacheSize ? int(i) : -1;
+            score[p] = vertexScore(cachePosition[p], remaining[p]);
+        }
+
+        /* Only triangles of points whose score changed need scoring again */
+        best = -1;
+        float bestScore = -1.f;
+        for (quint32 p : newCache) {
+            for (quint32 i = start[p]; i < start[p] + remaining[p]; ++i) {
+                const quint32 t = adjacent[i];
+                triangleScore[t] = score[corners[3 * t]] + score[corners[3 * t + 1]] + score[corners[3 * t + 2]];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        if (newCache.size() > VertexCacheSize)
+            newCache.resize(VertexCacheSize);
+        std::swap(cache, newCache);
+    }
+    std::copy(order.begin(), order.end(), triangles);
+}
+
+/**
+ * @brief Spreads the low 10 bits of a value to every third bit.
+ */
+quint32 spreadBits(quint32 x) {
+    x &= 0x3ff;
+    x = (x | (x << 16)) & 0x030000ff;
+    x = (x | (x << 8)) & 0x0300f00f;
+    x = (x | (x << 4)) & 0x030c30c3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+
+/**
+ * @brief Returns the FIFO cache misses of an index list.
+ */
+qint64 fifoMisses(const quint32* indices, qint64 count, int cacheSize) {
+    std::vector<quint32> fifo(size_t(cacheSize), std::numeric_limits<quint32>::max());
+    size_t head = 0;
+    qint64 misses = 0;
+    for (qint64 i = 0; i < count; ++i) {
+        if (std::find(fifo.begin(), fifo.end(), indices[i]) != fifo.end())
+            continue;
+        fifo[head] = indices[i];
+        head = (head + 1) % fifo.size();
+        ++misses;
+    }
+    return misses;
+}
+
+/**
+ * @brief Narrows cell array ids to 32 bits.
+ */
+template <typename T>
+void narrowIds(const T* source, quint32* target, qint64 count) {
+    MeshUtils::parallelFor(count, [&](qint64 begin, qint64 end) {
+        for (qint64 i = begin; i < end; ++i)
+            target[i] = static_cast<quint32>(source[i]);
+    }, 1 << 16);
+}
+
+/**
+ * @brief Implements MeshUtils::generateNormals() for one cell array storage type.
+ * @param polyData Mesh made of polygons only.
+ * @param offsetsArray The polygons' offsets.
+ * @param connectivityArray The polygons' point ids.
+ * @param cosAngle Cosine of the feature angle.
+ */
+template <typename IdArray>
+vtkSmartPointer<vtkPolyData> splitNormals(vtkPolyData* polyData, IdArray* offsetsArray, IdArray* connectivityArray,
+                                          double cosAngle) {
+    using Id = typename IdArray::ValueType;
+    const Id* offsets = offsetsArray->GetPointer(0);
+    const Id* connectivity = connectivityArray->GetPointer(0);
+    const qint64 pointCount = polyData->GetNumberOfPoints();
+    const qint64 faceCount = offsetsArray->GetNumberOfValues() - 1;
+    const qint64 cornerCount = connectivityArray->GetNumberOfValues();
+    vtkDataArray* sourcePoints = polyData->GetPoints()->GetData();
+
+    /* 1. Unit normal and area of every face, by Newell's method so any planar polygon works */
+    std::vector<float> faceNormals(size_t(faceCount) * 3);
+    std::vector<float> faceAreas(static_cast<size_t>(faceCount));
+    std::vector<quint32> cornerFaces(static_cast<size_t>(cornerCount));
+    MeshUtils::parallelFor(faceCount, [&](qint64 begin, qint64 end) {
+        double a[3], b[3];
+        for (qint64 f = begin; f < end; ++f) {
+            double n[3] = { 0., 0., 0. };
+            sourcePoints->GetTuple(connectivity[offsets[f + 1] - 1], a);
+            for (qint64 c = offsets[f]; c < offsets[f + 1]; ++c) {
+                sourcePoints->GetTuple(connectivity[c], b);
+                n[0] += (a[1] - b[1]) * (a[2] + b[2]);
+                n[1] += (a[2] - b[2]) * (a[0] + b[0]);
+                n[2] += (a[0] - b[0]) * (a[1] + b[1]);
+                std::copy(b, b + 3, a);
+                cornerFaces[c] = static_cast<quint32>(f);
+            }
+            const double length = vtkMath::Norm(n);
+            faceAreas[f] = static_cast<float>(0.5 * length);
+            for (int k = 0; k < 3; ++k)
+                faceNormals[3 * f + k] = length > 0. ? static_cast<float>(n[k] / length) : 0.f;
+        }
+    });
+
+    /* 2. Corners around every point, in corner order so the result does not depend on the
+     *    threads. Two passes of integer increments, cheap next to the other steps */
+    std::vector<quint32> pointStart(size_t(pointCount) + 1, 0);
+    for (qint64 c = 0; c < cornerCount; ++c)
+        ++pointStart[connectivity[c] + 1];
+    for (qint64 p = 0; p < pointCount; ++p)
+        pointStart[p + 1] += pointStart[p];
+    std::vector<quint32> pointCorners(static_cast<size_t>(cornerCount));
+    {
+        std::vector<quint32> cursor(pointStart.begin(), pointStart.end() - 1);
+        for (qint64 c = 0; c < cornerCount; ++c)
+            pointCorners[cursor[connectivity[c]]++] = static_cast<quint32>(c);
+    }
+
+    /* 3. Normal of every corner, and which of its point's output points it uses. The faces
+     *    around a point are grouped greedily: a face joins the first group whose first face is
+     *    within the feature angle of its own, so each face is compared with one normal per
+     *    group rather than with every other face, and every group becomes one output point */
+    std::vector<float> cornerNormals(size_t(cornerCount) * 3);
+    std::vector<quint32> cornerSlots(static_cast<size_t>(cornerCount));
+    std::vector<qint64> pointFirst(size_t(pointCount) + 1, 0);
+    MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+        std::vector<quint32> groupFaces;    // First face of each group
+        std::vector<double> groupSums;      // Area weighted normal sum of each group
+        for (qint64 p = begin; p < end; ++p) {
+            const quint32* corners = pointCorners.data() + pointStart[p];
+            const qint64 count = pointStart[p + 1] - pointStart[p];
+            groupFaces.clear();
+            groupSums.clear();
+            double all[3] = { 0., 0., 0. };
+            bool degenerate = false;
+            for (qint64 i = 0; i < count; ++i) {
+                const quint32 face = cornerFaces[corners[i]];
+                const float* own = &faceNormals[3 * size_t(face)];
+                for (int k = 0; k < 3; ++k)
+                    all[k] += faceAreas[face] * own[k];
+                if (faceAreas[face] == 0.f) {
+                    degenerate = true;
+                    continue;
+                }
+
+                size_t group = 0;
+                for (; group < groupFaces.size(); ++group) {
+                    const float* first = &faceNormals[3 * size_t(groupFaces[group])];
+                    if (own[0] * first[0] + own[1] * first[1] + own[2] * first[2] >= cosAngle)
+                        break;
+                }
+                if (group == groupFaces.size()) {
+                    groupFaces.push_back(face);
+                    groupSums.insert(groupSums.end(), 3, 0.);
+                }
+                for (int k = 0; k < 3; ++k)
+                    groupSums[3 * group + k] += faceAreas[face] * own[k];
+                cornerSlots[corners[i]] = static_cast<quint32>(group);
+            }
+
+            /* A degenerate face has no direction of its own and takes all of its neighbours'. With
+             * at most one group that is the group's normal, otherwise it needs a point of its own */
+            const quint32 allSlot = static_cast<quint32>(groupFaces.size() <= 1 ? 0 : groupFaces.size());
+            if (degenerate && allSlot == groupSums.size() / 3)
+                groupSums.insert(groupSums.end(), all, all + 3);
+            for (size_t group = 0; group < groupSums.size() / 3; ++group)
+                vtkMath::Normalize(&groupSums[3 * group]);
+
+            for (qint64 i = 0; i < count; ++i) {
+                const quint32 c = corners[i];
+                if (faceAreas[cornerFaces[c]] == 0.f)
+                    cornerSlots[c] = allSlot;
+                const double* n = &groupSums[3 * size_t(cornerSlots[c])];
+                for (int k = 0; k < 3; ++k)
+                    cornerNormals[3 * size_t(c) + k] = static_cast<float>(n[k]);
+            }
+            /* Points no face uses are kept, without a normal */
+            pointFirst[p + 1] = std::max<qint64>(qint64(groupSums.size() / 3), 1);
+        }
+    });
+    for (qint64 p = 0; p < pointCount; ++p)
+        pointFirst[p + 1] += pointFirst[p];
+    const qint64 outputCount = pointFirst[pointCount];
+
+    /* 4. The output points with their normals */
+    auto normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetName("Normals");
+    normals->SetNumberOfComponents(3);
+    normals->SetNumberOfTuples(outputCount);
+    float* normalData = normals->GetPointer(0);
+    std::fill(normalData, normalData + 3 * outputCount, 0.f);
+
+    auto output = vtkSmartPointer<vtkPolyData>::New();
+    output->GetCellData()->PassData(polyData->GetCellData());
+
+    if (outputCount == pointCount) {
+        /* Nothing was split, so the points and cells are shared with the input */
+        MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+            for (qint64 p = begin; p < end; ++p) {
+                if (pointStart[p + 1] > pointStart[p])
+                    std::memcpy(normalData + 3 * p, &cornerNormals[3 * size_t(pointCorners[pointStart[p]])],
+                                3 * sizeof(float));
+            }
+        });
+        output->SetPoints(polyData->GetPoints());
+        output->SetPolys(polyData->GetPolys());
+        output->GetPointData()->PassData(polyData->GetPointData());
+        output->GetPointData()->SetNormals(normals);
+        return output;
+    }
+
+    auto pointArray = vtkSmartPointer<vtkFloatArray>::New();
+    pointArray->SetNumberOfComponents(3);
+    pointArray->SetNumberOfTuples(outputCount);
+    float* pointData = pointArray->GetPointer(0);
+    std::vector<quint32> pointSources(static_cast<size_t>(outputCount));
+    MeshUtils::parallelFor(pointCount, [&](qint64 begin, qint64 end) {
+        double x[3];
+        for (qint64 p = begin; p < end; ++p) {
+            sourcePoints->GetTuple(p, x);
+            for (qint64 q = pointFirst[p]; q < pointFirst[p + 1]; ++q) {
+                for (int k = 0; k < 3; ++k)
+                    pointData[3 * q + k] = static_cast<float>(x[k]);
+                pointSources[q] = static_cast<quint32>(p);
+            }
+            for (quint32 i = pointStart[p]; i < pointStart[p + 1]; ++i) {
+                const quint32 c = pointCorners[i];
+                std::memcpy(normalData + 3 * (pointFirst[p] + cornerSlots[c]), &cornerNormals[3 * size_t(c)],
+                            3 * sizeof(float));
+            }
+        }
+    });
+
+    auto newConnectivity = vtkSmartPointer<IdArray>::New();
+    newConnectivity->SetNumberOfValues(cornerCount);
+    Id* ids = newConnectivity->GetPointer(0);
+    MeshUtils::parallelFor(cornerCount, [&](qint64 begin, qint64 end) {
+        for (qint64 c = begin; c < end; ++c)
+            ids[c] = static_cast<Id>(pointFirst[connectivity[c]] + cornerSlots[c]);
+    });
+
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(pointArray);
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsetsArray, newConnectivity);
+    output->SetPoints(points);
+    output->SetPolys(polys);
+
+    /* Any other point data follows its point to every copy */
+    vtkPointData* source = polyData->GetPointData();
+    if (source->GetNumberOfArrays() > 0) {
+        vtkPointData* target = output->GetPointData();
+        target->CopyNormalsOff();
+        target->CopyAllocate(source, outputCount);
+        for (qint64 q = 0; q < outputCount; ++q)
+            target->CopyData(source, pointSources[q], q);
+    }
+    output->GetPointData()->SetNormals(normals);
+    return output;
+}
+
+}
+
+/**
+ * @brief Builds a triangle polydata from point and index buffers.
+ */
+vtkSmartPointer<vtkPolyData> MeshUtils::makePolyData(const float* points, qint64 pointCount,
+                                                     const quint32* indices, qint64 triangleCount) {
+    auto pointArray = vtkSmartPointer<vtkFloatArray>::New();
+    pointArray->SetNumberOfComponents(3);
+    pointArray->SetNumberOfTuples(pointCount);
+    std::memcpy(pointArray->GetPointer(0), points, size_t(pointCount) * 3 * sizeof(float));
+
+    auto vtkpoints = vtkSmartPointer<vtkPoints>::New();
+    vtkpoints->SetData(pointArray);
+
+    /* Fill offsets and connectivity directly rather than inserting one cell at a time */
+    auto offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+    offsets->SetNumberOfValues(triangleCount + 1);
+    auto connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(triangleCount * 3);
+
+    vtkIdType* offsetPtr = offsets->GetPointer(0);
+    vtkIdType* connPtr = connectivity->GetPointer(0);
+    for (vtkIdType t = 0; t <= triangleCount; ++t)
+        offsetPtr[t] = 3 * t;
+    for (vtkIdType i = 0; i < triangleCount * 3; ++i)
+        connPtr[i] = indices[i];
+
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsets, connectivity);
+
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(vtkpoints);
+    polyData->SetPolys(polys);
+    return polyData;
+}
+
+/**
+ * @brief Welds a triangle soup into unique points and triangle indices.
+ * @details Four parallel passes: hash every vertex, count vertices per (block, partition),
+ *          scatter vertex ids into partition order, then weld each partition with its own
+ *          hash map. Unique points keep the order in which they were first seen within
+ *          their partition, so the result is deterministic.
+ */
+void MeshUtils::weld(const std::vector<float>& soup, std::vector<float>& points, std::vector<quint32>& indices) {
+    const qint64 n = static_cast<qint64>(soup.size() / 3);
+    indices.assign(static_cast<size_t>(n), 0);
+    points.clear();
+    if (n == 0)
+        return;
+
+    /* 1. Partition of each vertex from the top bits of its hash */
+    std::vector<quint8> partition(static_cast<size_t>(n));
+    parallelFor(n, [&](qint64 begin, qint64 end) {
+        for (qint64 i = begin; i < end; ++i)
+            partition[i] = static_cast<quint8>(hashKey(keyOf(&soup[3 * i])) >> (64 - WeldPartitionBits));
+    });
+
+    /* 2. Count per fixed block so the scatter below can run without locks */
+    const qint64 blockSize = 1 << 16;
+    const qint64 blocks = (n + blockSize - 1) / blockSize;
+    std::vector<qint64> counts(static_cast<size_t>(blocks * WeldPartitions), 0);
+    parallelFor(blocks, [&](qint64 begin, qint64 end) {
+        for (qint64 b = begin; b < end; ++b) {
+            qint64* count = &counts[b * WeldPartitions];
+            for (qint64 i = b * blockSize; i < std::min(n, (b + 1) * blockSize); ++i)
+                ++count[partition[i]];
+        }
+    }, 1);
+
+    /* Exclusive prefix sum in partition-major order gives each block its write position */
+    std::vector<qint64> partitionStart(WeldPartitions + 1, 0);
+    qint64 running = 0;
+    for (int p = 0; p < WeldPartitions; ++p) {
+        partitionStart[p] = running;
+        for (qint64 b = 0; b < blocks; ++b) {
+            qint64 c = counts[b * WeldPartitions + p];
+            counts[b * WeldPartitions + p] = running;
+            running += c;
+        }
+    }
+    partitionStart[WeldPartitions] = running;
+
+    /* 3. Scatter vertex ids into partition order, stable within each partition */
+    std::vector<quint32> order(static_cast<size_t>(n));
+    parallelFor(blocks, [&](qint64 begin, qint64 end) {
+        for (qint64 b = begin; b < end; ++b) {
+            qint64* position = &counts[b * WeldPartitions];
+            for (qint64 i = b * blockSize; i < std::min(n, (b + 1) * blockSize); ++i)
+                order[position[partition[i]]++] = static_cast<quint32>(i);
+        }
+    }, 1);
+
+    /* 4. Weld each partition on its own, recording the first vertex of every unique point */
+    std::vector<std::vector<quint32>> uniques(WeldPartitions);
+    parallelFor(WeldPartitions, [&](qint64 begin, qint64 end) {
+        for (qint64 p = begin; p < end; ++p) {
+            const qint64 first = partitionStart[p], last = partitionStart[p + 1];
+            std::unordered_map<VertexKey, quint32, VertexKeyHash> map;
+            map.reserve(static_cast<size_t>(last - first));
+            for (qint64 k = first; k < last; ++k) {
+                quint32 vertex = order[k];
+                auto inserted = map.try_emplace(keyOf(&soup[3 * size_t(vertex)]), static_cast<quint32>(uniques[p].size()));
+                if (inserted.second)
+                    uniques[p].push_back(vertex);
+                indices[vertex] = inserted.first->second;
+            }
+        }
+    }, 1);
+
+    /* 5. Offset local ids by the number of unique points in earlier partitions and copy points */
+    std::vector<quint32> base(WeldPartitions + 1, 0);
+    for (int p = 0; p < WeldPartitions; ++p)
+        base[p + 1] = base[p] + static_cast<quint32>(uniques[p].size());
+    points.resize(size_t(base[WeldPartitions]) * 3);
+
+    parallelFor(WeldPartitions, [&](qint64 begin, qint64 end) {
+        for (qint64 p = begin; p < end; ++p) {
+            for (size_t j = 0; j < uniques[p].size(); ++j)
+                std::memcpy(&points[3 * (base[p] + j)], &soup[3 * size_t(uniques[p][j])], 3 * sizeof(float));
+            for (qint64 k = partitionStart[p]; k < partitionStart[p + 1]; ++k)
+                indices[order[k]] += base[p];
+        }
+    }, 1);
+}
+
+/**
+ * @brief Checks the mesh and dispatches on the width of its cell ids.
+ */
+vtkSmartPointer<vtkPolyData> MeshUtils::generateNormals(vtkPolyData* polyData, double featureAngle) {
+    if (!polyData || !polyData->GetPoints() || polyData->GetNumberOfPolys() == 0
+        || polyData->GetNumberOfVerts() || polyData->GetNumberOfLines() || polyData->GetNumberOfStrips())
+        return nullptr;
+
+    /* Corners and points are counted in 32 bits, like the geometry block stores them */
+    vtkCellArray* polys = polyData->GetPolys();
+    if (polys->GetNumberOfConnectivityIds() > std::numeric_limits<quint32>::max()
+        || polyData->GetNumberOfPoints() > std::numeric_limits<quint32>::max())
+        return nullptr;
+
+    const double cosAngle = std::cos(vtkMath::RadiansFromDegrees(std::clamp(featureAngle, 0., 180.)));
+    if (polys->IsStorage64Bit())
+        return splitNormals(polyData, polys->GetOffsetsArray64(), polys->GetConnectivityArray64(), cosAngle);
+    return splitNormals(polyData, polys->GetOffsetsArray32(), polys->GetConnectivityArray32(), cosAngle);
+}
+
+/**
+ * @brief Sorts the triangles spatially if asked, optimises the runs in parallel and renumbers
+ *        the points by first use.
+ */
+vtkSmartPointer<vtkPolyData> MeshUtils::reorder(vtkPolyData* polyData, bool spatial) {
+    if (!polyData || !polyData->GetPoints() || polyData->GetNumberOfPolys() == 0
+        || polyData->GetNumberOfVerts() || polyData->GetNumberOfLines() || polyData->GetNumberOfStrips())
+        return nullptr;
+    vtkCellArray* polys = polyData->GetPolys();
+    const qint64 triangleCount = polys->GetNumberOfCells();
+    const qint64 pointCount = polyData->GetNumberOfPoints();
+    if (polys->IsHomogeneous() != 3 || 3 * triangleCount > std::numeric_limits<quint32>::max()
+        || pointCount >= std::numeric_limits<quint32>::max())
+        return nullptr;
+
+    std::vector<quint32> indices(static_cast<size_t>(3 * triangleCount));
+    if (polys->IsStorage64Bit())
+        narrowIds(polys->GetConnectivityArray64()->GetPointer(0), indices.data(), 3 * triangleCount);
+    else
+        narrowIds(polys->GetConnectivityArray32()->GetPointer(0), indices.data(), 3 * triangleCount);
+
+    /* 1. Triangles along a Morton curve through their centres, 10 bits per axis */
+    std::vector<quint32> order(static_cast<size_t>(triangleCount));
+    if (spatial) {
+        double bounds[6];
+        polyData->GetBounds(bounds);
+        vtkDataArray* points = polyData->GetPoints()->GetData();
+        std::vector<quint64> keys(static_cast<size_t>(triangleCount));
+        parallelFor(triangleCount, [&](qint64 begin, qint64 end) {
+            double corner[3][3];
+            for (qint64 t = begin; t < end; ++t) {
+                for (int i = 0; i < 3; ++i)
+                    points->GetTuple(indices[3 * t + i], corner[i]);
+                quint32 code = 0;
+                for (int k = 0; k < 3; ++k) {
+                    const double extent = bounds[2 * k + 1] - bounds[2 * k];
+                    const double centre = (corner[0][k] + corner[1][k] + corner[2][k]) / 3.;
+                    const long cell = extent > 0. ? std::lround((centre - bounds[2 * k]) / extent * 1023.) : 0;
+                    code |= spreadBits(quint32(std::clamp(cell, 0L, 1023L))) << k;
+                }
+                keys[t] = quint64(code) << 32 | quint64(t);
+            }
+        });
+        std::sort(keys.begin(), keys.end());
+        parallelFor(triangleCount, [&](qint64 begin, qint64 end) {
+            for (qint64 t = begin; t < end; ++t)
+                order[t] = static_cast<quint32>(keys[t]);
+        });
+    } else {
+        std::iota(order.begin(), order.end(), 0u);
+    }
+
+    /* 2. Vertex cache order within each run */
+    const VertexScores scores;
+    const qint64 runs = (triangleCount + ReorderRunSize - 1) / ReorderRunSize;
+    parallelFor(runs, [&](qint64 begin, qint64 end) {
+        for (qint64 r = begin; r < end; ++r) {
+            const qint64 first = r * ReorderRunSize;
+            forsythOrder(indices.data(), order.data() + first, std::min(ReorderRunSize, triangleCount - first), scores);
+        }
+    }, 1);
+
+    /* 3. Points in the order the triangles first use them, unused points last */
+    const quint32 unused = std::numeric_limits<quint32>::max();
+    std::vector<quint32> newIndex(static_cast<size_t>(pointCount), unused);
+    vtkNew<vtkIdList> pointSources;
+    pointSources->SetNumberOfIds(pointCount);
+    vtkIdType used = 0;
+    auto connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(3 * triangleCount);
+    vtkIdType* ids = connectivity->GetPointer(0);
+    for (qint64 t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            const quint32 p = indices[3 * size_t(order[t]) + k];
+            if (newIndex[p] == unused) {
+                newIndex[p] = static_cast<quint32>(used);
+                pointSources->SetId(used++, p);
+            }
+            ids[3 * t + k] = newIndex[p];
+        }
+    }
+    for (qint64 p = 0; p < pointCount; ++p) {
+        if (newIndex[p] == unused)
+            pointSources->SetId(used++, p);
+    }
+
+    auto offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+    offsets->SetNumberOfValues(triangleCount + 1);
+    vtkIdType* offsetPtr = offsets->GetPointer(0);
+    parallelFor(triangleCount + 1, [&](qint64 begin, qint64 end) {
+        for (qint64 t = begin; t < end; ++t)
+            offsetPtr[t] = 3 * t;
+    });
+    auto cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(offsets, connectivity);
+
+    vtkDataArray* sourcePoints = polyData->GetPoints()->GetData();
+    auto pointArray = vtkSmartPointer<vtkDataArray>::Take(sourcePoints->NewInstance());
+    pointArray->SetNumberOfComponents(3);
+    pointArray->SetNumberOfTuples(pointCount);
+    sourcePoints->GetTuples(pointSources, pointArray);
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(pointArray);
+
+    auto output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(points);
+    output->SetPolys(cells);
+
+    /* Attributes follow their points and triangles */
+    if (polyData->GetPointData()->GetNumberOfArrays() > 0) {
+        vtkNew<vtkIdList> targets;
+        targets->SetNumberOfIds(pointCount);
+        std::iota(targets->begin(), targets->end(), vtkIdType(0));
+        output->GetPointData()->CopyAllocate(polyData->GetPointData(), pointCount);
+        output->GetPointData()->CopyData(polyData->GetPointData(), pointSources, targets);
+    }
+    if (polyData->GetCellData()->GetNumberOfArrays() > 0) {
+        vtkNew<vtkIdList> sources, targets;
+        sources->SetNumberOfIds(triangleCount);
+        targets->SetNumberOfIds(triangleCount);
+        for (qint64 t = 0; t < triangleCount; ++t) {
+            sources->SetId(t, order[t]);
+            targets->SetId(t, t);
+        }
+        output->GetCellData()->CopyAllocate(polyData->GetCellData(), triangleCount);
+        output->GetCellData()->CopyData(polyData->GetCellData(), sources, targets);
+    }
+    return output;
+}
+
+/**
+ * @brief Simulates the cache over the triangles in cell order.
+ */
+double MeshUtils::cacheMissRatio(vtkPolyData* polyData, int cacheSize) {
+    if (!polyData || !polyData->GetPolys() || cacheSize <= 0)
+        return 0.;
+
+    std::vector<quint32> indices;
+    indices.reserve(static_cast<size_t>(polyData->GetNumberOfPolys()) * 3);
+    auto it = vtk::TakeSmartPointer(polyData->GetPolys()->NewIterator());
+    for (it->GoToFirstCell(); !it->IsDoneWithTraversal(); it->GoToNextCell()) {
+        vtkIdType npts;
+        const vtkIdType* pts;
+        it->GetCurrentCell(npts, pts);
+        for (vtkIdType k = 1; k + 1 < npts; ++k) {
+            indices.push_back(static_cast<quint32>(pts[0]));
+            indices.push_back(static_cast<quint32>(pts[k]));
+            indices.push_back(static_cast<quint32>(pts[k + 1]));
+        }
+    }
+    if (indices.empty())
+        return 0.;
+    return double(fifoMisses(indices.data(), qint64(indices.size()), cacheSize)) / double(indices.size() / 3);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file MetricsEngine.cpp
+ * @brief Implementation of the MetricsEngine class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "MetricsEngine.h"
+#include "ModelPart.h"
+#include "ModelPartList.h"
+#include "Trace.h"
+
+#include <QtConcurrent>
+
+/**
+ * @brief Sets up the coalescing timer and the batch watcher.
+ */
+MetricsEngine::MetricsEngine(ModelPartList* list, QObject* parent)
+    : QObject(parent), partList(list), updateWanted(false) {
+    updateTimer.setSingleShot(true);
+    updateTimer.setInterval(0);
+    connect(&updateTimer, &QTimer::timeout, this, &MetricsEngine::update);
+    connect(&watcher, &QFutureWatcher<void>::finished, this, &MetricsEngine::finished);
+}
+
+/**
+ * @brief Lets the workers finish with their copies of the geometry.
+ */
+MetricsEngine::~MetricsEngine() {
+    watcher.waitForFinished();
+}
+
+/**
+ * @brief Starts the timer, or remembers the request while a batch runs.
+ */
+void MetricsEngine::requestUpdate() {
+    if (watcher.isRunning())
+        updateWanted = true;
+    else if (!updateTimer.isActive())
+        updateTimer.start();
+}
+
+/**
+ * @brief Walks the tree and measures the outdated parts on the thread pool.
+ */
+void MetricsEngine::update() {
+    TRACE_SCOPE("MetricsEngine::update");
+
+    if (watcher.isRunning()) {
+        updateWanted = true;
+        return;
+    }
+    updateWanted = false;
+
+    /* Moved parts get their new world matrix, and so show up as outdated */
+    partList->getRootItem()->updateWorldMatrices();
+
+    QVector<Job> jobs;
+    QList<ModelPart*> stack = { partList->getRootItem() };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        for (int i = 0; i < part->childCount(); ++i)
+            stack.append(part->child(i));
+        if (!part->metricsOutdated())
+            continue;
+
+        vtkPolyData* geometry = part->getStoredGeometry();
+
+        /* The workers read their own copy of the data object, the arrays themselves are shared */
+        Job job;
+        job.index = partList->indexOf(part);
+        job.part = part;
+        job.geometry = vtkSmartPointer<vtkPolyData>::New();
+        job.geometry->ShallowCopy(geometry);
+        /* The same matrix a VR actor uses: the world matrix after any dequantisation */
+        double matrix[16];
+        part->getVRMatrix(matrix);
+        job.matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+        job.matrix->DeepCopy(matrix);
+        if (job.matrix->IsIdentity())
+            job.matrix = nullptr;
+        job.time = geometry->GetMTime();
+        job.placement = part->placementStamp();
+        jobs.append(job);
+    }
+    if (jobs.isEmpty())
+        return;
+
+    running = jobs;
+    watcher.setFuture(QtConcurrent::map(running, [](Job& job) {
+        job.metrics = MeshMetrics::compute(job.geometry, job.matrix);
+        job.geometry = nullptr;
+    }));
+}
+
+/**
+ * @brief Gives each part its metrics unless it was deleted or given new geometry meanwhile; a part
+ *        moved meanwhile keeps the old placement stamp, so the next batch measures it again.
+ */
+void MetricsEngine::finished() {
+    for (const Job& job : std::as_const(running)) {
+        if (!job.index.isValid() || partList->getItem(job.index) != job.part)
+            continue;
+        vtkPolyData* geometry = job.part->getStoredGeometry();
+        if (geometry && geometry->GetMTime() == job.time)
+            job.part->setMetrics(job.metrics, job.time, job.placement);
+    }
+    running.clear();
+    emit metricsUpdated();
+
+    if (updateWanted)
+        requestUpdate();
+}
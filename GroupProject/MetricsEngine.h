@@ -0,0 +1,95 @@
+/**
+ * @file MetricsEngine.h
+ * @brief Declaration of the MetricsEngine class, which measures parts in the background.
+ * @details After parts are loaded or their geometry changes, the engine collects every part whose
+ *          MeshMetrics are missing or out of date and measures them on the global thread pool,
+ *          several parts at once and large parts split into blocks. Parts are measured where they
+ *          are placed in the scene, through their world matrix, and measured again when they move.
+ *          The results are stored in the parts' Stats, where the tree adds them up per
+ *          subassembly like the cost columns.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_METRICSENGINE_H
+#define VIEWER_METRICSENGINE_H
+
+#include "MeshMetrics.h"
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QPersistentModelIndex>
+#include <QTimer>
+#include <QVector>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkMatrix4x4.h>
+
+class ModelPart;
+class ModelPartList;
+
+/**
+ * @class MetricsEngine
+ * @brief Keeps the metrics of every part in a ModelPartList up to date.
+ * @details Must be used on the GUI thread. One batch of parts is measured at a time; changes made
+ *          while a batch runs are picked up by the next one.
+ */
+class MetricsEngine : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs an idle engine.
+     * @param partList Model holding the parts.
+     * @param parent Optional QObject parent.
+     */
+    MetricsEngine(ModelPartList* partList, QObject* parent = nullptr);
+
+    /**
+     * @brief Waits for the running batch, its results are dropped.
+     */
+    ~MetricsEngine();
+
+    /**
+     * @brief Looks for parts to measure once control returns to the event loop.
+     * @details Cheap to call often, e.g. after every change to the tree.
+     */
+    void requestUpdate();
+
+signals:
+    /**
+     * @brief Emitted after a batch of parts has been given new metrics.
+     */
+    void metricsUpdated();
+
+private:
+    /** One part to measure */
+    struct Job {
+        QPersistentModelIndex           index;      /**< Part the metrics are for */
+        ModelPart*                      part;       /**< Part, only compared, never dereferenced by workers */
+        vtkSmartPointer<vtkPolyData>    geometry;   /**< Shallow copy of the stored geometry */
+        vtkSmartPointer<vtkMatrix4x4>   matrix;     /**< World matrix after any compact dequantisation, null for the identity */
+        vtkMTimeType                    time;       /**< Modification time of the geometry */
+        quint64                         placement;  /**< Placement stamp of the world matrix */
+        MeshMetrics                     metrics;    /**< Set by the worker */
+    };
+
+    /**
+     * @brief Starts a batch with every part whose metrics are out of date.
+     */
+    void update();
+
+    /**
+     * @brief Stores the results of the finished batch.
+     */
+    void finished();
+
+    ModelPartList*          partList;       /**< Model holding the parts */
+    QTimer                  updateTimer;    /**< Coalesces update requests */
+    QFutureWatcher<void>    watcher;        /**< Watches the running batch */
+    QVector<Job>            running;        /**< Jobs of the running batch */
+    bool                    updateWanted;   /**< An update was requested while a batch was running */
+};
+
+#endif
@@ -8,6 +8,13 @@
  */
 
 #include "ModelPart.h"
+#include "MeshImporter.h"
+#include "GeometryCache.h"
+#include "Trace.h"
+
+#include <QFile>
+#include <QElapsedTimer>
+#include <QFileInfo>
 
 
 /* Commented out for now, will be uncommented later when you have
@@ -19,6 +26,18 @@
 #include <vtkPlane.h>
 #include <vtkClipDataSet.h>
 #include <vtkShrinkFilter.h>
+#include <vtkNew.h>
+#include <vtkMath.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/** Whether geometry given to setPolyData() is stored compactly */
+bool compactStorage = false;
+
+}
 
 
 /**
@@ -29,9 +48,15 @@
 ModelPart::ModelPart(const QList<QVariant>& data, ModelPart* parent )
     : m_itemData(data), m_parentItem(parent), isVisible(true),
     clipFilter(false), shrinkFilter(false),
-    actor(nullptr), mapper(nullptr)  {
+    released(false), viewedTick(0), subtreeDirty(true), metricsTime(0), metricsPlacement(0), mapper(nullptr), actor(nullptr)  {
     colour.Set(100,100,100);
     /* You probably want to give the item a default colour */
+    vtkMatrix4x4::Identity(localMatrix);
+    vtkMatrix4x4::Identity(world);
+    worldStamp = 0;
+    transformDirty = true;
+    subtreeTransformDirty = false;
+    animated = false;
 }
 
 /**
@@ -39,6 +64,8 @@ ModelPart::ModelPart(const QList<QVariant>& data, ModelPart* parent )
  */
 ModelPart::~ModelPart() {
     qDeleteAll(m_childItems);
+    if (!spillFile.isEmpty())
+        QFile::remove(spillFile);
 }
 
 /**
@@ -51,6 +78,8 @@ void ModelPart::appendChild( ModelPart* item ) {
      */
     item->m_parentItem = this;
     m_childItems.append(item);
+    invalidateStats();
+    item->invalidateTransform();
 }
 
 /**
@@ -191,34 +220,218 @@ bool ModelPart::visible() {
 }
 
 /**
- * @brief Loads an STL file and creates associated VTK mapper and actor.
- * @param fileName Path to the STL file.
+ * @brief Loads a mesh file and creates associated VTK mapper and actor.
+ * @param fileName Path to an STL, OBJ or PLY file.
  */
 void ModelPart::loadSTL( QString fileName ) {
-    /* This is a placeholder function that you will need to modify if you want to use it */
+    TRACE_SCOPE("ModelPart::loadSTL");
 
-    /* 1. Use the vtkSTLReader class to load the STL file
-     *     https://vtk.org/doc/nightly/html/classvtkSTLReader.html
+    /* 1. Read the file with the reader registered for its extension
+     *     (vtkSTLReader for binary STL, see MeshImporter)
      */
-    file = vtkSmartPointer<vtkSTLReader>::New();
-    file->SetFileName(fileName.toStdString().c_str());
-    file->Update();
+    double loadMs = 0.;
+    vtkSmartPointer<vtkPolyData> polyData = MeshImporter::read(fileName, &loadMs);
+    if (!polyData)
+        return;
+
+    sourceFile = fileName;
+
+    /* 2. Initialise the part's vtkMapper and vtkActor and link them to the geometry */
+    setPolyData(polyData);
+    setLoadTime(loadMs);
+}
+
+/**
+ * @brief Sets the part's geometry, creating the mapper and actor if needed.
+ * @param polyData Geometry to display.
+ */
+void ModelPart::setPolyData(vtkPolyData* polyData) {
+    if (!spillFile.isEmpty()) {
+        QFile::remove(spillFile);
+        spillFile.clear();
+    }
+    released = false;
 
-    /* 2. Initialise the part's vtkMapper */
-    mapper = vtkSmartPointer<vtkDataSetMapper>::New();
-    mapper->SetInputConnection(file->GetOutputPort());
+    compact = compactStorage ? CompactMesh::encode(polyData) : CompactMesh();
+    decoded = nullptr;
 
+    if (!file)
+        file = vtkSmartPointer<vtkTrivialProducer>::New();
+    file->SetOutput(compact.isValid() ? compact.polyData() : polyData);
 
-    /* 3. Initialise the part's vtkActor and link to the mapper */
+    ownStats.triangles = polyData->GetNumberOfPolys();
+    ownStats.points = polyData->GetNumberOfPoints();
 
-    actor = vtkSmartPointer<vtkActor>::New();
-    actor->SetMapper(mapper);
-    actor->GetProperty()->SetColor(
-        colour.GetRed()   / 255.0,
-        colour.GetGreen() / 255.0,
-        colour.GetBlue()  / 255.0
-        );
-    actor->SetVisibility(isVisible);
+    if (!mapper)
+        mapper = vtkSmartPointer<vtkDataSetMapper>::New();
+
+    if (!actor) {
+        actor = vtkSmartPointer<vtkActor>::New();
+        actor->SetMapper(mapper);
+    }
+
+    /* Rebuild the filter chain on top of the new geometry, this also applies
+     * the current colour and visibility to the actor */
+    setFilter();
+}
+
+/**
+ * @brief Returns the unfiltered geometry of this part, decoding it if the part is compact.
+ */
+vtkSmartPointer<vtkPolyData> ModelPart::getPolyData() {
+    if (!file)
+        return nullptr;
+    if (released)
+        return spillFile.isEmpty() ? MeshImporter::read(sourceFile) : GeometryCache::readEntry(spillFile);
+    if (compact.isValid())
+        return compact.decode();
+    return vtkPolyData::SafeDownCast(file->GetOutputDataObject(0));
+}
+
+/**
+ * @brief Returns the geometry in the trivial producer, quantised for a compact part.
+ */
+vtkPolyData* ModelPart::getStoredGeometry(vtkMatrix4x4** matrix) const {
+    if (matrix)
+        *matrix = compact.isValid() ? compact.matrix() : nullptr;
+    if (!file || released)
+        return nullptr;
+    return vtkPolyData::SafeDownCast(file->GetOutputDataObject(0));
+}
+
+/**
+ * @brief Converts the part's geometry to or from compact storage.
+ * @param compactGeometry True to quantise the geometry, false to restore float geometry.
+ */
+void ModelPart::setCompact(bool compactGeometry) {
+    if (!file || released || compactGeometry == isCompact())
+        return;
+
+    vtkSmartPointer<vtkPolyData> polyData = getPolyData();
+    if (compactGeometry) {
+        CompactMesh mesh = CompactMesh::encode(polyData);
+        if (!mesh.isValid())
+            return;
+        compact = mesh;
+        file->SetOutput(compact.polyData());
+    } else {
+        compact = CompactMesh();
+        file->SetOutput(polyData);
+    }
+    decoded = nullptr;
+
+    setFilter();
+}
+
+/**
+ * @brief Returns whether the geometry is stored compactly.
+ */
+bool ModelPart::isCompact() const {
+    return compact.isValid();
+}
+
+/**
+ * @brief Returns the memory saved by compact storage.
+ */
+qint64 ModelPart::memorySaved() const {
+    if (!compact.isValid())
+        return 0;
+    return std::max<qint64>(0, compact.originalMemorySize() - compact.memorySize());
+}
+
+/**
+ * @brief Returns the bytes held by the geometry, any decoded copy and the filter output.
+ */
+qint64 ModelPart::memorySize() const {
+    if (!file || released)
+        return 0;
+
+    vtkDataObject* source = file->GetOutputDataObject(0);
+    qint64 kib = compact.isValid() ? compact.memorySize() / 1024 : source->GetActualMemorySize();
+    if (decoded)
+        kib += decoded->GetOutputDataObject(0)->GetActualMemorySize();
+    if (vtkDataSet* input = mapper->GetInputAsDataSet())
+        if (input != source && (!decoded || input != decoded->GetOutputDataObject(0)))
+            kib += input->GetActualMemorySize();
+    return kib * 1024;
+}
+
+/**
+ * @brief Frees the geometry, spilling it to a file first if it has no readable source.
+ * @param spill File to write the geometry to when needed.
+ * @return true if the geometry was released
+ */
+bool ModelPart::releaseGeometry(const QString& spill) {
+    if (!file || released)
+        return false;
+
+    if (sourceFile.isEmpty() || !QFileInfo::exists(sourceFile)) {
+        vtkSmartPointer<vtkPolyData> polyData = getPolyData();
+        if (!GeometryCache::writeEntry(spill, polyData))
+            return false;
+        spillFile = spill;
+    }
+
+    compact = CompactMesh();
+    decoded = nullptr;
+    file->SetOutput(vtkSmartPointer<vtkPolyData>::New());
+    released = true;
+
+    /* Drops the filter pipeline's output too */
+    setFilter();
+    return true;
+}
+
+/**
+ * @brief Returns whether the geometry has been released.
+ */
+bool ModelPart::isReleased() const {
+    return released;
+}
+
+/**
+ * @brief Records when the part was last visible.
+ * @param tick Increasing counter value.
+ */
+void ModelPart::markViewed(quint64 tick) {
+    viewedTick = tick;
+}
+
+/**
+ * @brief Returns when the part was last visible.
+ */
+quint64 ModelPart::lastViewed() const {
+    return viewedTick;
+}
+
+/**
+ * @brief Sets whether new geometry is stored compactly.
+ * @param compactGeometry True to quantise geometry passed to setPolyData().
+ */
+void ModelPart::setCompactByDefault(bool compactGeometry) {
+    compactStorage = compactGeometry;
+}
+
+/**
+ * @brief Returns whether new geometry is stored compactly.
+ */
+bool ModelPart::compactByDefault() {
+    return compactStorage;
+}
+
+/**
+ * @brief Returns the path of the file the geometry was loaded from.
+ */
+QString ModelPart::getFileName() const {
+    return sourceFile;
+}
+
+/**
+ * @brief Sets the path of the file the geometry was loaded from.
+ * @param fileName Path to the source file.
+ */
+void ModelPart::setFileName(const QString& fileName) {
+    sourceFile = fileName;
 }
 /**
  * @brief Returns the current VTK actor for GUI rendering.
@@ -234,7 +447,7 @@ vtkSmartPointer<vtkActor> ModelPart::getActor() {
  * @brief Creates a new VTK actor for VR rendering, using a fresh mapper.
  * @return Pointer to the new VTK actor.
  */
-vtkActor* ModelPart::getNewActor() {
+vtkSmartPointer<vtkActor> ModelPart::getNewActor() {
     /* This is a placeholder function that you will need to modify if you want to use it
      * 
      * The default mapper/actor combination can only be used to render the part in 
@@ -243,9 +456,16 @@ vtkActor* ModelPart::getNewActor() {
      * of this function. */
      
      
-     /* 1. Create new mapper */
+     /* 1. Create new mapper. It gets a polydata of its own rather than the part's producer,
+      *    which the GUI thread swaps when the geometry is reloaded or released while the VR
+      *    thread renders. The arrays are shared, nothing changes them in place. */
+    auto geometry = vtkSmartPointer<vtkPolyData>::New();
+    if (vtkPolyData* stored = getStoredGeometry())
+        geometry->ShallowCopy(stored);
+    else if (vtkSmartPointer<vtkPolyData> reread = getPolyData())
+        geometry->ShallowCopy(reread);      // Released, so read again
     auto newMapper = vtkSmartPointer<vtkDataSetMapper>::New();
-    newMapper->SetInputConnection(file->GetOutputPort());
+    newMapper->SetInputData(geometry);
      
      /* 2. Create new actor and link to mapper */
     auto newActor = vtkSmartPointer<vtkActor>::New();
@@ -260,9 +480,17 @@ vtkActor* ModelPart::getNewActor() {
       */
     newActor->SetProperty(actor->GetProperty());
     newActor->SetVisibility(isVisible);
+
+    /* The VR actor always shows the unfiltered geometry, quantised if the part is compact. Its
+     * matrix is its own: the VR thread renders it, so only that thread may change it later */
+    double placement[16];
+    getVRMatrix(placement);
+    auto matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    matrix->DeepCopy(placement);
+    newActor->SetUserMatrix(matrix);
     
 
-    /* The new vtkActor pointer must be returned here */
+    /* Returned as a smart pointer, a raw pointer would outlive the only reference */
     return newActor;
     
 }
@@ -274,6 +502,24 @@ void ModelPart::setFilter()
     if (!file) {
         return;
     }
+    TRACE_SCOPE("ModelPart::setFilter");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    /* Compact parts render their quantised points through the actor's user matrix, but
+     * filters work in model coordinates and are fed decoded float geometry instead */
+    vtkSmartPointer<vtkTrivialProducer> source = file;
+    if (compact.isValid() && (clipFilter || shrinkFilter)) {
+        if (!decoded) {
+            decoded = vtkSmartPointer<vtkTrivialProducer>::New();
+            decoded->SetOutput(compact.decode());
+        }
+        source = decoded;
+    } else {
+        decoded = nullptr;
+    }
+    updateActorMatrix();
 
     if (clipFilter && shrinkFilter) {
 
@@ -283,7 +529,7 @@ void ModelPart::setFilter()
         planeLeft->SetNormal(0, 1, 0.0);
 
         vtkSmartPointer<vtkClipDataSet> clip = vtkSmartPointer<vtkClipDataSet>::New();
-        clip->SetInputConnection(file->GetOutputPort());
+        clip->SetInputConnection(source->GetOutputPort());
         clip->SetClipFunction(planeLeft.Get());
 
         vtkSmartPointer<vtkShrinkFilter> shrink = vtkSmartPointer<vtkShrinkFilter>::New();
@@ -300,15 +546,16 @@ void ModelPart::setFilter()
         planeLeft->SetNormal(0.0, 1, 0.0);
 
         vtkSmartPointer<vtkClipDataSet> clip = vtkSmartPointer<vtkClipDataSet>::New();
-        clip->SetInputConnection(file->GetOutputPort());
+        clip->SetInputConnection(source->GetOutputPort());
         clip->SetClipFunction(planeLeft.Get());
+        clip->Update();
 
         mapper->SetInputConnection(clip->GetOutputPort());
     }
 
     else if (shrinkFilter) {
         vtkSmartPointer<vtkShrinkFilter> shrink = vtkSmartPointer<vtkShrinkFilter>::New();
-        shrink->SetInputConnection(file->GetOutputPort());
+        shrink->SetInputConnection(source->GetOutputPort());
         shrink->SetShrinkFactor(0.8);
         shrink->Update();
 
@@ -316,7 +563,7 @@ void ModelPart::setFilter()
     }
 
     else {
-        mapper->SetInputConnection(file->GetOutputPort());
+        mapper->SetInputConnection(source->GetOutputPort());
     }
 
     actor->SetMapper(mapper);
@@ -326,6 +573,11 @@ void ModelPart::setFilter()
         colour.GetBlue()  / 255.0
         );
     actor->SetVisibility(isVisible);
+
+    /* Filters run eagerly above, so this covers their whole cost */
+    ownStats.filterMs = (clipFilter || shrinkFilter) ? timer.nsecsElapsed() / 1e6 : 0.;
+    ownStats.memory = memorySize();
+    invalidateStats();
 }
 /**
  * @brief Returns whether clipping is enabled.
@@ -363,5 +615,258 @@ void ModelPart::setShrink(bool shrink) {
 ModelPart* ModelPart::takeChild(int row) {
     if (row < 0 || row >= m_childItems.size())
         return nullptr;
+    invalidateStats();
     return m_childItems.takeAt(row);
 }
+
+/**
+ * @brief Inserts a child at the specified row.
+ * @param row Row index for the child, clamped to the valid range.
+ * @param item Pointer to the child item.
+ */
+void ModelPart::insertChild(int row, ModelPart* item) {
+    item->m_parentItem = this;
+    m_childItems.insert(std::clamp(row, 0, int(m_childItems.size())), item);
+    invalidateStats();
+    item->invalidateTransform();
+}
+
+/**
+ * @brief Sorts the children, and their children, with a stable sort.
+ * @param lessThan Ordering of two parts.
+ */
+void ModelPart::sortChildren(const std::function<bool(ModelPart*, ModelPart*)>& lessThan) {
+    std::stable_sort(m_childItems.begin(), m_childItems.end(), lessThan);
+    for (ModelPart* child : std::as_const(m_childItems))
+        child->sortChildren(lessThan);
+}
+
+/**
+ * @brief Adds another part's cost to this one.
+ */
+ModelPart::Stats& ModelPart::Stats::operator+=(const Stats& other) {
+    triangles += other.triangles;
+    points    += other.points;
+    memory    += other.memory;
+    loadMs    += other.loadMs;
+    filterMs  += other.filterMs;
+    metrics   += other.metrics;
+    return *this;
+}
+
+/**
+ * @brief Returns this part's own cost.
+ */
+const ModelPart::Stats& ModelPart::stats() const {
+    return ownStats;
+}
+
+/**
+ * @brief Returns the cost of this part and its descendants, recomputing only dirty branches.
+ */
+ModelPart::Stats ModelPart::subtreeStats() const {
+    if (subtreeDirty) {
+        subtreeCache = ownStats;
+        for (const ModelPart* child : m_childItems)
+            subtreeCache += child->subtreeStats();
+        subtreeDirty = false;
+    }
+    return subtreeCache;
+}
+
+/**
+ * @brief Records the load time of this part's geometry.
+ * @param milliseconds Load time.
+ */
+void ModelPart::setLoadTime(double milliseconds) {
+    ownStats.loadMs = milliseconds;
+    invalidateStats();
+}
+
+/**
+ * @brief Stores the metrics and the geometry time and placement they belong to.
+ * @param metrics Measured metrics.
+ * @param geometryTime Modification time of the measured geometry.
+ * @param placement Placement stamp of the world matrix used.
+ */
+void ModelPart::setMetrics(const MeshMetrics& metrics, vtkMTimeType geometryTime, quint64 placement) {
+    ownStats.metrics = metrics;
+    metricsTime = geometryTime;
+    metricsPlacement = placement;
+    invalidateStats();
+}
+
+/**
+ * @brief Compares the metrics' geometry time with the stored geometry, and their placement with
+ *        the world matrix.
+ */
+bool ModelPart::metricsOutdated() const {
+    vtkPolyData* geometry = getStoredGeometry();
+    return geometry && geometry->GetNumberOfPolys() > 0 &&
+           (geometry->GetMTime() != metricsTime || worldStamp != metricsPlacement);
+}
+
+/**
+ * @brief Marks this part's and its ancestors' cached totals as out of date.
+ */
+void ModelPart::invalidateStats() {
+    /* A dirty part always has dirty ancestors, so the walk can stop at the first one */
+    for (ModelPart* part = this; part && !part->subtreeDirty; part = part->m_parentItem)
+        part->subtreeDirty = true;
+}
+
+/**
+ * @brief Compares position, orientation and scale.
+ */
+bool ModelPart::Transform::operator==(const Transform& other) const {
+    return std::equal(position, position + 3, other.position) &&
+           std::equal(orientation, orientation + 3, other.orientation) &&
+           std::equal(scale, scale + 3, other.scale);
+}
+
+/**
+ * @brief Builds the matrix the way vtkProp3D does for an actor with its origin at zero.
+ * @details Written out as T * Rz * Rx * Ry * S so it allocates nothing; animations call it for every
+ *          animated part on every frame.
+ */
+void ModelPart::Transform::toMatrix(double matrix[16]) const {
+    const double ca = std::cos(vtkMath::RadiansFromDegrees(orientation[0]));
+    const double sa = std::sin(vtkMath::RadiansFromDegrees(orientation[0]));
+    const double cb = std::cos(vtkMath::RadiansFromDegrees(orientation[1]));
+    const double sb = std::sin(vtkMath::RadiansFromDegrees(orientation[1]));
+    const double cc = std::cos(vtkMath::RadiansFromDegrees(orientation[2]));
+    const double sc = std::sin(vtkMath::RadiansFromDegrees(orientation[2]));
+    const double rotation[9] = {
+        cc * cb - sc * sa * sb, -sc * ca, cc * sb + sc * sa * cb,
+        sc * cb + cc * sa * sb,  cc * ca, sc * sb - cc * sa * cb,
+        -ca * sb,                sa,      ca * cb
+    };
+
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column)
+            matrix[4 * row + column] = rotation[3 * row + column] * scale[column];
+        matrix[4 * row + 3] = position[row];
+    }
+    matrix[12] = matrix[13] = matrix[14] = 0.;
+    matrix[15] = 1.;
+}
+
+/**
+ * @brief Stores the transform and its matrix, the world matrices follow on the next update.
+ */
+void ModelPart::setTransform(const Transform& transform) {
+    if (transform == localTransform)
+        return;
+    localTransform = transform;
+    localTransform.toMatrix(localMatrix);
+    invalidateTransform();
+}
+
+/**
+ * @brief Returns the local transform.
+ */
+const ModelPart::Transform& ModelPart::transform() const {
+    return localTransform;
+}
+
+/**
+ * @brief Overrides the local matrix until called with nullptr, leaving the stored transform alone.
+ */
+void ModelPart::setAnimationMatrix(const double matrix[16]) {
+    if (matrix)
+        std::copy(matrix, matrix + 16, animationMatrix);
+    else if (!animated)
+        return;
+    animated = matrix != nullptr;
+    invalidateTransform();
+}
+
+/**
+ * @brief Returns true while an animation places the part.
+ */
+bool ModelPart::isAnimated() const {
+    return animated;
+}
+
+/**
+ * @brief Returns the cached world matrix.
+ */
+const double* ModelPart::worldMatrix() const {
+    return world;
+}
+
+/**
+ * @brief Starts the walk from the parent's world matrix, or the identity for the root item.
+ */
+void ModelPart::updateWorldMatrices() {
+    TRACE_SCOPE("ModelPart::updateWorldMatrices");
+
+    double identity[16];
+    vtkMatrix4x4::Identity(identity);
+    updateWorld(m_parentItem ? m_parentItem->world : identity, false);
+}
+
+/**
+ * @brief Flags this part and marks the path from the root so the update walk finds it.
+ */
+void ModelPart::invalidateTransform() {
+    transformDirty = true;
+    /* A flagged part always has flagged ancestors, so the walk can stop at the first one */
+    for (ModelPart* part = m_parentItem; part && !part->subtreeTransformDirty; part = part->m_parentItem)
+        part->subtreeTransformDirty = true;
+}
+
+/**
+ * @brief Multiplies the parent's world matrix by the local one where needed and descends only into
+ *        subtrees that moved or contain a moved part.
+ */
+void ModelPart::updateWorld(const double parentWorld[16], bool parentMoved) {
+    const bool moved = parentMoved || transformDirty;
+    if (moved) {
+        vtkMatrix4x4::Multiply4x4(parentWorld, animated ? animationMatrix : localMatrix, world);
+        ++worldStamp;
+        transformDirty = false;
+        if (actor)
+            updateActorMatrix();
+    }
+    if (moved || subtreeTransformDirty) {
+        for (ModelPart* child : std::as_const(m_childItems))
+            child->updateWorld(world, moved);
+    }
+    subtreeTransformDirty = false;
+}
+
+/**
+ * @brief Composes the world matrix with the compact dequantisation for the stored geometry.
+ */
+void ModelPart::getVRMatrix(double matrix[16]) const {
+    if (compact.isValid())
+        vtkMatrix4x4::Multiply4x4(world, compact.matrix()->GetData(), matrix);
+    else
+        std::copy(world, world + 16, matrix);
+}
+
+/**
+ * @brief Returns the count of world matrix updates.
+ */
+quint64 ModelPart::placementStamp() const {
+    return worldStamp;
+}
+
+/**
+ * @brief Sets the desktop actor's matrix.
+ * @details The desktop actor renders decoded geometry while filters are on, so it only gets the
+ *          world matrix then; otherwise it renders the stored geometry like the VR actors.
+ */
+void ModelPart::updateActorMatrix() {
+    if (!actorMatrix)
+        actorMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+
+    double stored[16];
+    getVRMatrix(stored);
+    actorMatrix->DeepCopy(compact.isValid() && !decoded ? stored : world);
+
+    /* Unplaced parts keep an identity actor, which static batching relies on */
+    if (actor)
+        actor->SetUserMatrix(actorMatrix->IsIdentity() ? nullptr : actorMatrix.Get());
+}
@@ -15,6 +15,8 @@
 #include <QList>
 #include <QVariant>
 
+#include <functional>
+
 /* VTK headers - will be needed when VTK used in next worksheet,
  * commented out for now
  *
@@ -26,13 +28,56 @@
 #include <vtkMapper.h>
 #include <vtkActor.h>
 #include <vtkSTLReader.h>
+#include <vtkPolyData.h>
+#include <vtkTrivialProducer.h>
 #include <vtkColor.h>
+#include <vtkMatrix4x4.h>
+
+#include "CompactMesh.h"
+#include "MeshMetrics.h"
 /**
  * @class ModelPart
  * @brief Represents a single part in a hierarchical model tree and links it to a VTK-rendered entity.
  */
 class ModelPart {
 public:
+    /**
+     * @brief Rendering cost of a part, or of a part and everything below it.
+     */
+    struct Stats {
+        qint64  triangles = 0;      /**< Number of polygons */
+        qint64  points = 0;         /**< Number of points */
+        qint64  memory = 0;         /**< Bytes held by geometry and filter output */
+        double  loadMs = 0.;        /**< Time taken to read the geometry */
+        double  filterMs = 0.;      /**< Time taken by the last filter update */
+        MeshMetrics metrics;        /**< Area, volume, bounds and centre of mass, see MetricsEngine */
+
+        /** Adds another part's cost to this one */
+        Stats& operator+=(const Stats& other);
+    };
+
+    /**
+     * @brief Placement of a part relative to its parent.
+     * @details Applied in the same order as a vtkProp3D: scale, then rotation about y, x and z,
+     *          then translation.
+     */
+    struct Transform {
+        double  position[3] = { 0., 0., 0. };       /**< Translation */
+        double  orientation[3] = { 0., 0., 0. };    /**< Rotation about x, y and z, in degrees */
+        double  scale[3] = { 1., 1., 1. };          /**< Scale factors */
+
+        /** Compares all nine values exactly */
+        bool operator==(const Transform& other) const;
+        /** Compares all nine values exactly */
+        bool operator!=(const Transform& other) const { return !(*this == other); }
+
+        /**
+         * @brief Computes the row-major 4x4 matrix of the transform.
+         * @param matrix Receives 16 values.
+         */
+        void toMatrix(double matrix[16]) const;
+    };
+
     /** Constructor
      * @brief Constructor for a model part.
      * @param data is a List (array) of strings for each property of this item (part name and visiblity in our case
@@ -142,11 +187,109 @@ public:
     bool visible();
 	
 	/** Load STL file
-     *  @brief Loads an STL file into this part.
+     *  @brief Loads a mesh file into this part.
+     *  @details Any format registered with MeshImporter is accepted, not only STL.
       * @param fileName
       */
     void loadSTL(QString fileName);
 
+    /** Set geometry
+     *  @brief Replaces this part's geometry, creating the mapper and actor on first use.
+     *  @details The actor is kept if it already exists, so a part can be updated in place
+     *           without being removed from the renderer. Files can be read on worker threads
+     *           with MeshImporter::read() and then handed to this on the GUI thread.
+     *  @param polyData Geometry to display.
+     */
+    void setPolyData(vtkPolyData* polyData);
+
+    /** Get geometry
+     *  @brief Returns the unfiltered geometry of this part in float precision.
+     *  @details For a compact part this decodes a new copy, so keep the result only as long
+     *           as it is needed.
+     *  @return the polydata, or nullptr if nothing is loaded
+     */
+    vtkSmartPointer<vtkPolyData> getPolyData();
+
+    /** Get stored geometry
+     *  @brief Returns the geometry as it is held in memory, without decoding a compact part.
+     *  @param matrix If given, receives the matrix placing the points in model coordinates,
+     *         nullptr unless the part is compact.
+     *  @return the polydata, or nullptr if nothing is loaded or the geometry is released
+     */
+    vtkPolyData* getStoredGeometry(vtkMatrix4x4** matrix = nullptr) const;
+
+    /** Set compact storage
+     *  @brief Switches this part between float and quantised (CompactMesh) geometry.
+     *  @details Compact parts render the quantised mesh directly and decode the float mesh
+     *           only while a clip or shrink filter is active.
+     *  @param compact True to store the geometry compactly.
+     */
+    void setCompact(bool compact);
+
+    /** Get compact storage
+     *  @brief Checks whether the geometry is stored compactly.
+     */
+    bool isCompact() const;
+
+    /** Get memory saved
+     *  @brief Returns the bytes saved by compact storage, 0 if the part is not compact.
+     */
+    qint64 memorySaved() const;
+
+    /** Set default storage
+     *  @brief Chooses whether geometry given to setPolyData() is stored compactly.
+     *  @param compact True to store new geometry compactly.
+     */
+    static void setCompactByDefault(bool compact);
+
+    /** Get default storage
+     *  @brief Checks whether new geometry is stored compactly.
+     */
+    static bool compactByDefault();
+
+    /** Get memory size
+     *  @brief Returns the memory held by this part's geometry and filter output, in bytes.
+     */
+    qint64 memorySize() const;
+
+    /** Release geometry
+     *  @brief Frees this part's geometry while keeping its actor and settings.
+     *  @details Parts loaded from a file that still exists can be re-read from it (or the
+     *           geometry cache). Other parts first write their geometry to spillFile.
+     *           getPolyData() keeps working and setPolyData() makes the part resident again.
+     *  @param spillFile File to write the geometry to if it cannot be re-read from its source.
+     *  @return true if the geometry was released
+     */
+    bool releaseGeometry(const QString& spillFile);
+
+    /** Get released flag
+     *  @brief Checks whether the geometry has been released by releaseGeometry().
+     */
+    bool isReleased() const;
+
+    /** Mark viewed
+     *  @brief Records when the part was last seen, for least recently used eviction.
+     *  @param tick Increasing counter value.
+     */
+    void markViewed(quint64 tick);
+
+    /** Get last viewed
+     *  @brief Returns the counter value passed to the last markViewed() call.
+     */
+    quint64 lastViewed() const;
+
+    /**
+     * @brief Returns the file this part's geometry was loaded from.
+     * @return Path to the source file, empty if the geometry did not come from a file.
+     */
+    QString getFileName() const;
+
+    /**
+     * @brief Records the file this part's geometry was loaded from.
+     * @param fileName Path to the source file.
+     */
+    void setFileName(const QString& fileName);
+
     /** Return actor
      *  @brief Gets the VTK actor for GUI rendering.
       * @return pointer to default actor for GUI rendering
@@ -155,9 +298,11 @@ public:
 
     /** Return new actor for use in VR
      *  @brief Creates and returns a new VTK actor for VR rendering.
-      * @return pointer to new actor
+      * @details The actor shows a copy of the unfiltered geometry as it is now, so reloading or
+      *          releasing the part later does not reach it; a released part is read again.
+      * @return the new actor, owned by the caller
       */
-    vtkActor* getNewActor();
+    vtkSmartPointer<vtkActor> getNewActor();
 
     /**
      * @brief Applies selected VTK filters (clip/shrink) to the part.
@@ -187,8 +332,131 @@ public:
      * @return Pointer to the removed child.
      */
     ModelPart* takeChild(int row);
+    /**
+     * @brief Inserts a child at the specified row, e.g. one taken out earlier by takeChild().
+     * @param row Index the child will have, clamped to the number of children.
+     * @param item Child to insert, ownership passes to this part.
+     */
+    void insertChild(int row, ModelPart* item);
+
+    /**
+     * @brief Reorders the children, and recursively their children.
+     * @param lessThan Returns true if the first part belongs before the second.
+     */
+    void sortChildren(const std::function<bool(ModelPart*, ModelPart*)>& lessThan);
+
+    /**
+     * @brief Returns this part's own cost, collected when it is loaded and filtered.
+     */
+    const Stats& stats() const;
+
+    /**
+     * @brief Returns the cost of this part and all of its descendants.
+     * @details Totals are cached and only recomputed after something below this part changed.
+     */
+    Stats subtreeStats() const;
+
+    /**
+     * @brief Records how long reading this part's geometry took.
+     * @param milliseconds Load time.
+     */
+    void setLoadTime(double milliseconds);
+
+    /**
+     * @brief Stores the metrics measured from this part's geometry.
+     * @param metrics Metrics of the unfiltered geometry, placed in the scene by the world matrix.
+     * @param geometryTime Modification time of the stored geometry they were measured from.
+     * @param placement placementStamp() of the world matrix they were measured with.
+     */
+    void setMetrics(const MeshMetrics& metrics, vtkMTimeType geometryTime, quint64 placement);
+
+    /**
+     * @brief Checks whether the metrics are missing, older than the stored geometry or measured
+     *        before the part last moved.
+     * @details A released part keeps the metrics of its last geometry and placement.
+     */
+    bool metricsOutdated() const;
+
+    /**
+     * @brief Places the part relative to its parent.
+     * @details Only marks this subtree's world matrices out of date; they are recomputed by the
+     *          next updateWorldMatrices() on an ancestor.
+     * @param transform New local transform.
+     */
+    void setTransform(const Transform& transform);
+
+    /**
+     * @brief Returns the part's placement relative to its parent.
+     */
+    const Transform& transform() const;
+
+    /**
+     * @brief Places the part with an animation's local matrix instead of its transform.
+     * @details The transform itself, which is saved, edited and undone, is left alone and takes
+     *          over again when the animation ends. Like setTransform(), only marks the subtree's
+     *          world matrices out of date.
+     * @param matrix Row-major local matrix, or nullptr to end the animation.
+     */
+    void setAnimationMatrix(const double matrix[16]);
+
+    /**
+     * @brief Checks whether an animation currently places the part.
+     */
+    bool isAnimated() const;
+
+    /**
+     * @brief Returns the row-major matrix from the part's coordinates to the scene's.
+     * @details Valid as of the last updateWorldMatrices() on the root item.
+     */
+    const double* worldMatrix() const;
+
+    /**
+     * @brief Recomputes the world matrices that are out of date below this part.
+     * @details Call on the root item before rendering. Subtrees without a changed transform are
+     *          skipped, so the cost is one matrix product per part that moved (or whose ancestor
+     *          moved), and nothing when no transform changed. The desktop actors of updated parts
+     *          pick up the new matrix through their user matrix. VR actors have a matrix of their
+     *          own, which only the VR thread writes; see getVRMatrix().
+     */
+    void updateWorldMatrices();
+
+    /**
+     * @brief Returns the user matrix a VR actor of this part needs.
+     * @details The world matrix, after the dequantisation of a compact part, as of the last
+     *          updateWorldMatrices(). Send it with VRRenderThread::setActorMatrix() when the part
+     *          moves while VR runs.
+     * @param matrix Receives the row-major matrix.
+     */
+    void getVRMatrix(double matrix[16]) const;
+
+    /**
+     * @brief Returns a number that changes whenever updateWorldMatrices() moves this part.
+     */
+    quint64 placementStamp() const;
 
 private:
+    /**
+     * @brief Marks the cached subtree totals of this part and its ancestors as out of date.
+     */
+    void invalidateStats();
+
+    /**
+     * @brief Marks this part's world matrix, and the path down to it, as out of date.
+     */
+    void invalidateTransform();
+
+    /**
+     * @brief Recomputes the world matrix of this part if needed, then of its children.
+     * @param parentWorld World matrix of the parent.
+     * @param parentMoved True if the parent's world matrix changed.
+     */
+    void updateWorld(const double parentWorld[16], bool parentMoved);
+
+    /**
+     * @brief Sets the desktop actor's user matrix to the world matrix, after any dequantisation.
+     */
+    void updateActorMatrix();
+
     QList<ModelPart*>                           m_childItems;       /**< List (array) of child items */
     QList<QVariant>                             m_itemData;         /**< List (array of column data for item */
     ModelPart*                                  m_parentItem;       /**< Pointer to parent */
@@ -203,7 +471,27 @@ private:
 	/* These are vtk properties that will be used to load/render a model of this part,
 	 * commented out for now but will be used later
 	 */
-    vtkSmartPointer<vtkSTLReader>               file;               /**< Datafile from which part loaded */
+    QString                                     sourceFile;         /**< Path of the file the geometry was loaded from */
+    vtkSmartPointer<vtkTrivialProducer>         file;               /**< Source of the part's geometry for the filter pipeline */
+    CompactMesh                                 compact;            /**< Quantised geometry, valid when the part is compact */
+    bool                                        released;           /**< True while the geometry is released to save memory */
+    QString                                     spillFile;          /**< Copy of released geometry that has no source file */
+    quint64                                     viewedTick;         /**< When the part was last visible, see MemoryBudget */
+    Stats                                       ownStats;           /**< Cost of this part alone */
+    mutable Stats                               subtreeCache;       /**< Cached cost of this part and its descendants */
+    mutable bool                                subtreeDirty;       /**< True when subtreeCache needs recomputing */
+    vtkMTimeType                                metricsTime;        /**< Modification time of the geometry the metrics belong to */
+    quint64                                     metricsPlacement;   /**< placementStamp() the metrics belong to */
+    Transform                                   localTransform;     /**< Placement relative to the parent */
+    double                                      localMatrix[16];    /**< Matrix of localTransform */
+    double                                      world[16];          /**< Cached product of the ancestors' local matrices and this one */
+    quint64                                     worldStamp;         /**< Counts the changes of world, see placementStamp() */
+    bool                                        transformDirty;     /**< True when world needs recomputing */
+    bool                                        subtreeTransformDirty;  /**< True when some descendant's world needs recomputing */
+    bool                                        animated;           /**< True while animationMatrix replaces localMatrix */
+    double                                      animationMatrix[16];    /**< Local matrix set by a playing animation */
+    vtkSmartPointer<vtkMatrix4x4>               actorMatrix;        /**< User matrix of the desktop actor */
+    vtkSmartPointer<vtkTrivialProducer>         decoded;            /**< Decoded float geometry of a compact part, kept while filters need it */
     vtkSmartPointer<vtkMapper>                  mapper;             /**< Mapper for rendering */
     vtkSmartPointer<vtkActor>                   actor;              /**< Actor for rendering */
     vtkColor3<unsigned char>                    colour;             /**< User defineable colour */
@@ -10,6 +10,52 @@
 
 #include "ModelPartList.h"
 #include "ModelPart.h"
+#include "ThumbnailCache.h"
+#include "MetricsEngine.h"
+
+#include <QIcon>
+#include <QLocale>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/** Returns the raw value of a cost column */
+QVariant statValue(const ModelPart::Stats& stats, int column) {
+    switch (column) {
+    case ModelPartList::TrianglesColumn:  return stats.triangles;
+    case ModelPartList::PointsColumn:     return stats.points;
+    case ModelPartList::MemoryColumn:     return stats.memory;
+    case ModelPartList::LoadTimeColumn:   return stats.loadMs;
+    case ModelPartList::FilterTimeColumn: return stats.filterMs;
+    default:                              break;
+    }
+
+    const MeshMetrics& metrics = stats.metrics;
+    if (!metrics.isValid())
+        return 0.;
+    switch (column) {
+    case ModelPartList::AreaColumn:       return metrics.area;
+    case ModelPartList::VolumeColumn:     return metrics.volume;
+    case ModelPartList::SizeColumn: {
+        /* Sorted by the box diagonal */
+        double dx = metrics.bounds[1] - metrics.bounds[0];
+        double dy = metrics.bounds[3] - metrics.bounds[2];
+        double dz = metrics.bounds[5] - metrics.bounds[4];
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+    case ModelPartList::CentreColumn: {
+        /* Sorted by the distance from the origin */
+        double c[3];
+        metrics.centre(c);
+        return std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+    }
+    default:                              return QVariant();
+    }
+}
+
+}
 /**
  * @brief Constructs the model with an optional name and parent object.
  * @param data Root node label.
@@ -20,6 +66,20 @@ ModelPartList::ModelPartList( const QString& data, QObject* parent ) : QAbstract
      * acts as the column headers
      */
     rootItem = new ModelPart( { tr("Part"), tr("Visible?") } );
+
+    /* Thumbnails are rendered in the background, repaint the row when one arrives */
+    thumbnails = new ThumbnailCache(this, this);
+    connect(thumbnails, &ThumbnailCache::thumbnailReady, this, [this](const QModelIndex& index) {
+        emit dataChanged(index, index, { Qt::DecorationRole });
+    });
+
+    /* Metrics are measured in the background once new parts have their geometry */
+    metricsEngine = new MetricsEngine(this, this);
+    connect(metricsEngine, &MetricsEngine::metricsUpdated, this, [this]() {
+        refreshColumns(FirstMetricsColumn, LastMetricsColumn);
+    });
+    connect(this, &QAbstractItemModel::rowsInserted, metricsEngine, &MetricsEngine::requestUpdate);
+    connect(this, &QAbstractItemModel::modelReset, metricsEngine, &MetricsEngine::requestUpdate);
 }
 
 
@@ -31,12 +91,12 @@ ModelPartList::~ModelPartList() {
 }
 
 /**
- * @brief Returns the number of columns from the root item.
+ * @brief Returns the number of columns, the name and visibility plus the cost columns.
  */
 int ModelPartList::columnCount( const QModelIndex& parent ) const {
     Q_UNUSED(parent);
 
-    return rootItem->columnCount();
+    return ColumnCount;
 }
 
 /**
@@ -48,15 +108,33 @@ QVariant ModelPartList::data( const QModelIndex& index, int role ) const {
     if( !index.isValid() )
         return QVariant();
 
-    /* Role represents what this data will be used for, we only need deal with the case
-     * when QT is asking for data to create and display the treeview. Return a new,
-     * empty QVariant if any other request comes through. */
-    if (role != Qt::DisplayRole)
-        return QVariant();
-
     /* Get a a pointer to the item referred to by the QModelIndex */
     ModelPart* item = static_cast<ModelPart*>( index.internalPointer() );
 
+    /* Cost columns, totals for the item and everything below it */
+    if (index.column() >= TrianglesColumn) {
+        ModelPart::Stats stats = item->subtreeStats();
+        if (role == Qt::TextAlignmentRole)
+            return int(Qt::AlignRight | Qt::AlignVCenter);
+        if (role == SortRole)
+            return statValue(stats, index.column());
+        if (role == Qt::DisplayRole && (stats.triangles || stats.memory || stats.loadMs > 0.))
+            return formatStat(stats, index.column());
+        return QVariant();
+    }
+
+    /* Thumbnail next to the name, only asked for by the view for rows it paints */
+    if (role == Qt::DecorationRole && index.column() == NameColumn) {
+        QIcon icon = thumbnails->icon(index);
+        return icon.isNull() ? QVariant() : QVariant(icon);
+    }
+
+    /* Role represents what this data will be used for, we only need deal with the case
+     * when QT is asking for data to create and display the treeview (or sort it). Return
+     * a new, empty QVariant if any other request comes through. */
+    if (role != Qt::DisplayRole && role != SortRole)
+        return QVariant();
+
     /* Each item in the tree has a number of columns ("Part" and "Visible" in this 
      * initial example) return the column requested by the QModelIndex */
     return item->data( index.column() );
@@ -76,10 +154,22 @@ Qt::ItemFlags ModelPartList::flags( const QModelIndex& index ) const {
  * @brief Returns the header label at a given section and orientation.
  */
 QVariant ModelPartList::headerData( int section, Qt::Orientation orientation, int role ) const {
-    if( orientation == Qt::Horizontal && role == Qt::DisplayRole )
-        return rootItem->data( section );
+    if( orientation != Qt::Horizontal || role != Qt::DisplayRole )
+        return QVariant();
+
+    switch (section) {
+    case TrianglesColumn:  return tr("Triangles");
+    case PointsColumn:     return tr("Points");
+    case MemoryColumn:     return tr("Memory");
+    case LoadTimeColumn:   return tr("Load");
+    case FilterTimeColumn: return tr("Filter");
+    case AreaColumn:       return tr("Area");
+    case VolumeColumn:     return tr("Volume");
+    case SizeColumn:       return tr("Size");
+    case CentreColumn:     return tr("Centre of Mass");
+    default:               return rootItem->data( section );
+    }
 
-    return QVariant();
 }
 
 /**
@@ -184,11 +274,15 @@ bool ModelPartList::removeRows(int row, int count, const QModelIndex &parent) {
     if (!hasIndex(row, 0, parent))
         return false;
 
-    beginRemoveRows(parent, row, row + count - 1);
-
     ModelPart* parentItem = parent.isValid()
                                 ? static_cast<ModelPart*>(parent.internalPointer())
                                 : rootItem;
+    QList<ModelPart*> deleted;
+    for (int i = 0; i < count; ++i)
+        deleted.append(parentItem->child(row + i));
+    emit partsAboutToBeDeleted(deleted);
+
+    beginRemoveRows(parent, row, row + count - 1);
     for (int i = 0; i < count; ++i) {
         ModelPart* child = parentItem->takeChild(row);
         delete child;
@@ -197,3 +291,183 @@ bool ModelPartList::removeRows(int row, int count, const QModelIndex &parent) {
     endRemoveRows();
     return true;
 }
+/**
+ * @brief Appends a list of parts under a parent with one row insertion.
+ * @param parent Index of the parent item.
+ * @param parts Parts to append.
+ */
+void ModelPartList::appendParts(const QModelIndex& parent, const QList<ModelPart*>& parts) {
+    if (parts.isEmpty())
+        return;
+
+    ModelPart* parentPart = getItem(parent);
+    int first = parentPart->childCount();
+
+    beginInsertRows(indexOf(parentPart), first, first + parts.size() - 1);
+    for (ModelPart* part : parts)
+        parentPart->appendChild(part);
+    endInsertRows();
+}
+
+/**
+ * @brief Removes the part's row from its parent and hands the part back to the caller.
+ */
+int ModelPartList::takePart(ModelPart* part) {
+    ModelPart* parentPart = part->parentItem();
+    const int row = part->row();
+
+    beginRemoveRows(indexOf(parentPart), row, row);
+    parentPart->takeChild(row);
+    endRemoveRows();
+    return row;
+}
+
+/**
+ * @brief Inserts the part as a row of its new parent.
+ */
+void ModelPartList::insertPart(ModelPart* parent, int row, ModelPart* part) {
+    row = std::clamp(row, 0, parent->childCount());
+
+    beginInsertRows(indexOf(parent), row, row);
+    parent->insertChild(row, part);
+    endInsertRows();
+}
+
+/**
+ * @brief Emits dataChanged for every column of the part's row.
+ */
+void ModelPartList::partChanged(ModelPart* part) {
+    const QModelIndex first = indexOf(part);
+    emit dataChanged(first, first.siblingAtColumn(ColumnCount - 1));
+}
+
+/**
+ * @brief Returns the part stored in an index, or the root item for an invalid index.
+ */
+ModelPart* ModelPartList::getItem(const QModelIndex& index) const {
+    if (!index.isValid())
+        return rootItem;
+    return static_cast<ModelPart*>(index.internalPointer());
+}
+
+/**
+ * @brief Builds the model index of a part from its position under its parent.
+ */
+QModelIndex ModelPartList::indexOf(ModelPart* part) const {
+    if (!part || part == rootItem)
+        return QModelIndex();
+    return createIndex(part->row(), 0, part);
+}
+
+/**
+ * @brief Deletes all existing parts and installs a new list of top level parts.
+ * @param parts New top level parts.
+ */
+void ModelPartList::resetParts(const QList<ModelPart*>& parts) {
+    beginResetModel();
+
+    for (int row = rootItem->childCount() - 1; row >= 0; --row)
+        delete rootItem->takeChild(row);
+
+    for (ModelPart* part : parts)
+        rootItem->appendChild(part);
+
+    endResetModel();
+}
+
+/**
+ * @brief Sorts the children of every part by a column, keeping persistent indexes valid.
+ * @param column Column to sort by.
+ * @param order Sort order.
+ */
+void ModelPartList::sort(int column, Qt::SortOrder order) {
+    if (column < 0 || column >= ColumnCount)
+        return;
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    /* Remember which part each persistent index points at */
+    const QModelIndexList before = persistentIndexList();
+    QList<QPair<ModelPart*, int>> targets;
+    for (const QModelIndex& index : before)
+        targets.append({ getItem(index), index.column() });
+
+    rootItem->sortChildren([&](ModelPart* a, ModelPart* b) {
+        if (order == Qt::DescendingOrder)
+            std::swap(a, b);
+        QVariant left = data(createIndex(0, column, a), SortRole);
+        QVariant right = data(createIndex(0, column, b), SortRole);
+        if (column < TrianglesColumn)
+            return QString::localeAwareCompare(left.toString(), right.toString()) < 0;
+        return left.toDouble() < right.toDouble();
+    });
+
+    QModelIndexList after;
+    for (const auto& target : std::as_const(targets))
+        after.append(target.first == rootItem ? QModelIndex()
+                                              : createIndex(target.first->row(), target.second, target.first));
+    changePersistentIndexList(before, after);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+/**
+ * @brief Emits dataChanged for the cost columns of every row and looks for parts to measure.
+ */
+void ModelPartList::refreshStats() {
+    refreshColumns(TrianglesColumn, ColumnCount - 1);
+    metricsEngine->requestUpdate();
+}
+
+/**
+ * @brief Emits dataChanged for a range of columns, one signal per parent.
+ */
+void ModelPartList::refreshColumns(int first, int last) {
+    QList<ModelPart*> stack = { rootItem };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        if (part->childCount() == 0)
+            continue;
+
+        QModelIndex parent = indexOf(part);
+        emit dataChanged(index(0, first, parent),
+                         index(part->childCount() - 1, last, parent),
+                         { Qt::DisplayRole, SortRole });
+        for (int i = 0; i < part->childCount(); ++i)
+            stack.append(part->child(i));
+    }
+}
+
+/**
+ * @brief Formats a cost column for display.
+ */
+QString ModelPartList::formatStat(const ModelPart::Stats& stats, int column) {
+    QLocale locale;
+    switch (column) {
+    case TrianglesColumn:  return locale.toString(stats.triangles);
+    case PointsColumn:     return locale.toString(stats.points);
+    case MemoryColumn:     return tr("%1 MB").arg(stats.memory / (1024. * 1024.), 0, 'f', 1);
+    case LoadTimeColumn:   return tr("%1 ms").arg(stats.loadMs, 0, 'f', 1);
+    case FilterTimeColumn: return tr("%1 ms").arg(stats.filterMs, 0, 'f', 1);
+    default:               break;
+    }
+
+    const MeshMetrics& metrics = stats.metrics;
+    if (!metrics.isValid())
+        return QString();
+    switch (column) {
+    case AreaColumn:       return locale.toString(metrics.area, 'g', 4);
+    case VolumeColumn:     return locale.toString(metrics.volume, 'g', 4);
+    case SizeColumn:
+        return tr("%1 x %2 x %3").arg(locale.toString(metrics.bounds[1] - metrics.bounds[0], 'g', 4),
+                                      locale.toString(metrics.bounds[3] - metrics.bounds[2], 'g', 4),
+                                      locale.toString(metrics.bounds[5] - metrics.bounds[4], 'g', 4));
+    case CentreColumn: {
+        double c[3];
+        metrics.centre(c);
+        return tr("%1, %2, %3").arg(locale.toString(c[0], 'g', 4), locale.toString(c[1], 'g', 4),
+                                    locale.toString(c[2], 'g', 4));
+    }
+    default:               return QString();
+    }
+}
@@ -21,6 +21,8 @@
 #include <QList>
 
 class ModelPart;
+class ThumbnailCache;
+class MetricsEngine;
 /**
  * @class ModelPartList
  * @brief Qt model class representing a tree of model parts.
@@ -29,6 +31,31 @@ class ModelPart;
 class ModelPartList : public QAbstractItemModel {
     Q_OBJECT        /**< A special Qt tag used to indicate that this is a special Qt class that might require preprocessing before compiling. */
 public:
+    /**
+     * @brief Columns of the tree, the cost columns show totals for each part and everything below it.
+     */
+    enum Column {
+        NameColumn = 0,
+        VisibleColumn,
+        TrianglesColumn,
+        PointsColumn,
+        MemoryColumn,
+        LoadTimeColumn,
+        FilterTimeColumn,
+        AreaColumn,
+        VolumeColumn,
+        SizeColumn,
+        CentreColumn,
+        ColumnCount
+    };
+
+    /** First and last of the metrics columns, measured in the background by MetricsEngine */
+    static const int FirstMetricsColumn = AreaColumn;
+    static const int LastMetricsColumn = CentreColumn;
+
+    /** Role returning unformatted column values (numbers for the cost columns), used for sorting */
+    static const int SortRole = Qt::UserRole;
+
     /** Constructor
       *  Arguments are standard arguments for this type of class but are not used in this example.
       * @brief Constructs the model with a label and optional parent.
@@ -45,7 +72,7 @@ public:
     /**
      * @brief Returns the number of columns in the tree view.
      * @param parent Not used.
-     * @return Number of columns (usually 2: "Part", "Visible").
+     * @return Number of columns, see Column.
      */
     int columnCount( const QModelIndex& parent ) const;
 
@@ -126,8 +153,100 @@ public:
      */
     bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
 
+    /**
+     * @brief Appends already constructed parts (which may have children of their own) under a parent.
+     * @details All parts are inserted with a single row insertion, which is much cheaper than
+     *          calling appendChild() once per part when importing many files.
+     * @param parent Index of the parent item, or an invalid index for the top level.
+     * @param parts Parts to append, ownership passes to the model.
+     */
+    void appendParts(const QModelIndex& parent, const QList<ModelPart*>& parts);
+
+    /**
+     * @brief Takes a part and its children out of the tree without deleting them.
+     * @details Used to park deleted subtrees on the undo stack with their geometry still loaded.
+     * @param part Part in the tree, not the root item.
+     * @return the row the part had under its parent
+     */
+    int takePart(ModelPart* part);
+
+    /**
+     * @brief Puts a part taken out by takePart(), or a new one, back into the tree.
+     * @param parent Part to insert under, the root item for the top level.
+     * @param row Row the part will have, clamped to the parent's children.
+     * @param part Part to insert, ownership passes to the model.
+     */
+    void insertPart(ModelPart* parent, int row, ModelPart* part);
+
+    /**
+     * @brief Tells the views that a part's name, visibility or other properties have changed.
+     * @param part Part in the tree.
+     */
+    void partChanged(ModelPart* part);
+
+    /**
+     * @brief Returns the part referred to by an index.
+     * @param index Model index.
+     * @return the part, or the root item if the index is invalid
+     */
+    ModelPart* getItem(const QModelIndex& index) const;
+
+    /**
+     * @brief Returns the model index (column 0) of a part in the tree.
+     * @param part Part to look up.
+     * @return the index, or an invalid index for the root item
+     */
+    QModelIndex indexOf(ModelPart* part) const;
+
+    /**
+     * @brief Replaces every part in the tree with a new set of top level parts.
+     * @details Used when a whole tree is built at once (e.g. loading a project), the view is
+     *          reset a single time instead of once per inserted row.
+     * @param parts New top level parts, ownership passes to the model.
+     */
+    void resetParts(const QList<ModelPart*>& parts);
+
+    /**
+     * @brief Sorts every level of the tree by a column, cost columns sort numerically.
+     * @param column Column to sort by, a negative column leaves the order unchanged.
+     * @param order Ascending or descending.
+     */
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    /**
+     * @brief Tells the views that the cost columns may have changed.
+     * @details Also has the metrics of new or changed geometry measured in the background.
+     */
+    void refreshStats();
+
+    /**
+     * @brief Formats one cost column of a set of part statistics for display.
+     * @param stats Statistics to format.
+     * @param column One of the cost columns.
+     * @return the text, e.g. "12.5 MB"
+     */
+    static QString formatStat(const ModelPart::Stats& stats, int column);
+
+signals:
+    /**
+     * @brief Emitted by removeRows() before it deletes parts, ahead of rowsAboutToBeRemoved().
+     * @details Parts taken out by takePart() are not deleted and do not emit this, nor does
+     *          resetParts(), which resets the whole model.
+     * @param parts Top of each subtree about to be deleted.
+     */
+    void partsAboutToBeDeleted(const QList<ModelPart*>& parts);
+
 private:
+    /**
+     * @brief Tells the views that a range of columns may have changed for every row.
+     * @param first First column.
+     * @param last Last column.
+     */
+    void refreshColumns(int first, int last);
+
     ModelPart *rootItem;    /**< This is a pointer to the item at the base of the tree */
+    ThumbnailCache *thumbnails; /**< Pictures shown next to the part names */
+    MetricsEngine *metricsEngine; /**< Measures parts for the metrics columns */
 };
 #endif
 
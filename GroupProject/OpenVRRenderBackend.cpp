@@ -0,0 +1,65 @@
+/**
+ * @file OpenVRRenderBackend.cpp
+ * @brief Implementation of the OpenVR render backend.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "OpenVRRenderBackend.h"
+
+#include <vtkActorCollection.h>
+#include <vtkMath.h>
+#include <vtkOpenVRCamera.h>
+#include <vtkOpenVRRenderWindow.h>
+#include <vtkOpenVRRenderWindowInteractor.h>
+#include <vtkOpenVRRenderer.h>
+
+/**
+ * @brief Sets up the headset in the order OpenVR expects: renderer, window, camera, interactor.
+ */
+vtkRenderer* OpenVRRenderBackend::initialize(vtkActorCollection* actors, const double background[3]) {
+    renderer = vtkSmartPointer<vtkOpenVRRenderer>::New();
+    renderer->SetBackground(background[0], background[1], background[2]);
+    addActors(renderer, actors);
+
+    window = vtkSmartPointer<vtkOpenVRRenderWindow>::New();
+    window->Initialize();
+    window->AddRenderer(renderer);
+
+    camera = vtkSmartPointer<vtkOpenVRCamera>::New();
+    renderer->SetActiveCamera(camera);
+
+    interactor = vtkSmartPointer<vtkOpenVRRenderWindowInteractor>::New();
+    interactor->SetRenderWindow(window);
+    interactor->Initialize();
+    window->Render();
+
+    return renderer;
+}
+
+/**
+ * @brief Processes one headset event.
+ */
+void OpenVRRenderBackend::frame() {
+    interactor->DoOneEvent(window, renderer);
+}
+
+/**
+ * @brief Checks whether the interactor has finished.
+ */
+bool OpenVRRenderBackend::done() const {
+    return interactor->GetDone();
+}
+
+/**
+ * @brief Places the physical origin at the eye position, facing the focal point.
+ */
+void OpenVRRenderBackend::setCamera(const double position[3], const double focalPoint[3], const double viewUp[3]) {
+    double direction[3] = { focalPoint[0] - position[0], focalPoint[1] - position[1], focalPoint[2] - position[2] };
+    if (vtkMath::Normalize(direction) == 0.)
+        return;
+    window->SetPhysicalTranslation(-position[0], -position[1], -position[2]);
+    window->SetPhysicalViewDirection(direction);
+    window->SetPhysicalViewUp(viewUp[0], viewUp[1], viewUp[2]);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file OpenVRRenderBackend.h
+ * @brief Declaration of the OpenVRRenderBackend class, which renders the VR loop to a headset.
+ * @details Kept apart from RenderBackend.h so that only this file needs VTK's OpenVR module. It is
+ *          built when the CMake option GROUPPROJECT_WITH_OPENVR is on, which also defines the macro
+ *          of the same name; without it the VR loop can only run offscreen.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_OPENVRRENDERBACKEND_H
+#define VIEWER_OPENVRRENDERBACKEND_H
+
+#include "RenderBackend.h"
+
+#include <vtkSmartPointer.h>
+
+class vtkOpenVRCamera;
+class vtkOpenVRRenderer;
+class vtkOpenVRRenderWindow;
+class vtkOpenVRRenderWindowInteractor;
+
+/**
+ * @class OpenVRRenderBackend
+ * @brief Renders to a headset through VTK's OpenVR module.
+ */
+class OpenVRRenderBackend : public RenderBackend {
+public:
+    /**
+     * @brief Creates the OpenVR renderer, window, camera and interactor and renders once.
+     */
+    vtkRenderer* initialize(vtkActorCollection* actors, const double background[3]) override;
+
+    /**
+     * @brief Lets the interactor process one event, which renders when needed.
+     */
+    void frame() override;
+
+    /**
+     * @brief Returns true once the interactor is done.
+     */
+    bool done() const override;
+
+    /**
+     * @brief Carries the play area along the path; the head still looks around freely within it.
+     */
+    void setCamera(const double position[3], const double focalPoint[3], const double viewUp[3]) override;
+
+private:
+    vtkSmartPointer<vtkOpenVRRenderWindow>              window;     /**< VR render window */
+    vtkSmartPointer<vtkOpenVRRenderWindowInteractor>    interactor; /**< VR input interactor */
+    vtkSmartPointer<vtkOpenVRRenderer>                  renderer;   /**< Scene renderer */
+    vtkSmartPointer<vtkOpenVRCamera>                    camera;     /**< Active VR camera */
+};
+
+#endif
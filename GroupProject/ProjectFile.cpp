@@ -0,0 +1,433 @@
+/**
+ * @file ProjectFile.cpp
+ * @brief Implementation of the ProjectFile class.
+ * @details Saving walks the tree once in pre-order so that every parent is written before its
+ *          children. Loading maps the file, decodes all meshes in parallel and then links the
+ *          parts together with a single pass over the node table.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "ProjectFile.h"
+#include "ModelPart.h"
+#include "MeshUtils.h"
+#include "MeshImporter.h"
+
+#include <QObject>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <vtkActor.h>
+#include <vtkPoints.h>
+#include <vtkFloatArray.h>
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkPointData.h>
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+/* Geometry blocks are handed to VTK straight from the mapped file, without byte swapping */
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "Project and cache files are little-endian");
+
+namespace {
+
+const char     ProjectMagic[4] = { 'G', 'P', 'R', 'J' };
+const quint32  ProjectVersion  = 1;
+
+/** Flags stored in each node record */
+enum NodeFlags : quint8 {
+    NodeVisible      = 0x01,
+    NodeClip         = 0x02,
+    NodeShrink       = 0x04,
+    NodeEmbedded     = 0x08,
+    NodeHasTransform = 0x10,
+    NodeHasNormals   = 0x20
+};
+
+/** File header, written once at the start of the file */
+struct FileHeader {
+    char     magic[4];
+    quint32  version;
+    quint32  nodeCount;
+    quint32  reserved;
+    quint64  stringTableOffset;
+    quint64  stringTableSize;
+    quint64  geometryOffset;
+    quint64  geometrySize;
+};
+static_assert(sizeof(FileHeader) == 48, "Project header layout must not change");
+
+/** One record per part, parents are always stored before their children */
+struct NodeRecord {
+    qint32   parent;            /**< Index of parent record, -1 for a top level part */
+    quint32  nameOffset;        /**< Offset of the UTF-8 name in the string table */
+    quint32  nameLength;
+    quint32  pathOffset;        /**< Offset of the UTF-8 source path in the string table */
+    quint32  pathLength;        /**< 0 if the part has no source file */
+    quint8   colour[3];
+    quint8   flags;             /**< Combination of NodeFlags */
+    float    position[3];       /**< Position relative to the parent */
+    float    orientation[3];    /**< Orientation relative to the parent (degrees about x, y, z) */
+    float    scale[3];          /**< Scale relative to the parent */
+    quint32  reserved;
+    quint64  geometryOffset;    /**< Offset of the embedded mesh in the geometry section */
+    quint32  pointCount;
+    quint32  triangleCount;
+};
+static_assert(sizeof(NodeRecord) == 80, "Project node layout must not change");
+
+/** Appends a string to the string table, returning its offset and length */
+void appendString(QByteArray& table, const QString& text, quint32& offset, quint32& length) {
+    QByteArray utf8 = text.toUtf8();
+    offset = static_cast<quint32>(table.size());
+    length = static_cast<quint32>(utf8.size());
+    table.append(utf8);
+}
+
+/** Pads a buffer with zeros up to a multiple of 8 bytes */
+void padTo8(QByteArray& buffer) {
+    while (buffer.size() % 8)
+        buffer.append('\0');
+}
+
+/** Sets the error string if the caller asked for it */
+bool fail(QString* errorString, const QString& message) {
+    if (errorString)
+        *errorString = message;
+    return false;
+}
+
+}
+
+/**
+ * @brief Returns the size in bytes of a geometry block.
+ */
+qint64 ProjectFile::geometrySize(quint32 pointCount, quint32 triangleCount, bool hasNormals) {
+    return qint64(pointCount) * (hasNormals ? 6 : 3) * sizeof(float) + qint64(triangleCount) * 3 * sizeof(quint32);
+}
+
+/**
+ * @brief Appends a mesh to a buffer as points followed by triangle indices and normals.
+ */
+void ProjectFile::appendGeometry(QByteArray& buffer, vtkPolyData* polyData, quint32& pointCount, quint32& triangleCount,
+                                 bool& hasNormals) {
+    pointCount = 0;
+    triangleCount = 0;
+    hasNormals = false;
+    if (!polyData || !polyData->GetPoints())
+        return;
+
+    /* Points, converted to float if the source holds doubles */
+    vtkIdType nPoints = polyData->GetNumberOfPoints();
+    std::vector<float> points(static_cast<size_t>(nPoints) * 3);
+    vtkFloatArray* floatPoints = vtkFloatArray::SafeDownCast(polyData->GetPoints()->GetData());
+    if (floatPoints) {
+        std::memcpy(points.data(), floatPoints->GetPointer(0), points.size() * sizeof(float));
+    } else {
+        for (vtkIdType i = 0; i < nPoints; ++i) {
+            double p[3];
+            polyData->GetPoint(i, p);
+            points[3 * i + 0] = static_cast<float>(p[0]);
+            points[3 * i + 1] = static_cast<float>(p[1]);
+            points[3 * i + 2] = static_cast<float>(p[2]);
+        }
+    }
+
+    /* Triangles, fan triangulating any larger polygons */
+    std::vector<quint32> indices;
+    indices.reserve(static_cast<size_t>(polyData->GetNumberOfPolys()) * 3);
+    auto it = vtk::TakeSmartPointer(polyData->GetPolys()->NewIterator());
+    for (it->GoToFirstCell(); !it->IsDoneWithTraversal(); it->GoToNextCell()) {
+        vtkIdType npts;
+        const vtkIdType* pts;
+        it->GetCurrentCell(npts, pts);
+        for (vtkIdType k = 1; k + 1 < npts; ++k) {
+            indices.push_back(static_cast<quint32>(pts[0]));
+            indices.push_back(static_cast<quint32>(pts[k]));
+            indices.push_back(static_cast<quint32>(pts[k + 1]));
+        }
+    }
+
+    pointCount = static_cast<quint32>(nPoints);
+    triangleCount = static_cast<quint32>(indices.size() / 3);
+    buffer.append(reinterpret_cast<const char*>(points.data()), static_cast<qsizetype>(points.size() * sizeof(float)));
+    buffer.append(reinterpret_cast<const char*>(indices.data()), static_cast<qsizetype>(indices.size() * sizeof(quint32)));
+
+    /* Normals, in the same layout as the points */
+    vtkDataArray* normals = polyData->GetPointData()->GetNormals();
+    if (!normals || normals->GetNumberOfTuples() != nPoints)
+        return;
+    vtkFloatArray* floatNormals = vtkFloatArray::SafeDownCast(normals);
+    if (floatNormals) {
+        std::memcpy(points.data(), floatNormals->GetPointer(0), points.size() * sizeof(float));
+    } else {
+        for (vtkIdType i = 0; i < nPoints; ++i) {
+            double n[3];
+            normals->GetTuple(i, n);
+            points[3 * i + 0] = static_cast<float>(n[0]);
+            points[3 * i + 1] = static_cast<float>(n[1]);
+            points[3 * i + 2] = static_cast<float>(n[2]);
+        }
+    }
+    hasNormals = true;
+    buffer.append(reinterpret_cast<const char*>(points.data()), static_cast<qsizetype>(points.size() * sizeof(float)));
+}
+
+/**
+ * @brief Checks the indices of a geometry block, then decodes it into a new polydata.
+ */
+vtkSmartPointer<vtkPolyData> ProjectFile::readGeometry(const uchar* data, quint32 pointCount, quint32 triangleCount,
+                                                      bool hasNormals) {
+    const float* points = reinterpret_cast<const float*>(data);
+    const quint32* indices = reinterpret_cast<const quint32*>(data + size_t(pointCount) * 3 * sizeof(float));
+
+    /* The block may come from any file, so a triangle must not name a point it does not hold */
+    std::atomic<bool> valid(true);
+    MeshUtils::parallelFor(qint64(triangleCount) * 3, [&](qint64 begin, qint64 end) {
+        for (qint64 i = begin; i < end; ++i) {
+            if (indices[i] >= pointCount) {
+                valid = false;
+                return;
+            }
+        }
+    }, 1 << 16);
+    if (!valid)
+        return nullptr;
+
+    vtkSmartPointer<vtkPolyData> polyData = MeshUtils::makePolyData(points, pointCount, indices, triangleCount);
+    if (!hasNormals)
+        return polyData;
+
+    auto normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetName("Normals");
+    normals->SetNumberOfComponents(3);
+    normals->SetNumberOfTuples(pointCount);
+    std::memcpy(normals->GetPointer(0), indices + size_t(triangleCount) * 3, size_t(pointCount) * 3 * sizeof(float));
+    polyData->GetPointData()->SetNormals(normals);
+    return polyData;
+}
+
+/**
+ * @brief Saves the tree below root to a project file.
+ */
+bool ProjectFile::save(const QString& fileName, ModelPart* root, bool embedGeometry, QString* errorString) {
+    if (!root)
+        return fail(errorString, QObject::tr("Nothing to save"));
+
+    QDir projectDir = QFileInfo(fileName).absoluteDir();
+
+    QVector<NodeRecord> nodes;
+    QByteArray strings;
+    QByteArray geometry;
+    QHash<ModelPart*, qint32> nodeIndex;
+
+    /* Pre-order walk so parents are always written before their children */
+    QList<ModelPart*> stack;
+    for (int i = root->childCount() - 1; i >= 0; --i)
+        stack.append(root->child(i));
+
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+
+        NodeRecord node;
+        std::memset(&node, 0, sizeof(node));
+        node.parent = nodeIndex.value(part->parentItem(), -1);
+        node.scale[0] = node.scale[1] = node.scale[2] = 1.f;
+
+        appendString(strings, part->data(0).toString(), node.nameOffset, node.nameLength);
+
+        node.colour[0] = part->getColourR();
+        node.colour[1] = part->getColourG();
+        node.colour[2] = part->getColourB();
+        if (part->visible()) node.flags |= NodeVisible;
+        if (part->clip())    node.flags |= NodeClip;
+        if (part->shrink())  node.flags |= NodeShrink;
+
+        /* The part's own transform, not the actor's, which carries the explode offset */
+        const ModelPart::Transform& transform = part->transform();
+        if (transform != ModelPart::Transform()) {
+            node.flags |= NodeHasTransform;
+            for (int k = 0; k < 3; ++k) {
+                node.position[k]    = static_cast<float>(transform.position[k]);
+                node.orientation[k] = static_cast<float>(transform.orientation[k]);
+                node.scale[k]       = static_cast<float>(transform.scale[k]);
+            }
+        }
+
+        QString source = part->getFileName();
+        vtkSmartPointer<vtkPolyData> polyData;
+        if (embedGeometry || source.isEmpty())
+            polyData = part->getPolyData();     // decodes compact geometry, so only when needed
+        if (polyData) {
+            node.flags |= NodeEmbedded;
+            node.geometryOffset = static_cast<quint64>(geometry.size());
+            bool hasNormals = false;
+            appendGeometry(geometry, polyData, node.pointCount, node.triangleCount, hasNormals);
+            if (hasNormals)
+                node.flags |= NodeHasNormals;
+            padTo8(geometry);
+        } else if (!source.isEmpty()) {
+            appendString(strings, projectDir.relativeFilePath(source), node.pathOffset, node.pathLength);
+        }
+
+        nodeIndex.insert(part, static_cast<qint32>(nodes.size()));
+        nodes.append(node);
+
+        for (int i = part->childCount() - 1; i >= 0; --i)
+            stack.append(part->child(i));
+    }
+
+    padTo8(strings);
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, ProjectMagic, sizeof(header.magic));
+    header.version = ProjectVersion;
+    header.nodeCount = static_cast<quint32>(nodes.size());
+    header.stringTableOffset = sizeof(FileHeader) + quint64(nodes.size()) * sizeof(NodeRecord);
+    header.stringTableSize = static_cast<quint64>(strings.size());
+    header.geometryOffset = header.stringTableOffset + header.stringTableSize;
+    header.geometrySize = static_cast<quint64>(geometry.size());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return fail(errorString, file.errorString());
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(nodes.constData()), qint64(nodes.size()) * sizeof(NodeRecord));
+    file.write(strings);
+    file.write(geometry);
+
+    if (!file.commit())
+        return fail(errorString, file.errorString());
+    return true;
+}
+
+/**
+ * @brief Loads a project file into a list of new top level parts.
+ */
+bool ProjectFile::load(const QString& fileName, QList<ModelPart*>& topLevelParts, QString* errorString) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(errorString, file.errorString());
+
+    const qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(FileHeader)))
+        return fail(errorString, QObject::tr("Not a project file"));
+
+    const uchar* base = file.map(0, fileSize);
+    if (!base)
+        return fail(errorString, file.errorString());
+
+    /* Validate the header and make sure every section lies inside the file before touching it */
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(base);
+    if (std::memcmp(header->magic, ProjectMagic, sizeof(ProjectMagic)) != 0)
+        return fail(errorString, QObject::tr("Not a project file"));
+    if (header->version != ProjectVersion)
+        return fail(errorString, QObject::tr("Unsupported project version %1").arg(header->version));
+
+    /* Compared by subtraction, so that huge offsets cannot wrap around */
+    const quint64 size = quint64(fileSize);
+    const quint64 nodeTableEnd = sizeof(FileHeader) + quint64(header->nodeCount) * sizeof(NodeRecord);
+    if (nodeTableEnd > size
+        || header->stringTableOffset > size || header->stringTableSize > size - header->stringTableOffset
+        || header->geometryOffset > size || header->geometrySize > size - header->geometryOffset)
+        return fail(errorString, QObject::tr("Project file is truncated"));
+
+    const NodeRecord* nodes = reinterpret_cast<const NodeRecord*>(base + sizeof(FileHeader));
+    const char* strings = reinterpret_cast<const char*>(base + header->stringTableOffset);
+    const uchar* geometry = base + header->geometryOffset;
+    const int nodeCount = static_cast<int>(header->nodeCount);
+
+    for (int i = 0; i < nodeCount; ++i) {
+        const NodeRecord& node = nodes[i];
+        if (node.parent < -1 || node.parent >= i
+            || quint64(node.nameOffset) + node.nameLength > header->stringTableSize
+            || quint64(node.pathOffset) + node.pathLength > header->stringTableSize)
+            return fail(errorString, QObject::tr("Project file is corrupt"));
+        if ((node.flags & NodeEmbedded)
+            && (node.geometryOffset > header->geometrySize
+                || quint64(geometrySize(node.pointCount, node.triangleCount, node.flags & NodeHasNormals))
+                       > header->geometrySize - node.geometryOffset))
+            return fail(errorString, QObject::tr("Project file is corrupt"));
+    }
+
+    /* Decode embedded meshes and read referenced files in parallel, this is where nearly
+     * all of the time goes so nothing else is done until every mesh is available */
+    QDir projectDir = QFileInfo(fileName).absoluteDir();
+    std::vector<vtkSmartPointer<vtkPolyData>> meshes(static_cast<size_t>(nodeCount));
+    QVector<QString> sources(nodeCount);
+    QVector<int> meshNodes;
+    for (int i = 0; i < nodeCount; ++i) {
+        if (nodes[i].pathLength)
+            sources[i] = projectDir.absoluteFilePath(
+                QString::fromUtf8(strings + nodes[i].pathOffset, nodes[i].pathLength));
+        if ((nodes[i].flags & NodeEmbedded) || nodes[i].pathLength)
+            meshNodes.append(i);
+    }
+
+    std::vector<double> loadTimes(static_cast<size_t>(nodeCount), 0.);
+    QtConcurrent::blockingMap(meshNodes, [&](int& i) {
+        const NodeRecord& node = nodes[i];
+        QElapsedTimer timer;
+        timer.start();
+        if (node.flags & NodeEmbedded)
+            meshes[i] = readGeometry(geometry + node.geometryOffset, node.pointCount, node.triangleCount,
+                                     node.flags & NodeHasNormals);
+        else
+            meshes[i] = MeshImporter::read(sources[i]);
+        loadTimes[i] = timer.nsecsElapsed() / 1e6;
+    });
+
+    /* An embedded mesh is only rejected once its indices are checked, the file is then corrupt */
+    for (int i : std::as_const(meshNodes)) {
+        if ((nodes[i].flags & NodeEmbedded) && !meshes[i])
+            return fail(errorString, QObject::tr("Project file is corrupt"));
+    }
+
+    /* Build the whole tree in one pass, parents are guaranteed to already exist */
+    std::vector<ModelPart*> parts(static_cast<size_t>(nodeCount));
+    for (int i = 0; i < nodeCount; ++i) {
+        const NodeRecord& node = nodes[i];
+        QString name = QString::fromUtf8(strings + node.nameOffset, node.nameLength);
+        bool visible = node.flags & NodeVisible;
+
+        ModelPart* part = new ModelPart({ name, visible ? "true" : "false" });
+        part->setVisible(visible);
+        part->setColour(node.colour[0], node.colour[1], node.colour[2]);
+        part->setClip(node.flags & NodeClip);
+        part->setShrink(node.flags & NodeShrink);
+        part->setFileName(sources[i]);
+
+        if (meshes[i]) {
+            part->setPolyData(meshes[i]);
+            part->setLoadTime(loadTimes[i]);
+        }
+        if (node.flags & NodeHasTransform) {
+            ModelPart::Transform transform;
+            for (int k = 0; k < 3; ++k) {
+                transform.position[k]    = node.position[k];
+                transform.orientation[k] = node.orientation[k];
+                transform.scale[k]       = node.scale[k];
+            }
+            part->setTransform(transform);
+        }
+
+        parts[i] = part;
+        if (node.parent < 0)
+            topLevelParts.append(part);
+        else
+            parts[node.parent]->appendChild(part);
+    }
+
+    return true;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ProjectFile.h
+ * @brief Declaration of the ProjectFile class used to save and restore the model tree.
+ * @details A project file is a compact binary snapshot of the ModelPart tree: structure, names,
+ *          colours, visibility, filter flags and local transforms, plus either a reference to each
+ *          part's source file or the part's geometry embedded in the project itself.
+ *          Files are memory-mapped on load and the whole tree is built in a single pass.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_PROJECTFILE_H
+#define VIEWER_PROJECTFILE_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+class ModelPart;
+
+/**
+ * @class ProjectFile
+ * @brief Reads and writes the binary project format (*.gpp).
+ * @details Layout (all values little-endian):
+ *          - Header: magic "GPRJ", version, node count, offsets of the string table and geometry section
+ *          - Node table: one fixed size record per part, parents always stored before their children
+ *          - String table: UTF-8 part names and source file paths (relative to the project file)
+ *          - Geometry section: embedded meshes as float xyz points followed by uint32 triangle indices
+ *            and, if the mesh has them, float xyz point normals
+ *          Blocks are used in place from the mapped file, so the format is only read and written
+ *          on little-endian hosts.
+ */
+class ProjectFile {
+public:
+    /**
+     * @brief Writes the children of a root item, and everything below them, to a project file.
+     * @param fileName Path of the project file to create.
+     * @param root Root of the tree, the root itself is not saved (it only holds the column headers).
+     * @param embedGeometry If true every mesh is stored inside the project, otherwise only parts
+     *        without a source file have their geometry embedded.
+     * @param errorString Optional output for a description of any failure.
+     * @return true on success.
+     */
+    static bool save(const QString& fileName, ModelPart* root, bool embedGeometry, QString* errorString = nullptr);
+
+    /**
+     * @brief Reads a project file and builds the tree it describes.
+     * @details The file is memory-mapped, referenced and embedded meshes are decoded in parallel,
+     *          then parts are created and linked together in one pass on the calling thread.
+     * @param fileName Path of the project file to read.
+     * @param topLevelParts Receives the newly allocated top level parts, ownership passes to the caller.
+     * @param errorString Optional output for a description of any failure.
+     * @return true on success.
+     */
+    static bool load(const QString& fileName, QList<ModelPart*>& topLevelParts, QString* errorString = nullptr);
+
+    /**
+     * @brief Appends a mesh to a buffer as float xyz points followed by uint32 triangle indices,
+     *        then float xyz normals if the mesh has point normals.
+     * @details Polygons with more than three points are fan triangulated.
+     * @param buffer Buffer to append to.
+     * @param polyData Mesh to write.
+     * @param pointCount Receives the number of points written.
+     * @param triangleCount Receives the number of triangles written.
+     * @param hasNormals Receives whether normals were written.
+     */
+    static void appendGeometry(QByteArray& buffer, vtkPolyData* polyData, quint32& pointCount, quint32& triangleCount,
+                               bool& hasNormals);
+
+    /**
+     * @brief Builds a mesh from a block written by appendGeometry().
+     * @param data Start of the block, typically inside a memory-mapped file.
+     * @param pointCount Number of points in the block.
+     * @param triangleCount Number of triangles in the block.
+     * @param hasNormals Whether the block ends with normals.
+     * @return The decoded mesh, or nullptr if a triangle refers to a point outside the block.
+     */
+    static vtkSmartPointer<vtkPolyData> readGeometry(const uchar* data, quint32 pointCount, quint32 triangleCount,
+                                                     bool hasNormals);
+
+    /**
+     * @brief Returns the number of bytes a geometry block of the given size occupies.
+     */
+    static qint64 geometrySize(quint32 pointCount, quint32 triangleCount, bool hasNormals);
+};
+
+#endif
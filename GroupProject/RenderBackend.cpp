@@ -0,0 +1,77 @@
+/**
+ * @file RenderBackend.cpp
+ * @brief Implementation of the offscreen render backend.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "RenderBackend.h"
+
+#include <vtkActor.h>
+#include <vtkActorCollection.h>
+#include <vtkCamera.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+
+/**
+ * @brief Adds every actor of a collection to a renderer.
+ */
+void RenderBackend::addActors(vtkRenderer* renderer, vtkActorCollection* actors) {
+    vtkActor* actor;
+    actors->InitTraversal();
+    while ((actor = actors->GetNextActor()))
+        renderer->AddActor(actor);
+}
+
+/**
+ * @brief Stores the size and frame limit; the window is created on the render thread.
+ */
+OffscreenRenderBackend::OffscreenRenderBackend(int width, int height, int frameLimit)
+    : width(width), height(height), frameLimit(frameLimit), frames(0) {
+}
+
+/**
+ * @brief Sets up an offscreen window the size of the headset view.
+ */
+vtkRenderer* OffscreenRenderBackend::initialize(vtkActorCollection* actors, const double background[3]) {
+    renderer = vtkSmartPointer<vtkRenderer>::New();
+    renderer->SetBackground(background[0], background[1], background[2]);
+    addActors(renderer, actors);
+    /* There is no head to follow, so look at the whole scene */
+    renderer->ResetCamera();
+
+    window = vtkSmartPointer<vtkRenderWindow>::New();
+    window->SetOffScreenRendering(1);
+    window->SetSize(width, height);
+    window->AddRenderer(renderer);
+    window->Render();
+
+    return renderer;
+}
+
+/**
+ * @brief Renders the scene once.
+ */
+void OffscreenRenderBackend::frame() {
+    window->Render();
+    ++frames;
+}
+
+/**
+ * @brief Checks the frame count against the limit.
+ */
+bool OffscreenRenderBackend::done() const {
+    return frameLimit > 0 && frames >= frameLimit;
+}
+
+/**
+ * @brief Moves the camera and refits the clipping range to it.
+ */
+void OffscreenRenderBackend::setCamera(const double position[3], const double focalPoint[3], const double viewUp[3]) {
+    vtkCamera* camera = renderer->GetActiveCamera();
+    camera->SetPosition(position[0], position[1], position[2]);
+    camera->SetFocalPoint(focalPoint[0], focalPoint[1], focalPoint[2]);
+    camera->SetViewUp(viewUp[0], viewUp[1], viewUp[2]);
+    renderer->ResetCameraClippingRange();
+}
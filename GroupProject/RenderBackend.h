@@ -0,0 +1,110 @@
+/**
+ * @file RenderBackend.h
+ * @brief Declaration of the window backends the VR render loop draws through.
+ * @details VRRenderThread owns the loop, the commands and the animation; a backend only sets up a
+ *          renderer and a window and turns one loop iteration into a frame. The offscreen backend
+ *          renders the scene into an invisible vtkRenderWindow, so the loop can run and be timed
+ *          on a machine without a headset or a display. The headset backend is in
+ *          OpenVRRenderBackend.h, which is only built with GROUPPROJECT_WITH_OPENVR.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_RENDERBACKEND_H
+#define VIEWER_RENDERBACKEND_H
+
+#include <vtkSmartPointer.h>
+
+class vtkActorCollection;
+class vtkRenderer;
+class vtkRenderWindow;
+
+/**
+ * @class RenderBackend
+ * @brief Window, renderer and event handling behind the VR render loop.
+ * @details Every method is called on the render thread, which creates and destroys the backend.
+ */
+class RenderBackend {
+public:
+    /**
+     * @brief Releases the window and renderer.
+     */
+    virtual ~RenderBackend() = default;
+
+    /**
+     * @brief Creates the renderer and window and adds the actors.
+     * @param actors Actors to show.
+     * @param background Background colour, 0 to 1.
+     * @return the renderer, whose actors the loop animates
+     */
+    virtual vtkRenderer* initialize(vtkActorCollection* actors, const double background[3]) = 0;
+
+    /**
+     * @brief Handles one event or draws one frame.
+     */
+    virtual void frame() = 0;
+
+    /**
+     * @brief Returns true once the backend wants the loop to stop, e.g. the headset was closed.
+     */
+    virtual bool done() const = 0;
+
+    /**
+     * @brief Moves the view for an animated camera path.
+     * @param position Eye position.
+     * @param focalPoint Point looked at.
+     * @param viewUp Up direction.
+     */
+    virtual void setCamera(const double position[3], const double focalPoint[3], const double viewUp[3]) = 0;
+
+protected:
+    /**
+     * @brief Adds every actor of a collection to a renderer.
+     */
+    static void addActors(vtkRenderer* renderer, vtkActorCollection* actors);
+};
+
+/**
+ * @class OffscreenRenderBackend
+ * @brief Renders into an invisible window, one frame per loop iteration.
+ */
+class OffscreenRenderBackend : public RenderBackend {
+public:
+    /**
+     * @brief Sets the image size and how many frames to render.
+     * @param width Window width in pixels.
+     * @param height Window height in pixels.
+     * @param frameLimit Frames after which done() becomes true, 0 to run until the loop is ended.
+     */
+    OffscreenRenderBackend(int width, int height, int frameLimit);
+
+    /**
+     * @brief Creates an offscreen window and a renderer whose camera sees all actors.
+     */
+    vtkRenderer* initialize(vtkActorCollection* actors, const double background[3]) override;
+
+    /**
+     * @brief Renders one frame.
+     */
+    void frame() override;
+
+    /**
+     * @brief Returns true once the frame limit is reached.
+     */
+    bool done() const override;
+
+    /**
+     * @brief Sets the renderer's camera.
+     */
+    void setCamera(const double position[3], const double focalPoint[3], const double viewUp[3]) override;
+
+private:
+    vtkSmartPointer<vtkRenderWindow>    window;     /**< Offscreen render window */
+    vtkSmartPointer<vtkRenderer>        renderer;   /**< Scene renderer */
+    int                                 width;      /**< Window width in pixels */
+    int                                 height;     /**< Window height in pixels */
+    int                                 frameLimit; /**< Frames to render, 0 for no limit */
+    int                                 frames;     /**< Frames rendered so far */
+};
+
+#endif
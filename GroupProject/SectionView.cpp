@@ -0,0 +1,174 @@
+/**
+ * @file SectionView.cpp
+ * @brief Implementation of the SectionView class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "SectionView.h"
+#include "ModelPart.h"
+#include "ModelPartList.h"
+
+#include <vtkActor.h>
+#include <vtkActorCollection.h>
+#include <vtkBoundingBox.h>
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+
+/**
+ * @brief Creates the plane, its widget and representation, initially off.
+ * @param partList Model holding the tree.
+ * @param parent Optional QObject parent.
+ */
+SectionView::SectionView(ModelPartList* partList, QObject* parent)
+    : QObject(parent), partList(partList), currentScope(Off) {
+    plane = vtkSmartPointer<vtkPlane>::New();
+
+    representation = vtkSmartPointer<vtkImplicitPlaneRepresentation>::New();
+    representation->SetPlaceFactor(1.1);
+    representation->OutlineTranslationOff();
+    representation->ScaleEnabledOff();
+    representation->DrawPlaneOn();
+
+    widget = vtkSmartPointer<vtkImplicitPlaneWidget2>::New();
+    widget->SetRepresentation(representation);
+
+    vtkNew<vtkCallbackCommand> moved;
+    moved->SetClientData(this);
+    moved->SetCallback([](vtkObject*, unsigned long, void* clientData, void*) {
+        static_cast<SectionView*>(clientData)->updatePlane();
+    });
+    widget->AddObserver(vtkCommand::InteractionEvent, moved);
+}
+
+/**
+ * @brief Attaches the widget to the interactor and renderer of the view.
+ */
+void SectionView::setView(vtkRenderWindowInteractor* interactor, vtkRenderer* viewRenderer) {
+    renderer = viewRenderer;
+    widget->SetInteractor(interactor);
+    widget->SetCurrentRenderer(viewRenderer);
+}
+
+/**
+ * @brief Stores the scope and target, then fits the widget to the sectioned actors.
+ */
+void SectionView::setScope(Scope scope, const QModelIndex& index) {
+    currentScope = scope;
+    target = (scope == Part || scope == Subtree) ? QPersistentModelIndex(index) : QPersistentModelIndex();
+
+    /* Hide the old widget so that it does not count towards the scene bounds */
+    widget->Off();
+    if (currentScope == Off) {
+        apply();
+        return;
+    }
+
+    /* Fit the widget to what is sectioned, cutting through its centre along y like the clip filter */
+    vtkBoundingBox box;
+    if (currentScope == Scene) {
+        double bounds[6];
+        renderer->ComputeVisiblePropBounds(bounds);
+        box.AddBounds(bounds);
+    } else {
+        QList<ModelPart*> stack = { partList->getItem(target) };
+        while (!stack.isEmpty()) {
+            ModelPart* part = stack.takeLast();
+            if (part->getActor())
+                box.AddBounds(part->getActor()->GetBounds());
+            if (currentScope == Subtree)
+                for (int i = 0; i < part->childCount(); ++i)
+                    stack.append(part->child(i));
+        }
+    }
+    double bounds[6] = { -1., 1., -1., 1., -1., 1. };
+    if (box.IsValid())
+        box.GetBounds(bounds);
+
+    representation->PlaceWidget(bounds);
+    representation->SetOrigin((bounds[0] + bounds[1]) / 2., (bounds[2] + bounds[3]) / 2., (bounds[4] + bounds[5]) / 2.);
+    representation->SetNormal(0., 1., 0.);
+    updatePlane();
+
+    widget->On();
+    apply();
+}
+
+/**
+ * @brief Returns the scope, treating a deleted target as Off.
+ */
+SectionView::Scope SectionView::scope() const {
+    if ((currentScope == Part || currentScope == Subtree) && !target.isValid())
+        return Off;
+    return currentScope;
+}
+
+/**
+ * @brief Checks whether the part is the target, or below it in Subtree scope.
+ */
+bool SectionView::sectionsPart(ModelPart* part) const {
+    Scope active = scope();
+    if (active != Part && active != Subtree)
+        return false;
+
+    ModelPart* targetPart = partList->getItem(target);
+    if (active == Part)
+        return part == targetPart;
+    for (ModelPart* p = part; p; p = p->parentItem())
+        if (p == targetPart)
+            return true;
+    return false;
+}
+
+/**
+ * @brief Moves the shared plane from the previously sectioned mappers to the current ones.
+ * @details The widget's representation is taken out of the renderer while the scene's actors
+ *          are collected and put back afterwards, which also restores it after the renderer's
+ *          props were cleared.
+ */
+void SectionView::apply() {
+    /* Keep the widget's own actors out of the scene scope while collecting */
+    renderer->RemoveViewProp(representation);
+
+    for (vtkMapper* mapper : std::as_const(clipped))
+        mapper->RemoveClippingPlane(plane);
+    clipped.clear();
+
+    Scope active = scope();
+    if (active == Off) {
+        widget->Off();
+        return;
+    }
+
+    if (active == Scene) {
+        vtkActorCollection* actors = renderer->GetActors();
+        vtkCollectionSimpleIterator it;
+        actors->InitTraversal(it);
+        while (vtkActor* actor = actors->GetNextActor(it))
+            if (actor->GetMapper())
+                clipped.append(actor->GetMapper());
+    } else {
+        QList<ModelPart*> stack = { partList->getItem(target) };
+        while (!stack.isEmpty()) {
+            ModelPart* part = stack.takeLast();
+            if (part->getActor() && part->getActor()->GetMapper())
+                clipped.append(part->getActor()->GetMapper());
+            if (active == Subtree)
+                for (int i = 0; i < part->childCount(); ++i)
+                    stack.append(part->child(i));
+        }
+    }
+
+    for (vtkMapper* mapper : std::as_const(clipped))
+        mapper->AddClippingPlane(plane);
+
+    renderer->AddViewProp(representation);
+}
+
+/**
+ * @brief Copies the widget's plane into the clipping plane used by the mappers.
+ */
+void SectionView::updatePlane() {
+    representation->GetPlane(plane);
+}
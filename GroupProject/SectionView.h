@@ -0,0 +1,102 @@
+/**
+ * @file SectionView.h
+ * @brief Declaration of the SectionView class, an interactive section plane for the desktop view.
+ * @details The section is cut by the graphics hardware: one vtkPlane is added as a clipping
+ *          plane to the mappers of the sectioned actors, and the plane widget moves that plane.
+ *          Dragging the widget therefore only re-renders, no geometry is rebuilt, unlike the
+ *          per-part clip filter which recomputes the part on the CPU.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_SECTIONVIEW_H
+#define VIEWER_SECTIONVIEW_H
+
+#include <QObject>
+#include <QList>
+#include <QPersistentModelIndex>
+
+#include <vtkSmartPointer.h>
+#include <vtkPlane.h>
+#include <vtkMapper.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkImplicitPlaneWidget2.h>
+#include <vtkImplicitPlaneRepresentation.h>
+
+class ModelPart;
+class ModelPartList;
+
+/**
+ * @class SectionView
+ * @brief Section plane applied to one part, a subtree or the whole scene.
+ * @details The target is kept as a persistent model index, so deleting the sectioned part
+ *          simply ends the section.
+ */
+class SectionView : public QObject {
+    Q_OBJECT
+
+public:
+    /** What the section plane cuts */
+    enum Scope {
+        Off,        /**< Nothing, the widget is hidden */
+        Part,       /**< The target part only */
+        Subtree,    /**< The target part and everything below it */
+        Scene       /**< Every actor in the renderer */
+    };
+
+    /**
+     * @brief Constructs an inactive section view.
+     * @param partList Model holding the tree.
+     * @param parent Optional QObject parent.
+     */
+    SectionView(ModelPartList* partList, QObject* parent = nullptr);
+
+    /**
+     * @brief Connects the plane widget to the view.
+     * @param interactor Interactor of the render window.
+     * @param renderer Renderer the widget and the sectioned actors belong to.
+     */
+    void setView(vtkRenderWindowInteractor* interactor, vtkRenderer* renderer);
+
+    /**
+     * @brief Changes what is sectioned and places the plane through the middle of it.
+     * @param scope New scope.
+     * @param target Part to section for the Part and Subtree scopes.
+     */
+    void setScope(Scope scope, const QModelIndex& target = QModelIndex());
+
+    /**
+     * @brief Returns the current scope, Off if the target part has been deleted.
+     */
+    Scope scope() const;
+
+    /**
+     * @brief Returns whether a part is cut by the plane on its own actor (Part or Subtree scope).
+     * @details Such parts must keep their own actor rather than being merged into a batch.
+     */
+    bool sectionsPart(ModelPart* part) const;
+
+    /**
+     * @brief Puts the plane on the mappers of the sectioned actors and takes it off all others.
+     * @details Call after the renderer's actors have been rebuilt.
+     */
+    void apply();
+
+private:
+    /**
+     * @brief Copies the widget's plane into the clipping plane.
+     */
+    void updatePlane();
+
+    ModelPartList*                                  partList;       /**< Model holding the tree */
+    Scope                                           currentScope;   /**< What is being sectioned */
+    QPersistentModelIndex                           target;         /**< Part sectioned in Part and Subtree scope */
+    vtkSmartPointer<vtkRenderer>                    renderer;       /**< Renderer holding the sectioned actors */
+    vtkSmartPointer<vtkPlane>                       plane;          /**< Clipping plane shared by all sectioned mappers */
+    vtkSmartPointer<vtkImplicitPlaneRepresentation> representation; /**< Drawn plane, normal arrow and outline */
+    vtkSmartPointer<vtkImplicitPlaneWidget2>        widget;         /**< Lets the user drag and tilt the plane */
+    QList<vtkSmartPointer<vtkMapper>>               clipped;        /**< Mappers the plane is currently on */
+};
+
+#endif
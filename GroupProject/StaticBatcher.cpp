@@ -0,0 +1,318 @@
+/**
+ * @file StaticBatcher.cpp
+ * @brief Implementation of the StaticBatcher class.
+ * @details Merged meshes use float points and 64 bit cell arrays, like the meshes built by
+ *          MeshUtils. Members are copied into their batch in parallel, one task per member.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "StaticBatcher.h"
+#include "ModelPart.h"
+#include "MeshUtils.h"
+#include "Trace.h"
+
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief Copies cells into a merged cell array, shifting offsets and point ids.
+ * @param offsets Source offsets, cells + 1 values.
+ * @param connectivity Source point ids.
+ * @param cells Number of cells to copy.
+ * @param outOffsets Receives cells offsets (the final offset is written by the caller).
+ * @param outConnectivity Receives offsets[cells] point ids.
+ * @param connectivityBase Position of the first point id in the merged connectivity.
+ * @param pointBase Position of the first point in the merged points.
+ */
+template <typename T>
+void copyCells(const T* offsets, const T* connectivity, vtkIdType cells,
+               vtkIdType* outOffsets, vtkIdType* outConnectivity,
+               vtkIdType connectivityBase, vtkIdType pointBase) {
+    const T first = offsets[0];
+    for (vtkIdType c = 0; c < cells; ++c)
+        outOffsets[c] = connectivityBase + vtkIdType(offsets[c] - first);
+    const vtkIdType count = vtkIdType(offsets[cells] - first);
+    for (vtkIdType k = 0; k < count; ++k)
+        outConnectivity[k] = pointBase + vtkIdType(connectivity[first + k]);
+}
+
+}
+
+/**
+ * @brief Checks visibility, residency, filters, transform, opacity and cell types.
+ */
+bool StaticBatcher::isEligible(ModelPart* part) {
+    if (!part || !part->visible() || part->clip() || part->shrink() || part->isCompact() || part->isReleased() ||
+        part->isAnimated())
+        return false;
+
+    vtkActor* actor = part->getActor();
+    if (!actor || !actor->GetVisibility() || !actor->GetIsIdentity() || actor->GetProperty()->GetOpacity() < 1.)
+        return false;
+
+    /* Only polygons are merged, anything else would be dropped from the batch */
+    vtkSmartPointer<vtkPolyData> polyData = part->getPolyData();
+    return polyData && polyData->GetNumberOfPolys() > 0 && polyData->GetNumberOfVerts() == 0 &&
+           polyData->GetNumberOfLines() == 0 && polyData->GetNumberOfStrips() == 0;
+}
+
+/**
+ * @brief Reads the geometry and colour an eligible part is drawn with.
+ */
+StaticBatcher::Signature StaticBatcher::signatureOf(ModelPart* part) {
+    Signature signature;
+    vtkSmartPointer<vtkPolyData> polyData = part->getPolyData();
+    signature.geometry = polyData;
+    signature.geometryTime = polyData->GetMTime();
+    signature.cells = polyData->GetNumberOfPolys();
+
+    double rgb[3];
+    part->getActor()->GetProperty()->GetColor(rgb);
+    for (double c : rgb)
+        signature.colour = (signature.colour << 8) | quint32(std::lround(std::clamp(c, 0., 1.) * 255.));
+    return signature;
+}
+
+/**
+ * @brief Removes members that left or changed colour, places new parts and rebuilds dirty batches.
+ */
+int StaticBatcher::update(const QList<ModelPart*>& parts) {
+    TRACE_SCOPE("StaticBatcher::update");
+
+    QHash<ModelPart*, Signature> current;
+    current.reserve(parts.size());
+    for (ModelPart* part : parts)
+        current.insert(part, signatureOf(part));
+
+    /* 1. Members that are gone, or now need a different colour, leave their batch */
+    for (const std::unique_ptr<Batch>& batch : batches) {
+        batch->triangles = 0;
+        for (int i = batch->members.size() - 1; i >= 0; --i) {
+            auto it = current.constFind(batch->members[i]);
+            if (it == current.cend() || it->colour != batch->colour) {
+                assignment.remove(batch->members[i]);
+                batch->members.removeAt(i);
+                batch->signatures.removeAt(i);
+                batch->dirty = true;
+                continue;
+            }
+            if (!(*it == batch->signatures[i]))
+                batch->dirty = true;
+            batch->triangles += it->cells;
+        }
+    }
+
+    /* 2. New members join a batch of their colour that still has room */
+    QHash<quint32, Batch*> open;
+    for (const std::unique_ptr<Batch>& batch : batches)
+        if (batch->triangles < MaxBatchTriangles)
+            open.insert(batch->colour, batch.get());
+
+    for (ModelPart* part : parts) {
+        if (assignment.contains(part))
+            continue;
+        const Signature& signature = current[part];
+        Batch* batch = open.value(signature.colour);
+        if (!batch || batch->triangles >= MaxBatchTriangles) {
+            batches.push_back(std::make_unique<Batch>());
+            batch = batches.back().get();
+            batch->colour = signature.colour;
+            open.insert(signature.colour, batch);
+        }
+        batch->members.append(part);
+        batch->signatures.append(signature);
+        batch->triangles += signature.cells;
+        batch->dirty = true;
+        assignment.insert(part, batch);
+    }
+
+    /* 3. Drop empty batches, rebuild the ones that changed */
+    int rebuilt = 0;
+    for (auto it = batches.begin(); it != batches.end(); ) {
+        Batch& batch = **it;
+        if (batch.members.isEmpty()) {
+            actorBatches.remove(batch.actor);
+            it = batches.erase(it);
+            continue;
+        }
+        if (batch.dirty) {
+            for (int i = 0; i < batch.members.size(); ++i)
+                batch.signatures[i] = current[batch.members[i]];
+            rebuild(batch);
+            actorBatches.insert(batch.actor, &batch);
+            ++rebuilt;
+        }
+        ++it;
+    }
+    return rebuilt;
+}
+
+/**
+ * @brief Concatenates the members' points, normals (if all members have them) and polygons.
+ */
+void StaticBatcher::rebuild(Batch& batch) {
+    TRACE_SCOPE("StaticBatcher::rebuild");
+
+    const int n = batch.members.size();
+    std::vector<vtkSmartPointer<vtkPolyData>> meshes(static_cast<size_t>(n));
+    std::vector<vtkIdType> pointStart(n + 1, 0), cellStart(n + 1, 0), connectivityStart(n + 1, 0);
+    bool withNormals = true;
+    for (int i = 0; i < n; ++i) {
+        meshes[i] = batch.members[i]->getPolyData();
+        withNormals = withNormals && meshes[i]->GetPointData()->GetNormals();
+        pointStart[i + 1] = pointStart[i] + meshes[i]->GetNumberOfPoints();
+        cellStart[i + 1] = cellStart[i] + meshes[i]->GetNumberOfPolys();
+        connectivityStart[i + 1] = connectivityStart[i] + meshes[i]->GetPolys()->GetNumberOfConnectivityIds();
+    }
+
+    auto points = vtkSmartPointer<vtkFloatArray>::New();
+    points->SetNumberOfComponents(3);
+    points->SetNumberOfTuples(pointStart[n]);
+    vtkSmartPointer<vtkFloatArray> normals;
+    if (withNormals) {
+        normals = vtkSmartPointer<vtkFloatArray>::New();
+        normals->SetName("Normals");
+        normals->SetNumberOfComponents(3);
+        normals->SetNumberOfTuples(pointStart[n]);
+    }
+    auto offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+    offsets->SetNumberOfValues(cellStart[n] + 1);
+    auto connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(connectivityStart[n]);
+
+    float* pointOut = points->GetPointer(0);
+    float* normalOut = normals ? normals->GetPointer(0) : nullptr;
+    vtkIdType* offsetOut = offsets->GetPointer(0);
+    vtkIdType* connectivityOut = connectivity->GetPointer(0);
+
+    MeshUtils::parallelFor(n, [&](qint64 begin, qint64 end) {
+        for (qint64 i = begin; i < end; ++i) {
+            vtkPolyData* mesh = meshes[i];
+            const vtkIdType pointCount = mesh->GetNumberOfPoints();
+            float* pointDst = pointOut + 3 * pointStart[i];
+
+            vtkDataArray* pointData = mesh->GetPoints()->GetData();
+            if (vtkFloatArray* floats = vtkFloatArray::SafeDownCast(pointData)) {
+                std::memcpy(pointDst, floats->GetPointer(0), size_t(pointCount) * 3 * sizeof(float));
+            } else {
+                double p[3];
+                for (vtkIdType j = 0; j < pointCount; ++j) {
+                    pointData->GetTuple(j, p);
+                    pointDst[3 * j] = float(p[0]);
+                    pointDst[3 * j + 1] = float(p[1]);
+                    pointDst[3 * j + 2] = float(p[2]);
+                }
+            }
+
+            if (normalOut) {
+                vtkDataArray* normalData = mesh->GetPointData()->GetNormals();
+                float* normalDst = normalOut + 3 * pointStart[i];
+                double v[3];
+                for (vtkIdType j = 0; j < pointCount; ++j) {
+                    normalData->GetTuple(j, v);
+                    normalDst[3 * j] = float(v[0]);
+                    normalDst[3 * j + 1] = float(v[1]);
+                    normalDst[3 * j + 2] = float(v[2]);
+                }
+            }
+
+            vtkCellArray* polys = mesh->GetPolys();
+            if (polys->IsStorage64Bit())
+                copyCells(polys->GetOffsetsArray64()->GetPointer(0), polys->GetConnectivityArray64()->GetPointer(0),
+                          mesh->GetNumberOfPolys(), offsetOut + cellStart[i], connectivityOut + connectivityStart[i],
+                          connectivityStart[i], pointStart[i]);
+            else
+                copyCells(polys->GetOffsetsArray32()->GetPointer(0), polys->GetConnectivityArray32()->GetPointer(0),
+                          mesh->GetNumberOfPolys(), offsetOut + cellStart[i], connectivityOut + connectivityStart[i],
+                          connectivityStart[i], pointStart[i]);
+        }
+    }, 1);
+    offsetOut[cellStart[n]] = connectivityStart[n];
+
+    auto vtkpoints = vtkSmartPointer<vtkPoints>::New();
+    vtkpoints->SetData(points);
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsets, connectivity);
+
+    auto merged = vtkSmartPointer<vtkPolyData>::New();
+    merged->SetPoints(vtkpoints);
+    merged->SetPolys(polys);
+    if (normals)
+        merged->GetPointData()->SetNormals(normals);
+
+    if (!batch.actor) {
+        batch.actor = vtkSmartPointer<vtkActor>::New();
+        batch.actor->SetMapper(vtkSmartPointer<vtkPolyDataMapper>::New());
+        batch.actor->GetProperty()->SetColor(((batch.colour >> 16) & 0xff) / 255.,
+                                             ((batch.colour >> 8) & 0xff) / 255.,
+                                             (batch.colour & 0xff) / 255.);
+    }
+    vtkPolyDataMapper::SafeDownCast(batch.actor->GetMapper())->SetInputData(merged);
+
+    batch.cellStarts = QVector<vtkIdType>(cellStart.begin(), cellStart.end());
+    batch.dirty = false;
+}
+
+/**
+ * @brief Forgets all batches and members.
+ */
+void StaticBatcher::clear() {
+    batches.clear();
+    assignment.clear();
+    actorBatches.clear();
+}
+
+/**
+ * @brief Looks the part up in the member table.
+ */
+bool StaticBatcher::contains(ModelPart* part) const {
+    return assignment.contains(part);
+}
+
+/**
+ * @brief Collects the batch actors.
+ */
+QList<vtkActor*> StaticBatcher::actors() const {
+    QList<vtkActor*> list;
+    for (const std::unique_ptr<Batch>& batch : batches)
+        list.append(batch->actor);
+    return list;
+}
+
+/**
+ * @brief Finds the member whose cell range contains the picked cell.
+ */
+ModelPart* StaticBatcher::partAt(vtkActor* actor, vtkIdType cellId) const {
+    const Batch* batch = actorBatches.value(actor, nullptr);
+    if (!batch || cellId < 0 || cellId >= batch->cellStarts.last())
+        return nullptr;
+    auto it = std::upper_bound(batch->cellStarts.cbegin(), batch->cellStarts.cend(), cellId);
+    return batch->members[int(it - batch->cellStarts.cbegin()) - 1];
+}
+
+/**
+ * @brief Returns the number of batches.
+ */
+int StaticBatcher::batchCount() const {
+    return int(batches.size());
+}
+
+/**
+ * @brief Returns the number of members over all batches.
+ */
+int StaticBatcher::memberCount() const {
+    return assignment.size();
+}
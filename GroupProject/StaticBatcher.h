@@ -0,0 +1,130 @@
+/**
+ * @file StaticBatcher.h
+ * @brief Declaration of the StaticBatcher class, which merges same coloured parts for rendering.
+ * @details Scenes made of thousands of small parts are limited by the per-actor cost of the
+ *          renderer rather than by triangle count. With static batching, visible parts that have
+ *          no filter, transform or compact storage are merged by colour into a few large meshes,
+ *          each drawn with a single actor. Batches remember which cells came from which part, so
+ *          picks can be mapped back to the tree. Batched geometry is a second copy of the
+ *          members' meshes, so batching trades memory for draw calls.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_STATICBATCHER_H
+#define VIEWER_STATICBATCHER_H
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkPolyData.h>
+
+#include <memory>
+#include <vector>
+
+class ModelPart;
+
+/**
+ * @class StaticBatcher
+ * @brief Keeps merged meshes of eligible parts up to date.
+ * @details Parts stay in the batch they were first put in. When a member changes (geometry,
+ *          colour, visibility or a filter), joins or leaves, only the batches it belongs to are
+ *          rebuilt; the others keep their merged mesh.
+ */
+class StaticBatcher {
+public:
+    /** A batch accepts no new members once it holds this many triangles */
+    static constexpr qint64 MaxBatchTriangles = qint64(1) << 20;
+
+    /**
+     * @brief Returns whether a part can be drawn as part of a batch.
+     * @details The part must be visible and resident, unfiltered, untransformed, not animated,
+     *          opaque and not compact.
+     */
+    static bool isEligible(ModelPart* part);
+
+    /**
+     * @brief Brings the batches in line with a new set of eligible parts.
+     * @details Parts that have been deleted may still be referenced by the batches, they are
+     *          recognised by not being in the list and never dereferenced.
+     * @param parts Every eligible part, in tree order.
+     * @return the number of batches that were rebuilt
+     */
+    int update(const QList<ModelPart*>& parts);
+
+    /**
+     * @brief Removes all batches.
+     */
+    void clear();
+
+    /**
+     * @brief Returns whether a part is drawn by one of the batches instead of its own actor.
+     */
+    bool contains(ModelPart* part) const;
+
+    /**
+     * @brief Returns the actors of all batches.
+     */
+    QList<vtkActor*> actors() const;
+
+    /**
+     * @brief Maps a picked cell of a batch actor back to the part it came from.
+     * @param actor Picked actor.
+     * @param cellId Picked cell of the actor's mesh.
+     * @return the part, or nullptr if the actor is not a batch
+     */
+    ModelPart* partAt(vtkActor* actor, vtkIdType cellId) const;
+
+    /**
+     * @brief Returns the number of batches.
+     */
+    int batchCount() const;
+
+    /**
+     * @brief Returns the number of parts drawn by the batches.
+     */
+    int memberCount() const;
+
+private:
+    /** What a member looked like when its batch was built */
+    struct Signature {
+        vtkPolyData*    geometry = nullptr;     /**< Geometry that was merged */
+        vtkMTimeType    geometryTime = 0;       /**< Its modification time */
+        quint32         colour = 0;             /**< Packed RGB colour */
+        vtkIdType       cells = 0;              /**< Number of polygons, not compared */
+
+        bool operator==(const Signature& other) const {
+            return geometry == other.geometry && geometryTime == other.geometryTime && colour == other.colour;
+        }
+    };
+
+    /** One merged mesh */
+    struct Batch {
+        quint32                     colour = 0;     /**< Packed RGB colour shared by all members */
+        QVector<ModelPart*>         members;        /**< Parts in the order they appear in the mesh */
+        QVector<Signature>          signatures;     /**< Member state at the last rebuild */
+        QVector<vtkIdType>          cellStarts;     /**< First cell of each member, plus the total */
+        qint64                      triangles = 0;  /**< Cells held by the members */
+        bool                        dirty = true;   /**< Mesh needs rebuilding */
+        vtkSmartPointer<vtkActor>   actor;          /**< Actor drawing the merged mesh */
+    };
+
+    /**
+     * @brief Returns the current signature of an eligible part.
+     */
+    static Signature signatureOf(ModelPart* part);
+
+    /**
+     * @brief Merges the members' geometry into the batch's mesh, in parallel.
+     */
+    static void rebuild(Batch& batch);
+
+    std::vector<std::unique_ptr<Batch>>     batches;        /**< All batches */
+    QHash<ModelPart*, Batch*>               assignment;     /**< Batch of every member */
+    QHash<vtkActor*, Batch*>                actorBatches;   /**< Batch drawn by each actor */
+};
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * @file ThumbnailCache.cpp
+ * @brief Implementation of the ThumbnailCache class.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "ThumbnailCache.h"
+#include "BatchRenderer.h"
+#include "ModelPart.h"
+#include "ModelPartList.h"
+#include "Trace.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QMetaObject>
+#include <QPixmap>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkPoints.h>
+
+namespace {
+
+/** Most jobs waiting at once, older requests are dropped when the user scrolls on quickly */
+const int MaxQueued = 256;
+
+/** Thumbnails kept in memory */
+const int MaxIcons = 4096;
+
+/**
+ * @brief Adds the raw values of an array to a hash.
+ */
+void addArray(QCryptographicHash& hash, vtkDataArray* array) {
+    if (!array || array->GetNumberOfValues() == 0)
+        return;
+    hash.addData(QByteArray::fromRawData(static_cast<const char*>(array->GetVoidPointer(0)),
+                                         int(array->GetNumberOfValues() * array->GetDataTypeSize())));
+}
+
+/**
+ * @brief Hashes the points and polygons of a mesh and the matrix placing it.
+ */
+QByteArray geometryHash(vtkPolyData* polyData, vtkMatrix4x4* matrix) {
+    TRACE_SCOPE("ThumbnailCache::hash");
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (polyData->GetPoints())
+        addArray(hash, polyData->GetPoints()->GetData());
+    if (vtkCellArray* polys = polyData->GetPolys()) {
+        addArray(hash, polys->GetOffsetsArray());
+        addArray(hash, polys->GetConnectivityArray());
+    }
+    if (matrix)
+        hash.addData(QByteArray::fromRawData(reinterpret_cast<const char*>(matrix->GetData()), 16 * sizeof(double)));
+    return hash.result();
+}
+
+}
+
+/**
+ * @brief Sets up a single worker thread that is kept alive, together with its offscreen window.
+ */
+ThumbnailCache::ThumbnailCache(ModelPartList* list, QObject* parent)
+    : QObject(parent), partList(list), busy(false), icons(MaxIcons) {
+    worker.setMaxThreadCount(1);
+    worker.setExpiryTimeout(-1);
+}
+
+/**
+ * @brief Drops the queue and waits for the running job; its result is discarded with this object.
+ */
+ThumbnailCache::~ThumbnailCache() {
+    queue.clear();
+    worker.waitForDone();
+}
+
+/**
+ * @brief Looks the thumbnail up in memory, otherwise queues a job for the worker.
+ */
+QIcon ThumbnailCache::icon(const QModelIndex& index) {
+    ModelPart* part = partList->getItem(index);
+    vtkMatrix4x4* matrix = nullptr;
+    vtkPolyData* geometry = part->getStoredGeometry(&matrix);
+    const quint32 rgb = (quint32(part->getColourR()) << 16) | (quint32(part->getColourG()) << 8)
+                        | quint32(part->getColourB());
+
+    /* A released part keeps the hash of its last geometry, so its picture can still come from disk */
+    auto known = hashes.constFind(part);
+    const bool hashValid = known != hashes.constEnd() && (!geometry || known->time == geometry->GetMTime());
+    if (hashValid) {
+        if (QIcon* cached = icons.object(cacheKey(known->hash, rgb)))
+            return *cached;
+    }
+
+    if (pending.contains(part) || (!geometry && !hashValid) || (geometry && geometry->GetNumberOfCells() == 0))
+        return QIcon();
+
+    Job job;
+    job.index = index.siblingAtColumn(0);
+    job.part = part;
+    job.time = geometry ? geometry->GetMTime() : known->time;
+    if (geometry) {
+        /* The worker reads its own copy of the data object, the arrays themselves are shared */
+        job.geometry = vtkSmartPointer<vtkPolyData>::New();
+        job.geometry->ShallowCopy(geometry);
+    }
+    if (matrix) {
+        job.matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+        job.matrix->DeepCopy(matrix);
+    }
+    if (hashValid)
+        job.hash = known->hash;
+    job.rgb = rgb;
+
+    pending.insert(part);
+    queue.append(job);
+    if (queue.size() > MaxQueued)
+        pending.remove(queue.takeFirst().part);
+    startNext();
+    return QIcon();
+}
+
+/**
+ * @brief Returns the thumbnails folder next to the geometry cache.
+ */
+QString ThumbnailCache::directory() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+}
+
+/**
+ * @brief Hands the newest request to the worker, the rows the user is looking at right now.
+ */
+void ThumbnailCache::startNext() {
+    if (busy || queue.isEmpty())
+        return;
+
+    busy = true;
+    Job job = queue.takeLast();
+    worker.start([this, job]() mutable {
+        run(job);
+        QMetaObject::invokeMethod(this, [this, job]() { finished(job); }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Remembers the hash and icon if the part still exists, then starts the next job.
+ */
+void ThumbnailCache::finished(const Job& job) {
+    busy = false;
+    pending.remove(job.part);
+
+    /* The part may have been deleted while its thumbnail was being made */
+    if (!job.hash.isEmpty() && job.index.isValid() && partList->getItem(job.index) == job.part) {
+        hashes.insert(job.part, { job.time, job.hash });
+        icons.insert(job.key, new QIcon(job.image.isNull() ? QIcon() : QIcon(QPixmap::fromImage(job.image))));
+        emit thumbnailReady(job.index);
+    }
+
+    startNext();
+}
+
+/**
+ * @brief Hashes the geometry if needed, then loads the thumbnail from disk or renders and stores it.
+ */
+void ThumbnailCache::run(Job& job) {
+    TRACE_SCOPE("ThumbnailCache::run");
+
+    if (job.hash.isEmpty()) {
+        if (!job.geometry)
+            return;
+        job.hash = geometryHash(job.geometry, job.matrix);
+    }
+    job.key = cacheKey(job.hash, job.rgb);
+
+    const QString fileName = directory() + '/' + job.key + ".png";
+    if (job.image.load(fileName, "PNG") || !job.geometry)
+        return;
+
+    BatchRenderer::Item item{ job.geometry, { ((job.rgb >> 16) & 0xff) / 255., ((job.rgb >> 8) & 0xff) / 255.,
+                                              (job.rgb & 0xff) / 255. }, job.matrix };
+    job.image = BatchRenderer::renderToImage({ item }, "iso", ImageSize, ImageSize);
+    if (job.image.isNull() || !QDir().mkpath(directory()))
+        return;
+
+    QSaveFile file(fileName);
+    if (file.open(QIODevice::WriteOnly) && job.image.save(&file, "PNG"))
+        file.commit();
+}
+
+/**
+ * @brief Combines the geometry hash and the colour, the two things the picture depends on.
+ */
+QString ThumbnailCache::cacheKey(const QByteArray& hash, quint32 rgb) {
+    return QString::fromLatin1(hash.toHex()) + '-' + QString::number(rgb, 16).rightJustified(6, '0');
+}
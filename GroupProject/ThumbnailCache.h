@@ -0,0 +1,132 @@
+/**
+ * @file ThumbnailCache.h
+ * @brief Declaration of the ThumbnailCache class, small rendered pictures of the parts in the tree.
+ * @details The tree asks for a part's thumbnail when it paints the row, so only parts in rows
+ *          the user can see are ever rendered. Rendering happens offscreen on one background
+ *          thread, most recent request first, and the finished pictures are kept in memory and
+ *          as PNG files on disk, keyed by a hash of the geometry and the part's colour. The same
+ *          mesh therefore renders once, even across sessions or when it appears under several
+ *          names.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_THUMBNAILCACHE_H
+#define VIEWER_THUMBNAILCACHE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QList>
+#include <QPersistentModelIndex>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkMatrix4x4.h>
+
+class ModelPart;
+class ModelPartList;
+
+/**
+ * @class ThumbnailCache
+ * @brief Lazily rendered, cached part thumbnails for the tree view.
+ * @details All public functions must be called on the GUI thread.
+ */
+class ThumbnailCache : public QObject {
+    Q_OBJECT
+
+public:
+    /** Width and height of a rendered thumbnail in pixels, twice the icon size for high DPI screens */
+    static constexpr int ImageSize = 64;
+
+    /**
+     * @brief Constructs the cache and its worker thread.
+     * @param partList Model holding the parts.
+     * @param parent Optional QObject parent.
+     */
+    ThumbnailCache(ModelPartList* partList, QObject* parent = nullptr);
+
+    /**
+     * @brief Waits for the thumbnail being rendered and drops the queued ones.
+     */
+    ~ThumbnailCache();
+
+    /**
+     * @brief Returns the thumbnail of a part, queueing it for rendering if it is not cached yet.
+     * @param index Index of the part.
+     * @return the icon, or a null icon until the thumbnail is ready
+     */
+    QIcon icon(const QModelIndex& index);
+
+    /**
+     * @brief Returns the folder the thumbnail images are stored in.
+     */
+    static QString directory();
+
+signals:
+    /**
+     * @brief Emitted when a requested thumbnail is ready.
+     * @param index Index of the part, column 0.
+     */
+    void thumbnailReady(const QModelIndex& index);
+
+private:
+    /** Everything the worker needs to produce one thumbnail */
+    struct Job {
+        QPersistentModelIndex           index;      /**< Part the thumbnail is for */
+        ModelPart*                      part;       /**< Part, only compared, never dereferenced by the worker */
+        vtkSmartPointer<vtkPolyData>    geometry;   /**< Shallow copy of the stored geometry, null if released */
+        vtkSmartPointer<vtkMatrix4x4>   matrix;     /**< Copy of the compact matrix, may be null */
+        vtkMTimeType                    time;       /**< Modification time of the geometry */
+        QByteArray                      hash;       /**< Geometry hash, empty if not known yet */
+        quint32                         rgb;        /**< Packed colour */
+        QString                         key;        /**< Set by the worker */
+        QImage                          image;      /**< Set by the worker, null if it could not be rendered */
+    };
+
+    /** Geometry hash remembered for a part */
+    struct PartHash {
+        vtkMTimeType    time;   /**< Modification time of the geometry that was hashed */
+        QByteArray      hash;   /**< Hash of its points and cells */
+    };
+
+    /**
+     * @brief Starts the most recent queued job if the worker is idle.
+     */
+    void startNext();
+
+    /**
+     * @brief Stores a finished job and tells the model.
+     * @param job Job returned by the worker.
+     */
+    void finished(const Job& job);
+
+    /**
+     * @brief Hashes, loads or renders one thumbnail, on the worker thread.
+     * @param job Job to complete.
+     */
+    static void run(Job& job);
+
+    /**
+     * @brief Returns the cache key of a thumbnail.
+     * @param hash Geometry hash.
+     * @param rgb Packed colour.
+     */
+    static QString cacheKey(const QByteArray& hash, quint32 rgb);
+
+    ModelPartList*                  partList;   /**< Model holding the parts */
+    QThreadPool                     worker;     /**< Single thread keeping one offscreen window */
+    bool                            busy;       /**< A job is on the worker */
+    QList<Job>                      queue;      /**< Waiting jobs, the last one is started next */
+    QSet<ModelPart*>                pending;    /**< Parts queued or being rendered */
+    QHash<ModelPart*, PartHash>     hashes;     /**< Geometry hash of each part seen so far */
+    QCache<QString, QIcon>          icons;      /**< Thumbnails in memory by cache key */
+};
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * @file Trace.cpp
+ * @brief Implementation of the Trace class.
+ * @details Each thread's buffer is created on its first event and registered in a global list,
+ *          which keeps it alive after the thread exits so that pooled and VR threads still show
+ *          up in the export. The per-buffer mutex is only ever contended by an export.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/** One complete ("ph":"X") event */
+struct TraceEvent {
+    const char* name;
+    qint64      start;
+    qint64      duration;
+};
+
+/** Ring buffer owned by one thread */
+struct ThreadBuffer {
+    std::mutex              lock;
+    std::vector<TraceEvent> events;
+    quint64                 written = 0;    /**< Total events recorded, the ring index is written % size */
+    int                     id = 0;
+    QByteArray              name;
+};
+
+/** All buffers ever created */
+struct Registry {
+    std::mutex                                  lock;
+    std::vector<std::shared_ptr<ThreadBuffer>>  buffers;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+/**
+ * @brief Returns the calling thread's buffer, creating and registering it on first use.
+ */
+ThreadBuffer& threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->events.resize(Trace::BufferSize);
+
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        buffer->id = int(reg.buffers.size()) + 1;
+
+        QThread* thread = QThread::currentThread();
+        if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+            buffer->name = "Main";
+        else if (thread && !thread->objectName().isEmpty())
+            buffer->name = QString("%1 %2").arg(thread->objectName()).arg(buffer->id).toUtf8();
+        else
+            buffer->name = QString("Thread %1").arg(buffer->id).toUtf8();
+
+        reg.buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+/**
+ * @brief Appends a JSON string literal, escaping quotes, backslashes and control characters.
+ */
+void appendJsonString(QByteArray& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+            out += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            out += ' ';
+        } else {
+            out += *c;
+        }
+    }
+    out += '"';
+}
+
+}
+
+std::atomic<bool> Trace::enabled{ false };
+
+/**
+ * @brief Turns recording on or off.
+ */
+void Trace::setEnabled(bool on) {
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Enables tracing when GROUPPROJECT_TRACE is set to anything but "0".
+ */
+void Trace::initFromEnvironment() {
+    QByteArray value = qgetenv("GROUPPROJECT_TRACE");
+    if (!value.isEmpty() && value != "0")
+        setEnabled(true);
+}
+
+/**
+ * @brief Empties every registered buffer.
+ */
+void Trace::clear() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> bufferGuard(buffer->lock);
+        buffer->written = 0;
+    }
+}
+
+/**
+ * @brief Returns steady clock nanoseconds.
+ */
+qint64 Trace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Stores an event in the calling thread's ring buffer, overwriting the oldest when full.
+ */
+void Trace::record(const char* name, qint64 startNs, qint64 durationNs) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> guard(buffer.lock);
+    buffer.events[buffer.written % BufferSize] = { name, startNs, durationNs };
+    ++buffer.written;
+}
+
+/**
+ * @brief Sums the held events of all buffers.
+ */
+qint64 Trace::eventCount() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    qint64 count = 0;
+    for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> bufferGuard(buffer->lock);
+        count += qint64(std::min<quint64>(buffer->written, BufferSize));
+    }
+    return count;
+}
+
+/**
+ * @brief Writes {"traceEvents":[...]} with a thread name entry and complete events per thread.
+ * @details Time stamps are microseconds relative to the earliest held event.
+ */
+bool Trace::exportChromeJson(const QString& fileName, QString* errorString) {
+    /* Copy the events out first so recording threads are held up as briefly as possible */
+    struct ThreadEvents {
+        int                     id;
+        QByteArray              name;
+        std::vector<TraceEvent> events;
+    };
+    std::vector<ThreadEvents> threads;
+    qint64 origin = std::numeric_limits<qint64>::max();
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        for (const std::shared_ptr<ThreadBuffer>& buffer : reg.buffers) {
+            std::lock_guard<std::mutex> bufferGuard(buffer->lock);
+            ThreadEvents copy{ buffer->id, buffer->name, {} };
+            quint64 count = std::min<quint64>(buffer->written, BufferSize);
+            copy.events.reserve(count);
+            for (quint64 i = buffer->written - count; i < buffer->written; ++i) {
+                const TraceEvent& event = buffer->events[i % BufferSize];
+                copy.events.push_back(event);
+                origin = std::min(origin, event.start);
+            }
+            threads.push_back(std::move(copy));
+        }
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QByteArray out = "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const ThreadEvents& thread : threads) {
+        if (!first)
+            out += ",\n";
+        first = false;
+        out += QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":")
+                   .arg(pid).arg(thread.id).toUtf8();
+        appendJsonString(out, thread.name.constData());
+        out += "}}";
+
+        for (const TraceEvent& event : thread.events) {
+            out += ",\n{\"name\":";
+            appendJsonString(out, event.name);
+            out += QString(",\"ph\":\"X\",\"ts\":%1,\"dur\":%2,\"pid\":%3,\"tid\":%4}")
+                       .arg((event.start - origin) / 1000., 0, 'f', 3)
+                       .arg(event.duration / 1000., 0, 'f', 3)
+                       .arg(pid).arg(thread.id).toUtf8();
+        }
+    }
+    out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit()) {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,216 @@
+/**
+ * @file UndoCommands.cpp
+ * @brief Implementation of the undoable tree edits.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "UndoCommands.h"
+#include "ModelPart.h"
+#include "ModelPartList.h"
+
+#include <QObject>
+#include <QUndoStack>
+
+/**
+ * @brief Collects the deleted subtrees and marks the commands that refer to them.
+ */
+void PartCommand::forgetParts(const QUndoStack* stack, const QList<ModelPart*>& parts) {
+    QSet<ModelPart*> deleted;
+    QList<ModelPart*> pending = parts;
+    while (!pending.isEmpty()) {
+        ModelPart* part = pending.takeLast();
+        deleted.insert(part);
+        for (int i = 0; i < part->childCount(); ++i)
+            pending.append(part->child(i));
+    }
+
+    for (int i = 0; i < stack->count(); ++i) {
+        auto command = static_cast<const PartCommand*>(stack->command(i));
+        if (!command->stale && command->refersTo(deleted))
+            command->stale = true;
+    }
+}
+
+/**
+ * @brief Marks a stale command obsolete, the stack deletes it once undo() or redo() returns.
+ */
+bool PartCommand::dropped() {
+    if (stale)
+        setObsolete(true);
+    return stale;
+}
+
+/**
+ * @brief Creates the part without a place in the tree yet.
+ */
+AddPartCommand::AddPartCommand(ModelPartList* list, ModelPart* parentPart, const QList<QVariant>& data)
+    : partList(list), parent(parentPart), part(new ModelPart(data, parentPart)), row(-1), parked(true) {
+    setText(QObject::tr("Add %1").arg(data.value(0).toString()));
+}
+
+/**
+ * @brief Frees the part only while the command owns it.
+ */
+AddPartCommand::~AddPartCommand() {
+    if (parked)
+        delete part;
+}
+
+/**
+ * @brief Appends the part the first time, later restores its row.
+ */
+void AddPartCommand::redo() {
+    if (dropped())
+        return;
+    if (row < 0)
+        row = parent->childCount();
+    partList->insertPart(parent, row, part);
+    parked = false;
+}
+
+/**
+ * @brief Parks the part, remembering its row in case it moved.
+ */
+void AddPartCommand::undo() {
+    if (dropped())
+        return;
+    row = partList->takePart(part);
+    parked = true;
+}
+
+/**
+ * @brief A parked part cannot be deleted by anyone else.
+ */
+bool AddPartCommand::refersTo(const QSet<ModelPart*>& deleted) const {
+    return deleted.contains(parent) || (!parked && deleted.contains(part));
+}
+
+/**
+ * @brief Remembers the part's parent and row.
+ */
+DeletePartCommand::DeletePartCommand(ModelPartList* list, ModelPart* deleted)
+    : partList(list), parent(deleted->parentItem()), part(deleted), row(deleted->row()), parked(false) {
+    setText(QObject::tr("Delete %1").arg(deleted->data(0).toString()));
+}
+
+/**
+ * @brief Frees the subtree only while the command owns it.
+ */
+DeletePartCommand::~DeletePartCommand() {
+    if (parked)
+        delete part;
+}
+
+/**
+ * @brief Takes the subtree out; its actors disappear with the next scene rebuild.
+ */
+void DeletePartCommand::redo() {
+    if (dropped())
+        return;
+    row = partList->takePart(part);
+    parked = true;
+}
+
+/**
+ * @brief Reinserts the same parts, geometry and filters untouched.
+ */
+void DeletePartCommand::undo() {
+    if (dropped())
+        return;
+    partList->insertPart(parent, row, part);
+    parked = false;
+}
+
+/**
+ * @brief A parked subtree cannot be deleted by anyone else.
+ */
+bool DeletePartCommand::refersTo(const QSet<ModelPart*>& deleted) const {
+    return deleted.contains(parent) || (!parked && deleted.contains(part));
+}
+
+/**
+ * @brief Reads the values the options dialog shows.
+ */
+EditPartCommand::Settings EditPartCommand::Settings::of(ModelPart* part) {
+    Settings settings;
+    settings.name = part->data(0).toString();
+    settings.visible = part->visible();
+    settings.colour[0] = part->getColourR();
+    settings.colour[1] = part->getColourG();
+    settings.colour[2] = part->getColourB();
+    settings.clip = part->clip();
+    settings.shrink = part->shrink();
+    settings.transform = part->transform();
+    return settings;
+}
+
+/**
+ * @brief Compares the new settings with the part's and keeps the differences.
+ */
+EditPartCommand::EditPartCommand(ModelPartList* list, ModelPart* edited, const Settings& settings)
+    : partList(list), part(edited), before(Settings::of(edited)), after(settings), changed(0) {
+    if (after.name != before.name)
+        changed |= Name;
+    if (after.visible != before.visible)
+        changed |= Visible;
+    if (after.colour[0] != before.colour[0] || after.colour[1] != before.colour[1] ||
+        after.colour[2] != before.colour[2])
+        changed |= Colour;
+    if (after.clip != before.clip)
+        changed |= Clip;
+    if (after.shrink != before.shrink)
+        changed |= Shrink;
+    if (after.transform != before.transform)
+        changed |= Placement;
+
+    setText(QObject::tr("Edit %1").arg(before.name));
+    setObsolete(changed == 0);
+}
+
+/**
+ * @brief Applies the new values of the changed fields.
+ */
+void EditPartCommand::redo() {
+    if (!dropped())
+        apply(after);
+}
+
+/**
+ * @brief Applies the old values of the changed fields.
+ */
+void EditPartCommand::undo() {
+    if (!dropped())
+        apply(before);
+}
+
+/**
+ * @brief Only the edited part matters.
+ */
+bool EditPartCommand::refersTo(const QSet<ModelPart*>& deleted) const {
+    return deleted.contains(part);
+}
+
+/**
+ * @brief Renames and moves leave the VTK pipeline alone; everything else goes through setFilter().
+ */
+void EditPartCommand::apply(const Settings& settings) {
+    if (changed & Name)
+        part->set(0, settings.name);
+    if (changed & Visible) {
+        part->setVisible(settings.visible);
+        part->set(1, settings.visible);
+    }
+    if (changed & Colour)
+        part->setColour(settings.colour[0], settings.colour[1], settings.colour[2]);
+    if (changed & Clip)
+        part->setClip(settings.clip);
+    if (changed & Shrink)
+        part->setShrink(settings.shrink);
+    if (changed & Placement)
+        part->setTransform(settings.transform);
+    if (changed & ~(Name | Placement))
+        part->setFilter();
+    partList->partChanged(part);
+}
@@ -0,0 +1,216 @@
+/**
+ * @file UndoCommands.h
+ * @brief Declaration of the undoable tree edits: adding, deleting and editing parts.
+ * @details Each command stores only what it needs to go back and forth. A delete takes the subtree
+ *          out of the model and parks it, geometry and all, inside the command, so undoing it just
+ *          puts the same parts back; nothing is copied or re-read. An edit records the properties
+ *          the options dialog changed, before and after, and leaves the others alone. Parts can
+ *          also be deleted outside the stack, e.g. when a watched file disappears; only the
+ *          commands that refer to them are dropped, the rest of the history stays.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_UNDOCOMMANDS_H
+#define VIEWER_UNDOCOMMANDS_H
+
+#include "ModelPart.h"
+
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QUndoCommand>
+#include <QVariant>
+
+class ModelPartList;
+class QUndoStack;
+
+/**
+ * @class PartCommand
+ * @brief Base of the commands on parts, which can be told that some of their parts were deleted.
+ * @details A command that refers to a deleted part does nothing any more and marks itself
+ *          obsolete the next time the stack undoes or redoes it, so the stack drops it.
+ */
+class PartCommand : public QUndoCommand {
+public:
+    /**
+     * @brief Tells every command on a stack that parts are about to be deleted.
+     * @param stack Stack holding PartCommand objects.
+     * @param parts Top of each subtree about to be deleted, see ModelPartList::partsAboutToBeDeleted().
+     */
+    static void forgetParts(const QUndoStack* stack, const QList<ModelPart*>& parts);
+
+protected:
+    /**
+     * @brief Returns true if the command refers to one of the deleted parts.
+     * @param deleted Every part about to be deleted, children included.
+     */
+    virtual bool refersTo(const QSet<ModelPart*>& deleted) const = 0;
+
+    /**
+     * @brief Returns true, and marks the command obsolete, if a part it refers to was deleted.
+     * @details Call first in undo() and redo(), which must then do nothing.
+     */
+    bool dropped();
+
+private:
+    mutable bool    stale = false;  /**< A part the command refers to was deleted */
+};
+
+/**
+ * @class AddPartCommand
+ * @brief Adds an empty part under a parent.
+ */
+class AddPartCommand : public PartCommand {
+public:
+    /**
+     * @brief Creates the part, which is inserted by the first redo().
+     * @param partList Model holding the tree.
+     * @param parent Part to add under.
+     * @param data Name and visibility of the new part.
+     */
+    AddPartCommand(ModelPartList* partList, ModelPart* parent, const QList<QVariant>& data);
+
+    /**
+     * @brief Deletes the part if it is parked, i.e. the add was undone.
+     */
+    ~AddPartCommand();
+
+    /**
+     * @brief Inserts the part as the last child of its parent, or where it was before.
+     */
+    void redo() override;
+
+    /**
+     * @brief Takes the part out of the tree and parks it.
+     */
+    void undo() override;
+
+protected:
+    /**
+     * @brief Checks the parent and, while it is in the tree, the part.
+     */
+    bool refersTo(const QSet<ModelPart*>& deleted) const override;
+
+private:
+    ModelPartList*  partList;   /**< Model holding the tree */
+    ModelPart*      parent;     /**< Part the new part goes under */
+    ModelPart*      part;       /**< The new part */
+    int             row;        /**< Row of the part, -1 before the first redo */
+    bool            parked;     /**< The command owns the part */
+};
+
+/**
+ * @class DeletePartCommand
+ * @brief Removes a part and everything below it, keeping them for undo.
+ */
+class DeletePartCommand : public PartCommand {
+public:
+    /**
+     * @brief Remembers where the part is; it is removed by the first redo().
+     * @param partList Model holding the tree.
+     * @param part Part to delete, not the root item.
+     */
+    DeletePartCommand(ModelPartList* partList, ModelPart* part);
+
+    /**
+     * @brief Deletes the parked subtree, unless the delete was undone.
+     */
+    ~DeletePartCommand();
+
+    /**
+     * @brief Takes the subtree out of the tree and parks it.
+     */
+    void redo() override;
+
+    /**
+     * @brief Puts the parked subtree back at its old row.
+     */
+    void undo() override;
+
+protected:
+    /**
+     * @brief Checks the parent and, while it is in the tree, the subtree.
+     */
+    bool refersTo(const QSet<ModelPart*>& deleted) const override;
+
+private:
+    ModelPartList*  partList;   /**< Model holding the tree */
+    ModelPart*      parent;     /**< Part the subtree was under */
+    ModelPart*      part;       /**< Top of the subtree */
+    int             row;        /**< Row the subtree had under its parent */
+    bool            parked;     /**< The command owns the subtree */
+};
+
+/**
+ * @class EditPartCommand
+ * @brief Changes the properties a part shows in the options dialog.
+ * @details Moving a part only marks its subtree's world matrices out of date, the filters are
+ *          not rebuilt.
+ */
+class EditPartCommand : public PartCommand {
+public:
+    /** Properties set through the options dialog */
+    struct Settings {
+        QString                 name;       /**< Name shown in the tree */
+        bool                    visible;    /**< Visibility */
+        unsigned char           colour[3];  /**< Red, green and blue */
+        bool                    clip;       /**< Clip filter on */
+        bool                    shrink;     /**< Shrink filter on */
+        ModelPart::Transform    transform;  /**< Placement relative to the parent */
+
+        /**
+         * @brief Returns a part's current settings.
+         */
+        static Settings of(ModelPart* part);
+    };
+
+    /**
+     * @brief Records which settings differ from the part's current ones.
+     * @details A command that changes nothing marks itself obsolete, so the stack drops it.
+     * @param partList Model holding the tree.
+     * @param part Part to edit.
+     * @param settings New settings.
+     */
+    EditPartCommand(ModelPartList* partList, ModelPart* part, const Settings& settings);
+
+    /**
+     * @brief Applies the changed settings.
+     */
+    void redo() override;
+
+    /**
+     * @brief Restores the changed settings to their old values.
+     */
+    void undo() override;
+
+protected:
+    /**
+     * @brief Checks the edited part.
+     */
+    bool refersTo(const QSet<ModelPart*>& deleted) const override;
+
+private:
+    /** Bits of the settings that changed */
+    enum Field {
+        Name      = 0x01,
+        Visible   = 0x02,
+        Colour    = 0x04,
+        Clip      = 0x08,
+        Shrink    = 0x10,
+        Placement = 0x20
+    };
+
+    /**
+     * @brief Sets the changed fields of the part and rebuilds its pipeline if needed.
+     */
+    void apply(const Settings& settings);
+
+    ModelPartList*  partList;   /**< Model holding the tree */
+    ModelPart*      part;       /**< Part being edited */
+    Settings        before;     /**< Settings before the edit */
+    Settings        after;      /**< Settings after the edit */
+    int             changed;    /**< Field bits that differ */
+};
+
+#endif
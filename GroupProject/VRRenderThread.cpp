@@ -3,6 +3,7 @@
  * @brief Implementation of the VRRenderThread class for VTK OpenVR rendering in a separate thread.
  * @details Handles background VR rendering using a separate thread to prevent blocking the main GUI thread.
  *          Supports actor registration, command handling, and basic animation such as rotation.
+ *          The loop is the same for every RenderBackend, headset or offscreen.
  * @version 1.0.0
  * @date 2025-05-12/2022
  * @author Woojin, Zhixing, Zhiyuan/Paul
@@ -10,24 +11,23 @@
 
 
 #include "VRRenderThread.h"
+#include "Trace.h"
+
+#ifdef GROUPPROJECT_WITH_OPENVR
+#include "OpenVRRenderBackend.h"
+#endif
 
 
 /* Vtk headers */
 #include <vtkActor.h>
-#include <vtkOpenVRRenderWindow.h>				
-#include <vtkOpenVRRenderWindowInteractor.h>	
-#include <vtkOpenVRRenderer.h>					
-#include <vtkOpenVRCamera.h>	
+#include <vtkRenderer.h>
 
 #include <vtkNew.h>
 #include <vtkSmartPointer.h>
 #include <vtkNamedColors.h>
-#include <vtkCylinderSource.h>
-#include <vtkPolyDataMapper.h>
-#include <vtkProperty.h>
-#include <vtkSTLReader.h>
-#include <vtkDataSetmapper.h>
-#include <vtkCallbackCommand.h>
+
+#include <algorithm>
+#include <cmath>
 
 
 /* The class constructor is called by MainWindow and runs in the primary program thread, this thread
@@ -39,11 +39,19 @@
  * @brief Constructor for the VRRenderThread.
  * @param parent Pointer to the parent QObject.
  */
-VRRenderThread::VRRenderThread( QObject* parent ) {
+VRRenderThread::VRRenderThread( QObject* parent ) : QThread(parent) {
 	/* Initialise actor list */
 	actors = vtkActorCollection::New();
 
+	/* Headset unless setOffscreen() is called */
+	offscreen = false;
+	offscreenSize[0] = 0;
+	offscreenSize[1] = 0;
+	frameLimit = 0;
+
 	/* Initialise command variables */
+	running = false;
+	endRender = false;
 	rotateX = 0.;
 	rotateY = 0.;
 	rotateZ = 0.;
@@ -67,30 +75,47 @@ VRRenderThread::~VRRenderThread() {
 /**
  * @brief Adds a VTK actor to the render list before the thread starts.
  * @param actor Pointer to the VTK actor to add.
+ * @param track Track of the actor's part in the animation, -1 if none.
  */
-void VRRenderThread::addActorOffline( vtkActor* actor ) {
+void VRRenderThread::addActorOffline( vtkActor* actor, int track ) {
 
 	/* Check to see if render thread is running */
 	if (!this->isRunning()) {
 		double* ac = actor->GetOrigin();
 	
 		/* I have found that these initial transforms will position the FS
-		 * car model in a sensible position but you can experiment
+		 * car model in a sensible position but you can experiment.
+		 * The part's own placement reaches the actor through its user matrix, which
+		 * ModelPart::getNewActor() sets and setActorMatrix() updates, so only the
+		 * placement of the whole scene in the headset is set here. Setting rather than adding it leaves
+		 * the actor the same however often it is added.
 		 */
-		actor->RotateX(-90);
-		actor->AddPosition(-ac[0]+0, -ac[1]-100, -ac[2]-200);
+		actor->SetOrientation(-90., 0., 0.);
+		actor->SetPosition(-ac[0]+0, -ac[1]-100, -ac[2]-200);
 
 		actors->AddItem(actor);
+		if (track >= 0)
+			animatedActors.append({ actor, track, nullptr, nullptr });
 	}
 }
 
+/**
+ * @brief Keeps the animation for the next run.
+ * @param animation Finished animation, or nullptr for none.
+ */
+void VRRenderThread::setAnimation( std::shared_ptr<const Animation> animation ) {
+	if (!this->isRunning())
+		this->animation = std::move(animation);
+}
+
 /**
  * @brief Issues a rendering command to the thread.
  * @param cmd Command identifier (e.g., rotation axis).
- * @param value Associated value (e.g., rotation angle).
+ * @param value Associated value (e.g., rotation angle per 20 ms).
  */
 
 void VRRenderThread::issueCommand( int cmd, double value ) {
+	QMutexLocker locker(&mutex);
 
 	/* Update class variables according to command */
 	switch (cmd) {
@@ -113,14 +138,103 @@ void VRRenderThread::issueCommand( int cmd, double value ) {
 	}
 }
 
+/**
+ * @brief Queues a matrix for the render thread, or applies it if the thread is not rendering.
+ * @param actor Actor to move.
+ * @param matrix Row-major user matrix.
+ */
+void VRRenderThread::setActorMatrix( vtkActor* actor, const double matrix[16] ) {
+	QMutexLocker locker(&mutex);
+
+	if (!running) {
+		applyActorMatrix(actor, matrix);
+		return;
+	}
+
+	/* A later matrix for the same actor replaces the queued one */
+	for (PendingMatrix& pending : pendingMatrices) {
+		if (pending.actor == actor) {
+			std::copy(matrix, matrix + 16, pending.matrix);
+			return;
+		}
+	}
+	PendingMatrix pending;
+	pending.actor = actor;
+	std::copy(matrix, matrix + 16, pending.matrix);
+	pendingMatrices.append(pending);
+}
+
+/**
+ * @brief Writes the matrix an actor shows outside the animation.
+ * @param actor Actor to move.
+ * @param matrix Row-major user matrix.
+ */
+void VRRenderThread::applyActorMatrix( vtkActor* actor, const double matrix[16] ) {
+	/* While the keyframes place an actor, its own matrix waits to be put back */
+	for (AnimatedActor& animated : animatedActors) {
+		if (animated.actor == actor && animated.matrix) {
+			if (!animated.placement)
+				animated.placement = vtkSmartPointer<vtkMatrix4x4>::New();
+			animated.placement->DeepCopy(matrix);
+			return;
+		}
+	}
+
+	vtkMatrix4x4* user = actor->GetUserMatrix();
+	if (!user) {
+		auto created = vtkSmartPointer<vtkMatrix4x4>::New();
+		actor->SetUserMatrix(created);
+		user = created;
+	}
+	user->DeepCopy(matrix);
+}
+
+/**
+ * @brief Takes the queue under the lock and applies it without holding the lock.
+ */
+void VRRenderThread::applyPendingMatrices() {
+	{
+		QMutexLocker locker(&mutex);
+		if (pendingMatrices.isEmpty())
+			return;
+		appliedMatrices.swap(pendingMatrices);
+	}
+	for (const PendingMatrix& pending : std::as_const(appliedMatrices))
+		applyActorMatrix(pending.actor, pending.matrix);
+	appliedMatrices.clear();
+}
+
+/**
+ * @brief Selects the offscreen backend for the next run.
+ * @param width Window width in pixels.
+ * @param height Window height in pixels.
+ * @param frameLimit Frames to render, 0 for no limit.
+ */
+void VRRenderThread::setOffscreen( int width, int height, int frameLimit ) {
+	if (!this->isRunning()) {
+		offscreen = true;
+		offscreenSize[0] = width;
+		offscreenSize[1] = height;
+		this->frameLimit = frameLimit;
+	}
+}
+
+/**
+ * @brief Returns a copy of the frame timings.
+ */
+VRRenderThread::FrameStats VRRenderThread::frameStats() {
+	QMutexLocker locker(&mutex);
+	return stats;
+}
+
 /* This function runs in a separate thread. This means that the program 
  * can fork into two separate execution paths. This thread is triggered by
  * calling VRRenderThread::start()
  */
 /**
  * @brief Entry point of the VR render thread.
- * @details Initializes the VTK OpenVR rendering pipeline, adds actors, and enters a loop
- *          for rendering frames and applying transformations at defined intervals.
+ * @details Creates the backend, which sets up the renderer and window with the actors, and enters
+ *          a loop for rendering frames and applying transformations at defined intervals.
  */
 void VRRenderThread::run() {
 	/* You might want to edit the 3D model once VR has started, however VTK is not "thread safe". 
@@ -130,57 +244,99 @@ void VRRenderThread::run() {
 	 * so there needs to be a mechanism to pass data from the GUi thread to the VR thread.
 	 */
 
+	/* From here on the actors belong to this thread, the GUI thread only queues matrices */
+	{
+		QMutexLocker locker(&mutex);
+		running = true;
+	}
+
 	vtkNew<vtkNamedColors> colors;
 
 	// Set the background color.
 	std::array<unsigned char, 4> bkg{ {26, 51, 102, 255} };
 	colors->SetColor("BkgColor", bkg.data());
-	
-	// The renderer generates the image
-	// which is then displayed on the render window.
-	// It can be thought of as a scene to which the actor is added
-	renderer = vtkOpenVRRenderer::New();	
-	
-	renderer->SetBackground(colors->GetColor3d("BkgColor").GetData());
-	
-	/* Loop through list of actors provided and add to scene */
-	vtkActor* a;
-	actors->InitTraversal();
-	while( (a = (vtkActor*)actors->GetNextActor() ) ) {
-		renderer->AddActor(a);
-	}
 
-	/* The render window is the actual GUI window
-	 * that appears on the computer screen
+	/* The backend's window and renderer belong to this thread, they are created
+	 * here and destroyed when the loop ends
 	 */
-	window = vtkOpenVRRenderWindow::New();
+	std::unique_ptr<RenderBackend> backend;
+	if (offscreen)
+		backend = std::make_unique<OffscreenRenderBackend>(offscreenSize[0], offscreenSize[1], frameLimit);
+#ifdef GROUPPROJECT_WITH_OPENVR
+	else
+		backend = std::make_unique<OpenVRRenderBackend>();
+#else
+	else {
+		qWarning("VRRenderThread: built without GROUPPROJECT_WITH_OPENVR, only offscreen rendering is available");
+		QMutexLocker locker(&mutex);
+		running = false;
+		return;
+	}
+#endif
 
-	window->Initialize();
-	window->AddRenderer(renderer);
-	
-	/* Create Open VR Camera */
-	camera = vtkOpenVRCamera::New();				
-	renderer->SetActiveCamera(camera);			
+	vtkRenderer* renderer = backend->initialize(actors, colors->GetColor3d("BkgColor").GetData());
 
-	/* The render window interactor captures mouse events
-	 * and will perform appropriate camera or actor manipulation
-	 * depending on the nature of the events.
+	/* Everything the keyframes need is allocated here, so a frame allocates nothing however
+	 * many parts are animated. Animated actors swap their own matrix for a keyframe one.
 	 */
-	interactor = vtkOpenVRRenderWindowInteractor::New();									
-	interactor->SetRenderWindow(window);													
-	interactor->Initialize();
-	window->Render();
-	
+	std::unique_ptr<Animation::Playhead> playhead;
+	if (animation) {
+		playhead = std::make_unique<Animation::Playhead>(*animation);
+		for (AnimatedActor& animated : animatedActors) {
+			animated.placement = animated.actor->GetUserMatrix();
+			animated.matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+			animated.actor->SetUserMatrix(animated.matrix);
+		}
+	}
 
-	/* Now start the VR - we will implement the command loop manually
+	/* Now start the loop - we will implement the command loop manually
 	 * so it can be interrupted to make modifications to the actors
 	 * (i.e. to implement animation)
 	 */
-	endRender = false;
+	{
+		QMutexLocker locker(&mutex);
+		endRender = false;
+		stats = FrameStats();
+	}
 	t_last = std::chrono::steady_clock::now();
+	const auto t_start = t_last;
+
+	while( !backend->done() ) {
+		{
+			QMutexLocker locker(&mutex);
+			if (endRender)
+				break;
+		}
+
+		TRACE_SCOPE("VRRenderThread::frame");
+		auto t_frame = std::chrono::steady_clock::now();
+
+		/* Parts moved on the desktop since the last frame */
+		applyPendingMatrices();
 
-	while( !interactor->GetDone() && !this->endRender ) {
-		interactor->DoOneEvent( window, renderer );
+		/* Keyframes follow the real clock, looping when the animation ends */
+		if (playhead) {
+			TRACE_SCOPE("VRRenderThread::keyframes");
+			double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+			if (animation->duration() > 0.)
+				t = std::fmod(t, animation->duration());
+			animation->evaluate(t, *playhead);
+
+			double matrix[16];
+			for (const AnimatedActor& animated : std::as_const(animatedActors)) {
+				animation->actorMatrix(animated.track, *playhead, matrix);
+				animated.matrix->DeepCopy(matrix);
+			}
+			if (animation->hasCamera()) {
+				const Animation::CameraKey& pose = playhead->camera();
+				backend->setCamera(pose.position, pose.focalPoint, pose.viewUp);
+			}
+		}
+
+		{
+			TRACE_SCOPE("VRRenderThread::DoOneEvent");
+			backend->frame();
+		}
 
 		/* Check to see if enough time has elapsed since last update 
 		 * This looks overcomplicated (and it is, C++ loves to make things unecessarily complicated!) but
@@ -192,34 +348,79 @@ void VRRenderThread::run() {
 		 * My choice of 20ms is arbitrary, if this value is too small the animation calculations could begin to
 		 * interfere with the interator processes and make the simulation unresponsive. If it is too large
 		 * the animations will be jerky. Play with the value to see what works best.
+		 *
+		 * The rotation is scaled by the time that really passed, so a slow frame does not slow it down.
 		 */
-		if (std::chrono::duration_cast <std::chrono::milliseconds> (std::chrono::steady_clock::now() - t_last).count() > 20) {
+		double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_last).count();
+		if (elapsedMs > 20.) {
 
-			/* Do things that might need doing ... */
-			vtkActorCollection* actorList = renderer->GetActors();
-			vtkActor* a;
-
-			/* X Rotation */
-			actorList->InitTraversal();
-			while ((a = (vtkActor*)actorList->GetNextActor())) {
-				a->RotateX(rotateX);
-			}
+			TRACE_SCOPE("VRRenderThread::animate");
+			animate(renderer, elapsedMs);
 
-			/* Y Rotation */
-			actorList->InitTraversal();
-			while ((a = (vtkActor*)actorList->GetNextActor())) {
-				a->RotateY(rotateY);
-			}
-
-			/* Z Rotation */
-			actorList->InitTraversal();
-			while ((a = (vtkActor*)actorList->GetNextActor())) {
-				a->RotateZ(rotateZ);
-			}
-			
 			/* Remember time now */
 			t_last = std::chrono::steady_clock::now();
 		}
+
+		/* Record how long this iteration took */
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_frame).count();
+		QMutexLocker locker(&mutex);
+		stats.frames++;
+		stats.totalMs += ms;
+		stats.maxMs = std::max(stats.maxMs, ms);
+	}
+
+	/* Give the animated actors their own matrices back */
+	for (AnimatedActor& animated : animatedActors) {
+		if (animated.matrix) {
+			animated.actor->SetUserMatrix(animated.placement);
+			animated.matrix = nullptr;
+		}
+	}
+
+	/* Anything queued after the last frame, under the lock so nothing is queued meanwhile;
+	 * then the actors are the GUI thread's again */
+	QMutexLocker locker(&mutex);
+	for (const PendingMatrix& pending : std::as_const(pendingMatrices))
+		applyActorMatrix(pending.actor, pending.matrix);
+	pendingMatrices.clear();
+	running = false;
+}
+
+/**
+ * @brief Rotates every actor by the commanded angles, scaled to the elapsed time.
+ * @param renderer Renderer holding the actors.
+ * @param elapsedMs Time since the last rotation step.
+ */
+void VRRenderThread::animate( vtkRenderer* renderer, double elapsedMs ) {
+	double x, y, z;
+	{
+		QMutexLocker locker(&mutex);
+		const double steps = elapsedMs / 20.;
+		x = rotateX * steps;
+		y = rotateY * steps;
+		z = rotateZ * steps;
+	}
+
+	/* Do things that might need doing ... */
+	vtkActorCollection* actorList = renderer->GetActors();
+	vtkActor* a;
+
+	/* X Rotation */
+	actorList->InitTraversal();
+	while ((a = (vtkActor*)actorList->GetNextActor())) {
+		a->RotateX(x);
+	}
+
+	/* Y Rotation */
+	actorList->InitTraversal();
+	while ((a = (vtkActor*)actorList->GetNextActor())) {
+		a->RotateY(y);
+	}
+
+	/* Z Rotation */
+	actorList->InitTraversal();
+	while ((a = (vtkActor*)actorList->GetNextActor())) {
+		a->RotateZ(z);
 	}
 }
 
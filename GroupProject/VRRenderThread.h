@@ -2,7 +2,9 @@
  * @file VRRenderThread.h
  * @brief Declaration of the VRRenderThread class for multithreaded OpenVR rendering.
  * @details This class handles VR rendering in a separate thread using VTK's OpenVR module and Qt's QThread.
- *          It enables asynchronous control and animation of 3D actors in a virtual scene.
+ *          It enables asynchronous control and animation of 3D actors in a virtual scene. The window
+ *          itself is a RenderBackend, so the same loop can also run offscreen without a headset.
+ *          A keyframe Animation shared with the desktop view can be played on the thread's own clock.
  * @version 1.0.0
  * @date 2025-05-12/2022
  * @author Woojin, Zhixing, Zhiyuan/Paul
@@ -11,20 +13,23 @@
 #define VR_RENDER_THREAD_H
 
 /* Project headers */
+#include "Animation.h"
+#include "RenderBackend.h"
 
 /* Qt headers */
 #include <QThread>
 #include <QMutex>
+#include <QVector>
 #include <QWaitCondition>
 
 /* Vtk headers */
 #include <vtkActor.h>
-#include <vtkOpenVRRenderWindow.h>				
-#include <vtkOpenVRRenderWindowInteractor.h>	
-#include <vtkOpenVRRenderer.h>					
-#include <vtkOpenVRCamera.h>	
 #include <vtkActorCollection.h>
 #include <vtkCommand.h>
+#include <vtkMatrix4x4.h>
+
+#include <chrono>
+#include <memory>
 
 
 
@@ -54,6 +59,12 @@ public:
         ROTATE_Z
     } Command;
 
+    /** Frame timings of the last run, for benchmarks */
+    struct FrameStats {
+        int     frames = 0;     /**< Loop iterations */
+        double  totalMs = 0.;   /**< Time spent in the loop */
+        double  maxMs = 0.;     /**< Longest iteration */
+    };
 
     /**
      * @brief Constructs the VRRenderThread instance.
@@ -69,18 +80,53 @@ public:
 
     /**
      * @brief Adds a VTK actor to be rendered by the thread before VR is started.
-     * @param actor Pointer to the VTK actor.
+     * @param actor Pointer to a VR actor from ModelPart::getNewActor(), never the desktop actor.
+     * @param track Track of the actor's part in the animation given to setAnimation(), -1 if none.
+     */
+    void addActorOffline(vtkActor* actor, int track = -1);
+
+    /**
+     * @brief Plays a keyframe animation, over and over, while the thread runs.
+     * @details Call before start(). Time starts when the loop does and follows the real clock, not
+     *          the frame rate. Animated actors get a keyframe matrix for the run; a matrix sent with
+     *          setActorMatrix() meanwhile takes effect when the run ends.
+     * @param animation Finished animation, or nullptr for none.
      */
-    void addActorOffline(vtkActor* actor);
+    void setAnimation(std::shared_ptr<const Animation> animation);
 
 
     /**
      * @brief Issues a rendering command to the thread safely.
      * @param cmd Command type.
-     * @param value Associated value (e.g., rotation angle).
+     * @param value Associated value (e.g., rotation angle per 20 ms).
      */
     void issueCommand( int cmd, double value );
 
+    /**
+     * @brief Moves a VR actor, safely while the thread runs.
+     * @details While the thread runs the matrix is queued, and the thread copies it into the
+     *          actor's user matrix before its next frame, so the GUI thread never writes to
+     *          anything being rendered. Otherwise it is applied at once.
+     * @param actor Actor given to addActorOffline().
+     * @param matrix Row-major user matrix, see ModelPart::getVRMatrix().
+     */
+    void setActorMatrix( vtkActor* actor, const double matrix[16] );
+
+    /**
+     * @brief Runs the loop in an invisible window instead of the headset.
+     * @details Call before start(). Commands and animation work as with a headset. Without
+     *          GROUPPROJECT_WITH_OPENVR this is the only way the thread renders anything.
+     * @param width Window width in pixels.
+     * @param height Window height in pixels.
+     * @param frameLimit Frames after which the thread finishes, 0 to run until END_RENDER.
+     */
+    void setOffscreen( int width, int height, int frameLimit = 0 );
+
+    /**
+     * @brief Returns the frame timings of the current or last run.
+     */
+    FrameStats frameStats();
+
 
 protected:
     /**
@@ -89,24 +135,60 @@ protected:
     void run() override;
 
 private:
-    vtkSmartPointer<vtkOpenVRRenderWindow> window;              /**< VR render window */
-    vtkSmartPointer<vtkOpenVRRenderWindowInteractor> interactor;/**< VR input interactor */
-    vtkSmartPointer<vtkOpenVRRenderer> renderer;                /**< Scene renderer */
-    vtkSmartPointer<vtkOpenVRCamera> camera;                    /**< Active VR camera */
+    /** An actor placed by the animation */
+    struct AnimatedActor {
+        vtkSmartPointer<vtkActor>       actor;  /**< VR actor */
+        int                             track;  /**< Track of its part */
+        vtkSmartPointer<vtkMatrix4x4>   matrix; /**< User matrix set from the track each frame */
+        vtkSmartPointer<vtkMatrix4x4>   placement; /**< The actor's own matrix, put back after the run */
+    };
+
+    /** A matrix queued by setActorMatrix() */
+    struct PendingMatrix {
+        vtkSmartPointer<vtkActor>       actor;      /**< Actor to move */
+        double                          matrix[16]; /**< New user matrix */
+    };
+
+    /**
+     * @brief Copies a matrix into an actor's own user matrix, on the thread that renders it.
+     * @param actor Actor to move.
+     * @param matrix Row-major user matrix.
+     */
+    void applyActorMatrix(vtkActor* actor, const double matrix[16]);
 
-    QMutex mutex;                                               /**< Synchronization mutex */
+    /**
+     * @brief Applies the matrices queued since the last call.
+     */
+    void applyPendingMatrices();
+    /**
+     * @brief Applies the rotation commands to every actor.
+     * @param renderer Renderer holding the actors.
+     * @param elapsedMs Time since the last rotation step.
+     */
+    void animate(vtkRenderer* renderer, double elapsedMs);
+
+    bool offscreen;                                             /**< Render into an invisible window */
+    int offscreenSize[2];                                       /**< Offscreen window width and height */
+    int frameLimit;                                             /**< Offscreen frames to render, 0 for no limit */
+    FrameStats stats;                                           /**< Frame timings, guarded by mutex */
+    bool running;                                               /**< The thread owns the actors, guarded by mutex */
+    QVector<PendingMatrix> pendingMatrices;                     /**< Matrices to apply, guarded by mutex */
+    QVector<PendingMatrix> appliedMatrices;                     /**< Matrices being applied, reused every frame */
+
+    QMutex mutex;                                               /**< Guards the commands and stats */
     QWaitCondition condition;                                   /**< Synchronization wait condition */
 
     vtkSmartPointer<vtkActorCollection> actors;                 /**< Collection of actors to render */
+    std::shared_ptr<const Animation> animation;                 /**< Keyframes to play, null if none */
+    QVector<AnimatedActor> animatedActors;                      /**< Actors with a track in the animation */
 
     std::chrono::time_point<std::chrono::steady_clock> t_last; /**< Timestamp for animation timing */
 
     bool endRender;                                             /**< Flag to signal render loop termination */
 
-    double rotateX; /**< Rotation amount around X axis (degrees) */
-    double rotateY; /**< Rotation amount around Y axis (degrees) */
-    double rotateZ; /**< Rotation amount around Z axis (degrees) */
-};
+    double rotateX; /**< Rotation around X axis (degrees per 20 ms) */
+    double rotateY; /**< Rotation around Y axis (degrees per 20 ms) */
+    double rotateZ; /**< Rotation around Z axis (degrees per 20 ms) */
 };
 
 
@@ -2,14 +2,18 @@
  * @file main.cpp
  * @brief Entry point for the Qt GUI application.
  * @details This file contains the main function which initializes the Qt application
- *          and displays the main window interface of the program.
+ *          and displays the main window interface of the program, or runs the headless
+ *          batch renderer when started with --render.
  * @version 1.0.0
  * @author Zhixing
  * @date 2025-05-12
  */
 #include "mainwindow.h"
+#include "Trace.h"
+#include "BatchRenderer.h"
 
 #include <QApplication>
+#include <QCoreApplication>
 
 /**
  * @brief Main function that launches the Qt GUI application.
@@ -19,7 +23,15 @@
  */
 int main(int argc, char *argv[])
 {
+    /* --render runs without a window, see BatchRenderer */
+    if (BatchRenderer::isRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        Trace::initFromEnvironment();
+        return BatchRenderer::run(app.arguments());
+    }
+
     QApplication a(argc, argv);
+    Trace::initFromEnvironment();
     MainWindow w;
     w.show();
     return a.exec();
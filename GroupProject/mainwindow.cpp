@@ -11,6 +11,13 @@
 #include "./ui_mainwindow.h"
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QInputDialog>
+#include <QHeaderView>
+#include <QTimer>
+#include <QActionGroup>
+#include <QVariantAnimation>
+#include <QSignalBlocker>
+#include <QSet>
 #include "ModelPart.h"
 #include "ModelPartList.h"
 #include <vtkCylinderSource.h>
@@ -19,7 +26,20 @@
 #include <vtkProperty.h>
 #include <vtkCamera.h>
 #include "optiondialog.h"
+#include "ProjectFile.h"
+#include "FolderWatcher.h"
+#include "MeshImporter.h"
+#include "Trace.h"
+#include "ExplodedView.h"
+#include "ThumbnailCache.h"
+#include "UndoCommands.h"
+#include <QtConcurrent>
 #include <vtkLight.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCellPicker.h>
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vtkRenderWindowInteractor.h>
 
 /**
  * @brief Constructs the main window and initializes the UI and VTK renderer.
@@ -39,6 +59,48 @@ MainWindow::MainWindow(QWidget *parent)
 
     ui->treeView->setModel(this->partList);
 
+    /* Cost columns are optional, clicking a header sorts the tree (starting unsorted) */
+    for (int column = ModelPartList::TrianglesColumn; column < ModelPartList::ColumnCount; ++column)
+        ui->treeView->setColumnHidden(column, true);
+    ui->treeView->header()->setSortIndicator(-1, Qt::AscendingOrder);
+    ui->treeView->setSortingEnabled(true);
+
+    /* Thumbnails are rendered at twice the icon size so they stay sharp on high DPI screens */
+    ui->treeView->setIconSize(QSize(ThumbnailCache::ImageSize / 2, ThumbnailCache::ImageSize / 2));
+
+    /* Adds, deletes and edits are undoable. Parts deleted outside the stack (a watched file
+     * disappearing) only drop the commands that refer to them; a new tree clears the stack */
+    undoStack = new QUndoStack(this);
+    undoStack->setUndoLimit(100);
+    QAction* undoAction = undoStack->createUndoAction(this, tr("Undo"));
+    undoAction->setShortcut(QKeySequence::Undo);
+    QAction* redoAction = undoStack->createRedoAction(this, tr("Redo"));
+    redoAction->setShortcut(QKeySequence::Redo);
+    ui->menuEdit->addAction(undoAction);
+    ui->menuEdit->addAction(redoAction);
+    connect(undoStack, &QUndoStack::indexChanged, this, &MainWindow::updateRender);
+    connect(partList, &ModelPartList::partsAboutToBeDeleted, this,
+            [this](const QList<ModelPart*>& parts) { PartCommand::forgetParts(undoStack, parts); });
+    connect(partList, &QAbstractItemModel::modelReset, undoStack, &QUndoStack::clear);
+
+    folderWatcher = new FolderWatcher(partList, this);
+    connect(folderWatcher, &FolderWatcher::partAdded, this, &MainWindow::handleWatchedPartAdded);
+    connect(folderWatcher, &FolderWatcher::partAboutToBeRemoved, this, &MainWindow::handleWatchedPartRemoved);
+    connect(folderWatcher, &FolderWatcher::partsUpdated, this, &MainWindow::handleWatchedPartsUpdated);
+
+    memoryBudget = new MemoryBudget(partList, this);
+    memoryLabel = new QLabel(this);
+    ui->statusbar->addPermanentWidget(memoryLabel);
+    connect(memoryBudget, &MemoryBudget::usageChanged, this, &MainWindow::handleMemoryUsageChanged);
+
+    ui->actionRecord_Trace->setChecked(Trace::isEnabled());
+
+    /* Every change only schedules a render, the timer fires once the event loop is idle */
+    renderTimer = new QTimer(this);
+    renderTimer->setSingleShot(true);
+    renderTimer->setInterval(0);
+    connect(renderTimer, &QTimer::timeout, this, &MainWindow::renderNow);
+
     ModelPart *rootItem = this->partList->getRootItem();
 
     for (int i = 0; i < 3; i++) {
@@ -60,6 +122,7 @@ MainWindow::MainWindow(QWidget *parent)
     }
 
     ui->treeView->addAction(ui->actionItem_Options);
+    ui->treeView->addAction(ui->actionExport_Parts);
 
 
     renderWindow = vtkSmartPointer<vtkGenericOpenGLRenderWindow>::New();
@@ -94,12 +157,97 @@ MainWindow::MainWindow(QWidget *parent)
     renderer->ResetCameraClippingRange();
 
     updateLight();
+
+    /* Double clicking a part in the view selects it in the tree */
+    vtkNew<vtkCallbackCommand> pickCallback;
+    pickCallback->SetClientData(this);
+    pickCallback->SetCallback([](vtkObject* caller, unsigned long, void* clientData, void*) {
+        auto interactor = static_cast<vtkRenderWindowInteractor*>(caller);
+        if (interactor->GetRepeatCount() > 0)
+            static_cast<MainWindow*>(clientData)->selectPartAt(interactor->GetEventPosition()[0],
+                                                               interactor->GetEventPosition()[1]);
+    });
+    renderWindow->GetInteractor()->AddObserver(vtkCommand::LeftButtonPressEvent, pickCallback);
+
+    sectionView = new SectionView(partList, this);
+    sectionView->setView(renderWindow->GetInteractor(), renderer);
+
+    interactionLod = new InteractionLod(this);
+    interactionLod->setView(renderWindow->GetInteractor(), renderer);
+    connect(interactionLod, &InteractionLod::renderRequested, this, &MainWindow::requestRender);
+
+    QActionGroup* sectionGroup = new QActionGroup(this);
+    sectionGroup->addAction(ui->actionSection_Off);
+    sectionGroup->addAction(ui->actionSection_Part);
+    sectionGroup->addAction(ui->actionSection_Subtree);
+    sectionGroup->addAction(ui->actionSection_Scene);
+
+    /* The explode slider eases towards its new value instead of jumping */
+    explodeAnimation = new QVariantAnimation(this);
+    explodeAnimation->setDuration(250);
+    explodeAnimation->setEasingCurve(QEasingCurve::OutCubic);
+    connect(explodeAnimation, &QVariantAnimation::valueChanged, this, [this](const QVariant& value) {
+        setExplodeFactor(value.toDouble());
+    });
+
+    /* Clash checks run on the thread pool, the dock lists what they find */
+    ui->dockClashes->setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+    ui->dockClashes->hide();
+    clashWatcher = new QFutureWatcher<QList<ClashDetector::Clash>>(this);
+    connect(clashWatcher, &QFutureWatcher<QList<ClashDetector::Clash>>::finished,
+            this, &MainWindow::handleClashesFinished);
+
+    contourWatcher = new QFutureWatcher<QList<ContourSlicer::Contour>>(this);
+    connect(contourWatcher, &QFutureWatcher<QList<ContourSlicer::Contour>>::finished,
+            this, &MainWindow::handleContoursFinished);
+
+    openWatcher = new QFutureWatcher<void>(this);
+    connect(openWatcher, &QFutureWatcher<void>::finished, this, &MainWindow::handleOpenFinished);
+
+    exportWatcher = new QFutureWatcher<MeshExporter::Result>(this);
+    connect(exportWatcher, &QFutureWatcher<MeshExporter::Result>::finished,
+            this, &MainWindow::handleExportFinished);
+
+    /* Animations are stepped by the clock, the timer only asks for frames */
+    animationTimer = new QTimer(this);
+    animationTimer->setTimerType(Qt::PreciseTimer);
+    animationTimer->setInterval(16);
+    connect(animationTimer, &QTimer::timeout, this, &MainWindow::stepAnimation);
+    /* Parts leaving the tree, deleted or parked by an undo command, end the animation while its
+     * tracks can still reset them */
+    connect(partList, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this]() { stopAnimation(); });
+    connect(partList, &QAbstractItemModel::modelAboutToBeReset, this, [this]() { stopAnimation(); });
+
+#ifndef GROUPPROJECT_WITH_OPENVR
+    ui->actionVR_Headset->setEnabled(false);
+    ui->actionVR_Headset->setToolTip(tr("Built without GROUPPROJECT_WITH_OPENVR"));
+#endif
+    /* The VR scene keeps showing deleted parts, but they are no longer sent any matrices */
+    connect(partList, &ModelPartList::partsAboutToBeDeleted, this, [this](const QList<ModelPart*>& parts) {
+        QList<ModelPart*> stack = parts;
+        while (!stack.isEmpty()) {
+            ModelPart* part = stack.takeLast();
+            vrActors.remove(part);
+            for (int i = 0; i < part->childCount(); ++i)
+                stack.append(part->child(i));
+        }
+    });
+    connect(partList, &QAbstractItemModel::modelAboutToBeReset, this, [this]() { vrActors.clear(); });
 }
 /**
  * @brief Destructor for the MainWindow class.
  */
 MainWindow::~MainWindow()
 {
+    /* A running clash check uses the detector, a member, and Open File fills openMeshes */
+    clashWatcher->waitForFinished();
+    openWatcher->waitForFinished();
+    contourWatcher->waitForFinished();
+    exportWatcher->waitForFinished();
+    if (vrThread) {
+        vrThread->issueCommand(VRRenderThread::END_RENDER, 0.);
+        vrThread->wait();
+    }
     delete ui;
 }
 /**
@@ -112,14 +260,8 @@ void MainWindow::handleButtonAdd()
         emit statusUpdateMessage("No item selected", 0);
         return;
     }
-    QModelIndex parentIndex = index.isValid() ? index : QModelIndex();
     QList<QVariant> data = { "NewPart", "true" };
-    partList->appendChild(parentIndex, data);
-
-    renderer->ResetCamera();
-    renderWindow->Render();
-    updateRender();
-    updateLight();
+    undoStack->push(new AddPartCommand(partList, partList->getItem(index), data));
 
     emit statusUpdateMessage(QString("Add button was clicked"), 0);
 }
@@ -134,41 +276,70 @@ void MainWindow::handleTreeClicked()
     emit statusUpdateMessage("The selected item is: " + text, 0);
 }
 /**
- * @brief Opens multiple STL files and loads them into the scene under the selected tree item.
+ * @brief Opens multiple mesh files, reads them in parallel and adds them under the selected tree item.
  */
 void MainWindow::on_actionOpen_File_triggered()
 {
+    if (openWatcher->isRunning())
+        return;
+
     QStringList fileNames = QFileDialog::getOpenFileNames(
         this,
-        tr("Open STL Files"),
+        tr("Open Mesh Files"),
         "C:\\",
-        tr("STL Files (*.stl)")
+        MeshImporter::fileDialogFilter()
         );
     if (fileNames.isEmpty())
         return;
 
-    QModelIndex parentIdx = ui->treeView->currentIndex();
+    /* Read every file on the thread pool, handleOpenFinished() creates the parts on this thread */
+    openParent = ui->treeView->currentIndex();
+    openResetsCamera = partList->getRootItem()->subtreeStats().triangles == 0;
+    openMeshes.clear();
+    for (const QString &filePath : fileNames)
+        openMeshes.append({ filePath, nullptr });
 
-    for (const QString &filePath : fileNames) {
-        QString justName = QFileInfo(filePath).fileName();
+    ui->actionOpen_File->setEnabled(false);
+    emit statusUpdateMessage(tr("Loading %1 files...").arg(openMeshes.size()), 0);
+    openWatcher->setFuture(QtConcurrent::map(openMeshes, [](LoadedMesh& mesh) {
+        mesh.polyData = MeshImporter::read(mesh.path, &mesh.loadMs);
+    }));
+}
 
-        QList<QVariant> data = { justName, true };
-        partList->appendChild(parentIdx, data);
+/**
+ * @brief Creates the parts for the meshes that were read and reports the files that were not.
+ */
+void MainWindow::handleOpenFinished()
+{
+    ui->actionOpen_File->setEnabled(true);
 
-        int newRow = partList->rowCount(parentIdx) - 1;
-        QModelIndex newIdx = partList->index(newRow, 0, parentIdx);
-        auto newPart = static_cast<ModelPart*>(newIdx.internalPointer());
-        newPart->loadSTL(filePath);
-        renderer->AddActor(newPart->getActor());
+    QList<ModelPart*> parts;
+    QStringList failed;
+    for (const LoadedMesh &mesh : std::as_const(openMeshes)) {
+        if (!mesh.polyData) {
+            failed.append(QFileInfo(mesh.path).fileName());
+            continue;
+        }
+        ModelPart* newPart = new ModelPart({ QFileInfo(mesh.path).fileName(), "true" });
+        newPart->setFileName(mesh.path);
+        newPart->setPolyData(mesh.polyData);
+        newPart->setLoadTime(mesh.loadMs);
+        parts.append(newPart);
     }
+    openMeshes.clear();
 
-    renderer->ResetCamera();
-    renderWindow->Render();
+    /* An item deleted while the files were read leaves them at the top level */
+    partList->appendParts(openParent, parts);
+
+    if (openResetsCamera)
+        cameraResetPending = true;
     updateRender();
-    updateLight();
 
-    emit statusUpdateMessage(
-        tr("Loaded %1 files").arg(fileNames.size()), 3000);
+    if (failed.isEmpty())
+        emit statusUpdateMessage(tr("Loaded %1 files").arg(parts.size()), 3000);
+    else
+        emit statusUpdateMessage(tr("Loaded %1 files, could not read %2")
+                                     .arg(parts.size()).arg(failed.join(", ")), 5000);
 }
 
 /**
@@ -188,11 +359,7 @@ void MainWindow::on_pushButtonOptions_clicked()
     dialog.setDialog(selectedPart);
 
     if (dialog.exec() == QDialog::Accepted) {
-        dialog.setModelPart(selectedPart);
-        renderer->ResetCamera();
-        renderWindow->Render();
-        updateRender();
-        updateLight();
+        undoStack->push(new EditPartCommand(partList, selectedPart, dialog.settings()));
 
         emit statusUpdateMessage("Dialog accepted", 0);
     } else {
@@ -217,11 +384,7 @@ void MainWindow::on_actionItem_Options_triggered()
     dialog.setDialog(selectedPart);
 
     if (dialog.exec() == QDialog::Accepted) {
-        dialog.setModelPart(selectedPart);
-        renderer->ResetCamera();
-        renderWindow->Render();
-        updateRender();
-        updateLight();
+        undoStack->push(new EditPartCommand(partList, selectedPart, dialog.settings()));
 
         emit statusUpdateMessage("Dialog accepted", 0);
     } else {
@@ -229,13 +392,95 @@ void MainWindow::on_actionItem_Options_triggered()
     }
 }
 /**
- * @brief Clears the VTK scene and recursively renders all visible parts from the tree.
+ * @brief Marks the scene as changed and schedules a render.
+ * @details The actor list is rebuilt and the window rendered once by renderNow(), however many
+ *          times this is called before the event loop gets back to the render timer.
  */
 void MainWindow::updateRender()
 {
-    renderer->RemoveAllViewProps();
-    updateRenderFromTree(QModelIndex());
-    renderer->Render();
+    sceneDirty = true;
+    requestRender();
+}
+/**
+ * @brief Schedules a render without rebuilding the actor list.
+ */
+void MainWindow::requestRender()
+{
+    if (!renderTimer->isActive())
+        renderTimer->start();
+}
+/**
+ * @brief Performs the pending scene update, camera reset and render.
+ * @details Calling this directly also satisfies any render already scheduled.
+ */
+void MainWindow::renderNow()
+{
+    TRACE_SCOPE("MainWindow::renderNow");
+    renderTimer->stop();
+
+    /* Only parts whose transform, or an ancestor's, changed get a new world matrix */
+    partList->getRootItem()->updateWorldMatrices();
+    if (vrThread)
+        sendVRMatrices();
+
+    if (sceneDirty) {
+        TRACE_SCOPE("MainWindow::updateRender");
+        sceneDirty = false;
+
+        /* Visibility may have changed, reload or release geometry before drawing */
+        memoryBudget->update();
+        partList->refreshStats();
+
+        /* New parts need their exploded position, which also keeps them out of batches */
+        if (explodeFactor > 0.)
+            ExplodedView::apply(partList->getRootItem(), explodeFactor);
+
+        /* Eligible parts are drawn by the batches instead of their own actors */
+        if (ui->actionStatic_Batching->isChecked()) {
+            QList<ModelPart*> eligible;
+            QList<ModelPart*> stack = { partList->getRootItem() };
+            while (!stack.isEmpty()) {
+                ModelPart* part = stack.takeLast();
+                if (StaticBatcher::isEligible(part) && !sectionView->sectionsPart(part))
+                    eligible.append(part);
+                for (int i = part->childCount() - 1; i >= 0; --i)
+                    stack.append(part->child(i));
+            }
+            batcher.update(eligible);
+        }
+
+        interactionLod->reset();
+        renderer->RemoveAllViewProps();
+        actorParts.clear();
+        updateRenderFromTree(QModelIndex());
+        for (vtkActor* actor : batcher.actors())
+            renderer->AddActor(actor);
+        if (clashActor)
+            renderer->AddActor(clashActor);
+        if (contourActor)
+            renderer->AddActor(contourActor);
+        sectionView->apply();
+        interactionLod->setParts(actorParts.values());
+
+        /* Parts may have been added, hidden or reloaded */
+        requestClashCheck();
+    }
+
+    if (cameraResetPending) {
+        cameraResetPending = false;
+        renderer->ResetCamera();
+    }
+
+    TRACE_SCOPE("vtkRenderWindow::Render");
+    renderWindow->Render();
+}
+/**
+ * @brief Fits the camera to the visible parts.
+ */
+void MainWindow::on_actionReset_Camera_triggered()
+{
+    cameraResetPending = true;
+    requestRender();
 }
 /**
  * @brief Recursive helper to render model parts from the given tree index.
@@ -249,21 +494,22 @@ void MainWindow::updateRenderFromTree(const QModelIndex &index)
         QModelIndex child = partList->index(row, 0, index);
         auto part = static_cast<ModelPart*>(child.internalPointer());
 
-        if (part->getActor()) {
+        if (part->getActor() && !batcher.contains(part)) {
             renderer->AddActor(part->getActor());
+            actorParts.insert(part->getActor(), part);
         }
 
         updateRenderFromTree(child);
     }
 }
 /**
- * @brief Opens a folder, loads all STL files within it, and adds them under the selected tree node.
+ * @brief Opens a folder, loads all mesh files within it and its sub-folders, and adds them under the selected tree node.
  */
 void MainWindow::on_actionOpen_Folder_triggered()
 {
     QString dir = QFileDialog::getExistingDirectory(
         this,
-        tr("Open Folder of STL Models"),
+        tr("Open Folder of Models"),
         QString(),
         QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks
         );
@@ -274,36 +520,70 @@ void MainWindow::on_actionOpen_Folder_triggered()
     if (!parentIdx.isValid())
         parentIdx = QModelIndex();
 
-    QDir d(dir);
-    QStringList files = d.entryList({ "*.stl" }, QDir::Files);
-    for (const QString &file : files) {
-        QString fullPath = d.filePath(file);
-
-        QList<QVariant> data = { file, true };
-        partList->appendChild(parentIdx, data);
+    bool watch = ui->actionWatch_Folders->isChecked();
+    bool emptyScene = partList->getRootItem()->subtreeStats().triangles == 0;
+    int loaded = folderWatcher->importFolder(dir, parentIdx, watch);
 
-        int newRow = partList->rowCount(parentIdx) - 1;
-        QModelIndex newIdx = partList->index(newRow, 0, parentIdx);
-        auto newPart = static_cast<ModelPart*>(newIdx.internalPointer());
-        newPart->loadSTL(fullPath);
-        renderer->AddActor(newPart->getActor());
-    }
-
-    renderer->ResetCamera();
-    renderWindow->Render();
+    if (emptyScene)
+        cameraResetPending = true;
     updateRender();
-    updateLight();
 
     emit statusUpdateMessage(
-        tr("Loaded %1 files from \"%2\"")
-            .arg(files.size())
-            .arg(QFileInfo(dir).fileName()),
+        tr("Loaded %1 files from \"%2\"%3")
+            .arg(loaded)
+            .arg(QFileInfo(dir).fileName())
+            .arg(watch ? tr(", watching for changes") : QString()),
         3000
         );
 }
 
 /**
- * @brief Deletes the currently selected item from the model tree and updates the render view.
+ * @brief Turns hot reloading of opened folders on or off.
+ * @param checked True to watch folders opened from now on, false to stop watching all folders.
+ */
+void MainWindow::on_actionWatch_Folders_toggled(bool checked)
+{
+    if (!checked) {
+        folderWatcher->unwatchAll();
+        emit statusUpdateMessage(tr("Stopped watching folders"), 3000);
+    }
+}
+
+/**
+ * @brief Adds the actor of a part created by a folder hot reload to the scene.
+ * @param part The new part.
+ */
+void MainWindow::handleWatchedPartAdded(ModelPart* part)
+{
+    if (part->getActor())
+        renderer->AddActor(part->getActor());
+}
+
+/**
+ * @brief Removes the actors of a part (and its children) deleted by a folder hot reload.
+ * @param part The part about to be deleted.
+ */
+void MainWindow::handleWatchedPartRemoved(ModelPart* part)
+{
+    if (part->getActor())
+        renderer->RemoveActor(part->getActor());
+    for (int i = 0; i < part->childCount(); ++i)
+        handleWatchedPartRemoved(part->child(i));
+}
+
+/**
+ * @brief Renders the scene once after a folder hot reload has been applied.
+ */
+void MainWindow::handleWatchedPartsUpdated(int reloaded, int added, int removed)
+{
+    updateRender();
+    emit statusUpdateMessage(
+        tr("Folder changes: %1 reloaded, %2 added, %3 removed").arg(reloaded).arg(added).arg(removed),
+        3000);
+}
+
+/**
+ * @brief Deletes the selected item and everything below it; the parts are kept for undo.
  */
 void MainWindow::on_pushButtonDelete_clicked()
 {
@@ -316,20 +596,122 @@ void MainWindow::on_pushButtonDelete_clicked()
     ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
     QString partName = selectedPart->data(0).toString();
 
-    partList->removeRows(index.row(), 1, index.parent());
+    undoStack->push(new DeletePartCommand(partList, selectedPart));
 
-    renderer->ResetCamera();
-    renderWindow->Render();
+    emit statusUpdateMessage("'" + partName + "' deleted", 0);
+}
+/**
+ * @brief Loads a project file, replacing every part currently in the tree.
+ */
+void MainWindow::on_actionOpen_Project_triggered()
+{
+    QString fileName = QFileDialog::getOpenFileName(
+        this,
+        tr("Open Project"),
+        QString(),
+        tr("Project Files (*.gpp)")
+        );
+    if (fileName.isEmpty())
+        return;
+
+    QList<ModelPart*> parts;
+    QString error;
+    if (!ProjectFile::load(fileName, parts, &error)) {
+        QMessageBox::warning(this, tr("Open Project"), tr("Could not open project: %1").arg(error));
+        return;
+    }
+
+    partList->resetParts(parts);
+
+    cameraResetPending = true;
     updateRender();
-    updateLight();
 
-    emit statusUpdateMessage("'" + partName + "' deleted", 0);
+    emit statusUpdateMessage(
+        tr("Opened project \"%1\"").arg(QFileInfo(fileName).fileName()), 3000);
 }
+
 /**
- * @brief Updates lighting in the VTK scene with key, fill, and back lights.
+ * @brief Saves the tree to a project file, optionally embedding all geometry.
+ */
+void MainWindow::on_actionSave_Project_triggered()
+{
+    const QString referenceFilter = tr("Project referencing STL files (*.gpp)");
+    const QString embedFilter = tr("Project with embedded geometry (*.gpp)");
+
+    QString selectedFilter = referenceFilter;
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        tr("Save Project"),
+        QString(),
+        referenceFilter + ";;" + embedFilter,
+        &selectedFilter
+        );
+    if (fileName.isEmpty())
+        return;
+
+    QString error;
+    if (!ProjectFile::save(fileName, partList->getRootItem(), selectedFilter == embedFilter, &error)) {
+        QMessageBox::warning(this, tr("Save Project"), tr("Could not save project: %1").arg(error));
+        return;
+    }
+
+    emit statusUpdateMessage(
+        tr("Saved project \"%1\"").arg(QFileInfo(fileName).fileName()), 3000);
+}
+
+/**
+ * @brief Exports the selected subtrees, or the whole scene if nothing is selected, as drawn.
+ */
+void MainWindow::on_actionExport_Parts_triggered()
+{
+    if (exportWatcher->isRunning())
+        return;
+
+    QList<ModelPart*> roots;
+    for (const QModelIndex& index : ui->treeView->selectionModel()->selectedRows())
+        roots.append(partList->getItem(index));
+    if (roots.isEmpty())
+        roots.append(partList->getRootItem());
+
+    /* Actor matrices are read below, so bring them up to date first */
+    partList->getRootItem()->updateWorldMatrices();
+    QList<MeshExporter::Input> inputs = MeshExporter::collect(roots);
+    if (inputs.isEmpty()) {
+        QMessageBox::information(this, tr("Export Parts"), tr("No parts with geometry to export."));
+        return;
+    }
+
+    bool ok = false;
+    const QStringList formats = { tr("Binary STL (*.stl)"), tr("Geometry cache (*.gpg)") };
+    const QString formatName = QInputDialog::getItem(this, tr("Export Parts"),
+                                                     tr("Export %1 parts as:").arg(inputs.size()),
+                                                     formats, 0, false, &ok);
+    if (!ok)
+        return;
+    const QString dir = QFileDialog::getExistingDirectory(this, tr("Export Parts To"));
+    if (dir.isEmpty())
+        return;
+
+    const MeshExporter::Format format = formats.indexOf(formatName) == 0 ? MeshExporter::BinarySTL
+                                                                         : MeshExporter::CacheFormat;
+    ui->actionExport_Parts->setEnabled(false);
+    emit statusUpdateMessage(tr("Exporting %1 parts...").arg(inputs.size()), 0);
+    exportClock.start();
+    exportWatcher->setFuture(QtConcurrent::run([inputs, dir, format]() {
+        return MeshExporter::exportParts(inputs, dir, format);
+    }));
+}
+
+/**
+ * @brief Sets up the key, fill and back lights of the VTK scene.
+ * @details Lights are fixed in the scene, so this only needs calling once.
  */
 void MainWindow::updateLight()
 {
+    TRACE_SCOPE("MainWindow::updateLight");
+
+    /* Replace rather than add to the lights set up by an earlier call */
+    renderer->RemoveAllLights();
     renderer->SetAmbient(0.2, 0.2, 0.2);
 
     vtkSmartPointer<vtkLight> keyLight = vtkSmartPointer<vtkLight>::New();
@@ -361,3 +743,752 @@ void MainWindow::updateLight()
     backLight->SetIntensity(0.2);
     renderer->AddLight(backLight);
 }
+
+/**
+ * @brief Converts all loaded parts to or from compact geometry and reports the memory saved.
+ * @param checked True to store geometry compactly, also for parts loaded later.
+ */
+void MainWindow::on_actionCompact_Geometry_toggled(bool checked)
+{
+    ModelPart::setCompactByDefault(checked);
+
+    qint64 saved = 0;
+    QList<ModelPart*> stack = { partList->getRootItem() };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        part->setCompact(checked);
+        saved += part->memorySaved();
+        for (int i = 0; i < part->childCount(); ++i)
+            stack.append(part->child(i));
+    }
+
+    updateRender();
+
+    if (checked)
+        emit statusUpdateMessage(tr("Compact geometry storage on, saving %1 MB")
+                                     .arg(saved / (1024. * 1024.), 0, 'f', 1), 5000);
+    else
+        emit statusUpdateMessage(tr("Compact geometry storage off"), 3000);
+}
+
+/**
+ * @brief Updates the memory usage label.
+ * @param usage Memory in use, in bytes.
+ * @param budget Budget, in bytes.
+ * @param released Number of parts whose geometry is released.
+ */
+void MainWindow::handleMemoryUsageChanged(qint64 usage, qint64 budget, int released)
+{
+    const double MiB = 1024. * 1024.;
+    QString text = tr("Geometry: %1 / %2 MB").arg(usage / MiB, 0, 'f', 0).arg(budget / MiB, 0, 'f', 0);
+    if (released > 0)
+        text += tr(" (%1 released)").arg(released);
+    memoryLabel->setText(text);
+}
+
+/**
+ * @brief Lets the user set the geometry memory budget in megabytes.
+ */
+void MainWindow::on_actionMemory_Budget_triggered()
+{
+    bool ok = false;
+    int megabytes = QInputDialog::getInt(
+        this,
+        tr("Memory Budget"),
+        tr("Geometry memory budget (MB):"),
+        int(memoryBudget->budget() >> 20), 64, 1024 * 1024, 256, &ok
+        );
+    if (!ok)
+        return;
+
+    memoryBudget->setBudget(qint64(megabytes) << 20);
+    updateRender();
+}
+
+/**
+ * @brief Lets the user set the feature angle of the normals generated for loaded parts.
+ */
+void MainWindow::on_actionSmooth_Shading_triggered()
+{
+    bool ok = false;
+    double degrees = QInputDialog::getDouble(
+        this,
+        tr("Smooth Shading"),
+        tr("Largest angle between smoothly shaded faces, 0 for flat shading (degrees):"),
+        MeshImporter::normalAngle(), 0., 180., 1, &ok
+        );
+    if (!ok)
+        return;
+
+    MeshImporter::setNormalAngle(degrees);
+    emit statusUpdateMessage(tr("Smooth shading angle of %1 degrees applies to parts loaded from now on").arg(degrees), 5000);
+}
+
+/**
+ * @brief Chooses how the meshes of parts loaded from now on are ordered.
+ * @param checked True for spatial order, false for vertex cache order only.
+ */
+void MainWindow::on_actionSpatial_Mesh_Order_toggled(bool checked)
+{
+    MeshImporter::setMeshOrder(checked ? MeshImporter::SpatialOrder : MeshImporter::CacheOrder);
+    emit statusUpdateMessage(checked ? tr("Spatial mesh order applies to parts loaded from now on")
+                                     : tr("Vertex cache order applies to parts loaded from now on"), 5000);
+}
+
+/**
+ * @brief Shows or hides the per-part cost columns of the tree view.
+ * @param checked True to show the columns.
+ */
+void MainWindow::on_actionCost_Columns_toggled(bool checked)
+{
+    for (int column = ModelPartList::TrianglesColumn; column <= ModelPartList::FilterTimeColumn; ++column) {
+        ui->treeView->setColumnHidden(column, !checked);
+        if (checked)
+            ui->treeView->resizeColumnToContents(column);
+    }
+}
+
+/**
+ * @brief Shows or hides the metrics columns, resizing them to fit when shown.
+ * @param checked True to show the columns.
+ */
+void MainWindow::on_actionMetrics_Columns_toggled(bool checked)
+{
+    for (int column = ModelPartList::FirstMetricsColumn; column <= ModelPartList::LastMetricsColumn; ++column) {
+        ui->treeView->setColumnHidden(column, !checked);
+        if (checked)
+            ui->treeView->resizeColumnToContents(column);
+    }
+}
+
+/**
+ * @brief Turns trace recording on or off, clearing old events when a new recording starts.
+ * @param checked True to record.
+ */
+void MainWindow::on_actionRecord_Trace_toggled(bool checked)
+{
+    if (checked && !Trace::isEnabled())
+        Trace::clear();
+    Trace::setEnabled(checked);
+    emit statusUpdateMessage(checked ? tr("Recording trace") : tr("Trace recording stopped"), 3000);
+}
+
+/**
+ * @brief Writes the recorded events to a JSON file chosen by the user.
+ */
+void MainWindow::on_actionExport_Trace_triggered()
+{
+    if (Trace::eventCount() == 0) {
+        QMessageBox::information(this, tr("Export Trace"),
+                                 tr("No trace events recorded, turn on Tools > Record Trace first."));
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        tr("Export Trace"),
+        QString(),
+        tr("Chrome Trace (*.json)")
+        );
+    if (fileName.isEmpty())
+        return;
+
+    QString error;
+    if (!Trace::exportChromeJson(fileName, &error)) {
+        QMessageBox::warning(this, tr("Export Trace"), tr("Could not export trace: %1").arg(error));
+        return;
+    }
+
+    emit statusUpdateMessage(
+        tr("Exported %1 trace events to \"%2\"").arg(Trace::eventCount()).arg(QFileInfo(fileName).fileName()), 3000);
+}
+
+/**
+ * @brief Turns static batching on or off.
+ * @param checked True to merge eligible parts by colour.
+ */
+void MainWindow::on_actionStatic_Batching_toggled(bool checked)
+{
+    if (!checked)
+        batcher.clear();
+
+    /* Render straight away so the batch counts below are current */
+    sceneDirty = true;
+    renderNow();
+
+    if (checked)
+        emit statusUpdateMessage(tr("Static batching: %1 parts drawn by %2 batches")
+                                     .arg(batcher.memberCount()).arg(batcher.batchCount()), 5000);
+    else
+        emit statusUpdateMessage(tr("Static batching off"), 3000);
+}
+
+/**
+ * @brief Turns lower detail while the camera moves on or off.
+ * @param checked True to use proxies during camera motion.
+ */
+void MainWindow::on_actionAdaptive_Detail_toggled(bool checked)
+{
+    interactionLod->setEnabled(checked);
+}
+
+/**
+ * @brief Picks the part under a view position and selects it in the tree.
+ * @param x Horizontal position in display coordinates.
+ * @param y Vertical position in display coordinates.
+ */
+void MainWindow::selectPartAt(int x, int y)
+{
+    vtkNew<vtkCellPicker> picker;
+    picker->SetTolerance(0.0005);
+    if (!picker->Pick(x, y, 0, renderer))
+        return;
+
+    /* Batches map the picked cell back to its part, other actors belong to one part each */
+    ModelPart* part = batcher.partAt(picker->GetActor(), picker->GetCellId());
+    if (!part)
+        part = actorParts.value(picker->GetActor(), nullptr);
+    if (!part)
+        return;
+
+    QModelIndex index = partList->indexOf(part);
+    ui->treeView->setCurrentIndex(index);
+    ui->treeView->scrollTo(index);
+    handleTreeClicked();
+}
+
+/**
+ * @brief Turns the section plane off.
+ */
+void MainWindow::on_actionSection_Off_triggered()
+{
+    setSectionScope(SectionView::Off);
+}
+
+/**
+ * @brief Sections the selected part.
+ */
+void MainWindow::on_actionSection_Part_triggered()
+{
+    setSectionScope(SectionView::Part);
+}
+
+/**
+ * @brief Sections the selected part and its children.
+ */
+void MainWindow::on_actionSection_Subtree_triggered()
+{
+    setSectionScope(SectionView::Subtree);
+}
+
+/**
+ * @brief Sections every part in the scene.
+ */
+void MainWindow::on_actionSection_Scene_triggered()
+{
+    setSectionScope(SectionView::Scene);
+}
+
+/**
+ * @brief Applies a section scope to the selected tree item and re-renders.
+ * @param scope New scope, Part and Subtree need a selected item.
+ */
+void MainWindow::setSectionScope(SectionView::Scope scope)
+{
+    QModelIndex index = ui->treeView->currentIndex();
+    if ((scope == SectionView::Part || scope == SectionView::Subtree) && !index.isValid()) {
+        emit statusUpdateMessage("No item selected", 0);
+        ui->actionSection_Off->setChecked(true);
+        scope = SectionView::Off;
+    }
+
+    sectionView->setScope(scope, index);
+    updateRender();
+}
+
+/**
+ * @brief Animates the explode factor to the slider's new position.
+ * @param value Slider position, 0 to 100.
+ */
+void MainWindow::on_sliderExplode_valueChanged(int value)
+{
+    explodeAnimation->stop();
+    explodeAnimation->setStartValue(explodeFactor);
+    explodeAnimation->setEndValue(value / 100.);
+    explodeAnimation->start();
+}
+
+/**
+ * @brief Moves the parts' actors to their positions for an explode factor.
+ * @details Only actor positions change. The scene is rebuilt only when leaving or returning to
+ *          the assembled state, since moved parts cannot stay in static batches.
+ * @param factor Explode factor, 0 for the assembled model.
+ */
+void MainWindow::setExplodeFactor(double factor)
+{
+    bool wasAssembled = explodeFactor == 0.;
+    explodeFactor = factor;
+    ExplodedView::apply(partList->getRootItem(), factor);
+
+    if (wasAssembled != (factor == 0.)) {
+        updateRender();
+    } else {
+        requestRender();
+        requestClashCheck();
+    }
+}
+
+/**
+ * @brief Snapshots the visible parts and checks them on the thread pool.
+ */
+void MainWindow::requestClashCheck()
+{
+    if (!ui->actionClash_Detection->isChecked())
+        return;
+    if (clashWatcher->isRunning()) {
+        clashCheckPending = true;
+        return;
+    }
+
+    clashCheckPending = false;
+    QList<ClashDetector::Input> inputs = ClashDetector::collect(partList->getRootItem());
+    clashWatcher->setFuture(QtConcurrent::run([this, inputs]() { return clashDetector.detect(inputs); }));
+}
+
+/**
+ * @brief Drops clashes of deleted parts, fills the list and draws the intersecting triangles in red.
+ */
+void MainWindow::handleClashesFinished()
+{
+    if (clashCheckPending) {
+        requestClashCheck();
+        return;
+    }
+    if (!ui->actionClash_Detection->isChecked())
+        return;
+
+    /* Parts may have been deleted while the check ran */
+    QSet<ModelPart*> live;
+    QList<ModelPart*> stack = { partList->getRootItem() };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        live.insert(part);
+        for (int i = 0; i < part->childCount(); ++i)
+            stack.append(part->child(i));
+    }
+
+    clashes.clear();
+    clashIndexes.clear();
+    const QSignalBlocker blocker(ui->listClashes);
+    ui->listClashes->clear();
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    auto triangles = vtkSmartPointer<vtkCellArray>::New();
+    for (const ClashDetector::Clash& clash : clashWatcher->result()) {
+        if (!live.contains(clash.first) || !live.contains(clash.second))
+            continue;
+        clashes.append(clash);
+        clashIndexes.append(partList->indexOf(clash.first));
+        ui->listClashes->addItem(tr("%1 and %2 (%3%4 intersecting triangles)")
+                                     .arg(clash.first->data(0).toString(), clash.second->data(0).toString())
+                                     .arg(clash.contacts)
+                                     .arg(clash.contacts >= ClashDetector::MaxContacts ? "+" : ""));
+        for (int t = 0; t + 9 <= clash.triangles.size(); t += 9) {
+            vtkIdType ids[3];
+            for (int v = 0; v < 3; ++v)
+                ids[v] = points->InsertNextPoint(clash.triangles[t + 3 * v], clash.triangles[t + 3 * v + 1],
+                                                 clash.triangles[t + 3 * v + 2]);
+            triangles->InsertNextCell(3, ids);
+        }
+    }
+
+    if (clashActor)
+        renderer->RemoveActor(clashActor);
+    clashActor = nullptr;
+    if (triangles->GetNumberOfCells() > 0) {
+        auto polyData = vtkSmartPointer<vtkPolyData>::New();
+        polyData->SetPoints(points);
+        polyData->SetPolys(triangles);
+        auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        mapper->SetInputData(polyData);
+        mapper->SetResolveCoincidentTopologyToPolygonOffset();
+        mapper->SetRelativeCoincidentTopologyPolygonOffsetParameters(-2., -2.);
+        clashActor = vtkSmartPointer<vtkActor>::New();
+        clashActor->SetMapper(mapper);
+        clashActor->SetPickable(false);
+        clashActor->GetProperty()->SetColor(1., 0., 0.);
+        clashActor->GetProperty()->SetLighting(false);
+        renderer->AddActor(clashActor);
+    }
+    requestRender();
+
+    ui->dockClashes->setWindowTitle(tr("Clashes (%1)").arg(clashes.size()));
+    emit statusUpdateMessage(tr("%1 clashes, %2 parts rebuilt, %3 pairs tested, %4 reused")
+                                 .arg(clashes.size()).arg(clashDetector.rebuiltParts())
+                                 .arg(clashDetector.testedPairs()).arg(clashDetector.reusedPairs()), 0);
+}
+
+/**
+ * @brief Shows the dock and runs a first check, or hides both the dock and the highlight.
+ * @param checked True to detect clashes.
+ */
+void MainWindow::on_actionClash_Detection_toggled(bool checked)
+{
+    ui->dockClashes->setVisible(checked);
+    if (checked) {
+        requestClashCheck();
+        return;
+    }
+
+    clashes.clear();
+    clashIndexes.clear();
+    ui->listClashes->clear();
+    if (clashActor)
+        renderer->RemoveActor(clashActor);
+    clashActor = nullptr;
+    requestRender();
+}
+
+/**
+ * @brief Selects the clash's first part in the tree and zooms to its intersecting triangles.
+ * @param row Row in the clash list.
+ */
+void MainWindow::on_listClashes_currentRowChanged(int row)
+{
+    if (row < 0 || row >= clashes.size() || !clashIndexes[row].isValid())
+        return;
+    const ClashDetector::Clash& clash = clashes[row];
+
+    QModelIndex index = clashIndexes[row];
+    ui->treeView->setCurrentIndex(index);
+    ui->treeView->scrollTo(index);
+
+    double bounds[6] = { clash.location[0], clash.location[0], clash.location[1],
+                         clash.location[1], clash.location[2], clash.location[2] };
+    for (int i = 0; i < clash.triangles.size(); ++i) {
+        bounds[2 * (i % 3)] = std::min(bounds[2 * (i % 3)], double(clash.triangles[i]));
+        bounds[2 * (i % 3) + 1] = std::max(bounds[2 * (i % 3) + 1], double(clash.triangles[i]));
+    }
+    renderer->ResetCamera(bounds);
+    requestRender();
+}
+
+/**
+ * @brief Slices the selected part and its children, or the whole scene if nothing is selected.
+ */
+void MainWindow::on_actionSlice_Contours_triggered()
+{
+    if (contourWatcher->isRunning())
+        return;
+
+    QModelIndex index = ui->treeView->currentIndex();
+    ModelPart* root = index.isValid() ? partList->getItem(index) : partList->getRootItem();
+    QList<ContourSlicer::Input> inputs = ContourSlicer::collect(root);
+    if (inputs.isEmpty()) {
+        QMessageBox::information(this, tr("Slice Contours"), tr("No visible parts with geometry to slice."));
+        return;
+    }
+
+    bool ok = false;
+    const QStringList axes = { tr("X"), tr("Y"), tr("Z") };
+    const QString axisName = QInputDialog::getItem(this, tr("Slice Contours"), tr("Planes perpendicular to:"),
+                                                   axes, 2, false, &ok);
+    if (!ok)
+        return;
+    const double spacing = QInputDialog::getDouble(this, tr("Slice Contours"), tr("Spacing between planes:"),
+                                                   10., 1e-6, 1e9, 6, &ok);
+    if (!ok)
+        return;
+
+    const int axis = axes.indexOf(axisName);
+    const QVector<double> heights = ContourSlicer::stations(inputs, axis, spacing);
+    if (heights.isEmpty()) {
+        QMessageBox::information(this, tr("Slice Contours"),
+                                 tr("The spacing gives no planes through the parts, or more than %1.")
+                                     .arg(ContourSlicer::MaxStations));
+        return;
+    }
+
+    ui->actionSlice_Contours->setEnabled(false);
+    emit statusUpdateMessage(tr("Slicing %1 parts with %2 planes...").arg(inputs.size()).arg(heights.size()), 0);
+    contourWatcher->setFuture(QtConcurrent::run([inputs, axis, heights]() {
+        return ContourSlicer::slice(inputs, axis, heights);
+    }));
+}
+
+/**
+ * @brief Replaces the drawn contours with the result of the finished slice.
+ */
+void MainWindow::handleContoursFinished()
+{
+    ui->actionSlice_Contours->setEnabled(true);
+    contours = contourWatcher->result();
+
+    if (contourActor)
+        renderer->RemoveActor(contourActor);
+    contourActor = nullptr;
+    if (!contours.isEmpty()) {
+        auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        mapper->SetInputData(ContourSlicer::toPolyData(contours));
+        mapper->SetResolveCoincidentTopologyToPolygonOffset();
+        mapper->SetRelativeCoincidentTopologyLineOffsetParameters(-2., -2.);
+        contourActor = vtkSmartPointer<vtkActor>::New();
+        contourActor->SetMapper(mapper);
+        contourActor->SetPickable(false);
+        contourActor->GetProperty()->SetColor(1., 1., 0.);
+        contourActor->GetProperty()->SetLineWidth(2.f);
+        contourActor->GetProperty()->SetLighting(false);
+        renderer->AddActor(contourActor);
+    }
+    ui->actionExport_Contours->setEnabled(!contours.isEmpty());
+    ui->actionClear_Contours->setEnabled(!contours.isEmpty());
+    requestRender();
+
+    int closed = 0;
+    for (const ContourSlicer::Contour& contour : std::as_const(contours))
+        closed += contour.closed ? 1 : 0;
+    emit statusUpdateMessage(tr("%1 contours, %2 closed").arg(contours.size()).arg(closed), 0);
+}
+
+/**
+ * @brief Asks for a file name and writes the contours to it.
+ */
+void MainWindow::on_actionExport_Contours_triggered()
+{
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        tr("Export Contours"),
+        QString(),
+        tr("CSV Files (*.csv)")
+        );
+    if (fileName.isEmpty())
+        return;
+
+    QString error;
+    if (!ContourSlicer::exportCsv(contours, fileName, &error)) {
+        QMessageBox::warning(this, tr("Export Contours"), tr("Could not export contours: %1").arg(error));
+        return;
+    }
+    emit statusUpdateMessage(
+        tr("Exported %1 contours to \"%2\"").arg(contours.size()).arg(QFileInfo(fileName).fileName()), 3000);
+}
+
+/**
+ * @brief Shows how much was written, and which parts failed.
+ */
+void MainWindow::handleExportFinished()
+{
+    ui->actionExport_Parts->setEnabled(true);
+    const MeshExporter::Result result = exportWatcher->result();
+    const double seconds = exportClock.elapsed() / 1000.;
+
+    if (!result.errors.isEmpty()) {
+        QStringList shown = result.errors.mid(0, 10);
+        if (result.errors.size() > shown.size())
+            shown.append(tr("... and %1 more").arg(result.errors.size() - shown.size()));
+        QMessageBox::warning(this, tr("Export Parts"),
+                             tr("%1 parts could not be exported:\n%2").arg(result.errors.size()).arg(shown.join('\n')));
+    }
+    emit statusUpdateMessage(tr("Exported %1 parts, %2 MB in %3 s")
+                                 .arg(result.written)
+                                 .arg(result.bytes / 1048576., 0, 'f', 1)
+                                 .arg(seconds, 0, 'f', 2), 5000);
+}
+
+/**
+ * @brief Removes the contour overlay.
+ */
+void MainWindow::on_actionClear_Contours_triggered()
+{
+    contours.clear();
+    if (contourActor)
+        renderer->RemoveActor(contourActor);
+    contourActor = nullptr;
+    ui->actionExport_Contours->setEnabled(false);
+    ui->actionClear_Contours->setEnabled(false);
+    requestRender();
+}
+
+/**
+ * @brief Builds the sequence from the current tree and plays it.
+ */
+void MainWindow::on_actionPlay_Explode_Sequence_triggered()
+{
+    stopAnimation();
+    playAnimation(Animation::explodeSequence(partList->getRootItem(), 6.));
+}
+
+/**
+ * @brief Builds the orbit from the current camera and plays it.
+ */
+void MainWindow::on_actionPlay_Camera_Orbit_triggered()
+{
+    stopAnimation();
+    playAnimation(Animation::cameraOrbit(renderer->GetActiveCamera(), 10.));
+}
+
+/**
+ * @brief Stops the animation where it is.
+ */
+void MainWindow::on_actionStop_Animation_triggered()
+{
+    stopAnimation();
+}
+
+/**
+ * @brief Allocates the playhead, then lets the timer step the animation.
+ * @details Animated parts cannot stay in static batches, so the scene is rebuilt once.
+ */
+void MainWindow::playAnimation(Animation built)
+{
+    if (built.trackCount() == 0 && !built.hasCamera()) {
+        emit statusUpdateMessage("Nothing to animate", 0);
+        return;
+    }
+
+    animation = std::make_shared<const Animation>(std::move(built));
+    playhead = std::make_unique<Animation::Playhead>(*animation);
+    ui->actionStop_Animation->setEnabled(true);
+    if (animation->trackCount() > 0)
+        updateRender();
+
+    animationClock.start();
+    animationTimer->start();
+    stepAnimation();
+}
+
+/**
+ * @brief Gives every animated part its local matrix and the renderer the camera pose.
+ * @details Only matrices change, the world matrices follow in renderNow(); nothing is allocated.
+ */
+void MainWindow::stepAnimation()
+{
+    if (!animation)
+        return;
+    TRACE_SCOPE("MainWindow::stepAnimation");
+
+    const double time = animationClock.elapsed() / 1000.;
+    animation->evaluate(time, *playhead);
+    for (int track = 0; track < animation->trackCount(); ++track)
+        animation->part(track)->setAnimationMatrix(playhead->localMatrix(track));
+
+    if (animation->hasCamera()) {
+        const Animation::CameraKey& pose = playhead->camera();
+        vtkCamera* camera = renderer->GetActiveCamera();
+        camera->SetPosition(pose.position);
+        camera->SetFocalPoint(pose.focalPoint);
+        camera->SetViewUp(pose.viewUp);
+        renderer->ResetCameraClippingRange();
+    }
+
+    /* The sequences end where they started, so stopping at the end changes nothing visible */
+    if (time >= animation->duration())
+        stopAnimation();
+    else
+        requestRender();
+}
+
+/**
+ * @brief Clears the parts' animation matrices and rebuilds the scene.
+ */
+void MainWindow::stopAnimation()
+{
+    if (!animation)
+        return;
+    animationTimer->stop();
+
+    for (int track = 0; track < animation->trackCount(); ++track)
+        animation->part(track)->setAnimationMatrix(nullptr);
+
+    animation.reset();
+    playhead.reset();
+    ui->actionStop_Animation->setEnabled(false);
+    updateRender();
+}
+
+/**
+ * @brief Starts or stops the VR thread.
+ */
+void MainWindow::on_actionVR_Headset_toggled(bool checked)
+{
+    if (checked)
+        startVR();
+    else
+        stopVR();
+}
+
+/**
+ * @brief Builds the VR actors from the visible parts and starts the thread.
+ */
+void MainWindow::startVR()
+{
+    if (vrThread)
+        return;
+    TRACE_SCOPE("MainWindow::startVR");
+
+    /* The actors start where the parts are now, renderNow() sends them on from there */
+    partList->getRootItem()->updateWorldMatrices();
+
+    vrThread = new VRRenderThread(this);
+    connect(vrThread, &QThread::finished, this, &MainWindow::handleVRFinished);
+
+    QList<ModelPart*> stack = { partList->getRootItem() };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        for (int i = part->childCount() - 1; i >= 0; --i)
+            stack.append(part->child(i));
+        if (!part->getActor() || !part->visible())
+            continue;
+
+        vtkSmartPointer<vtkActor> actor = part->getNewActor();
+        vrThread->addActorOffline(actor, animation ? animation->track(part) : -1);
+        vrActors.insert(part, { actor, part->placementStamp() });
+    }
+    vrThread->setAnimation(animation);
+    vrThread->start();
+    emit statusUpdateMessage(QString("VR started with %1 parts").arg(vrActors.size()), 0);
+}
+
+/**
+ * @brief Tells the VR loop to end.
+ */
+void MainWindow::stopVR()
+{
+    if (vrThread)
+        vrThread->issueCommand(VRRenderThread::END_RENDER, 0.);
+}
+
+/**
+ * @brief Deletes the finished thread and unchecks the action, also when the headset ended the loop.
+ */
+void MainWindow::handleVRFinished()
+{
+    vrActors.clear();
+    vrThread->deleteLater();
+    vrThread = nullptr;
+
+    const QSignalBlocker blocker(ui->actionVR_Headset);
+    ui->actionVR_Headset->setChecked(false);
+    emit statusUpdateMessage("VR stopped", 0);
+}
+
+/**
+ * @brief Queues the matrix of every part whose placement changed since it was last sent.
+ */
+void MainWindow::sendVRMatrices()
+{
+    TRACE_SCOPE("MainWindow::sendVRMatrices");
+    QList<ModelPart*> stack = { partList->getRootItem() };
+    while (!stack.isEmpty()) {
+        ModelPart* part = stack.takeLast();
+        for (int i = part->childCount() - 1; i >= 0; --i)
+            stack.append(part->child(i));
+
+        auto it = vrActors.find(part);
+        if (it == vrActors.end() || it->placement == part->placementStamp())
+            continue;
+        double matrix[16];
+        part->getVRMatrix(matrix);
+        vrThread->setActorMatrix(it->actor, matrix);
+        it->placement = part->placementStamp();
+    }
+}
@@ -12,9 +12,27 @@
 
 #include <QMainWindow>
 #include "ModelPartList.h"
+#include "FolderWatcher.h"
+#include "MemoryBudget.h"
+#include "StaticBatcher.h"
+#include "SectionView.h"
+#include "ClashDetector.h"
+#include "ContourSlicer.h"
+#include "MeshExporter.h"
+#include "Animation.h"
+#include "InteractionLod.h"
+#include "VRRenderThread.h"
+#include <QLabel>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVariantAnimation>
+#include <QFutureWatcher>
+#include <QUndoStack>
 #include <vtkGenericOpenGLRenderWindow.h>
 #include <vtkLight.h>
 
+#include <memory>
+
 /**
  * @class MainWindow
  * @brief Main application window integrating Qt UI with VTK rendering.
@@ -58,22 +76,65 @@ public slots:
      */
     void handleTreeClicked();
     /**
-     * @brief Clears and re-renders the VTK scene based on model tree.
+     * @brief Marks the scene as changed, the actors are rebuilt from the tree on the next render.
+     * @details Cheap to call repeatedly, all calls within one event loop turn share one render.
      */
     void updateRender();
+    /**
+     * @brief Schedules a render of the unchanged scene for the next event loop turn.
+     */
+    void requestRender();
     /**
      * @brief Recursively renders tree view model parts.
      * @param index The starting index in the model tree.
      */
     void updateRenderFromTree(const QModelIndex &index);
     /**
-     * @brief Configures lighting in the VTK renderer.
+     * @brief Sets up the lights of the VTK renderer, replacing any existing ones.
      */
     void updateLight();
+    /**
+     * @brief Adds the actor of a part created by a folder hot reload to the scene.
+     * @param part The new part.
+     */
+    void handleWatchedPartAdded(ModelPart* part);
+    /**
+     * @brief Removes the actors of a part deleted by a folder hot reload from the scene.
+     * @param part The part about to be removed.
+     */
+    void handleWatchedPartRemoved(ModelPart* part);
+    /**
+     * @brief Re-renders once a batch of folder changes has been applied.
+     * @param reloaded Number of parts whose geometry was replaced.
+     * @param added Number of parts added.
+     * @param removed Number of parts removed.
+     */
+    void handleWatchedPartsUpdated(int reloaded, int added, int removed);
+    /**
+     * @brief Shows the geometry memory usage against the budget in the status bar.
+     * @param usage Memory in use, in bytes.
+     * @param budget Budget, in bytes.
+     * @param released Number of parts whose geometry is released.
+     */
+    void handleMemoryUsageChanged(qint64 usage, qint64 budget, int released);
+    /**
+     * @brief Selects the part drawn at a position of the VTK view in the tree.
+     * @param x Horizontal position in display coordinates.
+     * @param y Vertical position in display coordinates.
+     */
+    void selectPartAt(int x, int y);
 
 private slots:
     /**
-     * @brief Opens one or more STL files and loads them into the scene.
+     * @brief Rebuilds the scene if needed and renders it, driven by the render timer.
+     */
+    void renderNow();
+    /**
+     * @brief Fits the camera to the visible parts on the next render.
+     */
+    void on_actionReset_Camera_triggered();
+    /**
+     * @brief Opens one or more mesh files (STL, OBJ, PLY) and loads them into the scene.
      */
     void on_actionOpen_File_triggered();
     /**
@@ -85,17 +146,253 @@ private slots:
      */
     void on_actionItem_Options_triggered();
     /**
-     * @brief Opens a folder and loads all STL files under the selected node.
+     * @brief Opens a folder and loads all mesh files below it under the selected node.
      */
     void on_actionOpen_Folder_triggered();
+    /**
+     * @brief Turns watching of opened folders on or off.
+     * @param checked New state of the action.
+     */
+    void on_actionWatch_Folders_toggled(bool checked);
     /**
      * @brief Deletes the selected model part from the tree and the scene.
      */
     void on_pushButtonDelete_clicked();
+    /**
+     * @brief Replaces the current tree with the contents of a project file.
+     */
+    void on_actionOpen_Project_triggered();
+    /**
+     * @brief Saves the current tree to a project file.
+     */
+    void on_actionSave_Project_triggered();
+    /**
+     * @brief Asks for a folder and format, then writes the selected parts and everything below
+     *        them in the background, one file per part.
+     */
+    void on_actionExport_Parts_triggered();
+    /**
+     * @brief Switches every part between float and compact (quantised) geometry storage.
+     * @param checked True to store geometry compactly.
+     */
+    void on_actionCompact_Geometry_toggled(bool checked);
+    /**
+     * @brief Asks for a new geometry memory budget.
+     */
+    void on_actionMemory_Budget_triggered();
+    /**
+     * @brief Asks for the feature angle of the normals generated on load.
+     */
+    void on_actionSmooth_Shading_triggered();
+    /**
+     * @brief Turns the spatial sort of newly loaded meshes on or off.
+     * @param checked True to sort by position before ordering for the vertex cache.
+     */
+    void on_actionSpatial_Mesh_Order_toggled(bool checked);
+    /**
+     * @brief Shows or hides the triangle, point, memory and timing columns of the tree.
+     * @param checked True to show the columns.
+     */
+    void on_actionCost_Columns_toggled(bool checked);
+    /**
+     * @brief Shows or hides the area, volume, size and centre of mass columns of the tree.
+     * @param checked True to show the columns.
+     */
+    void on_actionMetrics_Columns_toggled(bool checked);
+    /**
+     * @brief Starts or stops recording trace events.
+     * @param checked True to record.
+     */
+    void on_actionRecord_Trace_toggled(bool checked);
+    /**
+     * @brief Turns merging of same coloured static parts on or off.
+     * @param checked True to batch parts.
+     */
+    void on_actionStatic_Batching_toggled(bool checked);
+    /**
+     * @brief Turns lower detail while the camera moves on or off.
+     * @param checked True to use proxies during camera motion.
+     */
+    void on_actionAdaptive_Detail_toggled(bool checked);
+    /**
+     * @brief Removes the section plane.
+     */
+    void on_actionSection_Off_triggered();
+    /**
+     * @brief Cuts the selected part with the section plane.
+     */
+    void on_actionSection_Part_triggered();
+    /**
+     * @brief Cuts the selected part and everything below it with the section plane.
+     */
+    void on_actionSection_Subtree_triggered();
+    /**
+     * @brief Cuts the whole scene with the section plane.
+     */
+    void on_actionSection_Scene_triggered();
+    /**
+     * @brief Starts animating the explode factor towards the slider's value.
+     * @param value Slider position, 0 to 100.
+     */
+    void on_sliderExplode_valueChanged(int value);
+    /**
+     * @brief Saves the recorded trace events as Chrome trace JSON.
+     */
+    void on_actionExport_Trace_triggered();
+    /**
+     * @brief Starts or stops clash detection, showing its results in the Clashes dock.
+     * @param checked True to detect clashes.
+     */
+    void on_actionClash_Detection_toggled(bool checked);
+    /**
+     * @brief Selects the first part of a clash and fits the camera to where the parts intersect.
+     * @param row Row in the clash list.
+     */
+    void on_listClashes_currentRowChanged(int row);
+    /**
+     * @brief Asks for an axis and spacing, then slices the selected part and its children in the background.
+     */
+    void on_actionSlice_Contours_triggered();
+    /**
+     * @brief Saves the drawn contours as CSV.
+     */
+    void on_actionExport_Contours_triggered();
+    /**
+     * @brief Removes the drawn contours.
+     */
+    void on_actionClear_Contours_triggered();
+    /**
+     * @brief Plays the explode and assemble sequence of the whole tree.
+     */
+    void on_actionPlay_Explode_Sequence_triggered();
+    /**
+     * @brief Plays one turn of the camera around the scene.
+     */
+    void on_actionPlay_Camera_Orbit_triggered();
+    /**
+     * @brief Stops the animation and puts the parts back.
+     */
+    void on_actionStop_Animation_triggered();
+    /**
+     * @brief Starts or stops showing the visible parts in the headset.
+     * @param checked True to start the VR thread.
+     */
+    void on_actionVR_Headset_toggled(bool checked);
 
 private:
+    /**
+     * @brief Changes what the section plane cuts, using the selected tree item as target.
+     * @param scope New scope.
+     */
+    void setSectionScope(SectionView::Scope scope);
+    /**
+     * @brief Positions the parts for an explode factor and schedules a render.
+     * @param factor 0 for the assembled model, 1 for fully exploded.
+     */
+    void setExplodeFactor(double factor);
+    /**
+     * @brief Checks the visible parts for clashes in the background, if clash detection is on.
+     * @details Only one check runs at a time; a request during a check starts another one after it.
+     */
+    void requestClashCheck();
+    /**
+     * @brief Lists and highlights the clashes found by the finished check.
+     */
+    void handleClashesFinished();
+    /**
+     * @brief Draws the contours of the finished slice over the scene.
+     */
+    void handleContoursFinished();
+    /**
+     * @brief Reports the files written by the finished export.
+     */
+    void handleExportFinished();
+    /**
+     * @brief Adds a part for every mesh the finished Open File read, under the item chosen then.
+     */
+    void handleOpenFinished();
+    /**
+     * @brief Starts playing an animation.
+     * @details Stop any other first, before building this one from the parts' positions.
+     * @param animation Finished animation.
+     */
+    void playAnimation(Animation animation);
+    /**
+     * @brief Evaluates the animation at the elapsed time and places the parts and camera.
+     */
+    void stepAnimation();
+    /**
+     * @brief Ends the animation, so the parts' own transforms place them again.
+     * @details Called before any part leaves the tree, so every track's part is still alive.
+     */
+    void stopAnimation();
+    /**
+     * @brief Gives every visible part an actor of its own and starts the VR thread on them.
+     * @details A playing animation is handed over too, and plays on the VR thread's clock.
+     */
+    void startVR();
+    /**
+     * @brief Asks the VR thread to end, handleVRFinished() cleans up once it has.
+     */
+    void stopVR();
+    /**
+     * @brief Forgets the VR thread and its actors once its loop has ended.
+     */
+    void handleVRFinished();
+    /**
+     * @brief Sends the VR thread the matrices of the parts that moved since they were last sent.
+     * @details Call after updateWorldMatrices(); only the live tree is walked, so parts that
+     *          have been deleted are never touched.
+     */
+    void sendVRMatrices();
+
     Ui::MainWindow *ui;  /**< Pointer to the generated UI elements */
     ModelPartList* partList;  /**< The data model managing the parts hierarchy */
+    QUndoStack* undoStack;  /**< Undoable adds, deletes and edits of parts */
+    FolderWatcher* folderWatcher;  /**< Imports folders and hot reloads watched ones */
+    MemoryBudget* memoryBudget;  /**< Releases hidden parts' geometry over the memory budget */
+    QLabel* memoryLabel;  /**< Permanent status bar label showing memory usage */
+    SectionView* sectionView;  /**< Hardware section plane and its widget */
+    InteractionLod* interactionLod;  /**< Swaps large parts for proxies while the camera moves */
+    QVariantAnimation* explodeAnimation;  /**< Eases the explode factor towards the slider value */
+    double explodeFactor = 0.;  /**< Current explode factor, 0 when assembled */
+    QTimer* renderTimer;  /**< Zero interval single shot timer coalescing render requests */
+    bool sceneDirty = false;  /**< Actors must be rebuilt from the tree before the next render */
+    bool cameraResetPending = false;  /**< Camera is fitted to the scene before the next render */
+    StaticBatcher batcher;  /**< Merged meshes of eligible parts while static batching is on */
+    QHash<vtkProp*, ModelPart*> actorParts;  /**< Part owning each unbatched actor in the scene, for picking */
+    ClashDetector clashDetector;  /**< Hierarchies and results kept between clash checks */
+    QFutureWatcher<QList<ClashDetector::Clash>>* clashWatcher;  /**< Watches the running clash check */
+    bool clashCheckPending = false;  /**< The scene changed while a clash check was running */
+    QList<ClashDetector::Clash> clashes;  /**< Clashes listed in the dock */
+    QList<QPersistentModelIndex> clashIndexes;  /**< First part of each listed clash, invalid once deleted */
+    vtkSmartPointer<vtkActor> clashActor;  /**< Intersecting triangles drawn over the scene, null if none */
+    QFutureWatcher<QList<ContourSlicer::Contour>>* contourWatcher;  /**< Watches the running slice */
+    QList<ContourSlicer::Contour> contours;  /**< Contours drawn over the scene */
+    vtkSmartPointer<vtkActor> contourActor;  /**< Contour lines drawn over the scene, null if none */
+    /** A file read by Open File */
+    struct LoadedMesh {
+        QString                         path;       /**< File name */
+        vtkSmartPointer<vtkPolyData>    polyData;   /**< Mesh read, null if it could not be */
+        double                          loadMs = 0.; /**< Time taken to read it */
+    };
+    QVector<LoadedMesh> openMeshes;  /**< Files being read by Open File, filled in on the thread pool */
+    QPersistentModelIndex openParent;  /**< Item the opened files are added under */
+    bool openResetsCamera = false;  /**< The scene was empty when the files were chosen */
+    QFutureWatcher<void>* openWatcher;  /**< Watches the running Open File reads */
+    QFutureWatcher<MeshExporter::Result>* exportWatcher;  /**< Watches the running export */
+    QElapsedTimer exportClock;  /**< Times the running export */
+    std::shared_ptr<const Animation> animation;  /**< Animation playing, null if none; shareable with the VR thread */
+    std::unique_ptr<Animation::Playhead> playhead;  /**< Desktop view's state in the animation */
+    QTimer* animationTimer;  /**< Steps the animation every frame while it plays */
+    QElapsedTimer animationClock;  /**< Time since the animation started */
+    VRRenderThread* vrThread = nullptr;  /**< Headset render loop, null while VR is off */
+    /** A part's actor in the VR scene */
+    struct VRActor {
+        vtkSmartPointer<vtkActor>   actor;      /**< Actor from ModelPart::getNewActor() */
+        quint64                     placement;  /**< placementStamp() of the matrix last sent */
+    };
+    QHash<ModelPart*, VRActor> vrActors;  /**< VR actor of each part, keys are never dereferenced */
     vtkSmartPointer<vtkRenderer> renderer;  /**< VTK renderer for 3D content */
     vtkSmartPointer<vtkGenericOpenGLRenderWindow> renderWindow;  /**< VTK render window */
 };
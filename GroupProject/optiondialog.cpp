@@ -40,22 +40,62 @@ void OptionDialog::setDialog(ModelPart* part)
     ui->spinBoxB->setValue(static_cast<int>(part->getColourB()));
     ui->checkBoxClipFilter->setChecked(part->clip());
     ui->checkBoxShrinkFilter->setChecked(part->shrink());
+
+    loadedTransform = part->transform();
+    ui->spinBoxPositionX->setValue(loadedTransform.position[0]);
+    ui->spinBoxPositionY->setValue(loadedTransform.position[1]);
+    ui->spinBoxPositionZ->setValue(loadedTransform.position[2]);
+    ui->spinBoxRotationX->setValue(loadedTransform.orientation[0]);
+    ui->spinBoxRotationY->setValue(loadedTransform.orientation[1]);
+    ui->spinBoxRotationZ->setValue(loadedTransform.orientation[2]);
+
+    /* Cost of the part itself and, for parts with children, of the whole branch */
+    const ModelPart::Stats own = part->stats();
+    const ModelPart::Stats total = part->subtreeStats();
+    const QList<QPair<QString, int>> rows = {
+        { tr("Triangles"), ModelPartList::TrianglesColumn },
+        { tr("Points"),    ModelPartList::PointsColumn },
+        { tr("Memory"),    ModelPartList::MemoryColumn },
+        { tr("Load time"), ModelPartList::LoadTimeColumn },
+        { tr("Filter time"), ModelPartList::FilterTimeColumn }
+    };
+    QStringList lines;
+    for (const auto& row : rows) {
+        QString line = row.first + " : " + ModelPartList::formatStat(own, row.second);
+        if (part->childCount() > 0)
+            line += tr(" (%1 with children)").arg(ModelPartList::formatStat(total, row.second));
+        lines.append(line);
+    }
+    ui->labelStats->setText(lines.join('\n'));
 }
 /**
- * @brief Updates the given ModelPart object with the current values from the dialog UI.
- * @param part Pointer to the ModelPart that will be updated.
+ * @brief Collects the values of the dialog's fields.
+ * @return the settings to apply to the part
  */
-void OptionDialog::setModelPart(ModelPart* part)
+EditPartCommand::Settings OptionDialog::settings() const
 {
-    if (!part)
-        return;
-    part->set(0, ui->lineEditName->text());
-    part->setVisible(ui->isVisible->isChecked());
-    part->set(1, ui->isVisible->isChecked());
-    part->setColour(static_cast<unsigned char>(ui->spinBoxR->value()),
-                    static_cast<unsigned char>(ui->spinBoxG->value()),
-                    static_cast<unsigned char>(ui->spinBoxB->value()));
-    part->setClip(ui->checkBoxClipFilter->isChecked());
-    part->setShrink(ui->checkBoxShrinkFilter->isChecked());
-    part->setFilter();
+    EditPartCommand::Settings settings;
+    settings.name = ui->lineEditName->text();
+    settings.visible = ui->isVisible->isChecked();
+    settings.colour[0] = static_cast<unsigned char>(ui->spinBoxR->value());
+    settings.colour[1] = static_cast<unsigned char>(ui->spinBoxG->value());
+    settings.colour[2] = static_cast<unsigned char>(ui->spinBoxB->value());
+    settings.clip = ui->checkBoxClipFilter->isChecked();
+    settings.shrink = ui->checkBoxShrinkFilter->isChecked();
+
+    /* The dialog has no scale fields, so the part keeps its scale. Spin boxes round to their
+     * decimals; a field left as loaded keeps its exact value */
+    auto edited = [](const QDoubleSpinBox* box, double loaded) {
+        return box->value() != QString::number(loaded, 'f', box->decimals()).toDouble();
+    };
+    settings.transform = loadedTransform;
+    const QDoubleSpinBox* position[3] = { ui->spinBoxPositionX, ui->spinBoxPositionY, ui->spinBoxPositionZ };
+    const QDoubleSpinBox* rotation[3] = { ui->spinBoxRotationX, ui->spinBoxRotationY, ui->spinBoxRotationZ };
+    for (int k = 0; k < 3; ++k) {
+        if (edited(position[k], loadedTransform.position[k]))
+            settings.transform.position[k] = position[k]->value();
+        if (edited(rotation[k], loadedTransform.orientation[k]))
+            settings.transform.orientation[k] = rotation[k]->value();
+    }
+    return settings;
 }
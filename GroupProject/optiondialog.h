@@ -12,6 +12,7 @@
 #include <QDialog>
 #include "ModelPart.h"
 #include "ModelPartList.h"
+#include "UndoCommands.h"
 
 namespace Ui {
 class OptionDialog;
@@ -42,14 +43,16 @@ public slots:
      * @param part Pointer to the ModelPart to edit.
      */
     void setDialog(ModelPart* part);
+
     /**
-     * @brief Updates the ModelPart object with the values from the dialog UI.
-     * @param part Pointer to the ModelPart to update.
+     * @brief Returns the values entered in the dialog, for an undoable edit.
+     * @return the name, visibility, colour and filter settings
      */
-    void setModelPart(ModelPart* part);
+    EditPartCommand::Settings settings() const;
 
 private:
     Ui::OptionDialog *ui;/**< Pointer to the UI form. */
+    ModelPart::Transform loadedTransform;/**< Transform of the part shown, for the fields the dialog lacks */
 };
 
 #endif // OPTIONDIALOG_H
@@ -0,0 +1,51 @@
+/**
+ * @file AsciiSTLParserTest.cpp
+ * @brief Regression checks for AsciiSTLParser::parseBlock on solid names.
+ * @details Names on "solid" and "endsolid" lines may contain the word "vertex"; they must not be
+ *          read as vertices. Run by ctest, a non-zero exit code reports a failure.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "AsciiSTLParser.h"
+#include "TestHarness.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs every case and reports the ones that fail.
+ */
+int main() {
+    TestHarness harness;
+    const char* facet =
+        "facet normal 0 0 1\n"
+        " outer loop\n"
+        "  vertex 0 0 0\n"
+        "  vertex 1 0 0\n"
+        "  vertex +0 1e0 0\n"
+        " endloop\n"
+        "endfacet\n";
+    struct Case {
+        const char* name;
+        std::string text;
+        size_t      expected;
+    };
+    const Case cases[] = {
+        { "plain facet", std::string(facet), 9 },
+        { "vertex in the endsolid name", std::string(facet) + "endsolid part vertex 1\n", 9 },
+        { "vertex in both names", "solid vertex\n" + std::string(facet) + "endsolid vertex\n", 9 },
+        { "two solids", "solid a\n" + std::string(facet) + "endsolid a vertex\nsolid vertex b\n"
+                            + std::string(facet) + "endsolid vertex b", 18 },
+    };
+
+    for (const Case& test : cases) {
+        std::vector<float> vertices;
+        const bool ok = AsciiSTLParser::parseBlock(test.text.data(), test.text.data() + test.text.size(), vertices);
+        harness.check(test.name, ok && vertices.size() == test.expected,
+                      QString("%1 with %2 values, expected %3").arg(ok ? "parsed" : "rejected")
+                          .arg(vertices.size()).arg(test.expected));
+    }
+    return harness.result();
+}
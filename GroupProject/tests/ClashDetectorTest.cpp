@@ -0,0 +1,95 @@
+/**
+ * @file ClashDetectorTest.cpp
+ * @brief Regression checks for ClashDetector on pairs of cubes.
+ * @details Cubes resting flush on each other, side by side or offset along a shared face only
+ *          touch and must not clash; overlapping and interpenetrating cubes must. Run by ctest,
+ *          a non-zero exit code reports a failure.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "ClashDetector.h"
+#include "MeshUtils.h"
+#include "ModelPart.h"
+#include "TestHarness.h"
+
+#include <vtkMatrix4x4.h>
+
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Builds a closed axis aligned cube of twelve triangles.
+ * @param x Lowest x.
+ * @param y Lowest y.
+ * @param z Lowest z.
+ * @param size Edge length.
+ */
+vtkSmartPointer<vtkPolyData> cube(float x, float y, float z, float size) {
+    std::vector<float> points;
+    for (int i = 0; i < 8; ++i) {
+        points.push_back(x + (i & 1) * size);
+        points.push_back(y + ((i >> 1) & 1) * size);
+        points.push_back(z + ((i >> 2) & 1) * size);
+    }
+    const quint32 faces[6][4] = { { 0, 2, 3, 1 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 },
+                                  { 2, 6, 7, 3 }, { 0, 4, 6, 2 }, { 1, 3, 7, 5 } };
+    std::vector<quint32> indices;
+    for (const auto& face : faces) {
+        for (quint32 corner : { face[0], face[1], face[2], face[0], face[2], face[3] })
+            indices.push_back(corner);
+    }
+    return MeshUtils::makePolyData(points.data(), 8, indices.data(), 12);
+}
+
+/**
+ * @brief Checks two cubes against each other.
+ * @return the number of clashes found, 0 or 1
+ */
+int clashes(vtkPolyData* first, vtkPolyData* second) {
+    ModelPart a({ "a", "true" });
+    ModelPart b({ "b", "true" });
+    QList<ClashDetector::Input> inputs;
+    for (auto [part, geometry] : { std::make_pair(&a, first), std::make_pair(&b, second) }) {
+        ClashDetector::Input input;
+        input.part = part;
+        input.geometry = geometry;
+        vtkMatrix4x4::Identity(input.matrix);
+        input.time = geometry->GetMTime();
+        inputs.append(input);
+    }
+    ClashDetector detector;
+    return int(detector.detect(inputs).size());
+}
+
+}
+
+/**
+ * @brief Runs every case and reports the ones that fail.
+ */
+int main() {
+    TestHarness harness;
+    struct Case {
+        const char*                     name;
+        vtkSmartPointer<vtkPolyData>    other;
+        int                             expected;
+    };
+    const vtkSmartPointer<vtkPolyData> base = cube(0.f, 0.f, 0.f, 1.f);
+    const Case cases[] = {
+        { "smaller cube resting on top", cube(0.25f, 0.25f, 1.f, 0.5f), 0 },
+        { "equal cube side by side", cube(1.f, 0.f, 0.f, 1.f), 0 },
+        { "cube against a side, offset", cube(1.f, 0.5f, 0.3f, 1.f), 0 },
+        { "smaller cube flush underneath", cube(0.25f, 0.25f, -0.5f, 0.5f), 0 },
+        { "overlapping cubes", cube(0.5f, 0.5f, 0.5f, 1.f), 1 },
+        { "cube pushed through the bottom", cube(0.25f, 0.25f, -0.25f, 0.5f), 1 },
+    };
+
+    for (const Case& test : cases) {
+        const int found = clashes(base, test.other);
+        harness.check(test.name, found == test.expected,
+                      QString("%1 clashes, expected %2").arg(found).arg(test.expected));
+    }
+    return harness.result();
+}
@@ -0,0 +1,95 @@
+/**
+ * @file GeometryCacheTest.cpp
+ * @brief Regression checks for GeometryCache::readEntry on valid and damaged entries.
+ * @details An entry is written and read back, then read again with its header overwritten or
+ *          its body cut short. Every damaged entry must be refused, so that the cache simply
+ *          makes it again. Run by ctest, a non-zero exit code reports a failure.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "GeometryCache.h"
+#include "MeshUtils.h"
+#include "TestHarness.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <cstring>
+#include <functional>
+
+namespace {
+
+/* Byte offsets of the header fields, see GeometryCache.cpp */
+const int HeaderSize          = 24;
+const int HeaderVersion       = 4;
+const int HeaderPointCount    = 8;
+const int HeaderTriangleCount = 12;
+
+/**
+ * @brief Overwrites a value in a file image.
+ */
+template <typename T>
+void put(QByteArray& bytes, qint64 offset, T value) {
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+}
+
+/**
+ * @brief Runs every case and reports the ones that fail.
+ */
+int main() {
+    TestHarness harness;
+    QTemporaryDir dir;
+    if (!harness.check("temporary directory", dir.isValid()))
+        return harness.result();
+    const QString entry = dir.filePath("test.gpg");
+
+    const float points[] = { 0.f, 0.f, 0.f,  1.f, 0.f, 0.f,  0.f, 1.f, 0.f,  0.f, 0.f, 1.f };
+    const quint32 indices[] = { 0, 2, 1,  0, 1, 3,  0, 3, 2,  1, 2, 3 };
+    if (!harness.check("write", GeometryCache::writeEntry(entry, MeshUtils::makePolyData(points, 4, indices, 4))))
+        return harness.result();
+
+    QFile written(entry);
+    if (!harness.check("read back", written.open(QIODevice::ReadOnly)))
+        return harness.result();
+    const QByteArray valid = written.readAll();
+    written.close();
+
+    vtkSmartPointer<vtkPolyData> mesh = GeometryCache::readEntry(entry);
+    harness.check("valid entry", mesh && mesh->GetNumberOfPoints() == 4 && mesh->GetNumberOfPolys() == 4,
+                  mesh ? "wrong mesh" : "rejected");
+    harness.check("missing entry", !GeometryCache::readEntry(dir.filePath("missing.gpg")), "loaded");
+
+    struct Case {
+        const char*                         name;
+        std::function<void(QByteArray&)>    damage;
+    };
+    const Case cases[] = {
+        { "shorter than the header", [](QByteArray& b) { b.truncate(HeaderSize - 4); } },
+        { "wrong magic", [](QByteArray& b) { b[3] = 'X'; } },
+        { "older version", [](QByteArray& b) { put<quint32>(b, HeaderVersion, 0); } },
+        { "newer version", [](QByteArray& b) { put<quint32>(b, HeaderVersion, 2); } },
+        { "more points than stored", [](QByteArray& b) { put<quint32>(b, HeaderPointCount, 0xffffffffu); } },
+        { "more triangles than stored", [](QByteArray& b) { put<quint32>(b, HeaderTriangleCount, 0xffffffffu); } },
+        { "body cut short", [](QByteArray& b) { b.chop(4); } },
+        { "triangle naming a missing point",
+          [](QByteArray& b) { put<quint32>(b, HeaderSize + 4 * 3 * sizeof(float), 4); } },
+    };
+
+    for (const Case& test : cases) {
+        QByteArray bytes = valid;
+        test.damage(bytes);
+        QFile file(entry);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            harness.check(test.name, false, file.errorString());
+            continue;
+        }
+        file.write(bytes);
+        file.close();
+        harness.check(test.name, !GeometryCache::readEntry(entry), "loaded");
+    }
+    return harness.result();
+}
@@ -0,0 +1,151 @@
+/**
+ * @file MeshImporterTest.cpp
+ * @brief Regression checks for the native OBJ and PLY readers on valid and malformed files.
+ * @details Valid files must give the expected points and triangles; malformed ones, in
+ *          particular binary PLY files whose element and list counts do not match their size,
+ *          must be refused without reading past the end of the mapped file. Run by ctest, a
+ *          non-zero exit code reports a failure.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "MeshImporter.h"
+#include "TestHarness.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+namespace {
+
+/**
+ * @brief Returns the bytes of a list of values, in host (little-endian) order.
+ */
+template <typename... T>
+QByteArray pack(T... values) {
+    QByteArray bytes;
+    (bytes.append(reinterpret_cast<const char*>(&values), sizeof(values)), ...);
+    return bytes;
+}
+
+/**
+ * @brief Builds a binary little-endian PLY file.
+ * @param header Element and property lines.
+ * @param body Binary data following the header.
+ */
+QByteArray ply(const QByteArray& header, const QByteArray& body) {
+    return QByteArray("ply\nformat binary_little_endian 1.0\n") + header + "end_header\n" + body;
+}
+
+/**
+ * @brief Returns the binary body of four vertices and one quad.
+ * @param last Index of the quad's last corner.
+ */
+QByteArray quadBody(qint32 last = 3) {
+    QByteArray body;
+    const float points[] = { 0.f, 0.f, 0.f,  1.f, 0.f, 0.f,  1.f, 1.f, 0.f,  0.f, 1.f, 0.f };
+    for (float value : points)
+        body += pack(value);
+    body += pack(quint8(4), qint32(0), qint32(1), qint32(2), last);
+    return body;
+}
+
+const char* const QuadHeader =
+    "element vertex 4\n"
+    "property float x\nproperty float y\nproperty float z\n"
+    "element face 1\n"
+    "property list uchar int vertex_indices\n";
+
+}
+
+/**
+ * @brief Runs every case and reports the ones that fail.
+ */
+int main() {
+    TestHarness harness;
+    QTemporaryDir dir;
+    if (!harness.check("temporary directory", dir.isValid()))
+        return harness.result();
+
+    const QByteArray faceHeader = "element vertex 4\nproperty float x\nproperty float y\nproperty float z\n";
+    struct Case {
+        const char* name;
+        const char* extension;
+        QByteArray  data;
+        vtkIdType   points;         /**< Expected points, 0 if the file must be refused */
+        vtkIdType   polygons;       /**< Expected polygons */
+    };
+    const Case cases[] = {
+        /* OBJ */
+        { "obj quad and relative triangle", "obj",
+          "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\nf -4 -3 -2\n", 4, 3 },
+        { "obj texture and normal indices", "obj",
+          "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\nf 1/1/1 2/1/1 3/1/1\n", 3, 1 },
+        { "obj empty", "obj", "", 0, 0 },
+        { "obj without faces", "obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\n", 0, 0 },
+        { "obj index 0", "obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n", 0, 0 },
+        { "obj index past the points", "obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 9\n", 0, 0 },
+        { "obj relative index before the first point", "obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf -4 -1 -2\n", 0, 0 },
+        { "obj bad coordinate", "obj", "v 0 x 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", 0, 0 },
+
+        /* Binary PLY, quads are fan triangulated */
+        { "ply quad", "ply", ply(QuadHeader, quadBody()), 4, 2 },
+        { "ply extra element with lists", "ply",
+          ply(QByteArray(QuadHeader) + "element edge 1\nproperty list uchar int vertex_pair\nproperty uchar flag\n",
+              quadBody() + pack(quint8(2), qint32(0), qint32(1), quint8(7))), 4, 2 },
+        { "ply negative vertex count", "ply",
+          ply("element vertex -1\nproperty float x\nproperty float y\nproperty float z\n", quadBody()), 0, 0 },
+        { "ply unreadable vertex count", "ply",
+          ply("element vertex many\nproperty float x\nproperty float y\nproperty float z\n", quadBody()), 0, 0 },
+        { "ply vertex count past the end", "ply",
+          ply("element vertex 4000000000\nproperty float x\nproperty float y\nproperty float z\n", quadBody()), 0, 0 },
+        { "ply vertex count overflowing the stride", "ply",
+          ply("element vertex 4611686018427387904\nproperty double x\nproperty double y\nproperty double z\n",
+              quadBody()), 0, 0 },
+        { "ply face count past the end", "ply",
+          ply(faceHeader + "element face 1000000000000000\nproperty list uchar int vertex_indices\n", quadBody()), 0, 0 },
+        { "ply list longer than the file", "ply",
+          ply(QuadHeader, quadBody().replace(48, 1, QByteArray(1, char(200)))), 0, 0 },
+        { "ply negative list count", "ply",
+          ply(faceHeader + "element face 1\nproperty list char int vertex_indices\n",
+              quadBody().replace(48, 1, QByteArray(1, char(-1)))), 0, 0 },
+        { "ply floating point list count", "ply",
+          ply(faceHeader + "element face 1\nproperty list float int vertex_indices\n", quadBody()), 0, 0 },
+        { "ply extra element list past the end", "ply",
+          ply(QByteArray(QuadHeader) + "element edge 1\nproperty list uchar int vertex_pair\n",
+              quadBody() + pack(quint8(50), qint32(0))), 0, 0 },
+        { "ply extra element scalar past the end", "ply",
+          ply(QByteArray(QuadHeader) + "element edge 1\nproperty list uchar int vertex_pair\nproperty double weight\n",
+              quadBody() + pack(quint8(1), qint32(0), qint32(0))), 0, 0 },
+        { "ply face cut short", "ply", ply(QuadHeader, quadBody().chopped(2)), 0, 0 },
+        { "ply index past the points", "ply", ply(QuadHeader, quadBody(7)), 0, 0 },
+        { "ply negative index", "ply", ply(QuadHeader, quadBody(-1)), 0, 0 },
+        { "ply without end_header", "ply", "ply\nformat binary_little_endian 1.0\nelement vertex 0\n", 0, 0 },
+    };
+
+    int file = 0;
+    for (const Case& test : cases) {
+        const QString fileName = dir.filePath(QString("case%1.%2").arg(file++).arg(QString::fromLatin1(test.extension)));
+        QFile out(fileName);
+        if (!out.open(QIODevice::WriteOnly)) {
+            harness.check(test.name, false, out.errorString());
+            continue;
+        }
+        out.write(test.data);
+        out.close();
+
+        vtkSmartPointer<vtkPolyData> mesh = QString(test.extension) == "obj" ? MeshImporter::readOBJ(fileName)
+                                                                           : MeshImporter::readPLY(fileName);
+        if (test.points == 0) {
+            harness.check(test.name, !mesh, "loaded");
+            continue;
+        }
+        harness.check(test.name, mesh && mesh->GetNumberOfPoints() == test.points
+                                     && mesh->GetNumberOfPolys() == test.polygons,
+                      mesh ? QString("%1 points and %2 polygons, expected %3 and %4")
+                                 .arg(mesh->GetNumberOfPoints()).arg(mesh->GetNumberOfPolys())
+                                 .arg(test.points).arg(test.polygons)
+                           : QString("rejected"));
+    }
+    return harness.result();
+}
@@ -0,0 +1,165 @@
+/**
+ * @file ProjectFileTest.cpp
+ * @brief Regression checks for ProjectFile::load on valid and damaged project files.
+ * @details A small project is saved with its geometry embedded and loaded back, then loaded
+ *          again with one header field, node record or index overwritten at a time. Every
+ *          damaged copy must be refused without touching memory outside the file. Run by ctest,
+ *          a non-zero exit code reports a failure.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "MeshUtils.h"
+#include "ModelPart.h"
+#include "ProjectFile.h"
+#include "TestHarness.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <cstring>
+#include <functional>
+
+namespace {
+
+/* Byte offsets of the fields the cases overwrite, see ProjectFile.cpp */
+const int HeaderSize             = 48;
+const int HeaderVersion          = 4;
+const int HeaderNodeCount        = 8;
+const int HeaderStringOffset     = 16;
+const int HeaderStringSize       = 24;
+const int HeaderGeometryOffset   = 32;
+const int HeaderGeometrySize     = 40;
+const int NodeSize               = 80;
+const int NodeParent             = 0;
+const int NodeNameOffset         = 4;
+const int NodeGeometryOffset     = 64;
+const int NodePointCount         = 72;
+
+/**
+ * @brief Builds a tetrahedron.
+ */
+vtkSmartPointer<vtkPolyData> tetrahedron() {
+    const float points[] = { 0.f, 0.f, 0.f,  1.f, 0.f, 0.f,  0.f, 1.f, 0.f,  0.f, 0.f, 1.f };
+    const quint32 indices[] = { 0, 2, 1,  0, 1, 3,  0, 3, 2,  1, 2, 3 };
+    return MeshUtils::makePolyData(points, 4, indices, 4);
+}
+
+/**
+ * @brief Overwrites a value in a file image.
+ */
+template <typename T>
+void put(QByteArray& bytes, qint64 offset, T value) {
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+/**
+ * @brief Reads a value from a file image.
+ */
+template <typename T>
+T get(const QByteArray& bytes, qint64 offset) {
+    T value;
+    std::memcpy(&value, bytes.constData() + offset, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Writes a file image and loads it as a project.
+ * @param parts Receives the loaded top level parts.
+ */
+bool load(const QString& fileName, const QByteArray& bytes, QList<ModelPart*>& parts) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    file.write(bytes);
+    file.close();
+    return ProjectFile::load(fileName, parts);
+}
+
+}
+
+/**
+ * @brief Runs every case and reports the ones that fail.
+ */
+int main() {
+    TestHarness harness;
+    QTemporaryDir dir;
+    if (!harness.check("temporary directory", dir.isValid()))
+        return harness.result();
+    const QString fileName = dir.filePath("test.gpp");
+
+    /* A visible parent with a hidden child, both with embedded geometry */
+    {
+        ModelPart root({ "Part", "Visible?" });
+        ModelPart* parent = new ModelPart({ "parent", "true" });
+        ModelPart* child = new ModelPart({ "child", "false" });
+        parent->setPolyData(tetrahedron());
+        child->setPolyData(tetrahedron());
+        child->setVisible(false);
+        root.appendChild(parent);
+        parent->appendChild(child);
+        QString error;
+        if (!harness.check("save", ProjectFile::save(fileName, &root, true, &error), error))
+            return harness.result();
+    }
+    QFile saved(fileName);
+    if (!harness.check("read back", saved.open(QIODevice::ReadOnly)))
+        return harness.result();
+    const QByteArray valid = saved.readAll();
+    saved.close();
+
+    /* The saved project loads, with the visibility column as text */
+    {
+        QList<ModelPart*> parts;
+        const bool ok = load(fileName, valid, parts);
+        const bool shape = ok && parts.size() == 1 && parts[0]->childCount() == 1;
+        harness.check("valid project", shape, ok ? "wrong tree" : "rejected");
+        if (shape) {
+            harness.check("visible part", parts[0]->data(1).toString() == "true",
+                          parts[0]->data(1).toString());
+            harness.check("hidden part", parts[0]->child(0)->data(1).toString() == "false"
+                                             && !parts[0]->child(0)->visible(),
+                          parts[0]->child(0)->data(1).toString());
+        }
+        qDeleteAll(parts);
+    }
+
+    const qint64 firstNode = HeaderSize;
+    const qint64 secondNode = HeaderSize + NodeSize;
+    const qint64 geometry = get<quint64>(valid, HeaderGeometryOffset);
+    struct Case {
+        const char*                         name;
+        std::function<void(QByteArray&)>    damage;
+    };
+    const Case cases[] = {
+        { "truncated header", [](QByteArray& b) { b.truncate(HeaderSize - 8); } },
+        { "wrong magic", [](QByteArray& b) { b[0] = 'X'; } },
+        { "older version", [](QByteArray& b) { put<quint32>(b, HeaderVersion, 0); } },
+        { "newer version", [](QByteArray& b) { put<quint32>(b, HeaderVersion, 2); } },
+        { "node table past the end", [](QByteArray& b) { put<quint32>(b, HeaderNodeCount, 0x10000000); } },
+        { "string table past the end", [](QByteArray& b) { put<quint64>(b, HeaderStringOffset, ~quint64(0)); } },
+        { "string table size wraps", [](QByteArray& b) { put<quint64>(b, HeaderStringSize, ~quint64(0)); } },
+        { "geometry past the end", [](QByteArray& b) { put<quint64>(b, HeaderGeometryOffset, quint64(1) << 40); } },
+        { "geometry size wraps", [](QByteArray& b) { put<quint64>(b, HeaderGeometrySize, ~quint64(0)); } },
+        { "parent after its child", [=](QByteArray& b) { put<qint32>(b, firstNode + NodeParent, 1); } },
+        { "parent below -1", [=](QByteArray& b) { put<qint32>(b, secondNode + NodeParent, -2); } },
+        { "name outside the string table", [=](QByteArray& b) { put<quint32>(b, firstNode + NodeNameOffset, 0xfffffff0u); } },
+        { "mesh outside the geometry section",
+          [=](QByteArray& b) { put<quint64>(b, secondNode + NodeGeometryOffset, quint64(1) << 40); } },
+        { "mesh larger than the geometry section",
+          [=](QByteArray& b) { put<quint32>(b, firstNode + NodePointCount, 0xffffffffu); } },
+        { "triangle naming a missing point",
+          [=](QByteArray& b) { put<quint32>(b, geometry + 4 * 3 * sizeof(float), 4); } },
+    };
+
+    for (const Case& test : cases) {
+        QByteArray bytes = valid;
+        test.damage(bytes);
+        QList<ModelPart*> parts;
+        const bool ok = load(fileName, bytes, parts);
+        harness.check(test.name, !ok && parts.isEmpty(), "loaded");
+        qDeleteAll(parts);
+    }
+    return harness.result();
+}
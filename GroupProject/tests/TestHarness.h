@@ -0,0 +1,59 @@
+/**
+ * @file TestHarness.h
+ * @brief Declaration of the TestHarness class shared by the regression tests.
+ * @details Every test is a plain executable run by ctest: it checks its cases through one
+ *          TestHarness, which prints "FAIL name: detail" for each case that fails, and returns
+ *          result() from main(), so a non-zero exit code reports a failure.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+#ifndef VIEWER_TESTHARNESS_H
+#define VIEWER_TESTHARNESS_H
+
+#include <QString>
+#include <QTextStream>
+
+/**
+ * @class TestHarness
+ * @brief Counts and reports failed cases.
+ */
+class TestHarness {
+public:
+    /**
+     * @brief Creates a harness that reports to stderr.
+     */
+    TestHarness() : err(stderr) {
+    }
+
+    /**
+     * @brief Reports a case as failed unless ok is set.
+     * @param name Name of the case.
+     * @param ok Whether the case passed.
+     * @param detail What was found and what was expected, printed only on failure.
+     * @return ok
+     */
+    bool check(const QString& name, bool ok, const QString& detail = QString()) {
+        if (!ok) {
+            err << "FAIL " << name;
+            if (!detail.isEmpty())
+                err << ": " << detail;
+            err << Qt::endl;
+            ++failures;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Returns the exit code for main(), 1 if any case failed.
+     */
+    int result() const {
+        return failures > 0 ? 1 : 0;
+    }
+
+private:
+    QTextStream err;            /**< Failure report */
+    int         failures = 0;   /**< Number of failed cases */
+};
+
+#endif
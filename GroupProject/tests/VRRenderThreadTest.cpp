@@ -0,0 +1,142 @@
+/**
+ * @file VRRenderThreadTest.cpp
+ * @brief Regression checks for the VRRenderThread loop on the offscreen backend.
+ * @details The loop must stop after its frame limit, stop on END_RENDER when it has none, and
+ *          turn the actors by the commanded angle per 20 ms of real time, however long each frame
+ *          takes. Run by ctest, a non-zero exit code reports a failure.
+ * @version 1.0.0
+ * @author Woojin, Zhixing, Zhiyuan
+ * @date 2026-10-18
+ */
+
+#include "MeshUtils.h"
+#include "TestHarness.h"
+#include "VRRenderThread.h"
+
+#include <QElapsedTimer>
+
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPolyDataMapper.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/** Longest a run may take before the test gives up on it */
+const unsigned long TimeoutMs = 30000;
+
+/**
+ * @brief Builds an actor showing a tetrahedron.
+ */
+vtkSmartPointer<vtkActor> tetrahedron() {
+    const float points[] = { 0.f, 0.f, 0.f,  1.f, 0.f, 0.f,  0.f, 1.f, 0.f,  0.f, 0.f, 1.f };
+    const quint32 indices[] = { 0, 2, 1,  0, 1, 3,  0, 3, 2,  1, 2, 3 };
+    auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    mapper->SetInputData(MeshUtils::makePolyData(points, 4, indices, 4));
+    auto actor = vtkSmartPointer<vtkActor>::New();
+    actor->SetMapper(mapper);
+    return actor;
+}
+
+/**
+ * @brief Waits until the loop has drawn its first frame.
+ * @return false if it did not within the timeout
+ */
+bool waitForFirstFrame(VRRenderThread& thread) {
+    QElapsedTimer timer;
+    timer.start();
+    while (thread.frameStats().frames == 0) {
+        if (thread.isFinished() || timer.elapsed() > qint64(TimeoutMs))
+            return false;
+        QThread::msleep(1);
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the angle in degrees of the rotation taking one actor matrix to another.
+ * @details The angle of a rotation R satisfies trace(R) = 1 + 2 cos(angle), and the trace of
+ *          before^T after is the sum of the products of their matching elements.
+ */
+double rotationAngle(vtkMatrix4x4* before, vtkMatrix4x4* after) {
+    double trace = 0.;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j)
+            trace += before->GetElement(i, j) * after->GetElement(i, j);
+    }
+    return vtkMath::DegreesFromRadians(std::acos(std::clamp((trace - 1.) / 2., -1., 1.)));
+}
+
+}
+
+/**
+ * @brief Runs every case and reports the ones that fail.
+ */
+int main() {
+    TestHarness harness;
+
+    /* The frame limit ends the loop */
+    {
+        const int frames = 5;
+        VRRenderThread thread;
+        thread.addActorOffline(tetrahedron());
+        thread.setOffscreen(64, 64, frames);
+        thread.start();
+        const bool finished = thread.wait(TimeoutMs);
+        harness.check("frame limit", finished && thread.frameStats().frames == frames,
+                      finished ? QString("%1 frames, expected %2").arg(thread.frameStats().frames).arg(frames)
+                               : QString("still running"));
+    }
+
+    /* Without a limit END_RENDER ends it */
+    {
+        VRRenderThread thread;
+        thread.addActorOffline(tetrahedron());
+        thread.setOffscreen(64, 64);
+        thread.start();
+        const bool started = waitForFirstFrame(thread);
+        thread.issueCommand(VRRenderThread::END_RENDER, 0.);
+        const bool finished = thread.wait(TimeoutMs);
+        harness.check("end render", started && finished, started ? "still running" : "no frame drawn");
+        if (!finished) {
+            thread.terminate();
+            thread.wait();
+        }
+    }
+
+    /* Rotation follows the clock: degrees per 20 ms of loop time, not per frame */
+    {
+        const double degreesPer20Ms = 0.2;
+        vtkSmartPointer<vtkActor> actor = tetrahedron();
+        VRRenderThread thread;
+        thread.addActorOffline(actor);
+        auto before = vtkSmartPointer<vtkMatrix4x4>::New();
+        before->DeepCopy(actor->GetMatrix());
+
+        thread.setOffscreen(64, 64);
+        thread.issueCommand(VRRenderThread::ROTATE_Y, degreesPer20Ms);
+        thread.start();
+        const bool started = waitForFirstFrame(thread);
+        QThread::msleep(500);
+        thread.issueCommand(VRRenderThread::END_RENDER, 0.);
+        const bool finished = thread.wait(TimeoutMs);
+        if (!harness.check("rotation", started && finished, "loop did not run")) {
+            thread.terminate();
+            thread.wait();
+            return harness.result();
+        }
+
+        /* Steps happen once more than 20 ms have passed, so the last one may be up to that
+         * plus a frame before the loop ended */
+        const VRRenderThread::FrameStats stats = thread.frameStats();
+        const double angle = rotationAngle(before, actor->GetMatrix());
+        const double most = degreesPer20Ms * stats.totalMs / 20.;
+        const double least = degreesPer20Ms * (stats.totalMs - 20. - 2. * stats.maxMs) / 20.;
+        harness.check("rotation", angle <= most * 1.1 + 0.01 && angle >= least * 0.9,
+                      QString("turned %1 degrees in %2 frames over %3 ms, expected %4 to %5")
+                          .arg(angle).arg(stats.frames).arg(stats.totalMs).arg(least).arg(most));
+    }
+    return harness.result();
+}